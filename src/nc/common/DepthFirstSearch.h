@@ -0,0 +1,169 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <cassert>
+#include <cstddef> /* std::size_t */
+#include <utility> /* std::pair */
+#include <vector>
+
+#include "Foreach.h"
+
+namespace nc {
+
+/**
+ * Iterative depth-first search in a graph whose nodes are numbered from zero.
+ *
+ * Node colors are kept in a flat vector and the recursion is replaced by
+ * an explicit stack, so that long chains of nodes do not overflow the call
+ * stack and the traversal takes time linear in the size of the visited part
+ * of the graph.
+ *
+ * The nodes are visited in exactly the same order as by the classic
+ * recursive algorithm iterating over the successors in the given order.
+ */
+class DepthFirstSearch {
+public:
+    /** Node color. */
+    enum Color {
+        WHITE, ///< Not visited yet.
+        GRAY,  ///< Being visited.
+        BLACK  ///< Visited.
+    };
+
+    /**
+     * Base class for visitors doing nothing.
+     * Visitors do not need to be derived from it: any class with the same
+     * members will do. The members are resolved at compile time.
+     */
+    class Visitor {
+    public:
+        /**
+         * Called when the node is painted gray.
+         *
+         * \param node Index of the node.
+         */
+        void discover(std::size_t node) { (void)node; }
+
+        /**
+         * Called for every edge going out of a gray node.
+         *
+         * \param node      Index of the tail of the edge.
+         * \param index     Index of the edge among the edges going out of the node.
+         * \param successor Index of the head of the edge.
+         * \param color     Color of the successor.
+         *
+         * \return True if the successor must be visited, if it is white.
+         */
+        bool follow(std::size_t node, std::size_t index, std::size_t successor, Color color) {
+            (void)node; (void)index; (void)successor; (void)color;
+            return true;
+        }
+
+        /**
+         * Called when the node is painted black.
+         *
+         * \param node Index of the node.
+         */
+        void finish(std::size_t node) { (void)node; }
+    };
+
+private:
+    /** Colors of the nodes. */
+    std::vector<Color> colors_;
+
+    /** Nodes painted since the last reset. */
+    std::vector<std::size_t> painted_;
+
+    /** Stack of gray nodes, together with the index of the next edge to follow. */
+    std::vector<std::pair<std::size_t, std::size_t>> stack_;
+
+public:
+    /**
+     * Constructor.
+     *
+     * \param nodeCount Number of nodes in the graph.
+     */
+    explicit DepthFirstSearch(std::size_t nodeCount): colors_(nodeCount, WHITE) {}
+
+    /**
+     * \param node Index of a node.
+     *
+     * \return Color of the node.
+     */
+    Color color(std::size_t node) const {
+        assert(node < colors_.size());
+        return colors_[node];
+    }
+
+    /**
+     * Paints all the nodes white again.
+     * Takes time proportional to the number of nodes visited since the last reset.
+     */
+    void reset() {
+        foreach (std::size_t node, painted_) {
+            colors_[node] = WHITE;
+        }
+        painted_.clear();
+    }
+
+    /**
+     * Visits a white node and all white nodes reachable from it via followed edges.
+     *
+     * \param root       Index of a white node.
+     * \param successors Functor returning for a node index a random access
+     *                   container of the indices of its successors.
+     * \param visitor    Visitor with the members of DepthFirstSearch::Visitor.
+     */
+    template<class Successors, class V>
+    void visit(std::size_t root, const Successors &successors, V &visitor) {
+        assert(color(root) == WHITE);
+
+        paint(root, GRAY);
+        visitor.discover(root);
+        stack_.push_back(std::make_pair(root, std::size_t(0)));
+
+        while (!stack_.empty()) {
+            std::size_t node = stack_.back().first;
+            std::size_t &index = stack_.back().second;
+
+            const auto &nodeSuccessors = successors(node);
+
+            if (index < nodeSuccessors.size()) {
+                std::size_t successor = nodeSuccessors[index];
+                Color successorColor = color(successor);
+
+                if (visitor.follow(node, index++, successor, successorColor) && successorColor == WHITE) {
+                    paint(successor, GRAY);
+                    visitor.discover(successor);
+                    stack_.push_back(std::make_pair(successor, std::size_t(0)));
+                }
+            } else {
+                stack_.pop_back();
+                colors_[node] = BLACK;
+                visitor.finish(node);
+            }
+        }
+    }
+
+private:
+    /**
+     * Sets the color of a node, remembering it for reset().
+     *
+     * \param node  Index of the node.
+     * \param color New color.
+     */
+    void paint(std::size_t node, Color color) {
+        if (colors_[node] == WHITE) {
+            painted_.push_back(node);
+        }
+        colors_[node] = color;
+    }
+};
+
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
@@ -101,12 +101,17 @@ class DisjointSet {
 
     /**
      * Finds a representative of the set using path compression.
+     * Does not write anything when the path is already compressed,
+     * so that compressed sets can be queried from several threads.
      *
      * \return The representative.
      */
     DisjointSet<T> *findSetImpl() const {
         if (parent_ != this) {
-            parent_ = parent_->findSetImpl();
+            DisjointSet<T> *representative = parent_->findSetImpl();
+            if (parent_ != representative) {
+                parent_ = representative;
+            }
         }
         return parent_;
     }
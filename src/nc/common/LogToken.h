@@ -27,6 +27,7 @@
 
 #include <cassert>
 #include <memory>
+#include <type_traits>
 
 #include "Logger.h"
 
@@ -58,6 +59,13 @@ public:
         assert(logger_);
     }
 
+    /**
+     * \param level Log level.
+     *
+     * \return True if messages with the given level are logged.
+     */
+    bool isEnabled(LogLevel level) const { return logger_ && logger_->isEnabled(level); }
+
     /**
      * Logs a message with a given level.
      *
@@ -65,11 +73,25 @@ public:
      * \param[in] text  Text of the message.
      */
     void log(LogLevel level, const QString &text) const {
-        if (logger_) {
+        if (isEnabled(level)) {
             logger_->log(level, text);
         }
     }
 
+    /**
+     * Logs a message with a given level, formatting it only if it is logged.
+     *
+     * \param[in] level    Log level of the message.
+     * \param[in] makeText Function returning the text of the message.
+     */
+    template<class MakeText>
+    typename std::enable_if<!std::is_convertible<MakeText, QString>::value>::type
+    log(LogLevel level, const MakeText &makeText) const {
+        if (isEnabled(level)) {
+            logger_->log(level, makeText());
+        }
+    }
+
     /**
      * Logs a message with the debug level.
      *
@@ -77,6 +99,15 @@ public:
      */
     void debug(const QString &text) const { log(LogLevel::DEBUG, text); }
 
+    /**
+     * Logs a message with the debug level, formatting it only if it is logged.
+     *
+     * \param[in] makeText Function returning the text of the message.
+     */
+    template<class MakeText>
+    typename std::enable_if<!std::is_convertible<MakeText, QString>::value>::type
+    debug(const MakeText &makeText) const { log(LogLevel::DEBUG, makeText); }
+
     /**
      * Logs a message with the info level.
      *
@@ -84,6 +115,15 @@ public:
      */
     void info(const QString &text) const { log(LogLevel::INFO, text); }
 
+    /**
+     * Logs a message with the info level, formatting it only if it is logged.
+     *
+     * \param[in] makeText Function returning the text of the message.
+     */
+    template<class MakeText>
+    typename std::enable_if<!std::is_convertible<MakeText, QString>::value>::type
+    info(const MakeText &makeText) const { log(LogLevel::INFO, makeText); }
+
     /**
      * Logs a message with the warning level.
      *
@@ -91,12 +131,30 @@ public:
      */
     void warning(const QString &text) const { log(LogLevel::WARNING, text); }
 
+    /**
+     * Logs a message with the warning level, formatting it only if it is logged.
+     *
+     * \param[in] makeText Function returning the text of the message.
+     */
+    template<class MakeText>
+    typename std::enable_if<!std::is_convertible<MakeText, QString>::value>::type
+    warning(const MakeText &makeText) const { log(LogLevel::WARNING, makeText); }
+
     /**
      * Logs a message with the error level.
      *
      * \param[in] text Text of the message.
      */
     void error(const QString &text) const { log(LogLevel::ERROR, text); }
+
+    /**
+     * Logs a message with the error level, formatting it only if it is logged.
+     *
+     * \param[in] makeText Function returning the text of the message.
+     */
+    template<class MakeText>
+    typename std::enable_if<!std::is_convertible<MakeText, QString>::value>::type
+    error(const MakeText &makeText) const { log(LogLevel::ERROR, makeText); }
 };
 
 } // namespace nc
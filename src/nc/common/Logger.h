@@ -85,12 +85,40 @@ private:
  * Logger does the actual logging of messages.
  */
 class Logger {
+    /** Minimal level of the messages to be logged. */
+    LogLevel::Level minLevel_;
+
 public:
+    /**
+     * Constructor creating a logger logging messages of all levels.
+     */
+    Logger(): minLevel_(LogLevel::LOWEST) {}
+
     /**
      * Virtual destructor.
      */
     virtual ~Logger() {}
 
+    /**
+     * \return Minimal level of the messages to be logged.
+     */
+    LogLevel::Level minLevel() const { return minLevel_; }
+
+    /**
+     * Sets the minimal level of the messages to be logged.
+     * Must be called before the logger is shared between threads.
+     *
+     * \param level Log level value.
+     */
+    void setMinLevel(LogLevel::Level level) { minLevel_ = level; }
+
+    /**
+     * \param level Log level.
+     *
+     * \return True if messages with the given level are logged.
+     */
+    bool isEnabled(LogLevel level) const { return level >= minLevel_; }
+
     /**
      * Logs a message with a given level.
      *
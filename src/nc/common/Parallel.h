@@ -0,0 +1,163 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <algorithm> /* std::min */
+#include <cstddef> /* std::size_t */
+#include <utility> /* std::move */
+
+#ifdef NC_USE_THREADS
+#include <atomic>
+#include <exception>
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#endif
+
+namespace nc {
+
+/**
+ * \return Number of workers used by parallelFor(). Always at least one.
+ */
+inline std::size_t parallelWorkerCount() {
+#ifdef NC_USE_THREADS
+    int result = QThread::idealThreadCount();
+    return result > 0 ? static_cast<std::size_t>(result) : 1;
+#else
+    return 1;
+#endif
+}
+
+#ifdef NC_USE_THREADS
+namespace detail {
+
+/**
+ * State shared by the workers of a single parallelFor() call.
+ */
+template<class Function>
+class ParallelForState {
+    Function &function_;
+    std::size_t count_;
+    std::atomic<std::size_t> next_;
+    std::atomic<bool> failed_;
+    QMutex mutex_;
+    std::exception_ptr exception_;
+
+public:
+    ParallelForState(Function &function, std::size_t count):
+        function_(function), count_(count), next_(0), failed_(false)
+    {}
+
+    /**
+     * Processes indices until they run out or some worker fails.
+     *
+     * \param worker Index of the worker.
+     */
+    void work(std::size_t worker) {
+        try {
+            std::size_t index;
+            while (!failed_ && (index = next_++) < count_) {
+                function_(worker, index);
+            }
+        } catch (...) {
+            QMutexLocker locker(&mutex_);
+            if (!exception_) {
+                exception_ = std::current_exception();
+            }
+            failed_ = true;
+        }
+    }
+
+    /**
+     * Rethrows the first exception thrown by a worker, if any.
+     */
+    void rethrow() {
+        if (exception_) {
+            std::rethrow_exception(exception_);
+        }
+    }
+};
+
+/**
+ * Runnable executing a single worker of parallelFor().
+ */
+template<class Function>
+class ParallelForWorker: public QRunnable {
+    ParallelForState<Function> &state_;
+    std::size_t worker_;
+
+public:
+    ParallelForWorker(ParallelForState<Function> &state, std::size_t worker):
+        state_(state), worker_(worker)
+    {}
+
+    void run() override { state_.work(worker_); }
+};
+
+} // namespace detail
+#endif
+
+/**
+ * Calls function(worker, index) for every index in [0, count).
+ * When threads are enabled, the calls are distributed among at most
+ * maxWorkerCount workers, one of which is the calling thread.
+ *
+ * Calls with the same worker index are never executed concurrently,
+ * so the worker index can be used to address per-thread state.
+ * If the function throws, the remaining indices are skipped and
+ * the first exception is rethrown in the calling thread.
+ *
+ * \param count          Number of indices.
+ * \param maxWorkerCount Maximal number of workers.
+ * \param function       Function to call.
+ */
+template<class Function>
+void parallelFor(std::size_t count, std::size_t maxWorkerCount, Function function) {
+#ifdef NC_USE_THREADS
+    std::size_t workerCount = std::min(maxWorkerCount, count);
+
+    if (workerCount > 1) {
+        detail::ParallelForState<Function> state(function, count);
+
+        /* A private pool: waiting on the global one from its own thread could deadlock. */
+        QThreadPool pool;
+        pool.setMaxThreadCount(static_cast<int>(workerCount - 1));
+
+        for (std::size_t worker = 1; worker < workerCount; ++worker) {
+            pool.start(new detail::ParallelForWorker<Function>(state, worker));
+        }
+
+        state.work(0);
+        pool.waitForDone();
+        state.rethrow();
+        return;
+    }
+#endif
+
+    (void)maxWorkerCount;
+
+    for (std::size_t index = 0; index < count; ++index) {
+        function(0, index);
+    }
+}
+
+/**
+ * Same as parallelFor(count, parallelWorkerCount(), function).
+ *
+ * \param count     Number of indices.
+ * \param function  Function to call.
+ */
+template<class Function>
+void parallelFor(std::size_t count, Function function) {
+    parallelFor(count, parallelWorkerCount(), std::move(function));
+}
+
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,91 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <QString>
+
+namespace nc {
+
+/**
+ * State of a long-running operation: the stage being executed
+ * and the number of its units of work completed so far.
+ */
+class Progress {
+    QString stage_; ///< Name of the stage.
+    qint64 completed_; ///< Number of completed units.
+    qint64 total_; ///< Total number of units, zero if unknown.
+    qint64 elapsed_; ///< Milliseconds elapsed since the start of the stage.
+
+public:
+    /**
+     * Constructor.
+     *
+     * \param stage Name of the stage.
+     * \param completed Number of completed units.
+     * \param total Total number of units, zero if unknown.
+     * \param elapsed Milliseconds elapsed since the start of the stage.
+     */
+    Progress(const QString &stage, qint64 completed, qint64 total, qint64 elapsed):
+        stage_(stage), completed_(completed), total_(total), elapsed_(elapsed)
+    {}
+
+    /**
+     * \return Name of the stage.
+     */
+    const QString &stage() const { return stage_; }
+
+    /**
+     * \return Number of completed units.
+     */
+    qint64 completed() const { return completed_; }
+
+    /**
+     * \return Total number of units, zero if unknown.
+     */
+    qint64 total() const { return total_; }
+
+    /**
+     * \return Milliseconds elapsed since the start of the stage.
+     */
+    qint64 elapsed() const { return elapsed_; }
+
+    /**
+     * \return Estimated number of milliseconds until the end of the stage,
+     *         assuming the units take equal time, or -1 if it is unknown.
+     */
+    qint64 eta() const {
+        if (total_ <= 0 || completed_ <= 0) {
+            return -1;
+        }
+        if (completed_ >= total_) {
+            return 0;
+        }
+        return static_cast<qint64>(static_cast<double>(elapsed_) * (total_ - completed_) / completed_);
+    }
+};
+
+/**
+ * The base class for receivers of progress reports.
+ */
+class ProgressListener {
+public:
+    /**
+     * Virtual destructor.
+     */
+    virtual ~ProgressListener() {}
+
+    /**
+     * Receives the current progress. Can be called from any thread,
+     * but not from several threads at once.
+     *
+     * \param progress Current progress.
+     */
+    virtual void onProgress(const Progress &progress) = 0;
+};
+
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
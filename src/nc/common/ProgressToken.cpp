@@ -0,0 +1,95 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "ProgressToken.h"
+
+#include <cassert>
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+
+namespace nc {
+
+class ProgressToken::State {
+public:
+    QMutex mutex; ///< Mutex guarding the members.
+    std::shared_ptr<ProgressListener> listener; ///< Listener.
+    int interval; ///< Minimal interval between reports within a stage, in milliseconds.
+    QString stage; ///< Name of the current stage.
+    qint64 completed; ///< Number of completed units of the current stage.
+    qint64 total; ///< Total number of units of the current stage, zero if unknown.
+    QElapsedTimer stageTimer; ///< Timer started at the beginning of the stage.
+    qint64 lastReport; ///< Time of the last report since the beginning of the stage, in milliseconds.
+
+    State(std::shared_ptr<ProgressListener> listener, int interval):
+        listener(std::move(listener)), interval(interval), completed(0), total(0), lastReport(0)
+    {
+        stageTimer.start();
+    }
+
+    /**
+     * Reports the current progress to the listener.
+     * Must be called with the mutex locked.
+     *
+     * \param elapsed Milliseconds elapsed since the beginning of the stage.
+     */
+    void report(qint64 elapsed) {
+        lastReport = elapsed;
+        listener->onProgress(Progress(stage, completed, total, elapsed));
+    }
+};
+
+ProgressToken::ProgressToken(std::shared_ptr<ProgressListener> listener, int interval):
+    state_(std::make_shared<State>(std::move(listener), interval))
+{
+    assert(state_->listener);
+    assert(interval >= 0);
+}
+
+void ProgressToken::startStage(const QString &stage, qint64 total) const {
+    assert(total >= 0);
+
+    if (!state_) {
+        return;
+    }
+
+    QMutexLocker locker(&state_->mutex);
+    state_->stage = stage;
+    state_->completed = 0;
+    state_->total = total;
+    state_->stageTimer.start();
+    state_->report(0);
+}
+
+void ProgressToken::advance(qint64 units) const {
+    assert(units >= 0);
+
+    if (!state_) {
+        return;
+    }
+
+    QMutexLocker locker(&state_->mutex);
+    state_->completed += units;
+
+    qint64 elapsed = state_->stageTimer.elapsed();
+    if (elapsed - state_->lastReport >= state_->interval) {
+        state_->report(elapsed);
+    }
+}
+
+void ProgressToken::finishStage() const {
+    if (!state_) {
+        return;
+    }
+
+    QMutexLocker locker(&state_->mutex);
+    if (state_->total > 0) {
+        state_->completed = state_->total;
+    }
+    state_->report(state_->stageTimer.elapsed());
+}
+
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,73 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <memory> /* std::shared_ptr */
+
+#include <QString>
+
+#include "Progress.h"
+
+namespace nc {
+
+/**
+ * A copy-constructable class for reporting the progress of long-running
+ * operations to a listener.
+ *
+ * The reports are rate-limited: the listener is notified when a stage
+ * starts and finishes, and in between at most once per given interval,
+ * so that the units of work can be reported as finely as convenient.
+ * A token can be shared by several threads.
+ */
+class ProgressToken {
+    class State;
+
+    /** State shared by the copies of the token. nullptr if progress is not reported. */
+    std::shared_ptr<State> state_;
+
+public:
+    /** Default minimal interval between reports, in milliseconds. */
+    static const int DEFAULT_INTERVAL = 100;
+
+    /**
+     * Default constructor.
+     *
+     * Creates a token that does not actually report anything.
+     */
+    ProgressToken() {}
+
+    /**
+     * Constructor creating a token reporting the progress to a given listener.
+     *
+     * \param listener Valid pointer to the listener.
+     * \param interval Minimal interval between reports within a stage, in milliseconds.
+     */
+    explicit ProgressToken(std::shared_ptr<ProgressListener> listener, int interval = DEFAULT_INTERVAL);
+
+    /**
+     * Starts a new stage.
+     *
+     * \param stage Name of the stage.
+     * \param total Total number of units of work in the stage, zero if unknown.
+     */
+    void startStage(const QString &stage, qint64 total = 0) const;
+
+    /**
+     * Reports that some units of work of the current stage are completed.
+     *
+     * \param units Number of completed units.
+     */
+    void advance(qint64 units = 1) const;
+
+    /**
+     * Reports that the current stage is completed.
+     */
+    void finishStage() const;
+};
+
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
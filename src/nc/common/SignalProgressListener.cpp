@@ -0,0 +1,14 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "SignalProgressListener.h"
+
+namespace nc {
+
+void SignalProgressListener::onProgress(const Progress &progress) {
+    Q_EMIT progressChanged(progress.stage(), progress.completed(), progress.total(), progress.eta());
+}
+
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
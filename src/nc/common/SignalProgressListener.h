@@ -0,0 +1,37 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <QObject>
+
+#include "Progress.h"
+
+namespace nc {
+
+/**
+ * Progress listener converting reports to signals.
+ */
+class SignalProgressListener: public QObject, public nc::ProgressListener {
+    Q_OBJECT
+
+public:
+    void onProgress(const Progress &progress) override;
+
+Q_SIGNALS:
+    /**
+     * Signal emitted when there is a progress report.
+     *
+     * \param stage Name of the stage.
+     * \param completed Number of completed units of work.
+     * \param total Total number of units of work, zero if unknown.
+     * \param eta Estimated number of milliseconds until the end of the stage, or -1 if unknown.
+     */
+    void progressChanged(const QString &stage, qint64 completed, qint64 total, qint64 eta);
+};
+
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,30 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "StreamProgressListener.h"
+
+namespace nc {
+
+void StreamProgressListener::onProgress(const Progress &progress) {
+    QString text = progress.stage();
+
+    if (progress.total() > 0) {
+        text = tr("%1 %2/%3 (%4%)")
+            .arg(text)
+            .arg(progress.completed())
+            .arg(progress.total())
+            .arg(progress.completed() * 100 / progress.total());
+    } else if (progress.completed() > 0) {
+        text = tr("%1 %2").arg(text).arg(progress.completed());
+    }
+
+    if (progress.eta() > 0) {
+        text = tr("%1, %2 s left").arg(text).arg((progress.eta() + 999) / 1000);
+    }
+
+    stream_ << tr("[progress] %1").arg(text) << endl;
+}
+
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
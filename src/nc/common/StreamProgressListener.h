@@ -0,0 +1,37 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <QCoreApplication>
+#include <QTextStream>
+
+#include "Progress.h"
+
+namespace nc {
+
+/**
+ * Progress listener printing reports to a stream, one line per report.
+ * The rate of the reports is limited by the ProgressToken.
+ */
+class StreamProgressListener: public nc::ProgressListener {
+    Q_DECLARE_TR_FUNCTIONS(StreamProgressListener)
+
+    QTextStream &stream_;
+
+public:
+    /**
+     * Constructor.
+     *
+     * \param stream Reference to the stream to print reports to.
+     */
+    StreamProgressListener(QTextStream &stream): stream_(stream) {}
+
+    void onProgress(const Progress &progress) override;
+};
+
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
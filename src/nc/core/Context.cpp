@@ -25,6 +25,7 @@
 #include "Context.h"
 
 #include <nc/common/Foreach.h>
+#include <nc/common/Parallel.h>
 
 #include <nc/core/arch/Architecture.h>
 #include <nc/core/arch/Instructions.h>
@@ -41,12 +42,16 @@
 #include <nc/core/ir/vars/Variables.h>
 #include <nc/core/likec/Tree.h>
 
+#include "DecompilationCache.h"
+
 namespace nc {
 namespace core {
 
 Context::Context():
     image_(std::make_shared<image::Image>()),
-    instructions_(std::make_shared<arch::Instructions>())
+    instructions_(std::make_shared<arch::Instructions>()),
+    keepProgram_(true),
+    workerCount_(parallelWorkerCount())
 {}
 
 Context::~Context() {}
@@ -64,6 +69,10 @@ void Context::setProgram(std::unique_ptr<ir::Program> program) {
     program_ = std::move(program);
 }
 
+std::unique_ptr<ir::Program> Context::takeProgram() {
+    return std::move(program_);
+}
+
 void Context::setFunctions(std::unique_ptr<ir::Functions> functions) {
     functions_ = std::move(functions);
 }
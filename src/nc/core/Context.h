@@ -25,12 +25,14 @@
 
 #include <nc/config.h>
 
+#include <cstddef> /* For std::size_t. */
 #include <memory> /* For std::unique_ptr. */
 
 #include <QObject>
 
 #include <nc/common/CancellationToken.h>
 #include <nc/common/LogToken.h>
+#include <nc/common/ProgressToken.h>
 
 namespace nc {
 namespace core {
@@ -74,6 +76,8 @@ namespace likec {
     class Tree;
 }
 
+class DecompilationCache;
+
 /**
  * This class stores all the information that is required and produced during decompilation.
  */
@@ -95,6 +99,10 @@ class Context: public QObject {
     std::unique_ptr<likec::Tree> tree_; ///< Abstract syntax tree of the LikeC program.
     LogToken logToken_; ///< Log token.
     CancellationToken cancellationToken_; ///< Cancellation token.
+    ProgressToken progressToken_; ///< Progress token.
+    bool keepProgram_; ///< Whether the program is kept after the functions have been created.
+    std::shared_ptr<DecompilationCache> cache_; ///< Cache of decompiled functions.
+    std::size_t workerCount_; ///< Maximal number of threads used by a single analysis or printing step.
 
 public:
     /**
@@ -143,6 +151,54 @@ public:
      */
     const ir::Program *program() const { return program_.get(); }
 
+    /**
+     * Releases the ownership of the program.
+     *
+     * \return Pointer to the program. Can be nullptr.
+     */
+    std::unique_ptr<ir::Program> takeProgram();
+
+    /**
+     * Sets whether the program must be kept after the functions have been created.
+     * If not, the basic blocks of the program are moved into the functions
+     * instead of being cloned, and program() becomes nullptr.
+     *
+     * \param keepProgram Whether to keep the program.
+     */
+    void setKeepProgram(bool keepProgram) { keepProgram_ = keepProgram; }
+
+    /**
+     * \return Whether the program is kept after the functions have been created.
+     */
+    bool keepProgram() const { return keepProgram_; }
+
+    /**
+     * Sets the cache of decompiled functions.
+     * The cache is used only by the streaming decompilation, see
+     * MasterAnalyzer::decompile(Context &, const std::function<void(const ir::Function *, const likec::Declaration *)> &).
+     *
+     * \param cache Pointer to the cache. Can be nullptr.
+     */
+    void setCache(const std::shared_ptr<DecompilationCache> &cache) { cache_ = cache; }
+
+    /**
+     * \return Pointer to the cache of decompiled functions. Can be nullptr.
+     */
+    const std::shared_ptr<DecompilationCache> &cache() const { return cache_; }
+
+    /**
+     * Sets the maximal number of threads used by a single analysis or printing
+     * step working on this context. Defaults to parallelWorkerCount().
+     *
+     * \param workerCount Number of threads. Must be positive.
+     */
+    void setWorkerCount(std::size_t workerCount) { workerCount_ = workerCount; }
+
+    /**
+     * \return Maximal number of threads used by a single analysis or printing step.
+     */
+    std::size_t workerCount() const { return workerCount_; }
+
     /**
      * Sets the set of functions.
      *
@@ -317,6 +373,18 @@ public:
      */
     const LogToken &logToken() const { return logToken_; }
 
+    /**
+     * Sets the progress token.
+     *
+     * \param token Progress token.
+     */
+    void setProgressToken(const ProgressToken &token) { progressToken_ = token; }
+
+    /**
+     * \return Progress token.
+     */
+    const ProgressToken &progressToken() const { return progressToken_; }
+
     Q_SIGNALS:
 
     /**
@@ -0,0 +1,719 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "DecompilationCache.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+
+#include <nc/common/Exception.h>
+#include <nc/common/Foreach.h>
+#include <nc/common/Range.h>
+#include <nc/common/Version.h>
+#include <nc/common/make_unique.h>
+
+#include <nc/core/arch/Instruction.h>
+#include <nc/core/image/Image.h>
+#include <nc/core/image/Relocation.h>
+#include <nc/core/image/Symbol.h>
+#include <nc/core/ir/BasicBlock.h>
+#include <nc/core/ir/Function.h>
+#include <nc/core/ir/Functions.h>
+#include <nc/core/ir/Statements.h>
+#include <nc/core/ir/Terms.h>
+#include <nc/core/ir/calling/FunctionSignature.h>
+#include <nc/core/ir/calling/Hooks.h>
+#include <nc/core/ir/calling/SignatureAnalyzer.h>
+#include <nc/core/ir/calling/Signatures.h>
+#include <nc/core/ir/cgen/NameGenerator.h>
+#include <nc/core/ir/types/Type.h>
+#include <nc/core/ir/types/Types.h>
+#include <nc/core/ir/vars/Variable.h>
+#include <nc/core/ir/vars/Variables.h>
+#include <nc/core/likec/FunctionDefinition.h>
+#include <nc/core/likec/FunctionPointerType.h>
+#include <nc/core/likec/TreePrinter.h>
+#include <nc/core/likec/Typecast.h>
+#include <nc/core/likec/Types.h>
+#include <nc/core/likec/VariableDeclaration.h>
+
+#include "Context.h"
+
+namespace nc {
+namespace core {
+
+namespace {
+
+/** Version of the keys. Must be incremented whenever the set of hashed properties or the file format changes. */
+const char KEY_VERSION[] = "key 4";
+
+/**
+ * Adds the bytes of the instructions of the function to the hash,
+ * replacing the bytes patched by relocations by the names of the symbols.
+ * The instructions are identified by their offsets from the function's entry.
+ */
+void hashCode(QCryptographicHash &hash, const Context &context, const ir::Function *function) {
+    std::vector<const arch::Instruction *> instructions;
+    foreach (const ir::BasicBlock *basicBlock, function->basicBlocks()) {
+        foreach (const ir::Statement *statement, basicBlock->statements()) {
+            if (statement->instruction()) {
+                instructions.push_back(statement->instruction());
+            }
+        }
+    }
+
+    std::sort(instructions.begin(), instructions.end(),
+        [](const arch::Instruction *a, const arch::Instruction *b) { return a->addr() < b->addr(); });
+    instructions.erase(std::unique(instructions.begin(), instructions.end()), instructions.end());
+
+    const image::Image &image = *context.image();
+    const ByteAddr entry = *function->entry()->address();
+    std::vector<char> buffer;
+
+    foreach (const arch::Instruction *instruction, instructions) {
+        buffer.resize(instruction->size());
+        auto size = image.readBytes(instruction->addr(), buffer.data(), instruction->size());
+
+        hash.addData(QByteArray::number(static_cast<qlonglong>(instruction->addr() - entry)));
+        hash.addData(":", 1);
+
+        for (ByteSize i = 0; i < size;) {
+            if (auto relocation = image.getRelocation(instruction->addr() + i)) {
+                hash.addData(relocation->symbol()->name().toUtf8());
+                hash.addData("+", 1);
+                hash.addData(QByteArray::number(static_cast<qlonglong>(relocation->addend())));
+                i += std::max<ByteSize>(relocation->size(), 1);
+            } else {
+                hash.addData(&buffer[i], 1);
+                ++i;
+            }
+        }
+        hash.addData(";", 1);
+    }
+}
+
+/**
+ * Appends a description of the type traits to the string.
+ * Types on the current pointee chain are described by a back reference.
+ */
+void describeType(QString &out, const ir::types::Type *type, std::vector<const ir::types::Type *> &stack) {
+    if (!type) {
+        out += '-';
+        return;
+    }
+
+    auto i = std::find(stack.begin(), stack.end(), type);
+    if (i != stack.end()) {
+        out += QString("^%1").arg(stack.end() - i);
+        return;
+    }
+
+    out += QString("%1%2%3%4%5%6")
+        .arg(type->size())
+        .arg(type->isInteger() ? "i" : "")
+        .arg(type->isFloat() ? "f" : "")
+        .arg(type->isPointer() ? "p" : "")
+        .arg(type->isSigned() ? "s" : "")
+        .arg(type->isUnsigned() ? "u" : "");
+
+    if (type->isPointer()) {
+        stack.push_back(type);
+        out += '*';
+        describeType(out, type->pointee(), stack);
+        stack.pop_back();
+    }
+}
+
+/**
+ * \return Description of the type traits reconstructed for the term.
+ */
+QString describeType(const Context &context, const ir::Term *term) {
+    QString result;
+    std::vector<const ir::types::Type *> stack;
+    describeType(result, context.types()->getType(term), stack);
+    return result;
+}
+
+/**
+ * Adds the type traits described by the string starting at the given position
+ * to the type, and advances the position past the description.
+ *
+ * \return True on success, false if the description is malformed.
+ */
+bool restoreType(const QString &description, int &position, ir::types::Types &types, ir::types::Type *type,
+                 std::vector<ir::types::Type *> &stack)
+{
+    auto readNumber = [&]() -> int {
+        int start = position;
+        while (position < description.size() && description[position].isDigit()) {
+            ++position;
+        }
+        return description.mid(start, position - start).toInt();
+    };
+
+    if (position >= description.size() || !description[position].isDigit()) {
+        return false;
+    }
+
+    type->updateSize(static_cast<SmallBitSize>(readNumber()));
+
+    bool isPointer = false;
+    for (; position < description.size(); ++position) {
+        char c = description[position].toLatin1();
+        if (c == 'i') {
+            type->makeInteger();
+        } else if (c == 'f') {
+            type->makeFloat();
+        } else if (c == 'p') {
+            isPointer = true;
+        } else if (c == 's') {
+            type->makeSigned();
+        } else if (c == 'u') {
+            type->makeUnsigned();
+        } else {
+            break;
+        }
+    }
+
+    if (!isPointer) {
+        return true;
+    }
+
+    if (position >= description.size() || description[position] != '*') {
+        return false;
+    }
+    ++position;
+
+    if (position >= description.size()) {
+        return false;
+    } else if (description[position] == '-') {
+        ++position;
+        type->makePointer();
+        return true;
+    } else if (description[position] == '^') {
+        ++position;
+        int distance = readNumber() - 1;
+        if (distance < 0 || static_cast<std::size_t>(distance) > stack.size()) {
+            return false;
+        }
+        type->makePointer(distance == 0 ? type : stack[stack.size() - distance]);
+        return true;
+    } else {
+        auto pointee = types.makeType();
+        stack.push_back(type);
+        bool result = restoreType(description, position, types, pointee, stack);
+        stack.pop_back();
+        type->makePointer(pointee);
+        return result;
+    }
+}
+
+/**
+ * Adds the described type traits to the type of the term.
+ */
+void restoreType(ir::types::Types &types, const ir::Term *term, const QString &description) {
+    int position = 0;
+    std::vector<ir::types::Type *> stack;
+    restoreType(description, position, types, types.getType(term), stack);
+}
+
+/**
+ * \return Memory location of an argument term created by the signature analyzer,
+ *         or an invalid location if the term has an unexpected form.
+ */
+ir::MemoryLocation getArgumentLocation(const ir::Term *term) {
+    if (auto access = term->asMemoryLocationAccess()) {
+        return access->memoryLocation();
+    } else if (auto dereference = term->asDereference()) {
+        /* Stack arguments are dereferences of the stack pointer plus the offset. */
+        if (auto binary = dereference->address()->asBinaryOperator()) {
+            if (binary->operatorKind() == ir::BinaryOperator::ADD &&
+                binary->left()->asMemoryLocationAccess() &&
+                binary->right()->asConstant())
+            {
+                return ir::MemoryLocation(ir::MemoryDomain::STACK,
+                    binary->right()->asConstant()->value().signedValue() * CHAR_BIT, term->size());
+            }
+        }
+    }
+    return ir::MemoryLocation();
+}
+
+/**
+ * \return Textual form of a memory location with the description of its type.
+ */
+QString printTypedLocation(const ir::MemoryLocation &location, const QString &type) {
+    return QString("%1:%2:%3:%4")
+        .arg(location.domain())
+        .arg(location.addr(), 0, 16)
+        .arg(location.size(), 0, 16)
+        .arg(type);
+}
+
+/**
+ * Parses the result of printTypedLocation().
+ *
+ * \return True on success, false if the text is malformed.
+ */
+bool parseTypedLocation(const QByteArray &text, DecompilationCache::TypedLocation &result) {
+    QList<QByteArray> fields = text.split(':');
+    if (fields.size() != 4) {
+        return false;
+    }
+
+    bool domainOk, addrOk, sizeOk;
+    ir::Domain domain = fields[0].toInt(&domainOk);
+    BitAddr addr = fields[1].toLongLong(&addrOk, 16);
+    BitSize size = fields[2].toLongLong(&sizeOk, 16);
+    if (!domainOk || !addrOk || !sizeOk || size <= 0) {
+        return false;
+    }
+
+    result.location = ir::MemoryLocation(domain, addr, size);
+    result.type = QString::fromLatin1(fields[3].constData(), fields[3].size());
+    return true;
+}
+
+/**
+ * \return Term of the global variable that accesses exactly its memory location, if any.
+ */
+const ir::Term *getVariableTerm(const ir::vars::Variable *variable) {
+    foreach (const auto &termAndLocation, variable->termsAndLocations()) {
+        if (termAndLocation.location == variable->memoryLocation()) {
+            return termAndLocation.term;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * \return Textual form of the signature, with the types of its arguments and return value,
+ *         or an empty string if the signature has arguments not created by the signature analyzer.
+ */
+QString printSignature(const Context &context, const ir::calling::FunctionSignature &signature) {
+    QString result = signature.variadic() ? QLatin1String("variadic") : QLatin1String("fixed");
+
+    if (auto returnValue = signature.returnValue().get()) {
+        auto location = getArgumentLocation(returnValue);
+        if (!location) {
+            return QString();
+        }
+        result += ' ';
+        result += printTypedLocation(location, describeType(context, returnValue));
+    } else {
+        result += QLatin1String(" -");
+    }
+
+    foreach (const auto &argument, signature.arguments()) {
+        auto location = getArgumentLocation(argument.get());
+        if (!location) {
+            return QString();
+        }
+        result += ' ';
+        result += printTypedLocation(location, describeType(context, argument.get()));
+    }
+
+    return result;
+}
+
+/**
+ * Parses the result of printSignature() split by spaces, starting at the given field.
+ *
+ * \return True on success, false if the text is malformed.
+ */
+bool parseSignature(const QList<QByteArray> &fields, int first, DecompilationCache::Signature &result) {
+    if (fields.size() < first + 2) {
+        return false;
+    }
+    if (fields[first] == "variadic") {
+        result.variadic = true;
+    } else if (fields[first] != "fixed") {
+        return false;
+    }
+    if (fields[first + 1] != "-" && !parseTypedLocation(fields[first + 1], result.returnValue)) {
+        return false;
+    }
+    for (int i = first + 2; i < fields.size(); ++i) {
+        DecompilationCache::TypedLocation argument;
+        if (!parseTypedLocation(fields[i], argument)) {
+            return false;
+        }
+        result.arguments.push_back(argument);
+    }
+    return true;
+}
+
+/**
+ * Fixes the signature of the callee in the analyzer, or sets it as a fallback signature.
+ */
+void restoreSignature(const Context &context, ir::calling::SignatureAnalyzer &analyzer,
+                      const ir::calling::CalleeId &calleeId, const DecompilationCache::Signature &signature, bool fallback)
+{
+    /* Stack arguments are created relative to the stack pointer of the convention. */
+    context.hooks()->getConvention(calleeId);
+
+    std::vector<ir::MemoryLocation> arguments;
+    foreach (const auto &argument, signature.arguments) {
+        arguments.push_back(argument.location);
+    }
+
+    if (fallback) {
+        analyzer.setFallbackSignature(calleeId, std::move(arguments), signature.returnValue.location, signature.variadic);
+    } else {
+        analyzer.fixSignature(calleeId, std::move(arguments), signature.returnValue.location, signature.variadic);
+    }
+}
+
+/**
+ * Adds the cached types to the arguments and the return value of the signature,
+ * if the signature has the cached number of arguments.
+ */
+void restoreSignatureTypes(ir::types::Types &types, const ir::calling::FunctionSignature *signature,
+                           const DecompilationCache::Signature &cached)
+{
+    if (!signature) {
+        return;
+    }
+    if (signature->arguments().size() == cached.arguments.size()) {
+        for (std::size_t i = 0; i < cached.arguments.size(); ++i) {
+            restoreType(types, signature->arguments()[i].get(), cached.arguments[i].type);
+        }
+    }
+    if (signature->returnValue() && cached.returnValue.location) {
+        restoreType(types, signature->returnValue().get(), cached.returnValue.type);
+    }
+}
+
+/**
+ * \return Mapping from the memory locations of the global variables to the terms accessing them.
+ */
+boost::unordered_map<ir::MemoryLocation, const ir::Term *> getGlobalVariableTerms(const ir::vars::Variables &variables) {
+    boost::unordered_map<ir::MemoryLocation, const ir::Term *> result;
+    foreach (const ir::vars::Variable *variable, variables.list()) {
+        if (variable->isGlobal()) {
+            if (auto term = getVariableTerm(variable)) {
+                result[variable->memoryLocation()] = term;
+            }
+        }
+    }
+    return result;
+}
+
+bool usesStructure(const likec::Type *type) {
+    while (auto pointerType = type->as<likec::PointerType>()) {
+        type = pointerType->pointeeType();
+    }
+    if (type->isStructure()) {
+        return true;
+    }
+    if (auto functionPointerType = type->as<likec::FunctionPointerType>()) {
+        if (usesStructure(functionPointerType->returnType())) {
+            return true;
+        }
+        foreach (const likec::Type *argumentType, functionPointerType->argumentTypes()) {
+            if (usesStructure(argumentType)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * \return True if the printed subtree mentions a structural type.
+ */
+bool usesStructure(const likec::TreeNode *node) {
+    if (auto declaration = node->as<likec::Declaration>()) {
+        if (auto variableDeclaration = declaration->as<likec::VariableDeclaration>()) {
+            if (usesStructure(variableDeclaration->type())) {
+                return true;
+            }
+        } else if (auto functionDeclaration = declaration->as<likec::FunctionDeclaration>()) {
+            if (usesStructure(functionDeclaration->type())) {
+                return true;
+            }
+        }
+    } else if (auto expression = node->as<likec::Expression>()) {
+        if (auto typecast = expression->as<likec::Typecast>()) {
+            if (usesStructure(typecast->type())) {
+                return true;
+            }
+        }
+    }
+
+    bool result = false;
+    node->callOnChildren([&](const likec::TreeNode *child) {
+        if (!result && child) {
+            result = usesStructure(child);
+        }
+    });
+    return result;
+}
+
+} // anonymous namespace
+
+DecompilationCache::DecompilationCache(const QString &directory):
+    directory_(directory)
+{
+    if (!QDir().mkpath(directory)) {
+        throw nc::Exception(tr("Could not create directory %1.").arg(directory));
+    }
+}
+
+DecompilationCache::~DecompilationCache() {}
+
+void DecompilationCache::reset() {
+    keys_.clear();
+    entries_.clear();
+    variableTerms_.clear();
+}
+
+const QByteArray &DecompilationCache::getKey(const Context &context, const ir::Function *function) {
+    assert(function != nullptr);
+
+    if (!function->entry() || !function->entry()->address()) {
+        return emptyKey_;
+    }
+
+    auto &result = keys_[function];
+    if (!result.isEmpty()) {
+        return result;
+    }
+
+    const ByteAddr entry = *function->entry()->address();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    hash.addData(version);
+    hash.addData(KEY_VERSION);
+
+    /* Labels and names derived from addresses make the text depend on the entry address. */
+    auto nameAndComment = ir::cgen::NameGenerator(*context.image()).getFunctionName(function);
+    hash.addData(QString("function %1 %2 %3\n")
+        .arg(entry, 0, 16)
+        .arg(nameAndComment.name())
+        .arg(nameAndComment.comment())
+        .toUtf8());
+
+    hashCode(hash, context, function);
+
+    result = hash.result().toHex();
+    return result;
+}
+
+QString DecompilationCache::getFileName(const QByteArray &key) const {
+    return QDir(directory_).filePath(QString::fromLatin1(key.constData(), key.size()) + QLatin1String(".c"));
+}
+
+const DecompilationCache::Entry *DecompilationCache::find(const Context &context, const ir::Function *function) {
+    auto i = entries_.find(function);
+    if (i == entries_.end()) {
+        const auto &key = getKey(context, function);
+        i = entries_.insert(std::make_pair(function, key.isEmpty() ? boost::none : load(key))).first;
+    }
+    return i->second.get_ptr();
+}
+
+boost::optional<DecompilationCache::Entry> DecompilationCache::load(const QByteArray &key) const {
+    QFile file(getFileName(key));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return boost::none;
+    }
+
+    /*
+     * The file starts with a line listing the entries of the called functions,
+     * a line listing the global variables with their types, and a line with
+     * the signature: whether it is variadic, the return value, and the arguments.
+     * A line with the signature of each called function and the text of
+     * the definition follow.
+     */
+    Entry result;
+
+    QList<QByteArray> functions = file.readLine().trimmed().split(' ');
+    if (functions.isEmpty() || functions.front() != "functions") {
+        return boost::none;
+    }
+    for (int i = 1; i < functions.size(); ++i) {
+        bool ok;
+        result.dependencies.functions.push_back(functions[i].toLongLong(&ok, 16));
+        if (!ok) {
+            return boost::none;
+        }
+    }
+
+    QList<QByteArray> variables = file.readLine().trimmed().split(' ');
+    if (variables.isEmpty() || variables.front() != "variables") {
+        return boost::none;
+    }
+    for (int i = 1; i < variables.size(); ++i) {
+        TypedLocation variable;
+        if (!parseTypedLocation(variables[i], variable)) {
+            return boost::none;
+        }
+        result.dependencies.variables.push_back(variable.location);
+        result.variableTypes.push_back(variable.type);
+    }
+
+    QList<QByteArray> signature = file.readLine().trimmed().split(' ');
+    if (signature.isEmpty() || signature.front() != "signature" || !parseSignature(signature, 1, result.signature)) {
+        return boost::none;
+    }
+
+    result.calleeSignatures.resize(result.dependencies.functions.size());
+    foreach (Signature &calleeSignature, result.calleeSignatures) {
+        QList<QByteArray> fields = file.readLine().trimmed().split(' ');
+        if (fields.isEmpty() || fields.front() != "callee" || !parseSignature(fields, 1, calleeSignature)) {
+            return boost::none;
+        }
+    }
+
+    QByteArray text = file.readAll();
+    result.text = QString::fromUtf8(text.constData(), text.size());
+
+    return result;
+}
+
+void DecompilationCache::store(const Context &context, const ir::Function *function, const likec::FunctionDefinition *definition,
+                               const ir::cgen::Dependencies &dependencies)
+{
+    assert(definition != nullptr);
+
+    const auto &key = getKey(context, function);
+    if (key.isEmpty() || usesStructure(definition)) {
+        return;
+    }
+
+    QString text;
+    QTextStream out(&text);
+
+    out << "functions";
+    foreach (ByteAddr addr, dependencies.functions) {
+        out << ' ' << QString::number(addr, 16);
+    }
+
+    out << '\n' << "variables";
+    auto variableTerms = getGlobalVariableTerms(*context.variables());
+    foreach (const ir::MemoryLocation &memoryLocation, dependencies.variables) {
+        auto term = nc::find(variableTerms, memoryLocation);
+        out << ' ' << printTypedLocation(memoryLocation, term ? describeType(context, term) : QString('-'));
+    }
+
+    auto signature = context.signatures()->getSignature(function);
+    if (!signature) {
+        return;
+    }
+    QString signatureText = printSignature(context, *signature);
+    if (signatureText.isEmpty()) {
+        return;
+    }
+    out << '\n' << "signature " << signatureText << '\n';
+
+    foreach (ByteAddr addr, dependencies.functions) {
+        auto calleeSignature = context.signatures()->getSignature(addr);
+        if (!calleeSignature) {
+            return;
+        }
+        QString calleeSignatureText = printSignature(context, *calleeSignature);
+        if (calleeSignatureText.isEmpty()) {
+            return;
+        }
+        out << "callee " << calleeSignatureText << '\n';
+    }
+
+    likec::TreePrinter(out, nullptr).print(definition);
+    out.flush();
+
+    /* Write to a temporary file and rename it, so that concurrent readers never see a partial file. */
+    QString filename = getFileName(key);
+    QString temporaryFilename = QString("%1.%2.%3.tmp")
+        .arg(filename).arg(QCoreApplication::applicationPid()).arg(reinterpret_cast<quintptr>(this));
+
+    QFile file(temporaryFilename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        context.logToken().warning(tr("Could not write file %1.").arg(temporaryFilename));
+        return;
+    }
+    file.write(text.toUtf8());
+    file.close();
+
+    if (!QFile::rename(temporaryFilename, filename)) {
+        /* Somebody has stored the same definition meanwhile. */
+        QFile::remove(temporaryFilename);
+    }
+}
+
+void DecompilationCache::restoreSignatures(const Context &context, ir::calling::SignatureAnalyzer &analyzer) {
+    foreach (const ir::Function *function, context.functions()->list()) {
+        if (auto entry = find(context, function)) {
+            restoreSignature(context, analyzer, ir::calling::getCalleeId(function), entry->signature, false);
+
+            for (std::size_t i = 0; i < entry->dependencies.functions.size(); ++i) {
+                restoreSignature(context, analyzer,
+                    ir::calling::CalleeId(ir::calling::EntryAddress(entry->dependencies.functions[i])),
+                    entry->calleeSignatures[i], true);
+            }
+        }
+    }
+}
+
+void DecompilationCache::restoreVariables(const Context &context, ir::vars::Variables &variables) {
+    std::vector<ir::MemoryLocation> locations;
+    foreach (const ir::vars::Variable *variable, variables.list()) {
+        if (variable->isGlobal()) {
+            locations.push_back(variable->memoryLocation());
+        }
+    }
+
+    foreach (const ir::Function *function, context.functions()->list()) {
+        if (auto entry = find(context, function)) {
+            foreach (const ir::MemoryLocation &location, entry->dependencies.variables) {
+                if (std::any_of(locations.begin(), locations.end(),
+                        [&](const ir::MemoryLocation &that) { return that.overlaps(location); })) {
+                    continue;
+                }
+
+                auto term = std::make_unique<ir::MemoryLocationAccess>(location);
+
+                std::vector<ir::vars::Variable::TermAndLocation> termsAndLocations;
+                termsAndLocations.push_back(ir::vars::Variable::TermAndLocation(term.get(), location));
+                variables.addVariable(std::make_unique<ir::vars::Variable>(
+                    ir::vars::Variable::GLOBAL, std::move(termsAndLocations), location));
+
+                variableTerms_.push_back(std::move(term));
+                locations.push_back(location);
+            }
+        }
+    }
+}
+
+void DecompilationCache::restoreTypes(const Context &context, ir::types::Types &types) {
+    auto variableTerms = getGlobalVariableTerms(*context.variables());
+
+    foreach (const ir::Function *function, context.functions()->list()) {
+        if (auto entry = find(context, function)) {
+            restoreSignatureTypes(types, context.signatures()->getSignature(*function->entry()->address()).get(),
+                                  entry->signature);
+
+            for (std::size_t i = 0; i < entry->dependencies.functions.size(); ++i) {
+                restoreSignatureTypes(types, context.signatures()->getSignature(entry->dependencies.functions[i]).get(),
+                                      entry->calleeSignatures[i]);
+            }
+
+            for (std::size_t i = 0; i < entry->dependencies.variables.size(); ++i) {
+                if (auto term = nc::find(variableTerms, entry->dependencies.variables[i])) {
+                    restoreType(types, term, entry->variableTypes[i]);
+                }
+            }
+        }
+    }
+}
+
+} // namespace core
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,204 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <memory>
+#include <vector>
+
+#include <QByteArray>
+#include <QCoreApplication> /* For Q_DECLARE_TR_FUNCTIONS. */
+#include <QString>
+
+#include <boost/optional.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <nc/common/Types.h>
+#include <nc/core/ir/MemoryLocation.h>
+#include <nc/core/ir/cgen/Dependencies.h>
+
+namespace nc {
+namespace core {
+
+class Context;
+
+namespace ir {
+    class Function;
+    class Term;
+
+    namespace calling {
+        class SignatureAnalyzer;
+    }
+
+    namespace types {
+        class Types;
+    }
+
+    namespace vars {
+        class Variables;
+    }
+}
+
+namespace likec {
+    class FunctionDefinition;
+}
+
+/**
+ * On-disk cache of decompiled functions.
+ *
+ * A function is stored under a hash of the decompiler version, its entry address
+ * and name, and the bytes of its instructions. Bytes patched by relocations are
+ * replaced by the names of the relocated symbols, so that the keys do not depend
+ * on where the loader puts the imported symbols. The key is computed before any
+ * analysis, so that a function found in the cache needs no per-function analyses.
+ *
+ * Together with the printed definition, the cache keeps the function's signature
+ * and the types of its arguments, return value, and the global variables it refers
+ * to. They are restored into the global analyses in place of the results the skipped
+ * analyses of the function would have contributed. Thus, a cached definition reflects
+ * the types inferred from the rest of the program it was stored from. Definitions
+ * using recovered structural types are not stored, since the structures' names
+ * depend on the order of code generation.
+ */
+class DecompilationCache {
+    Q_DECLARE_TR_FUNCTIONS(DecompilationCache)
+
+public:
+    /**
+     * Memory location with a description of the type traits reconstructed for it.
+     */
+    class TypedLocation {
+    public:
+        ir::MemoryLocation location; ///< Memory location.
+        QString type; ///< Description of the type traits.
+    };
+
+    /**
+     * Signature with the types of its arguments and return value.
+     */
+    class Signature {
+    public:
+        std::vector<TypedLocation> arguments; ///< Arguments.
+        TypedLocation returnValue; ///< Return value. The location is invalid if there is none.
+        bool variadic; ///< Whether the signature is variadic.
+
+        Signature(): variadic(false) {}
+    };
+
+    /**
+     * Function taken from the cache.
+     */
+    class Entry {
+    public:
+        QString text; ///< Printed definition.
+        ir::cgen::Dependencies dependencies; ///< Functions and global variables the definition refers to.
+        std::vector<QString> variableTypes; ///< Descriptions of the types of dependencies.variables, in the same order.
+        std::vector<Signature> calleeSignatures; ///< Signatures of dependencies.functions, in the same order.
+        Signature signature; ///< Signature of the function.
+    };
+
+private:
+    QString directory_; ///< Directory with the cached files.
+    boost::unordered_map<const ir::Function *, QByteArray> keys_; ///< Memoized keys of the functions.
+    boost::unordered_map<const ir::Function *, boost::optional<Entry>> entries_; ///< Memoized lookups of the functions.
+    std::vector<std::unique_ptr<ir::Term>> variableTerms_; ///< Terms standing for the restored global variables.
+    QByteArray emptyKey_; ///< Key of functions that cannot be cached.
+
+public:
+    /**
+     * Constructor.
+     *
+     * \param directory Directory to keep the cached files in. Created if it does not exist.
+     */
+    explicit DecompilationCache(const QString &directory);
+
+    /**
+     * Destructor.
+     */
+    ~DecompilationCache();
+
+    /**
+     * \return Directory with the cached files.
+     */
+    const QString &directory() const { return directory_; }
+
+    /**
+     * \param context Context.
+     * \param function Valid pointer to a function of the context.
+     *
+     * \return Pointer to the cached function, or nullptr if it is not in the cache.
+     *         The pointer is valid until reset() is called.
+     */
+    const Entry *find(const Context &context, const ir::Function *function);
+
+    /**
+     * Stores the function in the cache, unless its definition uses structural types.
+     * The signatures and types of the context must be reconstructed.
+     *
+     * \param context Context.
+     * \param function Valid pointer to a function of the context.
+     * \param definition Valid pointer to the function's definition.
+     * \param dependencies Functions and global variables the definition refers to.
+     *                     Their declarations must be recreated when the cached
+     *                     definition is printed.
+     */
+    void store(const Context &context, const ir::Function *function, const likec::FunctionDefinition *definition,
+               const ir::cgen::Dependencies &dependencies);
+
+    /**
+     * Fixes the signatures of the cached functions of the context in the analyzer.
+     * The signatures of the functions they call become fallback signatures,
+     * for the case that no analyzed function calls them.
+     *
+     * \param context Context with hooks.
+     * \param analyzer Signature analyzer that has not run yet.
+     */
+    void restoreSignatures(const Context &context, ir::calling::SignatureAnalyzer &analyzer);
+
+    /**
+     * Adds the global variables the cached functions of the context refer to,
+     * unless the variables overlap the ones found in the analyzed functions.
+     *
+     * \param context Context.
+     * \param variables Variables reconstructed from the analyzed functions.
+     */
+    void restoreVariables(const Context &context, ir::vars::Variables &variables);
+
+    /**
+     * Gives the cached types to the arguments and return values of the signatures
+     * of the cached functions and their callees, and to the global variables
+     * the cached functions refer to.
+     *
+     * \param context Context with signatures and variables.
+     * \param types Types before the type reconstruction.
+     */
+    void restoreTypes(const Context &context, ir::types::Types &types);
+
+    /**
+     * Forgets the memoized keys and lookups. Must be called when the functions of the context change.
+     */
+    void reset();
+
+private:
+    /**
+     * \return Key of the function, or an empty array if the function has no entry address.
+     */
+    const QByteArray &getKey(const Context &context, const ir::Function *function);
+
+    /**
+     * \return Name of the file for the given key.
+     */
+    QString getFileName(const QByteArray &key) const;
+
+    /**
+     * \return Function read from the file with the given key, if the file exists and is well-formed.
+     */
+    boost::optional<Entry> load(const QByteArray &key) const;
+};
+
+} // namespace core
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
@@ -3,10 +3,16 @@
 
 #include "Driver.h"
 
+#include <algorithm>
+
 #include <QFile>
 
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+
 #include <nc/common/Foreach.h>
 #include <nc/common/Exception.h>
+#include <nc/common/make_unique.h>
 
 #include <nc/core/arch/Architecture.h>
 #include <nc/core/arch/Disassembler.h>
@@ -15,11 +21,17 @@
 #include <nc/core/image/Section.h>
 #include <nc/core/input/Parser.h>
 #include <nc/core/input/ParserRepository.h>
-#include <nc/core/ir/Function.h>
-#include <nc/core/ir/Functions.h>
+#include <nc/core/ir/BasicBlock.h>
+#include <nc/core/ir/Jump.h>
+#include <nc/core/ir/Program.h>
+#include <nc/core/ir/Statements.h>
+#include <nc/core/ir/Terms.h>
+#include <nc/core/irgen/IRGenerator.h>
 
 #include "Context.h"
+#include "FunctionSelector.h"
 #include "MasterAnalyzer.h"
+#include "Session.h"
 
 namespace nc {
 namespace core {
@@ -81,13 +93,18 @@ void Driver::disassemble(Context &context, const image::ByteSource *source, Byte
     try {
         auto newInstructions = std::make_shared<arch::Instructions>(*context.instructions());
 
+        context.progressToken().startStage(tr("Disassembling."), end - begin);
+
         context.image()->platform().architecture()->createDisassembler()->disassemble(
             context.image().get(),
             source,
             begin,
             end,
             [&](std::shared_ptr<arch::Instruction> instr){ newInstructions->add(std::move(instr)); },
-            context.cancellationToken());
+            context.cancellationToken(),
+            context.progressToken());
+
+        context.progressToken().finishStage();
 
         context.setInstructions(newInstructions);
 
@@ -97,6 +114,253 @@ void Driver::disassemble(Context &context, const image::ByteSource *source, Byte
     }
 }
 
+void Driver::saveSession(const Context &context, const arch::Instructions &instructions, const QString &filename) {
+    context.logToken().info(tr("Saving session to %1...").arg(filename));
+
+    Session::save(context, instructions, filename);
+
+    context.logToken().info(tr("Session saved."));
+}
+
+std::shared_ptr<const arch::Instructions> Driver::loadSession(Context &context, const QString &filename, bool restoreResults) {
+    context.logToken().info(tr("Loading session from %1...").arg(filename));
+
+    auto instructions = Session::load(context, filename, restoreResults);
+
+    if (context.tree()) {
+        context.logToken().info(tr("Session loaded: %1 instructions, decompilation results of %2 instructions.")
+            .arg(instructions->size()).arg(context.instructions()->size()));
+    } else {
+        context.logToken().info(tr("Session loaded: %1 instructions.").arg(instructions->size()));
+    }
+
+    return instructions;
+}
+
+std::vector<ByteAddr> Driver::selectFunctions(Context &context, const std::function<bool(ByteAddr)> &isSelected) {
+    context.logToken().info(tr("Selecting functions to decompile."));
+
+    FunctionSelector selector(context);
+
+    std::vector<ByteAddr> result;
+    foreach (ByteAddr entry, selector.entries()) {
+        if (isSelected(entry)) {
+            result.push_back(entry);
+        }
+    }
+
+    keepSelected(context, selector, result);
+
+    return result;
+}
+
+std::vector<ByteAddr> Driver::selectFunctions(Context &context, const std::vector<ByteAddr> &entries) {
+    context.logToken().info(tr("Selecting functions to decompile."));
+
+    auto allInstructions = context.instructions();
+
+    /* Number of bytes taken at once from an address the code continues at. */
+    const ByteSize chunkSize = 4096;
+
+    return completeFunctions(context, entries,
+        [&](ByteAddr address, const arch::Instructions &known, arch::Instructions &added) {
+            for (ByteAddr addr = address; addr < address + chunkSize;) {
+                auto &instruction = allInstructions->get(addr);
+                if (!instruction || known.get(addr) || !added.add(instruction)) {
+                    break;
+                }
+                addr = instruction->endAddr();
+            }
+        });
+}
+
+std::vector<ByteAddr> Driver::disassembleFunctions(Context &context, const std::vector<ByteAddr> &entries) {
+    context.logToken().info(tr("Disassembling the functions to decompile."));
+
+    auto disassembler = context.image()->platform().architecture()->createDisassembler();
+
+    /* Number of bytes disassembled at once from an address the code continues at. */
+    const ByteSize chunkSize = 4096;
+
+    return completeFunctions(context, entries,
+        [&](ByteAddr address, const arch::Instructions &known, arch::Instructions &added) {
+            auto section = context.image()->getSectionContainingAddress(address);
+            if (!section || !section->isCode()) {
+                return;
+            }
+            disassembler->disassemble(
+                context.image().get(),
+                section,
+                address,
+                std::min(section->endAddr(), address + chunkSize),
+                [&](std::shared_ptr<arch::Instruction> instruction) {
+                    if (!known.get(instruction->addr())) {
+                        added.add(std::move(instruction));
+                    }
+                },
+                context.cancellationToken(),
+                ProgressToken());
+        });
+}
+
+std::vector<ByteAddr> Driver::completeFunctions(Context &context, const std::vector<ByteAddr> &entries, const AddCode &addCode) {
+    auto instructions = std::make_shared<arch::Instructions>();
+
+    /*
+     * Intermediate representation of the code added in each round.
+     * Jump targets are computed within single basic blocks, therefore
+     * the code added in a round is translated alone, and the code added
+     * in the previous rounds is never translated again.
+     */
+    std::vector<std::unique_ptr<ir::Program>> programs;
+
+    /*
+     * Addresses of the code reached from the selected functions (depth 0)
+     * or only from their direct callees (depth 1), with the smallest depth.
+     */
+    boost::unordered_map<ByteAddr, int> depths;
+    std::vector<std::pair<ByteAddr, int>> queue;
+
+    /* Reached addresses without code yet. */
+    std::vector<std::pair<ByteAddr, int>> missing;
+
+    /* Addresses the code was added at. */
+    boost::unordered_set<ByteAddr> startAddresses;
+
+    auto reach = [&](ByteAddr address, int depth) {
+        auto i = depths.find(address);
+        if (i == depths.end() || i->second > depth) {
+            depths[address] = depth;
+            queue.push_back(std::make_pair(address, depth));
+        }
+    };
+
+    auto reachTarget = [&](const ir::JumpTarget &target, int depth) {
+        if (target.basicBlock() && target.basicBlock()->address()) {
+            reach(*target.basicBlock()->address(), depth);
+        }
+        if (target.table()) {
+            foreach (const auto &entry, *target.table()) {
+                reach(entry.address(), depth);
+            }
+        }
+    };
+
+    /* Follows the control flow from the given address to the end of its basic block. */
+    auto visit = [&](ByteAddr address, int depth) {
+        const ir::BasicBlock *basicBlock = nullptr;
+        foreach (const auto &program, programs) {
+            basicBlock = program->getBasicBlockCovering(address);
+            if (basicBlock && !basicBlock->statements().empty()) {
+                break;
+            }
+            basicBlock = nullptr;
+        }
+
+        if (!basicBlock) {
+            missing.push_back(std::make_pair(address, depth));
+            return;
+        }
+
+        foreach (const ir::Statement *statement, basicBlock->statements()) {
+            if (statement->instruction() && statement->instruction()->addr() < address) {
+                continue;
+            }
+            if (auto call = statement->as<ir::Call>()) {
+                if (depth == 0) {
+                    if (auto constant = call->target()->asConstant()) {
+                        reach(constant->value().value(), 1);
+                    }
+                }
+            } else if (auto jump = statement->as<ir::Jump>()) {
+                reachTarget(jump->thenTarget(), depth);
+                reachTarget(jump->elseTarget(), depth);
+            }
+        }
+
+        if (!basicBlock->getTerminator() && basicBlock->successorAddress()) {
+            reach(*basicBlock->successorAddress(), depth);
+        }
+    };
+
+    foreach (ByteAddr entry, entries) {
+        reach(entry, 0);
+    }
+
+    /*
+     * Jumps and calls to the addresses without instructions, and the code running past
+     * the last instruction, lead to missing code. Add the code at all the missing
+     * addresses at once, translate it, and continue following the control flow there,
+     * until the selected functions and their callees are complete.
+     */
+    for (;;) {
+        while (!queue.empty()) {
+            auto item = queue.back();
+            queue.pop_back();
+            visit(item.first, item.second);
+        }
+
+        context.cancellationToken().poll();
+
+        arch::Instructions added;
+        foreach (const auto &item, missing) {
+            if (startAddresses.insert(item.first).second) {
+                addCode(item.first, *instructions, added);
+            }
+        }
+
+        if (added.empty()) {
+            break;
+        }
+
+        auto program = std::make_unique<ir::Program>();
+        irgen::IRGenerator(context.image().get(), &added, program.get(),
+            context.cancellationToken(), context.logToken(), context.progressToken(), context.workerCount()).generate();
+        programs.push_back(std::move(program));
+
+        foreach (const auto &instruction, added.all()) {
+            instructions->add(instruction);
+        }
+
+        /* Some addresses may be covered by the code added at others. */
+        std::vector<std::pair<ByteAddr, int>> stillMissing;
+        foreach (const auto &item, missing) {
+            if (added.getCovering(item.first)) {
+                queue.push_back(item);
+            } else {
+                stillMissing.push_back(item);
+            }
+        }
+        missing.swap(stillMissing);
+    }
+
+    /* Form the functions from all the added code once. */
+    context.setInstructions(instructions);
+
+    FunctionSelector selector(context);
+
+    std::vector<ByteAddr> result;
+    foreach (ByteAddr entry, entries) {
+        if (selector.getFunction(entry) && std::find(result.begin(), result.end(), entry) == result.end()) {
+            result.push_back(entry);
+        }
+    }
+
+    keepSelected(context, selector, result);
+
+    return result;
+}
+
+void Driver::keepSelected(Context &context, const FunctionSelector &selector, const std::vector<ByteAddr> &entries) {
+    std::size_t calleeCount;
+    auto subset = selector.select(entries, &calleeCount);
+
+    context.logToken().info(tr("Selected %1 functions and %2 of their callees, %3 instructions.")
+        .arg(entries.size()).arg(calleeCount).arg(subset->size()));
+
+    context.setInstructions(subset);
+}
+
 void Driver::decompile(Context &context) {
     try {
         context.image()->platform().architecture()->masterAnalyzer()->decompile(context);
@@ -106,6 +370,15 @@ void Driver::decompile(Context &context) {
     }
 }
 
+void Driver::decompile(Context &context, const std::function<void(const ir::Function *, const likec::Declaration *)> &callback) {
+    try {
+        context.image()->platform().architecture()->masterAnalyzer()->decompile(context, callback);
+    } catch (const CancellationException &) {
+        context.logToken().info(tr("Decompilation canceled."));
+        throw;
+    }
+}
+
 } // namespace core
 } // namespace nc
 
@@ -5,6 +5,10 @@
 
 #include <nc/config.h>
 
+#include <functional>
+#include <memory>
+#include <vector>
+
 #include <nc/common/Types.h>
 
 #include <QCoreApplication> /* For Q_DECLARE_TR_FUNCTIONS. */
@@ -12,12 +16,25 @@
 namespace nc {
 namespace core {
 
+namespace arch {
+    class Instructions;
+}
+
 namespace image {
     class Section;
     class ByteSource;
 }
 
+namespace ir {
+    class Function;
+}
+
+namespace likec {
+    class Declaration;
+}
+
 class Context;
+class FunctionSelector;
 
 /**
  * Relatively high-level interface for running analyses in the right order.
@@ -59,6 +76,69 @@ public:
      */
     static void disassemble(Context &context, const image::ByteSource *source, ByteAddr begin, ByteAddr end);
 
+    /**
+     * Saves the image of the context, the given instructions, and the decompilation
+     * results of the context, if it has been decompiled, to a session file.
+     *
+     * \param context Context.
+     * \param instructions Instructions to save. Must include the instructions of the context.
+     * \param filename Name of the session file.
+     */
+    static void saveSession(const Context &context, const arch::Instructions &instructions, const QString &filename);
+
+    /**
+     * Restores the image, the instructions, and possibly the decompilation results
+     * from a session file into a context without an image.
+     *
+     * \param context Context.
+     * \param filename Name of the session file.
+     * \param restoreResults Whether to restore the decompilation results, if the file has them.
+     *
+     * \return Valid pointer to all the restored instructions.
+     *          The instructions of the context are the decompiled ones if the results have been restored.
+     */
+    static std::shared_ptr<const arch::Instructions> loadSession(Context &context, const QString &filename, bool restoreResults);
+
+    /**
+     * Leaves in the context only the instructions of the functions whose entry
+     * addresses satisfy the given predicate, and of the functions called by them
+     * directly, so that the decompilation analyzes only these functions.
+     * The callees are kept, because their signatures are reconstructed from their code.
+     *
+     * \param context Context with disassembled instructions.
+     * \param isSelected Predicate telling whether the function with the given entry address is selected.
+     *
+     * \return Entry addresses of the selected functions.
+     */
+    static std::vector<ByteAddr> selectFunctions(Context &context, const std::function<bool(ByteAddr)> &isSelected);
+
+    /**
+     * Disassembles the functions with the given entry addresses and the functions
+     * called by them directly, starting from the entries and following the control
+     * flow of the code disassembled so far, instead of disassembling whole sections.
+     * Then leaves in the context only the instructions of these functions,
+     * like selectFunctions() does.
+     *
+     * \param context Context with an image.
+     * \param entries Entry addresses of the functions to decompile.
+     *
+     * \return Entry addresses of the functions found at the given addresses.
+     */
+    static std::vector<ByteAddr> disassembleFunctions(Context &context, const std::vector<ByteAddr> &entries);
+
+    /**
+     * Leaves in the context only the instructions of the functions with the given
+     * entry addresses and of the functions called by them directly. Unlike the other
+     * overload, does not generate the intermediate representation of all the instructions:
+     * the functions are formed from the instructions reachable from the entries.
+     *
+     * \param context Context with disassembled instructions.
+     * \param entries Entry addresses of the functions.
+     *
+     * \return Entry addresses of the functions found at the given addresses.
+     */
+    static std::vector<ByteAddr> selectFunctions(Context &context, const std::vector<ByteAddr> &entries);
+
     /**
      * Performs decompilation by running all the necessary
      * analyses in the given context in the right order.
@@ -66,6 +146,53 @@ public:
      * \param context Context.
      */
     static void decompile(Context &context);
+
+    /**
+     * Performs decompilation by running all the necessary analyses
+     * in the given context in the right order, generating LikeC code
+     * one function at a time.
+     *
+     * \param context Context.
+     * \param callback Callback receiving functions and top-level declarations generated
+     *                 for them as soon as they are generated.
+     *
+     * \see MasterAnalyzer::decompile(Context &, const std::function<void(const ir::Function *, const likec::Declaration *)> &)
+     */
+    static void decompile(Context &context, const std::function<void(const ir::Function *, const likec::Declaration *)> &callback);
+
+private:
+    /**
+     * Function adding to the second set of instructions some code starting at the given
+     * address, except the instructions present in the first set, at which it may stop.
+     */
+    typedef std::function<void(ByteAddr, const arch::Instructions &, arch::Instructions &)> AddCode;
+
+    /**
+     * Collects code starting from the given entries and continuing at the addresses
+     * which the functions with these entries and their direct callees jump to or run
+     * into but which have no instructions yet, until there are no such addresses.
+     * Each round translates into the intermediate representation only the code added
+     * in this round. Then replaces the context's instructions by the instructions
+     * of these functions.
+     *
+     * \param context Context.
+     * \param entries Entry addresses of the selected functions.
+     * \param addCode Function adding the code starting at an address.
+     *
+     * \return Entry addresses of the functions found at the given addresses.
+     */
+    static std::vector<ByteAddr> completeFunctions(Context &context, const std::vector<ByteAddr> &entries,
+                                                   const AddCode &addCode);
+
+    /**
+     * Leaves in the context only the instructions of the given functions
+     * and of the functions called by them directly.
+     *
+     * \param context Context.
+     * \param selector Functions of the context's instructions.
+     * \param entries Entry addresses of the selected functions.
+     */
+    static void keepSelected(Context &context, const FunctionSelector &selector, const std::vector<ByteAddr> &entries);
 };
 
 } // namespace core
@@ -0,0 +1,142 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "FunctionSelector.h"
+
+#include <algorithm>
+
+#include <boost/unordered_set.hpp>
+
+#include <nc/common/Foreach.h>
+#include <nc/common/Range.h>
+#include <nc/common/make_unique.h>
+
+#include <nc/core/arch/Instructions.h>
+#include <nc/core/ir/BasicBlock.h>
+#include <nc/core/ir/Function.h>
+#include <nc/core/ir/Functions.h>
+#include <nc/core/ir/FunctionsGenerator.h>
+#include <nc/core/ir/Program.h>
+#include <nc/core/ir/Statements.h>
+#include <nc/core/ir/Terms.h>
+#include <nc/core/irgen/IRGenerator.h>
+
+#include "Context.h"
+
+namespace nc {
+namespace core {
+
+FunctionSelector::FunctionSelector(const Context &context):
+    instructions_(context.instructions()),
+    functions_(std::make_unique<ir::Functions>())
+{
+    auto program = std::make_unique<ir::Program>();
+    irgen::IRGenerator(context.image().get(), instructions_.get(), program.get(),
+        context.cancellationToken(), context.logToken(), context.progressToken(), context.workerCount()).generate();
+
+    ir::FunctionsGenerator().makeFunctions(std::move(program), *functions_);
+
+    foreach (const ir::Function *function, functions_->list()) {
+        if (function->entry() && function->entry()->address()) {
+            ByteAddr entry = *function->entry()->address();
+            entry2function_[entry] = function;
+            entries_.push_back(entry);
+        }
+
+        foreach (const ir::BasicBlock *basicBlock, function->basicBlocks()) {
+            foreach (const ir::Statement *statement, basicBlock->statements()) {
+                if (statement->instruction()) {
+                    address2function_.insert(std::make_pair(statement->instruction()->addr(), function));
+                }
+            }
+        }
+    }
+
+    std::sort(entries_.begin(), entries_.end());
+}
+
+FunctionSelector::~FunctionSelector() {}
+
+const ir::Function *FunctionSelector::getFunction(ByteAddr entry) const {
+    return nc::find(entry2function_, entry);
+}
+
+const ir::Function *FunctionSelector::getFunctionContaining(ByteAddr address) const {
+    return nc::find(address2function_, address);
+}
+
+std::vector<const ir::Function *> FunctionSelector::getCallees(const std::vector<ByteAddr> &entries) const {
+    boost::unordered_set<const ir::Function *> selected;
+    foreach (ByteAddr entry, entries) {
+        if (auto function = getFunction(entry)) {
+            selected.insert(function);
+        }
+    }
+
+    std::vector<const ir::Function *> result;
+    boost::unordered_set<const ir::Function *> callees;
+
+    foreach (ByteAddr entry, entries) {
+        auto function = getFunction(entry);
+        if (!function) {
+            continue;
+        }
+
+        foreach (const ir::BasicBlock *basicBlock, function->basicBlocks()) {
+            foreach (const ir::Statement *statement, basicBlock->statements()) {
+                if (auto call = statement->as<ir::Call>()) {
+                    if (auto constant = call->target()->asConstant()) {
+                        if (auto callee = getFunction(constant->value().value())) {
+                            if (!selected.count(callee) && callees.insert(callee).second) {
+                                result.push_back(callee);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+std::shared_ptr<arch::Instructions> FunctionSelector::select(const std::vector<ByteAddr> &entries, std::size_t *calleeCount) const {
+    boost::unordered_set<const arch::Instruction *> instructions;
+
+    auto addInstructions = [&](const ir::Function *function) {
+        foreach (const ir::BasicBlock *basicBlock, function->basicBlocks()) {
+            foreach (const ir::Statement *statement, basicBlock->statements()) {
+                if (statement->instruction()) {
+                    instructions.insert(statement->instruction());
+                }
+            }
+        }
+    };
+
+    foreach (ByteAddr entry, entries) {
+        if (auto function = getFunction(entry)) {
+            addInstructions(function);
+        }
+    }
+
+    auto callees = getCallees(entries);
+    foreach (const ir::Function *callee, callees) {
+        addInstructions(callee);
+    }
+
+    auto result = std::make_shared<arch::Instructions>();
+    foreach (const arch::Instruction *instruction, instructions) {
+        result->add(instructions_->get(instruction->addr()));
+    }
+
+    if (calleeCount) {
+        *calleeCount = callees.size();
+    }
+
+    return result;
+}
+
+} // namespace core
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,96 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <memory>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
+#include <nc/common/Types.h>
+
+namespace nc {
+namespace core {
+
+class Context;
+
+namespace arch {
+    class Instructions;
+}
+
+namespace ir {
+    class Function;
+    class Functions;
+}
+
+/**
+ * Index of the functions formed by a set of instructions, for decompiling
+ * some of them without generating the intermediate representation of the
+ * whole program each time.
+ */
+class FunctionSelector {
+    std::shared_ptr<const arch::Instructions> instructions_; ///< All the instructions.
+    std::unique_ptr<ir::Functions> functions_; ///< Functions formed by the instructions.
+    boost::unordered_map<ByteAddr, const ir::Function *> entry2function_; ///< Functions by entry address.
+    std::vector<ByteAddr> entries_; ///< Sorted entry addresses of the functions.
+    boost::unordered_map<ByteAddr, const ir::Function *> address2function_; ///< Function by address of its instruction.
+
+public:
+    /**
+     * Constructor. Generates the intermediate representation of the
+     * context's instructions and splits it into functions.
+     *
+     * \param context Context with disassembled instructions.
+     */
+    explicit FunctionSelector(const Context &context);
+
+    ~FunctionSelector();
+
+    /**
+     * \return Sorted entry addresses of the functions.
+     */
+    const std::vector<ByteAddr> &entries() const { return entries_; }
+
+    /**
+     * \param entry Entry address.
+     *
+     * \return Pointer to the function with this entry address. Can be nullptr.
+     */
+    const ir::Function *getFunction(ByteAddr entry) const;
+
+    /**
+     * \param address Address of an instruction.
+     *
+     * \return Pointer to a function containing the instruction. Can be nullptr.
+     */
+    const ir::Function *getFunctionContaining(ByteAddr address) const;
+
+    /**
+     * \param entries Entry addresses of the functions.
+     *
+     * \return Functions called directly by the functions with the given entry
+     *         addresses, except these functions themselves.
+     */
+    std::vector<const ir::Function *> getCallees(const std::vector<ByteAddr> &entries) const;
+
+    /**
+     * Collects the instructions of the functions with the given entry addresses
+     * and of the functions called by them directly. The callees are needed,
+     * because their signatures are reconstructed from their code.
+     *
+     * \param entries Entry addresses of the functions.
+     * \param calleeCount If not nullptr, the number of the callees that are
+     *                    not among the given functions is stored here.
+     *
+     * \return Valid pointer to the collected instructions.
+     */
+    std::shared_ptr<arch::Instructions> select(const std::vector<ByteAddr> &entries, std::size_t *calleeCount = nullptr) const;
+};
+
+} // namespace core
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
@@ -25,9 +25,11 @@
 #include "MasterAnalyzer.h"
 
 #include <nc/common/Foreach.h>
+#include <nc/common/Range.h>
 #include <nc/common/make_unique.h>
 
 #include <nc/core/Context.h>
+#include <nc/core/DecompilationCache.h>
 #include <nc/core/arch/Architecture.h>
 #include <nc/core/image/Image.h>
 #include <nc/core/ir/BasicBlock.h>
@@ -54,6 +56,7 @@
 #include <nc/core/ir/vars/VariableAnalyzer.h>
 #include <nc/core/ir/vars/Variables.h>
 #include <nc/core/irgen/IRGenerator.h>
+#include <nc/core/likec/FunctionDefinition.h>
 #include <nc/core/likec/Tree.h>
 #include <nc/core/mangling/Demangler.h>
 
@@ -68,7 +71,7 @@ void MasterAnalyzer::createProgram(Context &context) const {
     std::unique_ptr<ir::Program> program(new ir::Program());
 
     core::irgen::IRGenerator(context.image().get(), context.instructions().get(), program.get(),
-        context.cancellationToken(), context.logToken())
+        context.cancellationToken(), context.logToken(), context.progressToken(), context.workerCount())
     .generate();
 
     context.setProgram(std::move(program));
@@ -76,12 +79,22 @@ void MasterAnalyzer::createProgram(Context &context) const {
 
 void MasterAnalyzer::createFunctions(Context &context) const {
     context.logToken().info(tr("Creating functions."));
+    context.progressToken().startStage(tr("Creating functions."));
 
     std::unique_ptr<ir::Functions> functions(new ir::Functions);
 
-    ir::FunctionsGenerator().makeFunctions(*context.program(), *functions);
+    if (context.keepProgram()) {
+        ir::FunctionsGenerator().makeFunctions(*context.program(), *functions);
+    } else {
+        ir::FunctionsGenerator().makeFunctions(context.takeProgram(), *functions);
+    }
 
     context.setFunctions(std::move(functions));
+    context.progressToken().finishStage();
+
+    if (context.cache()) {
+        context.cache()->reset();
+    }
 }
 
 void MasterAnalyzer::createHooks(Context &context) const {
@@ -111,14 +124,22 @@ void MasterAnalyzer::dataflowAnalysis(Context &context) const {
 
     context.setDataflows(std::make_unique<ir::dflow::Dataflows>());
 
+    context.progressToken().startStage(tr("Dataflow analysis."), context.functions()->list().size());
+
     foreach (auto function, context.functions()->list()) {
-        dataflowAnalysis(context, function);
+        context.progressToken().advance();
+
+        if (!isCached(context, function)) {
+            dataflowAnalysis(context, function);
+        }
         context.cancellationToken().poll();
     }
+
+    context.progressToken().finishStage();
 }
 
 void MasterAnalyzer::dataflowAnalysis(Context &context, ir::Function *function) const {
-    context.logToken().info(tr("Dataflow analysis of %1.").arg(getFunctionName(context, function)));
+    context.logToken().debug([&]() { return tr("Dataflow analysis of %1.").arg(getFunctionName(context, function)); });
 
     std::unique_ptr<ir::dflow::Dataflow> dataflow(new ir::dflow::Dataflow());
 
@@ -132,21 +153,35 @@ void MasterAnalyzer::dataflowAnalysis(Context &context, ir::Function *function)
 
 void MasterAnalyzer::reconstructSignatures(Context &context) const {
     context.logToken().info(tr("Reconstructing function signatures."));
+    context.progressToken().startStage(tr("Reconstructing function signatures."));
 
-    ir::calling::SignatureAnalyzer(*context.signatures(), *context.dataflows(), *context.hooks(),
-        *context.livenesses(), context.cancellationToken(), context.logToken())
-        .analyze();
+    ir::calling::SignatureAnalyzer analyzer(*context.signatures(), *context.dataflows(), *context.hooks(),
+        *context.livenesses(), context.cancellationToken(), context.logToken());
+
+    if (context.cache()) {
+        context.cache()->restoreSignatures(context, analyzer);
+    }
+
+    analyzer.analyze();
+
+    context.progressToken().finishStage();
 }
 
 void MasterAnalyzer::reconstructVariables(Context &context) const {
     context.logToken().info(tr("Reconstructing variables."));
+    context.progressToken().startStage(tr("Reconstructing variables."));
 
     std::unique_ptr<ir::vars::Variables> variables(new ir::vars::Variables());
 
     ir::vars::VariableAnalyzer(*variables, *context.dataflows(), context.image()->platform().architecture())
         .analyze();
 
+    if (context.cache()) {
+        context.cache()->restoreVariables(context, *variables);
+    }
+
     context.setVariables(std::move(variables));
+    context.progressToken().finishStage();
 }
 
 void MasterAnalyzer::livenessAnalysis(Context &context) const {
@@ -154,19 +189,26 @@ void MasterAnalyzer::livenessAnalysis(Context &context) const {
 
     context.setLivenesses(std::make_unique<ir::liveness::Livenesses>());
 
+    context.progressToken().startStage(tr("Liveness analysis."), context.functions()->list().size());
+
     foreach (const ir::Function *function, context.functions()->list()) {
-        livenessAnalysis(context, function);
+        if (!isCached(context, function)) {
+            livenessAnalysis(context, function);
+        }
+        context.progressToken().advance();
     }
+
+    context.progressToken().finishStage();
 }
 
 void MasterAnalyzer::livenessAnalysis(Context &context, const ir::Function *function) const {
-    context.logToken().info(tr("Liveness analysis of %1.").arg(getFunctionName(context, function)));
+    context.logToken().debug([&]() { return tr("Liveness analysis of %1.").arg(getFunctionName(context, function)); });
 
     std::unique_ptr<ir::liveness::Liveness> liveness(new ir::liveness::Liveness());
 
     ir::liveness::LivenessAnalyzer(*liveness, function,
         *context.dataflows()->at(function), context.image()->platform().architecture(),
-        context.graphs() ? context.graphs()->at(function).get() : nullptr, *context.hooks(),
+        context.graphs() ? nc::find(*context.graphs(), function).get() : nullptr, *context.hooks(),
         context.signatures(), context.logToken())
     .analyze();
 
@@ -175,9 +217,14 @@ void MasterAnalyzer::livenessAnalysis(Context &context, const ir::Function *func
 
 void MasterAnalyzer::reconstructTypes(Context &context) const {
     context.logToken().info(tr("Reconstructing types."));
+    context.progressToken().startStage(tr("Reconstructing types."));
 
     std::unique_ptr<ir::types::Types> types(new ir::types::Types());
 
+    if (context.cache()) {
+        context.cache()->restoreTypes(context, *types);
+    }
+
     ir::types::TypeAnalyzer(
         *types, *context.functions(), *context.dataflows(), *context.variables(),
         *context.livenesses(), *context.hooks(), *context.signatures(),
@@ -185,6 +232,7 @@ void MasterAnalyzer::reconstructTypes(Context &context) const {
     .analyze();
 
     context.setTypes(std::move(types));
+    context.progressToken().finishStage();
 }
 
 void MasterAnalyzer::structuralAnalysis(Context &context) const {
@@ -192,14 +240,21 @@ void MasterAnalyzer::structuralAnalysis(Context &context) const {
 
     context.setGraphs(std::make_unique<ir::cflow::Graphs>());
 
+    context.progressToken().startStage(tr("Structural analysis."), context.functions()->list().size());
+
     foreach (auto function, context.functions()->list()) {
-        structuralAnalysis(context, function);
+        context.progressToken().advance();
+        if (!isCached(context, function)) {
+            structuralAnalysis(context, function);
+        }
         context.cancellationToken().poll();
     }
+
+    context.progressToken().finishStage();
 }
 
 void MasterAnalyzer::structuralAnalysis(Context &context, const ir::Function *function) const {
-    context.logToken().info(tr("Structural analysis of %1.").arg(getFunctionName(context, function)));
+    context.logToken().debug([&]() { return tr("Structural analysis of %1.").arg(getFunctionName(context, function)); });
 
     std::unique_ptr<ir::cflow::Graph> graph(new ir::cflow::Graph());
 
@@ -211,20 +266,68 @@ void MasterAnalyzer::structuralAnalysis(Context &context, const ir::Function *fu
 
 void MasterAnalyzer::generateTree(Context &context) const {
     context.logToken().info(tr("Generating AST."));
+    context.progressToken().startStage(tr("Generating AST."));
 
     auto tree = std::make_unique<nc::core::likec::Tree>();
 
     ir::cgen::CodeGenerator(*tree, *context.image(), *context.functions(), *context.hooks(),
         *context.signatures(), *context.dataflows(), *context.variables(), *context.graphs(),
-        *context.livenesses(), *context.types(), context.cancellationToken())
+        *context.livenesses(), *context.types(), context.cancellationToken(), context.workerCount())
         .makeCompilationUnit();
 
     context.setTree(std::move(tree));
+    context.progressToken().finishStage();
 }
 
-void MasterAnalyzer::decompile(Context &context) const {
-    context.logToken().info(tr("Decompiling."));
+void MasterAnalyzer::generateTree(Context &context, const std::function<void(const ir::Function *, const likec::Declaration *)> &callback) const {
+    context.logToken().info(tr("Generating AST function by function."));
+
+    likec::Tree tree;
+
+    ir::cgen::CodeGenerator generator(tree, *context.image(), *context.functions(), *context.hooks(),
+        *context.signatures(), *context.dataflows(), *context.variables(), *context.graphs(),
+        *context.livenesses(), *context.types(), context.cancellationToken(), context.workerCount());
+
+    generator.makeEmptyCompilationUnit();
 
+    auto &cache = context.cache();
+
+    context.progressToken().startStage(tr("Generating AST."), context.functions()->list().size());
+
+    foreach (const ir::Function *function, context.functions()->list()) {
+        auto cached = cache ? cache->find(context, function) : nullptr;
+
+        if (cached) {
+            generator.makeStreamedDeclarations(cached->dependencies, [&](const likec::Declaration *declaration) {
+                callback(function, declaration);
+            });
+            callback(function, nullptr);
+        } else {
+            ir::cgen::Dependencies dependencies;
+
+            generator.makeStreamedFunctionDefinition(function, [&](const likec::Declaration *declaration) {
+                callback(function, declaration);
+
+                if (cache) {
+                    if (auto definition = declaration->as<likec::FunctionDefinition>()) {
+                        cache->store(context, function, definition, dependencies);
+                    }
+                }
+            }, cache ? &dependencies : nullptr);
+        }
+
+        context.dataflows()->erase(function);
+        context.livenesses()->erase(function);
+        context.graphs()->erase(function);
+
+        context.progressToken().advance();
+        context.cancellationToken().poll();
+    }
+
+    context.progressToken().finishStage();
+}
+
+void MasterAnalyzer::analyze(Context &context) const {
     createProgram(context);
     context.cancellationToken().poll();
 
@@ -260,6 +363,14 @@ void MasterAnalyzer::decompile(Context &context) const {
 
     reconstructTypes(context);
     context.cancellationToken().poll();
+}
+
+void MasterAnalyzer::decompile(Context &context) const {
+    assert(!context.cache() && "Only the streaming decompilation can use the cache.");
+
+    context.logToken().info(tr("Decompiling."));
+
+    analyze(context);
 
     generateTree(context);
     context.cancellationToken().poll();
@@ -267,6 +378,21 @@ void MasterAnalyzer::decompile(Context &context) const {
     context.logToken().info(tr("Decompilation completed."));
 }
 
+void MasterAnalyzer::decompile(Context &context, const std::function<void(const ir::Function *, const likec::Declaration *)> &callback) const {
+    context.logToken().info(tr("Decompiling."));
+
+    analyze(context);
+
+    generateTree(context, callback);
+    context.cancellationToken().poll();
+
+    context.logToken().info(tr("Decompilation completed."));
+}
+
+bool MasterAnalyzer::isCached(Context &context, const ir::Function *function) const {
+    return context.cache() && context.cache()->find(context, function);
+}
+
 QString MasterAnalyzer::getFunctionName(Context &context, const ir::Function *function) const {
     return ir::cgen::NameGenerator(*context.image()).getFunctionName(function).name();
 }
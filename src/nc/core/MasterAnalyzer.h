@@ -25,6 +25,8 @@
 
 #include <nc/config.h>
 
+#include <functional>
+
 #include <QCoreApplication> /* For Q_DECLARE_TR_FUNCTIONS. */
 
 namespace nc {
@@ -38,6 +40,10 @@ namespace ir {
     }
 }
 
+namespace likec {
+    class Declaration;
+}
+
 class Context;
 
 /**
@@ -164,6 +170,35 @@ public:
      */
     virtual void generateTree(Context &context) const;
 
+    /**
+     * Generates LikeC code one function at a time, passing the function and the
+     * top-level declarations generated for it to the callback as soon as they are
+     * generated and simplified. The function's definition is the last declaration
+     * passed for it. Once it has been passed to the callback, it is destroyed
+     * together with the dataflow, liveness, and control-flow graph of the function.
+     * The functions are processed in the order of context.functions()->list().
+     * The tree is not stored in the context.
+     *
+     * If context.cache() has the function, the code for the function is not
+     * generated. Only the declarations of the functions and global variables
+     * the cached definition refers to are, if they were not yet, and the callback is
+     * called with the function and nullptr in place of the definition.
+     * The definitions of the other functions are stored in the cache.
+     *
+     * \param context Context.
+     * \param callback Callback to pass the functions and declarations to.
+     */
+    virtual void generateTree(Context &context, const std::function<void(const ir::Function *, const likec::Declaration *)> &callback) const;
+
+    /**
+     * Runs all the analyses preceding the generation of LikeC tree.
+     * The functions found in context.cache() are not analyzed: their signatures
+     * and types are restored from the cache instead.
+     *
+     * \param context Context.
+     */
+    virtual void analyze(Context &context) const;
+
     /**
      * Decompiles the assembler program.
      *
@@ -171,7 +206,28 @@ public:
      */
     virtual void decompile(Context &context) const;
 
+    /**
+     * Decompiles the assembler program, generating and passing to the callback
+     * LikeC code one function at a time. Peak memory usage is bounded by the size of
+     * the intermediate representation plus the analyses of the largest function,
+     * rather than by the size of the whole LikeC tree.
+     *
+     * \param context Context.
+     * \param callback Callback to pass functions and top-level declarations to.
+     *
+     * \see generateTree(Context &, const std::function<void(const ir::Function *, const likec::Declaration *)> &)
+     */
+    virtual void decompile(Context &context, const std::function<void(const ir::Function *, const likec::Declaration *)> &callback) const;
+
 protected:
+    /**
+     * \param context Context.
+     * \param function Valid pointer to a function.
+     *
+     * \return True if the function is in context.cache() and must not be analyzed.
+     */
+    virtual bool isCached(Context &context, const ir::Function *function) const;
+
     /**
      * \param context Context.
      * \param function Valid pointer to a function.
@@ -0,0 +1,2184 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "Session.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include <QDataStream>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+
+#include <nc/common/Exception.h>
+#include <nc/common/Foreach.h>
+#include <nc/common/make_unique.h>
+#include <nc/common/Parallel.h>
+#include <nc/common/Range.h>
+#include <nc/common/Unreachable.h>
+#include <nc/common/Version.h>
+
+#include <nc/core/arch/Architecture.h>
+#include <nc/core/arch/Disassembler.h>
+#include <nc/core/arch/Instruction.h>
+#include <nc/core/arch/Instructions.h>
+#include <nc/core/image/Image.h>
+#include <nc/core/image/Relocation.h>
+#include <nc/core/image/Section.h>
+#include <nc/core/image/Symbol.h>
+#include <nc/core/ir/BasicBlock.h>
+#include <nc/core/ir/Function.h>
+#include <nc/core/ir/Functions.h>
+#include <nc/core/ir/Jump.h>
+#include <nc/core/ir/Program.h>
+#include <nc/core/ir/Statements.h>
+#include <nc/core/ir/Terms.h>
+#include <nc/core/ir/calling/CallSignature.h>
+#include <nc/core/ir/calling/FunctionSignature.h>
+#include <nc/core/ir/calling/Signatures.h>
+#include <nc/core/ir/types/Type.h>
+#include <nc/core/ir/types/Types.h>
+#include <nc/core/ir/vars/Variable.h>
+#include <nc/core/ir/vars/Variables.h>
+#include <nc/core/likec/ArgumentDeclaration.h>
+#include <nc/core/likec/BinaryOperator.h>
+#include <nc/core/likec/Block.h>
+#include <nc/core/likec/Break.h>
+#include <nc/core/likec/CallOperator.h>
+#include <nc/core/likec/CaseLabel.h>
+#include <nc/core/likec/CompilationUnit.h>
+#include <nc/core/likec/Continue.h>
+#include <nc/core/likec/DefaultLabel.h>
+#include <nc/core/likec/DoWhile.h>
+#include <nc/core/likec/ExpressionStatement.h>
+#include <nc/core/likec/FunctionDefinition.h>
+#include <nc/core/likec/FunctionIdentifier.h>
+#include <nc/core/likec/FunctionPointerType.h>
+#include <nc/core/likec/Goto.h>
+#include <nc/core/likec/If.h>
+#include <nc/core/likec/InlineAssembly.h>
+#include <nc/core/likec/IntegerConstant.h>
+#include <nc/core/likec/LabelDeclaration.h>
+#include <nc/core/likec/LabelIdentifier.h>
+#include <nc/core/likec/LabelStatement.h>
+#include <nc/core/likec/MemberAccessOperator.h>
+#include <nc/core/likec/MemberDeclaration.h>
+#include <nc/core/likec/Return.h>
+#include <nc/core/likec/String.h>
+#include <nc/core/likec/StructType.h>
+#include <nc/core/likec/StructTypeDeclaration.h>
+#include <nc/core/likec/Switch.h>
+#include <nc/core/likec/Tree.h>
+#include <nc/core/likec/Typecast.h>
+#include <nc/core/likec/Types.h>
+#include <nc/core/likec/UnaryOperator.h>
+#include <nc/core/likec/UndeclaredIdentifier.h>
+#include <nc/core/likec/VariableDeclaration.h>
+#include <nc/core/likec/VariableIdentifier.h>
+#include <nc/core/likec/While.h>
+
+#include "Context.h"
+#include "MasterAnalyzer.h"
+
+namespace nc {
+namespace core {
+
+namespace {
+
+/** Signature of session files. */
+const quint32 MAGIC = 0x4e435353; // "NCSS"
+
+/** Version of the file format. Must be incremented on every change of the format. */
+const quint32 FORMAT_VERSION = 2;
+
+/** Version of the QDataStream serialization used for Qt types. */
+const int STREAM_VERSION = QDataStream::Qt_4_8;
+
+/** Flags of a section. */
+enum SectionFlags {
+    ALLOCATED  = 1 << 0,
+    READABLE   = 1 << 1,
+    WRITABLE   = 1 << 2,
+    EXECUTABLE = 1 << 3,
+    CODE       = 1 << 4,
+    DATA       = 1 << 5,
+    BSS        = 1 << 6
+};
+
+/** Flags of a set of type traits. */
+enum TypeFlags {
+    INTEGER  = 1 << 0,
+    FLOAT    = 1 << 1,
+    POINTER  = 1 << 2,
+    SIGNED   = 1 << 3,
+    UNSIGNED = 1 << 4
+};
+
+/** Kinds of LikeC types in the table of types. */
+enum TypeKind {
+    VOID_TYPE,
+    ERRONEOUS_TYPE,
+    INTEGER_TYPE,
+    FLOAT_TYPE,
+    POINTER_TYPE,
+    ARRAY_TYPE,
+    STRUCT_TYPE
+};
+
+/*
+ * Minimal sizes of the records in a session file, in bytes.
+ * They bound the counts read from the file before anything is allocated.
+ */
+const qint64 MIN_SECTION_SIZE = 4 + 8 + 8 + 4 + 4;
+const qint64 MIN_SYMBOL_SIZE = 4 + 4 + 1 + 8 + 4;
+const qint64 RELOCATION_SIZE = 8 + 4 + 8 + 8;
+const qint64 INSTRUCTION_SIZE = 8 + 4;
+const qint64 MIN_RECORD_SIZE = 4;
+
+/** Number of instructions decoded by a worker at once. */
+const std::size_t INSTRUCTIONS_PER_CHUNK = 4096;
+
+/**
+ * Reader of a session file, throwing an exception when the file is malformed.
+ */
+class Reader {
+    QDataStream &in_; ///< Stream to read from.
+    const QString &filename_; ///< Name of the file, for error messages.
+
+public:
+    /**
+     * \param in Stream to read from.
+     * \param filename Name of the file, for error messages.
+     */
+    Reader(QDataStream &in, const QString &filename): in_(in), filename_(filename) {}
+
+    /**
+     * \return Name of the file.
+     */
+    const QString &filename() const { return filename_; }
+
+    /**
+     * \return Next value in the stream.
+     */
+    template<class T>
+    T read() {
+        T result;
+        in_ >> result;
+        check();
+        return result;
+    }
+
+    /**
+     * \param minRecordSize Minimal size of a counted record, in bytes.
+     *
+     * \return Next count of records in the stream, checked against the size of the rest of the stream.
+     */
+    quint32 readCount(qint64 minRecordSize = MIN_RECORD_SIZE) {
+        auto count = read<quint32>();
+        if (count > (in_.device()->size() - in_.device()->pos()) / minRecordSize) {
+            corrupted();
+        }
+        return count;
+    }
+
+    /**
+     * \param size Number of indexed objects.
+     *
+     * \return Next index in the stream: either -1 or a valid index.
+     */
+    qint32 readIndex(std::size_t size) {
+        auto index = read<qint32>();
+        if (index < -1 || index >= static_cast<qint64>(size)) {
+            corrupted();
+        }
+        return index;
+    }
+
+    /**
+     * Throws an exception if a read has failed.
+     */
+    void check() const {
+        if (in_.status() != QDataStream::Ok) {
+            corrupted();
+        }
+    }
+
+    /**
+     * Throws an exception telling that the file is malformed.
+     */
+    void corrupted() const {
+        throw nc::Exception(Session::tr("File \"%1\" is truncated or corrupted.").arg(filename_));
+    }
+};
+
+/**
+ * Calls a function on the terms that are direct children of a statement.
+ */
+void callOnTerms(const ir::Statement *statement, const std::function<void(const ir::Term *)> &fun) {
+    switch (statement->kind()) {
+        case ir::Statement::ASSIGNMENT: {
+            fun(statement->asAssignment()->left());
+            fun(statement->asAssignment()->right());
+            break;
+        }
+        case ir::Statement::JUMP: {
+            auto jump = statement->asJump();
+            if (jump->condition()) {
+                fun(jump->condition());
+            }
+            if (jump->thenTarget().address()) {
+                fun(jump->thenTarget().address());
+            }
+            if (jump->elseTarget().address()) {
+                fun(jump->elseTarget().address());
+            }
+            break;
+        }
+        case ir::Statement::CALL: {
+            fun(statement->asCall()->target());
+            break;
+        }
+        case ir::Statement::TOUCH: {
+            fun(statement->asTouch()->term());
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
+/**
+ * \return Statements of the function generated from instructions, in the order of the basic blocks.
+ *         Statements inserted by the analyses have no instructions and are left out.
+ */
+std::vector<const ir::Statement *> getInstructionStatements(const ir::Function *function) {
+    std::vector<const ir::Statement *> result;
+
+    foreach (auto basicBlock, function->basicBlocks()) {
+        foreach (auto statement, basicBlock->statements()) {
+            if (statement->instruction()) {
+                result.push_back(statement);
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * \return Address of the function's entry, if known.
+ */
+boost::optional<ByteAddr> getEntryAddress(const ir::Function *function) {
+    if (function->entry()) {
+        return function->entry()->address();
+    }
+    return boost::none;
+}
+
+/**
+ * Numbering of the statements generated from instructions and of the terms in them
+ * and in the signatures. It does not depend on where these objects are in memory,
+ * thus it is the same for the saved context and for the restored one.
+ */
+class IrNumbering {
+    std::vector<const ir::Statement *> statements_; ///< Numbered statements.
+    std::vector<const ir::Term *> terms_; ///< Numbered terms.
+    boost::unordered_map<const ir::Statement *, qint32> statement2index_; ///< Numbers of the statements.
+    boost::unordered_map<const ir::Term *, qint32> term2index_; ///< Numbers of the terms.
+
+public:
+    /**
+     * Numbers the statement and its terms.
+     */
+    void addStatement(const ir::Statement *statement) {
+        statement2index_[statement] = static_cast<qint32>(statements_.size());
+        statements_.push_back(statement);
+        callOnTerms(statement, [this](const ir::Term *term) { addTerm(term); });
+    }
+
+    /**
+     * Numbers the term and its children.
+     */
+    void addTerm(const ir::Term *term) {
+        term2index_[term] = static_cast<qint32>(terms_.size());
+        terms_.push_back(term);
+        term->callOnChildren([this](const ir::Term *child) { addTerm(child); });
+    }
+
+    /**
+     * \return Numbered statements.
+     */
+    const std::vector<const ir::Statement *> &statements() const { return statements_; }
+
+    /**
+     * \return Numbered terms.
+     */
+    const std::vector<const ir::Term *> &terms() const { return terms_; }
+
+    /**
+     * \return Number of the statement, or -1 if the statement is nullptr or not numbered.
+     */
+    qint32 getIndex(const ir::Statement *statement) const {
+        return statement ? nc::find(statement2index_, statement, -1) : -1;
+    }
+
+    /**
+     * \return Number of the term, or -1 if the term is nullptr or not numbered.
+     */
+    qint32 getIndex(const ir::Term *term) const {
+        return term ? nc::find(term2index_, term, -1) : -1;
+    }
+
+    /**
+     * \return Pointer to the statement with the number read from the stream. Can be nullptr.
+     */
+    const ir::Statement *readStatement(Reader &in) const {
+        auto index = in.readIndex(statements_.size());
+        return index >= 0 ? statements_[index] : nullptr;
+    }
+
+    /**
+     * \return Pointer to the term with the number read from the stream. Can be nullptr.
+     */
+    const ir::Term *readTerm(Reader &in) const {
+        auto index = in.readIndex(terms_.size());
+        return index >= 0 ? terms_[index] : nullptr;
+    }
+};
+
+void writeMemoryLocation(QDataStream &out, const ir::MemoryLocation &location) {
+    out << static_cast<qint32>(location.domain()) << static_cast<qint64>(location.addr()) << static_cast<qint64>(location.size());
+}
+
+ir::MemoryLocation readMemoryLocation(Reader &in) {
+    auto domain = in.read<qint32>();
+    auto addr = in.read<qint64>();
+    auto size = in.read<qint64>();
+
+    if (size < 0) {
+        in.corrupted();
+    }
+    return size ? ir::MemoryLocation(domain, addr, size) : ir::MemoryLocation();
+}
+
+void writeTerm(QDataStream &out, const ir::Term *term) {
+    out << static_cast<qint32>(term->kind()) << static_cast<qint32>(term->size());
+
+    switch (term->kind()) {
+        case ir::Term::INT_CONST: {
+            out << static_cast<quint64>(term->asConstant()->value().value());
+            break;
+        }
+        case ir::Term::INTRINSIC: {
+            out << static_cast<qint32>(term->asIntrinsic()->intrinsicKind());
+            break;
+        }
+        case ir::Term::MEMORY_LOCATION_ACCESS: {
+            writeMemoryLocation(out, term->asMemoryLocationAccess()->memoryLocation());
+            break;
+        }
+        case ir::Term::DEREFERENCE: {
+            out << static_cast<qint32>(term->asDereference()->domain());
+            writeTerm(out, term->asDereference()->address());
+            break;
+        }
+        case ir::Term::UNARY_OPERATOR: {
+            out << static_cast<qint32>(term->asUnaryOperator()->operatorKind());
+            writeTerm(out, term->asUnaryOperator()->operand());
+            break;
+        }
+        case ir::Term::BINARY_OPERATOR: {
+            out << static_cast<qint32>(term->asBinaryOperator()->operatorKind());
+            writeTerm(out, term->asBinaryOperator()->left());
+            writeTerm(out, term->asBinaryOperator()->right());
+            break;
+        }
+        default: {
+            unreachable();
+        }
+    }
+}
+
+std::unique_ptr<ir::Term> readTerm(Reader &in) {
+    auto kind = in.read<qint32>();
+    auto size = in.read<qint32>();
+
+    if (size <= 0) {
+        in.corrupted();
+    }
+
+    switch (kind) {
+        case ir::Term::INT_CONST: {
+            return std::make_unique<ir::Constant>(SizedValue(size, in.read<quint64>()));
+        }
+        case ir::Term::INTRINSIC: {
+            return std::make_unique<ir::Intrinsic>(in.read<qint32>(), size);
+        }
+        case ir::Term::MEMORY_LOCATION_ACCESS: {
+            auto location = readMemoryLocation(in);
+            if (!location || location.size() != size) {
+                in.corrupted();
+            }
+            return std::make_unique<ir::MemoryLocationAccess>(location);
+        }
+        case ir::Term::DEREFERENCE: {
+            auto domain = in.read<qint32>();
+            auto address = readTerm(in);
+            return std::make_unique<ir::Dereference>(std::move(address), domain, size);
+        }
+        case ir::Term::UNARY_OPERATOR: {
+            auto operatorKind = in.read<qint32>();
+            auto operand = readTerm(in);
+            return std::make_unique<ir::UnaryOperator>(operatorKind, std::move(operand), size);
+        }
+        case ir::Term::BINARY_OPERATOR: {
+            auto operatorKind = in.read<qint32>();
+            auto left = readTerm(in);
+            auto right = readTerm(in);
+            return std::make_unique<ir::BinaryOperator>(operatorKind, std::move(left), std::move(right), size);
+        }
+        default: {
+            in.corrupted();
+            return nullptr;
+        }
+    }
+}
+
+/**
+ * Table of the terms of signatures. Signatures of calls share the terms
+ * with the signatures of the called functions, and so do their records.
+ */
+class SignatureTerms {
+    std::vector<const ir::Term *> terms_; ///< Terms in the table.
+    boost::unordered_map<const ir::Term *, qint32> term2index_; ///< Indices of the terms.
+
+public:
+    /**
+     * Adds the terms of a signature to the table.
+     */
+    template<class Signature>
+    void add(const Signature &signature) {
+        foreach (const auto &argument, signature.arguments()) {
+            add(argument.get());
+        }
+        if (signature.returnValue()) {
+            add(signature.returnValue().get());
+        }
+    }
+
+    /**
+     * \return Terms in the table.
+     */
+    const std::vector<const ir::Term *> &terms() const { return terms_; }
+
+    /**
+     * Writes the indices of the terms of a signature.
+     */
+    template<class Signature>
+    void writeReferences(QDataStream &out, const Signature &signature) const {
+        out << static_cast<quint32>(signature.arguments().size());
+        foreach (const auto &argument, signature.arguments()) {
+            out << term2index_.find(argument.get())->second;
+        }
+        out << (signature.returnValue() ? term2index_.find(signature.returnValue().get())->second : -1);
+    }
+
+private:
+    void add(const ir::Term *term) {
+        if (!nc::contains(term2index_, term)) {
+            term2index_[term] = static_cast<qint32>(terms_.size());
+            terms_.push_back(term);
+        }
+    }
+};
+
+/**
+ * Reads the indices of the terms of a signature and sets the terms of the signature.
+ */
+template<class Signature>
+void readSignatureReferences(Reader &in, const std::vector<std::shared_ptr<ir::Term>> &terms, Signature &signature) {
+    auto count = in.readCount();
+    for (quint32 i = 0; i < count; ++i) {
+        auto index = in.readIndex(terms.size());
+        if (index < 0) {
+            in.corrupted();
+        }
+        signature.arguments().push_back(terms[index]);
+    }
+
+    auto index = in.readIndex(terms.size());
+    if (index >= 0) {
+        signature.setReturnValue(terms[index]);
+    }
+}
+
+/**
+ * Mutex guarding internedNames.
+ */
+QMutex internedNamesMutex;
+
+/**
+ * Names of the undeclared identifiers restored from session files.
+ * QLatin1String does not own its characters, so the names are never freed.
+ */
+std::set<QByteArray> internedNames;
+
+/**
+ * \return Latin-1 string with the given characters, valid until the program exits.
+ */
+QLatin1String internName(const QByteArray &name) {
+    QMutexLocker locker(&internedNamesMutex);
+    return QLatin1String(internedNames.insert(name).first->constData());
+}
+
+/**
+ * Writer of a LikeC tree.
+ *
+ * Declarations and types are referred to by their indices in the tables
+ * written before the tree itself. Declarations are first created without
+ * their children, so that identifiers may refer to declarations appearing
+ * anywhere in the tree, and types may refer to structures with members
+ * referring to the structures back.
+ */
+class TreeWriter {
+    const IrNumbering &numbering_; ///< Numbering of the IR statements and terms.
+    QByteArray nodes_; ///< Serialized nodes of the tree.
+    QDataStream out_; ///< Stream writing nodes_.
+    std::vector<const likec::Declaration *> declarations_; ///< Table of declarations.
+    boost::unordered_map<const likec::Declaration *, qint32> declaration2index_; ///< Indices of the declarations.
+    boost::unordered_set<const likec::Declaration *> arguments_; ///< Declarations of the functions' arguments.
+    boost::unordered_set<const likec::Declaration *> owned_; ///< Declarations owned by the nodes of the tree.
+    std::vector<const likec::Type *> types_; ///< Table of types.
+    boost::unordered_map<const likec::Type *, qint32> type2index_; ///< Indices of the types.
+
+public:
+    /**
+     * \param numbering Numbering of the IR statements and terms the tree refers to.
+     */
+    explicit TreeWriter(const IrNumbering &numbering): numbering_(numbering), out_(&nodes_, QIODevice::WriteOnly) {
+        out_.setVersion(STREAM_VERSION);
+    }
+
+    /**
+     * Writes the tree to the stream.
+     */
+    void write(QDataStream &out, const likec::Tree &tree) {
+        out_ << static_cast<bool>(tree.root());
+        if (tree.root()) {
+            writeDeclarations(tree.root()->declarations());
+        }
+
+        /* Otherwise, the restored tree would not own all its declarations. */
+        if (owned_.size() != declarations_.size()) {
+            throw nc::Exception(Session::tr("The LikeC tree refers to declarations that are not in it."));
+        }
+
+        out << static_cast<qint32>(tree.intSize()) << static_cast<qint32>(tree.pointerSize()) << static_cast<qint32>(tree.ptrdiffSize());
+
+        out << static_cast<quint32>(declarations_.size());
+        foreach (auto declaration, declarations_) {
+            out << static_cast<qint32>(declaration->declarationKind()) << nc::contains(arguments_, declaration)
+                << declaration->identifier();
+        }
+
+        out << static_cast<quint32>(types_.size());
+        foreach (auto type, types_) {
+            writeTypeRecord(out, type);
+        }
+
+        foreach (auto declaration, declarations_) {
+            writeDeclarationRecord(out, declaration);
+        }
+
+        out << nodes_;
+    }
+
+private:
+    qint32 getIndex(const likec::Declaration *declaration) {
+        if (!declaration) {
+            return -1;
+        }
+        auto i = declaration2index_.find(declaration);
+        if (i != declaration2index_.end()) {
+            return i->second;
+        }
+
+        auto index = static_cast<qint32>(declarations_.size());
+        declaration2index_[declaration] = index;
+        declarations_.push_back(declaration);
+
+        switch (declaration->declarationKind()) {
+            case likec::Declaration::FUNCTION_DECLARATION: /* FALLTHROUGH */
+            case likec::Declaration::FUNCTION_DEFINITION: {
+                auto function = static_cast<const likec::FunctionDeclaration *>(declaration);
+                getIndex(function->type()->returnType());
+                foreach (const auto &argument, function->arguments()) {
+                    arguments_.insert(argument.get());
+                    owned_.insert(argument.get());
+                    getIndex(argument.get());
+                }
+                getIndex(function->getFirstDeclaration());
+                if (auto definition = declaration->as<likec::FunctionDefinition>()) {
+                    foreach (const auto &label, definition->labels()) {
+                        owned_.insert(label.get());
+                        getIndex(label.get());
+                    }
+                }
+                break;
+            }
+            case likec::Declaration::MEMBER_DECLARATION: {
+                getIndex(declaration->as<likec::MemberDeclaration>()->type());
+                break;
+            }
+            case likec::Declaration::STRUCT_TYPE_DECLARATION: {
+                auto structType = declaration->as<likec::StructTypeDeclaration>()->type();
+                getIndex(structType);
+                foreach (auto member, structType->members()) {
+                    owned_.insert(member);
+                    getIndex(member);
+                }
+                break;
+            }
+            case likec::Declaration::VARIABLE_DECLARATION: {
+                getIndex(declaration->as<likec::VariableDeclaration>()->type());
+                break;
+            }
+        }
+
+        return index;
+    }
+
+    qint32 getIndex(const likec::Type *type) {
+        if (!type) {
+            return -1;
+        }
+        auto i = type2index_.find(type);
+        if (i != type2index_.end()) {
+            return i->second;
+        }
+
+        if (type->kind() == likec::Type::STRUCT_TYPE) {
+            /* The members of the structure can refer to it. */
+            auto index = addType(type);
+            getIndex(type->as<likec::StructType>()->typeDeclaration());
+            return index;
+        }
+
+        switch (type->kind()) {
+            case likec::Type::VOID: /* FALLTHROUGH */
+            case likec::Type::ERRONEOUS: /* FALLTHROUGH */
+            case likec::Type::INTEGER: /* FALLTHROUGH */
+            case likec::Type::FLOAT: {
+                break;
+            }
+            case likec::Type::POINTER: {
+                getIndex(type->as<likec::PointerType>()->pointeeType());
+                /* The pointee can refer to this type via a structure's member. */
+                if (auto index = nc::find(type2index_, type, -1) + 1) {
+                    return index - 1;
+                }
+                break;
+            }
+            default: {
+                throw nc::Exception(Session::tr("The LikeC tree has a type that cannot be saved: %1.").arg(type->toString()));
+            }
+        }
+
+        return addType(type);
+    }
+
+    qint32 addType(const likec::Type *type) {
+        auto index = static_cast<qint32>(types_.size());
+        type2index_[type] = index;
+        types_.push_back(type);
+        return index;
+    }
+
+    void writeTypeRecord(QDataStream &out, const likec::Type *type) {
+        switch (type->kind()) {
+            case likec::Type::VOID: {
+                out << static_cast<qint32>(VOID_TYPE);
+                break;
+            }
+            case likec::Type::ERRONEOUS: {
+                out << static_cast<qint32>(ERRONEOUS_TYPE);
+                break;
+            }
+            case likec::Type::INTEGER: {
+                out << static_cast<qint32>(INTEGER_TYPE) << static_cast<qint32>(type->size())
+                    << type->as<likec::IntegerType>()->isUnsigned();
+                break;
+            }
+            case likec::Type::FLOAT: {
+                out << static_cast<qint32>(FLOAT_TYPE) << static_cast<qint32>(type->size());
+                break;
+            }
+            case likec::Type::POINTER: {
+                auto pointer = type->as<likec::PointerType>();
+                if (pointer->pointerKind() == likec::PointerType::ARRAY_PTR) {
+                    auto array = static_cast<const likec::ArrayType *>(pointer);
+                    out << static_cast<qint32>(ARRAY_TYPE) << static_cast<qint32>(type->size())
+                        << type2index_[array->elementType()] << static_cast<quint64>(array->length());
+                } else {
+                    out << static_cast<qint32>(POINTER_TYPE) << static_cast<qint32>(type->size())
+                        << type2index_[pointer->pointeeType()];
+                }
+                break;
+            }
+            case likec::Type::STRUCT_TYPE: {
+                out << static_cast<qint32>(STRUCT_TYPE) << declaration2index_[type->as<likec::StructType>()->typeDeclaration()];
+                break;
+            }
+            default: {
+                unreachable();
+            }
+        }
+    }
+
+    void writeDeclarationRecord(QDataStream &out, const likec::Declaration *declaration) {
+        switch (declaration->declarationKind()) {
+            case likec::Declaration::FUNCTION_DECLARATION: /* FALLTHROUGH */
+            case likec::Declaration::FUNCTION_DEFINITION: {
+                auto function = static_cast<const likec::FunctionDeclaration *>(declaration);
+                out << getIndex(function->type()->returnType()) << function->type()->variadic() << function->comment()
+                    << getIndex(function->getFirstDeclaration());
+
+                out << static_cast<quint32>(function->arguments().size());
+                foreach (const auto &argument, function->arguments()) {
+                    out << getIndex(argument.get());
+                }
+
+                if (auto definition = declaration->as<likec::FunctionDefinition>()) {
+                    const auto &labels = definition->labels();
+                    out << static_cast<quint32>(labels.size());
+                    foreach (const auto &label, labels) {
+                        out << getIndex(label.get());
+                    }
+                }
+                break;
+            }
+            case likec::Declaration::MEMBER_DECLARATION: {
+                out << getIndex(declaration->as<likec::MemberDeclaration>()->type());
+                break;
+            }
+            case likec::Declaration::STRUCT_TYPE_DECLARATION: {
+                const auto &members = declaration->as<likec::StructTypeDeclaration>()->type()->members();
+                out << static_cast<quint32>(members.size());
+                foreach (auto member, members) {
+                    out << getIndex(member);
+                }
+                break;
+            }
+            case likec::Declaration::VARIABLE_DECLARATION: {
+                auto variable = declaration->as<likec::VariableDeclaration>();
+                out << getIndex(variable->type()) << variable->comment();
+                break;
+            }
+        }
+    }
+
+    template<class Declarations>
+    void writeDeclarations(const Declarations &declarations) {
+        out_ << static_cast<quint32>(declarations.size());
+        foreach (const likec::Declaration *declaration, declarations) {
+            out_ << getIndex(declaration);
+            owned_.insert(declaration);
+
+            if (auto variable = declaration->as<likec::VariableDeclaration>()) {
+                writeExpression(variable->initialValue());
+            } else if (auto definition = declaration->as<likec::FunctionDefinition>()) {
+                writeStatement(definition->block());
+            }
+        }
+    }
+
+    void writeStatement(const likec::Statement *statement) {
+        if (!statement) {
+            out_ << static_cast<qint32>(-1);
+            return;
+        }
+
+        out_ << static_cast<qint32>(statement->statementKind()) << numbering_.getIndex(statement->statement());
+
+        switch (statement->statementKind()) {
+            case likec::Statement::BLOCK: {
+                auto block = statement->as<likec::Block>();
+                writeDeclarations(block->declarations());
+                out_ << static_cast<quint32>(block->statements().size());
+                foreach (auto child, block->statements()) {
+                    writeStatement(child);
+                }
+                break;
+            }
+            case likec::Statement::BREAK: /* FALLTHROUGH */
+            case likec::Statement::CONTINUE: /* FALLTHROUGH */
+            case likec::Statement::DEFAULT_LABEL: {
+                break;
+            }
+            case likec::Statement::DO_WHILE: {
+                writeStatement(statement->as<likec::DoWhile>()->body());
+                writeExpression(statement->as<likec::DoWhile>()->condition());
+                break;
+            }
+            case likec::Statement::EXPRESSION_STATEMENT: {
+                writeExpression(statement->as<likec::ExpressionStatement>()->expression());
+                break;
+            }
+            case likec::Statement::GOTO: {
+                writeExpression(statement->as<likec::Goto>()->destination());
+                break;
+            }
+            case likec::Statement::IF: {
+                writeExpression(statement->as<likec::If>()->condition());
+                writeStatement(statement->as<likec::If>()->thenStatement());
+                writeStatement(statement->as<likec::If>()->elseStatement());
+                break;
+            }
+            case likec::Statement::LABEL_STATEMENT: {
+                writeExpression(statement->as<likec::LabelStatement>()->identifier());
+                break;
+            }
+            case likec::Statement::RETURN: {
+                writeExpression(statement->as<likec::Return>()->returnValue());
+                break;
+            }
+            case likec::Statement::WHILE: {
+                writeExpression(statement->as<likec::While>()->condition());
+                writeStatement(statement->as<likec::While>()->body());
+                break;
+            }
+            case likec::Statement::INLINE_ASSEMBLY: {
+                out_ << statement->as<likec::InlineAssembly>()->code();
+                break;
+            }
+            case likec::Statement::SWITCH: {
+                writeExpression(statement->as<likec::Switch>()->expression());
+                writeStatement(statement->as<likec::Switch>()->body());
+                break;
+            }
+            case likec::Statement::CASE_LABEL: {
+                writeExpression(statement->as<likec::CaseLabel>()->expression());
+                break;
+            }
+            default: {
+                unreachable();
+            }
+        }
+    }
+
+    void writeExpression(const likec::Expression *expression) {
+        if (!expression) {
+            out_ << static_cast<qint32>(-1);
+            return;
+        }
+
+        out_ << static_cast<qint32>(expression->expressionKind()) << numbering_.getIndex(expression->term());
+
+        switch (expression->expressionKind()) {
+            case likec::Expression::BINARY_OPERATOR: {
+                auto binary = expression->as<likec::BinaryOperator>();
+                out_ << static_cast<qint32>(binary->operatorKind());
+                writeExpression(binary->left());
+                writeExpression(binary->right());
+                break;
+            }
+            case likec::Expression::CALL_OPERATOR: {
+                auto call = expression->as<likec::CallOperator>();
+                writeExpression(call->callee());
+                out_ << static_cast<quint32>(call->arguments().size());
+                foreach (auto argument, call->arguments()) {
+                    writeExpression(argument);
+                }
+                break;
+            }
+            case likec::Expression::FUNCTION_IDENTIFIER: {
+                out_ << getIndex(expression->as<likec::FunctionIdentifier>()->declaration());
+                break;
+            }
+            case likec::Expression::INTEGER_CONSTANT: {
+                auto constant = expression->as<likec::IntegerConstant>();
+                out_ << static_cast<qint32>(constant->value().size()) << static_cast<quint64>(constant->value().value())
+                     << getIndex(constant->type());
+                break;
+            }
+            case likec::Expression::LABEL_IDENTIFIER: {
+                out_ << getIndex(expression->as<likec::LabelIdentifier>()->declaration());
+                break;
+            }
+            case likec::Expression::MEMBER_ACCESS_OPERATOR: {
+                auto access = expression->as<likec::MemberAccessOperator>();
+                out_ << static_cast<qint32>(access->accessKind());
+                writeExpression(access->compound());
+                out_ << getIndex(access->member());
+                break;
+            }
+            case likec::Expression::STRING: {
+                out_ << expression->as<likec::String>()->characters();
+                break;
+            }
+            case likec::Expression::TYPECAST: {
+                auto typecast = expression->as<likec::Typecast>();
+                out_ << static_cast<qint32>(typecast->castKind()) << getIndex(typecast->type());
+                writeExpression(typecast->operand());
+                break;
+            }
+            case likec::Expression::UNARY_OPERATOR: {
+                auto unary = expression->as<likec::UnaryOperator>();
+                out_ << static_cast<qint32>(unary->operatorKind());
+                writeExpression(unary->operand());
+                break;
+            }
+            case likec::Expression::VARIABLE_IDENTIFIER: {
+                out_ << getIndex(expression->as<likec::VariableIdentifier>()->declaration());
+                break;
+            }
+            case likec::Expression::UNDECLARED_IDENTIFIER: {
+                auto identifier = expression->as<likec::UndeclaredIdentifier>();
+                auto type = identifier->type()->as<likec::FunctionPointerType>();
+                if (!type) {
+                    throw nc::Exception(Session::tr("The LikeC tree has an identifier of a type that cannot be saved: %1.")
+                        .arg(identifier->type()->toString()));
+                }
+                out_ << QByteArray(identifier->name().latin1()) << static_cast<qint64>(type->size())
+                     << getIndex(type->returnType()) << type->variadic();
+                out_ << static_cast<quint32>(type->argumentTypes().size());
+                foreach (auto argumentType, type->argumentTypes()) {
+                    out_ << getIndex(argumentType);
+                }
+                break;
+            }
+            default: {
+                unreachable();
+            }
+        }
+    }
+};
+
+/**
+ * Reader of a LikeC tree written by TreeWriter.
+ */
+class TreeReader {
+    const IrNumbering &numbering_; ///< Numbering of the IR statements and terms.
+    likec::Tree &tree_; ///< Tree being restored.
+    std::vector<std::unique_ptr<likec::Declaration>> owned_; ///< Declarations not yet given to their parents.
+    std::vector<likec::Declaration *> declarations_; ///< Table of declarations.
+    std::vector<const likec::Type *> types_; ///< Table of types.
+
+public:
+    /**
+     * \param numbering Numbering of the IR statements and terms the tree refers to.
+     * \param tree Empty tree to restore.
+     */
+    TreeReader(const IrNumbering &numbering, likec::Tree &tree): numbering_(numbering), tree_(tree) {}
+
+    /**
+     * Reads the tree from the stream.
+     */
+    void read(Reader &in) {
+        tree_.setIntSize(in.read<qint32>());
+        tree_.setPointerSize(in.read<qint32>());
+        tree_.setPtrdiffSize(in.read<qint32>());
+
+        /* Declarations that need no types are created before the types. */
+        auto declarationCount = in.readCount();
+        std::vector<std::pair<qint32, bool>> kinds;
+        std::vector<QString> identifiers;
+        kinds.reserve(declarationCount);
+        identifiers.reserve(declarationCount);
+
+        for (quint32 i = 0; i < declarationCount; ++i) {
+            auto kind = in.read<qint32>();
+            auto isArgument = in.read<bool>();
+            kinds.push_back(std::make_pair(kind, isArgument));
+            identifiers.push_back(in.read<QString>());
+
+            std::unique_ptr<likec::Declaration> declaration;
+            if (kind == likec::Declaration::STRUCT_TYPE_DECLARATION) {
+                declaration = std::make_unique<likec::StructTypeDeclaration>(identifiers.back());
+            } else if (kind == likec::Declaration::LABEL_DECLARATION) {
+                declaration = std::make_unique<likec::LabelDeclaration>(identifiers.back());
+            }
+            declarations_.push_back(declaration.get());
+            owned_.push_back(std::move(declaration));
+        }
+
+        auto typeCount = in.readCount();
+        for (quint32 i = 0; i < typeCount; ++i) {
+            types_.push_back(readTypeRecord(in));
+        }
+
+        /* Children of the declarations, in the order of the records. */
+        std::vector<std::vector<qint32>> children(declarationCount);
+        std::vector<qint32> firstDeclarations(declarationCount, -1);
+
+        for (quint32 i = 0; i < declarationCount; ++i) {
+            readDeclarationRecord(in, i, kinds[i].first, kinds[i].second, identifiers[i], children[i], firstDeclarations[i]);
+        }
+
+        for (quint32 i = 0; i < declarationCount; ++i) {
+            linkDeclaration(in, declarations_[i], children[i], firstDeclarations[i]);
+        }
+
+        auto nodes = in.read<QByteArray>();
+        QDataStream stream(nodes);
+        stream.setVersion(STREAM_VERSION);
+        Reader nodesIn(stream, in.filename());
+
+        if (nodesIn.read<bool>()) {
+            auto root = std::make_unique<likec::CompilationUnit>();
+            foreach (auto &declaration, readDeclarations(nodesIn)) {
+                root->addDeclaration(std::move(declaration));
+            }
+            tree_.setRoot(std::move(root));
+        }
+
+        /* Otherwise, the tree would refer to the declarations freed here. */
+        foreach (const auto &declaration, owned_) {
+            if (declaration) {
+                in.corrupted();
+            }
+        }
+    }
+
+private:
+    const likec::Type *readType(Reader &in) {
+        auto index = in.readIndex(types_.size());
+        return index >= 0 ? types_[index] : nullptr;
+    }
+
+    const likec::Type *readNonNullType(Reader &in) {
+        auto type = readType(in);
+        if (!type) {
+            in.corrupted();
+        }
+        return type;
+    }
+
+    likec::Declaration *readDeclarationReference(Reader &in) {
+        auto index = in.readIndex(declarations_.size());
+        if (index < 0 || !declarations_[index]) {
+            in.corrupted();
+        }
+        return declarations_[index];
+    }
+
+    template<class T>
+    T *readDeclarationReference(Reader &in) {
+        auto result = readDeclarationReference(in)->as<T>();
+        if (!result) {
+            in.corrupted();
+        }
+        return result;
+    }
+
+    likec::FunctionDeclaration *readFunctionReference(Reader &in) {
+        auto declaration = readDeclarationReference(in);
+        if (declaration->declarationKind() != likec::Declaration::FUNCTION_DECLARATION &&
+            declaration->declarationKind() != likec::Declaration::FUNCTION_DEFINITION) {
+            in.corrupted();
+        }
+        return static_cast<likec::FunctionDeclaration *>(declaration);
+    }
+
+    /**
+     * \return Declaration with the given index, taken from the declarations without a parent.
+     */
+    std::unique_ptr<likec::Declaration> take(Reader &in, qint32 index) {
+        if (index < 0 || !owned_[index]) {
+            in.corrupted();
+        }
+        return std::move(owned_[index]);
+    }
+
+    /**
+     * \return Declaration of the given class with the given index, taken from the declarations without a parent.
+     */
+    template<class T>
+    std::unique_ptr<T> take(Reader &in, qint32 index) {
+        if (index < 0 || !owned_[index] || !owned_[index]->as<T>()) {
+            in.corrupted();
+        }
+        return std::unique_ptr<T>(static_cast<T *>(owned_[index].release()));
+    }
+
+    const likec::Type *readTypeRecord(Reader &in) {
+        switch (in.read<qint32>()) {
+            case VOID_TYPE: {
+                return tree_.makeVoidType();
+            }
+            case ERRONEOUS_TYPE: {
+                return tree_.makeErroneousType();
+            }
+            case INTEGER_TYPE: {
+                auto size = in.read<qint32>();
+                return tree_.makeIntegerType(size, in.read<bool>());
+            }
+            case FLOAT_TYPE: {
+                return tree_.makeFloatType(in.read<qint32>());
+            }
+            case POINTER_TYPE: {
+                auto size = in.read<qint32>();
+                return tree_.makePointerType(size, readNonNullType(in));
+            }
+            case ARRAY_TYPE: {
+                auto size = in.read<qint32>();
+                auto elementType = readNonNullType(in);
+                return tree_.makeArrayType(size, elementType, in.read<quint64>());
+            }
+            case STRUCT_TYPE: {
+                return readDeclarationReference<likec::StructTypeDeclaration>(in)->type();
+            }
+            default: {
+                in.corrupted();
+                return nullptr;
+            }
+        }
+    }
+
+    void readDeclarationRecord(Reader &in, std::size_t index, qint32 kind, bool isArgument, const QString &identifier,
+                               std::vector<qint32> &children, qint32 &firstDeclaration)
+    {
+        auto readChildren = [&]() {
+            auto count = in.readCount();
+            for (quint32 i = 0; i < count; ++i) {
+                auto child = in.readIndex(declarations_.size());
+                if (child < 0) {
+                    in.corrupted();
+                }
+                children.push_back(child);
+            }
+        };
+
+        switch (kind) {
+            case likec::Declaration::FUNCTION_DECLARATION: /* FALLTHROUGH */
+            case likec::Declaration::FUNCTION_DEFINITION: {
+                auto returnType = readNonNullType(in);
+                auto variadic = in.read<bool>();
+                auto comment = in.read<QString>();
+                firstDeclaration = in.readIndex(declarations_.size());
+
+                std::unique_ptr<likec::FunctionDeclaration> function;
+                if (kind == likec::Declaration::FUNCTION_DEFINITION) {
+                    function = std::make_unique<likec::FunctionDefinition>(tree_, identifier, returnType, variadic);
+                } else {
+                    function = std::make_unique<likec::FunctionDeclaration>(tree_, identifier, returnType, variadic);
+                }
+                function->setComment(comment);
+
+                readChildren();
+                if (kind == likec::Declaration::FUNCTION_DEFINITION) {
+                    /* Labels follow the arguments. */
+                    children.push_back(-1);
+                    readChildren();
+                }
+
+                declarations_[index] = function.get();
+                owned_[index] = std::move(function);
+                break;
+            }
+            case likec::Declaration::LABEL_DECLARATION: {
+                break;
+            }
+            case likec::Declaration::MEMBER_DECLARATION: {
+                auto member = std::make_unique<likec::MemberDeclaration>(identifier, readNonNullType(in));
+                declarations_[index] = member.get();
+                owned_[index] = std::move(member);
+                break;
+            }
+            case likec::Declaration::STRUCT_TYPE_DECLARATION: {
+                readChildren();
+                break;
+            }
+            case likec::Declaration::VARIABLE_DECLARATION: {
+                auto type = readNonNullType(in);
+                auto comment = in.read<QString>();
+
+                std::unique_ptr<likec::VariableDeclaration> variable;
+                if (isArgument) {
+                    variable = std::make_unique<likec::ArgumentDeclaration>(identifier, type);
+                } else {
+                    variable = std::make_unique<likec::VariableDeclaration>(identifier, type);
+                }
+                variable->setComment(comment);
+
+                declarations_[index] = variable.get();
+                owned_[index] = std::move(variable);
+                break;
+            }
+            default: {
+                in.corrupted();
+            }
+        }
+    }
+
+    void linkDeclaration(Reader &in, likec::Declaration *declaration, const std::vector<qint32> &children, qint32 firstDeclaration) {
+        if (auto structDeclaration = declaration->as<likec::StructTypeDeclaration>()) {
+            foreach (auto child, children) {
+                structDeclaration->type()->addMember(take<likec::MemberDeclaration>(in, child));
+            }
+        } else if (declaration->declarationKind() == likec::Declaration::FUNCTION_DECLARATION ||
+                   declaration->declarationKind() == likec::Declaration::FUNCTION_DEFINITION) {
+            auto function = static_cast<likec::FunctionDeclaration *>(declaration);
+
+            bool labels = false;
+            foreach (auto child, children) {
+                if (child == -1) {
+                    labels = true;
+                } else if (labels) {
+                    declaration->as<likec::FunctionDefinition>()->addLabel(take<likec::LabelDeclaration>(in, child));
+                } else {
+                    auto argument = take<likec::VariableDeclaration>(in, child);
+                    /* Only arguments are created as ArgumentDeclaration. */
+                    function->addArgument(std::unique_ptr<likec::ArgumentDeclaration>(static_cast<likec::ArgumentDeclaration *>(argument.release())));
+                }
+            }
+
+            if (firstDeclaration >= 0) {
+                auto first = declarations_[firstDeclaration];
+                if (!first || (first->declarationKind() != likec::Declaration::FUNCTION_DECLARATION &&
+                               first->declarationKind() != likec::Declaration::FUNCTION_DEFINITION)) {
+                    in.corrupted();
+                }
+                function->setFirstDeclaration(static_cast<likec::FunctionDeclaration *>(first));
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<likec::Declaration>> readDeclarations(Reader &in) {
+        std::vector<std::unique_ptr<likec::Declaration>> result;
+
+        auto count = in.readCount();
+        for (quint32 i = 0; i < count; ++i) {
+            auto declaration = take(in, in.readIndex(declarations_.size()));
+
+            if (auto variable = declaration->as<likec::VariableDeclaration>()) {
+                variable->initialValue() = readExpression(in);
+            } else if (auto definition = declaration->as<likec::FunctionDefinition>()) {
+                auto block = readStatement(in);
+                if (!block || !block->is<likec::Block>()) {
+                    in.corrupted();
+                }
+                definition->block().reset(static_cast<likec::Block *>(block.release()));
+            }
+
+            result.push_back(std::move(declaration));
+        }
+
+        return result;
+    }
+
+    template<class T>
+    static std::unique_ptr<T> nonNull(Reader &in, std::unique_ptr<T> node) {
+        if (!node) {
+            in.corrupted();
+        }
+        return node;
+    }
+
+    std::unique_ptr<likec::Statement> readStatement(Reader &in) {
+        auto kind = in.read<qint32>();
+        if (kind == -1) {
+            return nullptr;
+        }
+
+        auto irStatement = numbering_.readStatement(in);
+
+        std::unique_ptr<likec::Statement> result;
+
+        switch (kind) {
+            case likec::Statement::BLOCK: {
+                auto block = std::make_unique<likec::Block>();
+                foreach (auto &declaration, readDeclarations(in)) {
+                    block->addDeclaration(std::move(declaration));
+                }
+                auto count = in.readCount();
+                for (quint32 i = 0; i < count; ++i) {
+                    block->addStatement(nonNull(in, readStatement(in)));
+                }
+                result = std::move(block);
+                break;
+            }
+            case likec::Statement::BREAK: {
+                result = std::make_unique<likec::Break>();
+                break;
+            }
+            case likec::Statement::CONTINUE: {
+                result = std::make_unique<likec::Continue>();
+                break;
+            }
+            case likec::Statement::DEFAULT_LABEL: {
+                result = std::make_unique<likec::DefaultLabel>();
+                break;
+            }
+            case likec::Statement::DO_WHILE: {
+                auto body = nonNull(in, readStatement(in));
+                result = std::make_unique<likec::DoWhile>(std::move(body), nonNull(in, readExpression(in)));
+                break;
+            }
+            case likec::Statement::EXPRESSION_STATEMENT: {
+                result = std::make_unique<likec::ExpressionStatement>(nonNull(in, readExpression(in)));
+                break;
+            }
+            case likec::Statement::GOTO: {
+                result = std::make_unique<likec::Goto>(readExpression(in));
+                break;
+            }
+            case likec::Statement::IF: {
+                auto condition = nonNull(in, readExpression(in));
+                auto thenStatement = nonNull(in, readStatement(in));
+                result = std::make_unique<likec::If>(std::move(condition), std::move(thenStatement), readStatement(in));
+                break;
+            }
+            case likec::Statement::LABEL_STATEMENT: {
+                auto identifier = nonNull(in, readExpression(in));
+                if (!identifier->is<likec::LabelIdentifier>()) {
+                    in.corrupted();
+                }
+                result = std::make_unique<likec::LabelStatement>(
+                    std::unique_ptr<likec::LabelIdentifier>(static_cast<likec::LabelIdentifier *>(identifier.release())));
+                break;
+            }
+            case likec::Statement::RETURN: {
+                result = std::make_unique<likec::Return>(readExpression(in));
+                break;
+            }
+            case likec::Statement::WHILE: {
+                auto condition = nonNull(in, readExpression(in));
+                result = std::make_unique<likec::While>(std::move(condition), nonNull(in, readStatement(in)));
+                break;
+            }
+            case likec::Statement::INLINE_ASSEMBLY: {
+                result = std::make_unique<likec::InlineAssembly>(in.read<QString>());
+                break;
+            }
+            case likec::Statement::SWITCH: {
+                auto expression = nonNull(in, readExpression(in));
+                result = std::make_unique<likec::Switch>(std::move(expression), nonNull(in, readStatement(in)));
+                break;
+            }
+            case likec::Statement::CASE_LABEL: {
+                result = std::make_unique<likec::CaseLabel>(nonNull(in, readExpression(in)));
+                break;
+            }
+            default: {
+                in.corrupted();
+            }
+        }
+
+        if (irStatement) {
+            result->setStatement(irStatement);
+        }
+
+        return result;
+    }
+
+    std::unique_ptr<likec::Expression> readExpression(Reader &in) {
+        auto kind = in.read<qint32>();
+        if (kind == -1) {
+            return nullptr;
+        }
+
+        auto term = numbering_.readTerm(in);
+
+        std::unique_ptr<likec::Expression> result;
+
+        switch (kind) {
+            case likec::Expression::BINARY_OPERATOR: {
+                auto operatorKind = in.read<qint32>();
+                auto left = nonNull(in, readExpression(in));
+                result = std::make_unique<likec::BinaryOperator>(operatorKind, std::move(left), nonNull(in, readExpression(in)));
+                break;
+            }
+            case likec::Expression::CALL_OPERATOR: {
+                auto call = std::make_unique<likec::CallOperator>(nonNull(in, readExpression(in)));
+                auto count = in.readCount();
+                for (quint32 i = 0; i < count; ++i) {
+                    call->addArgument(nonNull(in, readExpression(in)));
+                }
+                result = std::move(call);
+                break;
+            }
+            case likec::Expression::FUNCTION_IDENTIFIER: {
+                result = std::make_unique<likec::FunctionIdentifier>(readFunctionReference(in));
+                break;
+            }
+            case likec::Expression::INTEGER_CONSTANT: {
+                auto size = in.read<qint32>();
+                auto value = in.read<quint64>();
+                auto type = readNonNullType(in)->as<likec::IntegerType>();
+                if (!type || type->size() != size) {
+                    in.corrupted();
+                }
+                result = std::make_unique<likec::IntegerConstant>(SizedValue(size, value), type);
+                break;
+            }
+            case likec::Expression::LABEL_IDENTIFIER: {
+                result = std::make_unique<likec::LabelIdentifier>(readDeclarationReference<likec::LabelDeclaration>(in));
+                break;
+            }
+            case likec::Expression::MEMBER_ACCESS_OPERATOR: {
+                auto accessKind = static_cast<likec::MemberAccessOperator::AccessKind>(in.read<qint32>());
+                auto compound = nonNull(in, readExpression(in));
+                result = std::make_unique<likec::MemberAccessOperator>(accessKind, std::move(compound),
+                    readDeclarationReference<likec::MemberDeclaration>(in));
+                break;
+            }
+            case likec::Expression::STRING: {
+                result = std::make_unique<likec::String>(in.read<QString>());
+                break;
+            }
+            case likec::Expression::TYPECAST: {
+                auto castKind = static_cast<likec::Typecast::CastKind>(in.read<qint32>());
+                auto type = readNonNullType(in);
+                result = std::make_unique<likec::Typecast>(castKind, type, nonNull(in, readExpression(in)));
+                break;
+            }
+            case likec::Expression::UNARY_OPERATOR: {
+                auto operatorKind = in.read<qint32>();
+                result = std::make_unique<likec::UnaryOperator>(operatorKind, nonNull(in, readExpression(in)));
+                break;
+            }
+            case likec::Expression::VARIABLE_IDENTIFIER: {
+                result = std::make_unique<likec::VariableIdentifier>(readDeclarationReference<likec::VariableDeclaration>(in));
+                break;
+            }
+            case likec::Expression::UNDECLARED_IDENTIFIER: {
+                auto name = in.read<QByteArray>();
+                auto size = in.read<qint64>();
+                auto returnType = readType(in);
+                auto variadic = in.read<bool>();
+
+                auto type = std::make_unique<likec::FunctionPointerType>(size, returnType, variadic);
+                auto count = in.readCount();
+                for (quint32 i = 0; i < count; ++i) {
+                    type->addArgumentType(readNonNullType(in));
+                }
+
+                result = std::make_unique<likec::UndeclaredIdentifier>(internName(name), std::move(type));
+                break;
+            }
+            default: {
+                in.corrupted();
+            }
+        }
+
+        if (term) {
+            result->setTerm(term);
+        }
+
+        return result;
+    }
+};
+
+/**
+ * Writes the decompilation results of the context.
+ */
+void saveResults(QDataStream &out, const Context &context, const arch::Instructions &instructions) {
+    /* Decompiled instructions. */
+    out << static_cast<quint32>(context.instructions()->size());
+    foreach (const auto &instruction, context.instructions()->all()) {
+        const auto &saved = instructions.get(instruction->addr());
+        if (!saved || saved->size() != instruction->size()) {
+            throw nc::Exception(Session::tr("Decompiled instruction at address 0x%1 is not among the saved instructions.")
+                .arg(instruction->addr(), 0, 16));
+        }
+        out << static_cast<qint64>(instruction->addr());
+    }
+
+    /*
+     * Functions, with the instructions of their statements, so that
+     * the functions regenerated from the instructions can be checked.
+     */
+    IrNumbering numbering;
+    std::vector<const ir::Function *> functions;
+
+    foreach (const ir::Function *function, context.functions()->list()) {
+        functions.push_back(function);
+    }
+
+    out << static_cast<quint32>(functions.size());
+    foreach (auto function, functions) {
+        auto statements = getInstructionStatements(function);
+
+        auto entryAddress = getEntryAddress(function);
+        out << entryAddress.is_initialized() << static_cast<qint64>(entryAddress ? *entryAddress : 0);
+
+        out << static_cast<quint32>(statements.size());
+        foreach (auto statement, statements) {
+            out << static_cast<qint64>(statement->instruction()->addr()) << static_cast<qint32>(statement->kind());
+            numbering.addStatement(statement);
+        }
+    }
+
+    /* Signatures. */
+    const auto &signatures = *context.signatures();
+
+    std::vector<const ir::calling::FunctionSignature *> functionSignatures;
+    boost::unordered_map<const ir::calling::FunctionSignature *, qint32> signature2index;
+
+    auto getIndex = [&](const ir::calling::FunctionSignature *signature) -> qint32 {
+        if (!signature) {
+            return -1;
+        }
+        auto i = signature2index.find(signature);
+        if (i != signature2index.end()) {
+            return i->second;
+        }
+        auto index = static_cast<qint32>(functionSignatures.size());
+        signature2index[signature] = index;
+        functionSignatures.push_back(signature);
+        return index;
+    };
+
+    std::vector<qint32> functionIndices;
+    foreach (auto function, functions) {
+        functionIndices.push_back(getIndex(signatures.getSignature(function).get()));
+    }
+
+    std::vector<std::pair<ByteAddr, qint32>> addressIndices;
+    foreach (const auto &pair, signatures.addr2signature()) {
+        if (pair.second) {
+            addressIndices.push_back(std::make_pair(pair.first, -1));
+        }
+    }
+    std::sort(addressIndices.begin(), addressIndices.end());
+    foreach (auto &pair, addressIndices) {
+        pair.second = getIndex(signatures.getSignature(pair.first).get());
+    }
+
+    std::vector<std::pair<qint32, const ir::calling::CallSignature *>> callSignatures;
+    foreach (auto statement, numbering.statements()) {
+        if (auto call = statement->asCall()) {
+            if (auto signature = signatures.getSignature(call).get()) {
+                callSignatures.push_back(std::make_pair(numbering.getIndex(statement), signature));
+            }
+        }
+    }
+
+    SignatureTerms signatureTerms;
+    foreach (auto signature, functionSignatures) {
+        signatureTerms.add(*signature);
+    }
+    foreach (const auto &pair, callSignatures) {
+        signatureTerms.add(*pair.second);
+    }
+
+    out << static_cast<quint32>(signatureTerms.terms().size());
+    foreach (auto term, signatureTerms.terms()) {
+        writeTerm(out, term);
+        numbering.addTerm(term);
+    }
+
+    out << static_cast<quint32>(functionSignatures.size());
+    foreach (auto signature, functionSignatures) {
+        out << signature->variadic();
+        signatureTerms.writeReferences(out, *signature);
+    }
+
+    foreach (auto index, functionIndices) {
+        out << index;
+    }
+
+    out << static_cast<quint32>(addressIndices.size());
+    foreach (const auto &pair, addressIndices) {
+        out << static_cast<qint64>(pair.first) << pair.second;
+    }
+
+    out << static_cast<quint32>(callSignatures.size());
+    foreach (const auto &pair, callSignatures) {
+        out << pair.first;
+        signatureTerms.writeReferences(out, *pair.second);
+    }
+
+    /* Variables. Terms of the statements inserted by the analyses are dropped. */
+    out << static_cast<quint32>(context.variables()->list().size());
+    foreach (auto variable, context.variables()->list()) {
+        out << static_cast<qint32>(variable->scope());
+        writeMemoryLocation(out, variable->memoryLocation());
+
+        std::vector<std::pair<qint32, const ir::MemoryLocation *>> termsAndLocations;
+        foreach (const auto &termAndLocation, variable->termsAndLocations()) {
+            auto index = numbering.getIndex(termAndLocation.term);
+            if (index >= 0) {
+                termsAndLocations.push_back(std::make_pair(index, &termAndLocation.location));
+            }
+        }
+
+        out << static_cast<quint32>(termsAndLocations.size());
+        foreach (const auto &pair, termsAndLocations) {
+            out << pair.first;
+            writeMemoryLocation(out, *pair.second);
+        }
+    }
+
+    /* Types, as sets of type traits and the sets of the terms. */
+    std::vector<std::pair<qint32, const ir::types::Type *>> termTypes;
+    foreach (const auto &pair, context.types()->map()) {
+        auto index = numbering.getIndex(pair.first);
+        if (index >= 0) {
+            termTypes.push_back(std::make_pair(index, pair.second->findSet()));
+        }
+    }
+    std::sort(termTypes.begin(), termTypes.end(),
+        [](const std::pair<qint32, const ir::types::Type *> &a, const std::pair<qint32, const ir::types::Type *> &b) {
+            return a.first < b.first;
+        });
+
+    std::vector<const ir::types::Type *> sets;
+    boost::unordered_map<const ir::types::Type *, qint32> set2index;
+
+    std::function<qint32(const ir::types::Type *)> getSetIndex = [&](const ir::types::Type *type) -> qint32 {
+        auto i = set2index.find(type);
+        if (i != set2index.end()) {
+            return i->second;
+        }
+        auto index = static_cast<qint32>(sets.size());
+        set2index[type] = index;
+        sets.push_back(type);
+
+        if (type->pointee()) {
+            getSetIndex(type->pointee());
+        }
+#ifdef NC_STRUCT_RECOVERY
+        foreach (const auto &offsetType, type->offsets()) {
+            getSetIndex(offsetType.second->findSet());
+        }
+#endif
+        return index;
+    };
+
+    foreach (const auto &pair, termTypes) {
+        getSetIndex(pair.second);
+    }
+
+    out << static_cast<quint32>(sets.size());
+    foreach (auto type, sets) {
+        quint32 flags =
+            (type->isInteger()  ? INTEGER  : 0) |
+            (type->isFloat()    ? FLOAT    : 0) |
+            (type->isPointer()  ? POINTER  : 0) |
+            (type->isSigned()   ? SIGNED   : 0) |
+            (type->isUnsigned() ? UNSIGNED : 0);
+
+        out << static_cast<qint32>(type->size()) << flags << static_cast<quint64>(type->factor())
+            << (type->pointee() ? set2index[type->pointee()] : -1);
+
+#ifdef NC_STRUCT_RECOVERY
+        out << static_cast<quint32>(type->offsets().size());
+        foreach (const auto &offsetType, type->offsets()) {
+            out << static_cast<qint64>(offsetType.first) << set2index[offsetType.second->findSet()];
+        }
+#else
+        out << static_cast<quint32>(0);
+#endif
+    }
+
+    out << static_cast<quint32>(termTypes.size());
+    foreach (const auto &pair, termTypes) {
+        out << pair.first << set2index[pair.second];
+    }
+
+    /* LikeC tree. */
+    TreeWriter(numbering).write(out, *context.tree());
+}
+
+/**
+ * Restores the decompilation results into the context.
+ *
+ * \return True if the results have been restored, false if the functions
+ *         regenerated from the instructions do not match the saved ones.
+ */
+bool restoreResults(Reader &in, Context &context, const arch::Instructions &instructions) {
+    /* Decompiled instructions. */
+    auto decompiled = std::make_shared<arch::Instructions>();
+
+    auto instructionCount = in.readCount(8);
+    for (quint32 i = 0; i < instructionCount; ++i) {
+        auto &instruction = instructions.get(in.read<qint64>());
+        if (!instruction) {
+            in.corrupted();
+        }
+        decompiled->add(instruction);
+    }
+
+    context.setInstructions(decompiled);
+
+    /* Functions are regenerated from the instructions. */
+    auto masterAnalyzer = context.image()->platform().architecture()->masterAnalyzer();
+    masterAnalyzer->createProgram(context);
+    masterAnalyzer->createFunctions(context);
+
+    std::vector<ir::Function *> functions;
+    foreach (ir::Function *function, context.functions()->list()) {
+        functions.push_back(function);
+    }
+
+    IrNumbering numbering;
+    bool matches = in.readCount() == functions.size();
+
+    foreach (auto function, functions) {
+        if (!matches) {
+            break;
+        }
+
+        auto hasEntry = in.read<bool>();
+        auto entry = in.read<qint64>();
+        auto entryAddress = getEntryAddress(function);
+        matches = hasEntry == entryAddress.is_initialized() && (!hasEntry || entry == static_cast<qint64>(*entryAddress));
+
+        auto statements = getInstructionStatements(function);
+        matches = matches && in.readCount(12) == statements.size();
+
+        for (std::size_t i = 0; matches && i < statements.size(); ++i) {
+            auto addr = in.read<qint64>();
+            auto kind = in.read<qint32>();
+            matches = addr == static_cast<qint64>(statements[i]->instruction()->addr()) && kind == statements[i]->kind();
+            numbering.addStatement(statements[i]);
+        }
+    }
+
+    if (!matches) {
+        context.logToken().warning(Session::tr("Functions generated from the instructions in session file \"%1\" "
+            "differ from the saved ones. The decompilation results are not restored.").arg(in.filename()));
+        context.setFunctions(nullptr);
+        context.setProgram(nullptr);
+        return false;
+    }
+
+    /* Signatures. */
+    auto signatures = std::make_unique<ir::calling::Signatures>();
+
+    std::vector<std::shared_ptr<ir::Term>> signatureTerms(in.readCount());
+    foreach (auto &term, signatureTerms) {
+        term = readTerm(in);
+        numbering.addTerm(term.get());
+    }
+
+    std::vector<std::shared_ptr<ir::calling::FunctionSignature>> functionSignatures(in.readCount());
+    foreach (auto &signature, functionSignatures) {
+        signature = std::make_shared<ir::calling::FunctionSignature>();
+        signature->setVariadic(in.read<bool>());
+        readSignatureReferences(in, signatureTerms, *signature);
+    }
+
+    foreach (auto function, functions) {
+        auto index = in.readIndex(functionSignatures.size());
+        if (index >= 0) {
+            signatures->setSignature(function, functionSignatures[index]);
+        }
+    }
+
+    auto addressCount = in.readCount();
+    for (quint32 i = 0; i < addressCount; ++i) {
+        auto addr = in.read<qint64>();
+        auto index = in.readIndex(functionSignatures.size());
+        if (index < 0) {
+            in.corrupted();
+        }
+        signatures->setSignature(addr, functionSignatures[index]);
+    }
+
+    std::vector<std::shared_ptr<ir::calling::CallSignature>> callSignatures(in.readCount());
+    foreach (auto &signature, callSignatures) {
+        auto statement = numbering.readStatement(in);
+        if (!statement || !statement->asCall()) {
+            in.corrupted();
+        }
+        signature = std::make_shared<ir::calling::CallSignature>();
+        readSignatureReferences(in, signatureTerms, *signature);
+        signatures->setSignature(statement->asCall(), signature);
+    }
+
+    context.setSignatures(std::move(signatures));
+
+    /* Variables. */
+    auto variables = std::make_unique<ir::vars::Variables>();
+
+    auto variableCount = in.readCount();
+    for (quint32 i = 0; i < variableCount; ++i) {
+        auto scope = in.read<qint32>();
+        auto memoryLocation = readMemoryLocation(in);
+        if ((scope != ir::vars::Variable::GLOBAL && scope != ir::vars::Variable::LOCAL) || !memoryLocation) {
+            in.corrupted();
+        }
+
+        std::vector<ir::vars::Variable::TermAndLocation> termsAndLocations;
+        auto count = in.readCount();
+        for (quint32 j = 0; j < count; ++j) {
+            auto term = numbering.readTerm(in);
+            if (!term) {
+                in.corrupted();
+            }
+            termsAndLocations.push_back(ir::vars::Variable::TermAndLocation(term, readMemoryLocation(in)));
+        }
+
+        variables->addVariable(std::make_unique<ir::vars::Variable>(
+            static_cast<ir::vars::Variable::Scope>(scope), std::move(termsAndLocations), memoryLocation));
+    }
+
+    context.setVariables(std::move(variables));
+
+    /* Types. */
+    auto types = std::make_unique<ir::types::Types>();
+
+    struct Traits {
+        qint32 size;
+        quint32 flags;
+        quint64 factor;
+        qint32 pointee;
+        std::vector<std::pair<qint64, qint32>> offsets;
+    };
+
+    std::vector<Traits> traits(in.readCount());
+    foreach (auto &set, traits) {
+        set.size = in.read<qint32>();
+        set.flags = in.read<quint32>();
+        set.factor = in.read<quint64>();
+        set.pointee = in.readIndex(traits.size());
+
+        auto count = in.readCount();
+        for (quint32 i = 0; i < count; ++i) {
+            auto offset = in.read<qint64>();
+            auto index = in.readIndex(traits.size());
+            if (index < 0) {
+                in.corrupted();
+            }
+            set.offsets.push_back(std::make_pair(offset, index));
+        }
+    }
+
+    std::vector<ir::types::Type *> sets(traits.size());
+
+    auto termCount = in.readCount();
+    for (quint32 i = 0; i < termCount; ++i) {
+        auto term = numbering.readTerm(in);
+        auto index = in.readIndex(sets.size());
+        if (!term || index < 0) {
+            in.corrupted();
+        }
+
+        auto type = types->getType(term);
+        if (sets[index]) {
+            sets[index]->unionSet(type);
+        } else {
+            sets[index] = type;
+        }
+    }
+
+    foreach (auto &type, sets) {
+        if (!type) {
+            type = types->makeType();
+        }
+    }
+
+    for (std::size_t i = 0; i < sets.size(); ++i) {
+        auto type = sets[i]->findSet();
+
+        type->updateSize(traits[i].size);
+        if (traits[i].flags & INTEGER) {
+            type->makeInteger();
+        }
+        if (traits[i].flags & FLOAT) {
+            type->makeFloat();
+        }
+        if (traits[i].flags & POINTER) {
+            type->makePointer(traits[i].pointee >= 0 ? sets[traits[i].pointee] : nullptr);
+        }
+        if (traits[i].flags & SIGNED) {
+            type->makeSigned();
+        }
+        if (traits[i].flags & UNSIGNED) {
+            type->makeUnsigned();
+        }
+        type->updateFactor(traits[i].factor);
+
+#ifdef NC_STRUCT_RECOVERY
+        foreach (const auto &offset, traits[i].offsets) {
+            type->addOffset(offset.first, sets[offset.second]);
+        }
+#endif
+    }
+
+    types->compressPaths();
+    context.setTypes(std::move(types));
+
+    /* LikeC tree. */
+    auto tree = std::make_unique<likec::Tree>();
+    TreeReader(numbering, *tree).read(in);
+    context.setTree(std::move(tree));
+
+    return true;
+}
+
+} // anonymous namespace
+
+void Session::save(const Context &context, const arch::Instructions &instructions, const QString &filename) {
+    const auto &image = *context.image();
+
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        throw nc::Exception(tr("Could not open file \"%1\" for writing.").arg(filename));
+    }
+
+    QDataStream out(&file);
+    out.setVersion(STREAM_VERSION);
+
+    out << MAGIC << FORMAT_VERSION << QString(version);
+
+    /* Platform. */
+    const auto &platform = image.platform();
+    out << (platform.architecture() ? platform.architecture()->name() : QString());
+    out << static_cast<qint32>(platform.operatingSystem());
+    out << static_cast<qint32>(platform.intSize());
+
+    out << image.entrypoint().is_initialized();
+    out << static_cast<qint64>(image.entrypoint() ? *image.entrypoint() : 0);
+
+    /* Sections. Bss sections are stored without content. */
+    boost::unordered_map<const image::Section *, qint32> section2index;
+
+    out << static_cast<quint32>(image.sections().size());
+    foreach (const image::Section *section, image.sections()) {
+        qint32 index = static_cast<qint32>(section2index.size());
+        section2index[section] = index;
+
+        quint32 flags =
+            (section->isAllocated()  ? ALLOCATED  : 0) |
+            (section->isReadable()   ? READABLE   : 0) |
+            (section->isWritable()   ? WRITABLE   : 0) |
+            (section->isExecutable() ? EXECUTABLE : 0) |
+            (section->isCode()       ? CODE       : 0) |
+            (section->isData()       ? DATA       : 0) |
+            (section->isBss()        ? BSS        : 0);
+
+        QByteArray content;
+        if (!section->isBss()) {
+            content.resize(section->size());
+            content.resize(section->readBytes(section->addr(), content.data(), section->size()));
+        }
+
+        out << section->name() << static_cast<qint64>(section->addr()) << static_cast<qint64>(section->size()) << flags << content;
+    }
+
+    /* Symbols. */
+    boost::unordered_map<const image::Symbol *, qint32> symbol2index;
+
+    out << static_cast<quint32>(image.symbols().size());
+    foreach (const image::Symbol *symbol, image.symbols()) {
+        qint32 index = static_cast<qint32>(symbol2index.size());
+        symbol2index[symbol] = index;
+
+        out << static_cast<qint32>(symbol->type()) << symbol->name();
+        out << symbol->value().is_initialized() << static_cast<quint64>(symbol->value() ? *symbol->value() : 0);
+        out << (symbol->section() ? section2index[symbol->section()] : -1);
+    }
+
+    /* Relocations. */
+    out << static_cast<quint32>(image.relocations().size());
+    foreach (const image::Relocation *relocation, image.relocations()) {
+        out << static_cast<qint64>(relocation->address()) << symbol2index[relocation->symbol()]
+            << static_cast<qint64>(relocation->size()) << static_cast<qint64>(relocation->addend());
+    }
+
+    /* Instructions. */
+    out << static_cast<quint32>(instructions.size());
+    foreach (const auto &instruction, instructions.all()) {
+        out << static_cast<qint64>(instruction->addr()) << static_cast<qint32>(instruction->size());
+    }
+
+    /* Decompilation results. */
+    bool hasResults = context.tree() && context.functions() && context.signatures() && context.variables() && context.types();
+
+    out << hasResults;
+    if (hasResults) {
+        saveResults(out, context, instructions);
+    }
+
+    if (out.status() != QDataStream::Ok) {
+        throw nc::Exception(tr("Could not write file \"%1\".").arg(filename));
+    }
+}
+
+std::shared_ptr<const arch::Instructions> Session::load(Context &context, const QString &filename, bool restoreResults) {
+    auto &image = *context.image();
+    assert(image.sections().empty());
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw nc::Exception(tr("Could not open file \"%1\" for reading.").arg(filename));
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(STREAM_VERSION);
+
+    Reader in(stream, filename);
+
+    auto magic = in.read<quint32>();
+    auto formatVersion = in.read<quint32>();
+    auto savedVersion = in.read<QString>();
+
+    if (magic != MAGIC) {
+        throw nc::Exception(tr("File \"%1\" is not a session file.").arg(filename));
+    }
+    if (formatVersion != FORMAT_VERSION) {
+        throw nc::Exception(tr("Session file \"%1\" has version %2, but only version %3 is supported.")
+            .arg(filename).arg(formatVersion).arg(FORMAT_VERSION));
+    }
+
+    /* Platform. */
+    auto architectureName = in.read<QString>();
+    auto operatingSystem = in.read<qint32>();
+    auto intSize = in.read<qint32>();
+
+    if (!architectureName.isEmpty()) {
+        image.platform().setArchitecture(architectureName);
+        if (!image.platform().architecture()) {
+            throw nc::Exception(tr("Session file \"%1\" refers to unknown architecture %2.").arg(filename).arg(architectureName));
+        }
+    }
+    image.platform().setOperatingSystem(static_cast<image::Platform::OperatingSystem>(operatingSystem));
+    image.platform().setIntSize(intSize);
+
+    auto hasEntrypoint = in.read<bool>();
+    auto entrypoint = in.read<qint64>();
+
+    if (hasEntrypoint) {
+        image.setEntryPoint(entrypoint);
+    }
+
+    /* Sections. */
+    auto sectionCount = in.readCount(MIN_SECTION_SIZE);
+
+    std::vector<const image::Section *> sections;
+    sections.reserve(sectionCount);
+
+    for (quint32 i = 0; i < sectionCount; ++i) {
+        auto name = in.read<QString>();
+        auto addr = in.read<qint64>();
+        auto size = in.read<qint64>();
+        auto flags = in.read<quint32>();
+        auto content = in.read<QByteArray>();
+
+        auto section = std::make_unique<image::Section>(name, addr, size);
+        section->setAllocated(flags & ALLOCATED);
+        section->setReadable(flags & READABLE);
+        section->setWritable(flags & WRITABLE);
+        section->setExecutable(flags & EXECUTABLE);
+        section->setCode(flags & CODE);
+        section->setData(flags & DATA);
+        section->setBss(flags & BSS);
+        section->setContent(std::move(content));
+
+        sections.push_back(section.get());
+        image.addSection(std::move(section));
+    }
+
+    /* Symbols. */
+    auto symbolCount = in.readCount(MIN_SYMBOL_SIZE);
+
+    std::vector<const image::Symbol *> symbols;
+    symbols.reserve(symbolCount);
+
+    for (quint32 i = 0; i < symbolCount; ++i) {
+        auto type = in.read<qint32>();
+        auto name = in.read<QString>();
+        auto hasValue = in.read<bool>();
+        auto value = in.read<quint64>();
+        auto sectionIndex = in.readIndex(sections.size());
+
+        symbols.push_back(image.addSymbol(std::make_unique<image::Symbol>(
+            static_cast<image::SymbolType::Type>(type),
+            name,
+            hasValue ? boost::optional<ConstantValue>(value) : boost::none,
+            sectionIndex >= 0 ? sections[sectionIndex] : nullptr)));
+    }
+
+    /* Relocations. */
+    auto relocationCount = in.readCount(RELOCATION_SIZE);
+
+    for (quint32 i = 0; i < relocationCount; ++i) {
+        auto address = in.read<qint64>();
+        auto symbolIndex = in.readIndex(symbols.size());
+        auto size = in.read<qint64>();
+        auto addend = in.read<qint64>();
+
+        if (symbolIndex < 0) {
+            in.corrupted();
+        }
+
+        image.addRelocation(std::make_unique<image::Relocation>(address, symbols[symbolIndex], size, addend));
+    }
+
+    /* Instructions. */
+    auto instructionCount = in.readCount(INSTRUCTION_SIZE);
+
+    std::vector<std::pair<qint64, qint32>> bounds(instructionCount);
+    foreach (auto &pair, bounds) {
+        pair.first = in.read<qint64>();
+        pair.second = in.read<qint32>();
+    }
+
+    if (!bounds.empty() && !image.platform().architecture()) {
+        throw nc::Exception(tr("Session file \"%1\" has instructions, but no architecture.").arg(filename));
+    }
+
+    /*
+     * Decoding an instruction at a known address is much cheaper than
+     * disassembling the sections, and the chunks can be decoded independently.
+     */
+    std::vector<std::shared_ptr<arch::Instruction>> decoded(bounds.size());
+    std::vector<std::unique_ptr<arch::Disassembler>> disassemblers(context.workerCount());
+
+    parallelFor((bounds.size() + INSTRUCTIONS_PER_CHUNK - 1) / INSTRUCTIONS_PER_CHUNK, context.workerCount(), [&](std::size_t worker, std::size_t chunk) {
+        auto &disassembler = disassemblers[worker];
+        if (!disassembler) {
+            disassembler = image.platform().architecture()->createDisassembler();
+        }
+
+        std::size_t end = std::min(bounds.size(), (chunk + 1) * INSTRUCTIONS_PER_CHUNK);
+        for (std::size_t i = chunk * INSTRUCTIONS_PER_CHUNK; i < end; ++i) {
+            auto instruction = disassembler->disassembleSingleInstruction(bounds[i].first, &image);
+            if (!instruction || instruction->size() != bounds[i].second) {
+                throw nc::Exception(tr("Instruction at address 0x%1 in session file \"%2\" could not be decoded.")
+                    .arg(bounds[i].first, 0, 16).arg(filename));
+            }
+            decoded[i] = std::move(instruction);
+        }
+    });
+
+    auto instructions = std::make_shared<arch::Instructions>();
+    foreach (auto &instruction, decoded) {
+        instructions->add(std::move(instruction));
+    }
+
+    /* Decompilation results. */
+    bool restored = false;
+
+    if (in.read<bool>() && restoreResults) {
+        if (savedVersion != QLatin1String(version)) {
+            context.logToken().warning(tr("Session file \"%1\" was saved by version %2 of the decompiler. "
+                "The decompilation results are not restored.").arg(filename).arg(savedVersion));
+        } else {
+            restored = ::nc::core::restoreResults(in, context, *instructions);
+        }
+    }
+
+    if (!restored) {
+        context.setInstructions(instructions);
+    }
+
+    return instructions;
+}
+
+} // namespace core
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
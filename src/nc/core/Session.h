@@ -0,0 +1,79 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <memory> /* For std::shared_ptr. */
+
+#include <QCoreApplication> /* For Q_DECLARE_TR_FUNCTIONS. */
+#include <QString>
+
+namespace nc {
+namespace core {
+
+class Context;
+
+namespace arch {
+    class Instructions;
+}
+
+/**
+ * Saving and restoring the results of parsing, disassembling, and decompiling in a versioned binary file.
+ *
+ * A session file stores the image (platform, sections with their contents,
+ * symbols, relocations, entry point) and the addresses and sizes of the
+ * disassembled instructions. Restoring a session does not need the original
+ * input files and does not search for instructions: each instruction is
+ * decoded once at its known address, in parallel.
+ *
+ * If the context has been decompiled, the file also stores the decompiled
+ * instructions, the signatures, the variables, the types, and the LikeC tree.
+ * All of them refer to the terms and statements of the intermediate representation,
+ * which is not stored, but regenerated from the decompiled instructions when the
+ * session is restored, and the stored references are resolved against it.
+ * The results are only restored by the same version of the decompiler that saved
+ * them, as another version may generate different code. The analyses that are
+ * not stored (dataflow, liveness, structural analysis) are not restored, and neither
+ * are the statements the calling conventions' hooks insert into the functions:
+ * references to their terms are dropped.
+ */
+class Session {
+    Q_DECLARE_TR_FUNCTIONS(Session)
+
+public:
+    /**
+     * Saves the image, the instructions, and the decompilation results to a file.
+     * The results are saved if the context has a LikeC tree.
+     *
+     * \param context Context with an image.
+     * \param instructions Instructions of the image. Must include the instructions of the context.
+     * \param filename Name of the file to write.
+     *
+     * \throws nc::Exception If the file could not be written.
+     */
+    static void save(const Context &context, const arch::Instructions &instructions, const QString &filename);
+
+    /**
+     * Restores the image, the instructions, and possibly the decompilation results from a file.
+     * If the results are restored, the instructions of the context are the decompiled ones,
+     * and the context has functions, signatures, variables, types, and a LikeC tree.
+     * Otherwise, the instructions of the context are all the restored instructions.
+     *
+     * \param context Context with an image without sections, symbols, and relocations.
+     * \param filename Name of the file to read.
+     * \param restoreResults Whether to restore the decompilation results, if the file has them.
+     *
+     * \return Valid pointer to all the restored instructions.
+     *
+     * \throws nc::Exception If the file could not be read, has a wrong format or version,
+     *                       or does not match the architecture's disassembler.
+     */
+    static std::shared_ptr<const arch::Instructions> load(Context &context, const QString &filename, bool restoreResults);
+};
+
+} // namespace core
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
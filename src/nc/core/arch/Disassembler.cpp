@@ -10,6 +10,7 @@
 #include <nc/core/image/Relocation.h>
 
 #include <nc/common/CancellationToken.h>
+#include <nc/common/ProgressToken.h>
 
 #include "Architecture.h"
 #include "Instruction.h"
@@ -18,7 +19,7 @@ namespace nc {
 namespace core {
 namespace arch {
 
-void Disassembler::disassemble(const image::Image *image, const image::ByteSource *source, ByteAddr begin, ByteAddr end, InstructionCallback callback, const CancellationToken &canceled) {
+void Disassembler::disassemble(const image::Image *image, const image::ByteSource *source, ByteAddr begin, ByteAddr end, InstructionCallback callback, const CancellationToken &canceled, const ProgressToken &progress) {
     assert(source != nullptr);
     assert(begin <= end);
 
@@ -31,6 +32,8 @@ void Disassembler::disassemble(const image::Image *image, const image::ByteSourc
 
     for (ByteAddr pc = begin; pc < end; canceled.poll()) {
         if (pc + maxInstructionSize > bufferEnd && bufferEnd < end) {
+            /* Reporting once per buffer is frequent enough and keeps the loop cheap. */
+            progress.advance(pc - bufferBegin);
             bufferBegin = pc;
             bufferEnd = bufferBegin + source->readBytes(pc, buffer.get(), std::min(bufferSize, end - pc));
         }
@@ -53,6 +56,8 @@ void Disassembler::disassemble(const image::Image *image, const image::ByteSourc
             ++pc;
         }
     }
+
+    progress.advance(end - bufferBegin);
 }
 
 std::shared_ptr<Instruction> Disassembler::disassembleSingleInstruction(ByteAddr pc, const image::ByteSource *source) {
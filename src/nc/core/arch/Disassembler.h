@@ -14,6 +14,7 @@
 namespace nc {
 
 class CancellationToken;
+class ProgressToken;
 
 namespace core {
 
@@ -60,8 +61,9 @@ public:
      * \param end First address past the range.
      * \param callback Function being called for each disassembled instruction.
      * \param canceled Cancellation token.
+     * \param progress Progress token, advanced by the number of processed bytes.
      */
-    virtual void disassemble(const image::Image *image, const image::ByteSource *source, ByteAddr begin, ByteAddr end, InstructionCallback callback, const CancellationToken &canceled);
+    virtual void disassemble(const image::Image *image, const image::ByteSource *source, ByteAddr begin, ByteAddr end, InstructionCallback callback, const CancellationToken &canceled, const ProgressToken &progress);
 
     /**
      * Disassembles a single instruction.
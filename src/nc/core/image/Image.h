@@ -169,6 +169,13 @@ public:
      */
     const Relocation *getRelocation(ByteAddr address) const;
 
+    /**
+     * \return List of relocations.
+     */
+    const std::vector<const Relocation *> &relocations() const {
+        return reinterpret_cast<const std::vector<const Relocation *> &>(relocations_);
+    }
+
     /**
      * \return Valid pointer to a demangler.
      */
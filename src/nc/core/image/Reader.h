@@ -27,7 +27,7 @@
 
 #include <algorithm>
 #include <cassert>
-#include <cstring> /* memset */
+#include <cstring> /* memcpy, memset */
 #include <memory>
 
 #include <boost/optional.hpp>
@@ -48,6 +48,9 @@ class Reader: public ByteSource {
     const ByteSource *externalByteSource_; ///< External byte source.
 
 public:
+    /** Maximal size of an integer value read or decoded by this class, in bytes. Enough for a 512-bit register. */
+    static const ByteSize MAX_INT_SIZE = 64;
+
     /**
      * Constructor.
      *
@@ -89,21 +92,53 @@ public:
         assert(size >= 0);
         assert(byteOrder != ByteOrder::Unknown);
 
-        std::unique_ptr<char[]> buf(new char[std::max<std::size_t>(size, sizeof(T))]);
+        char buf[MAX_INT_SIZE];
+        if (size > MAX_INT_SIZE) {
+            return boost::none;
+        }
 
-        if (readBytes(addr, buf.get(), size) != size) {
+        if (readBytes(addr, buf, size) != size) {
             return boost::none;
         }
 
-        ByteOrder::convert(buf.get(), size, byteOrder, ByteOrder::LittleEndian);
+        return decodeInt<T>(buf, size, byteOrder);
+    }
+
+    /**
+     * Decodes an integer value stored in a buffer.
+     *
+     * \param[in] buf       Valid pointer to the buffer with the integer value.
+     * \param[in] size      Size of the integer value.
+     * \param[in] byteOrder Byte order used for storing the integer value.
+     *
+     * \tparam T Result type.
+     *
+     * \return The integer value.
+     *         If sizeof(T) < size, the lower bytes are returned.
+     *         If sizeof(T) > size, the value is zero-extended.
+     */
+    template<class T>
+    static T decodeInt(const void *buf, ByteSize size, ByteOrder byteOrder) {
+        assert(size >= 0);
+        assert(byteOrder != ByteOrder::Unknown);
+
+        static_assert(sizeof(T) <= MAX_INT_SIZE, "the result type is too large");
+        assert(size <= MAX_INT_SIZE);
+
+        char copy[MAX_INT_SIZE];
+        memcpy(copy, buf, size);
+
+        ByteOrder::convert(copy, size, byteOrder, ByteOrder::LittleEndian);
 
         if (static_cast<std::size_t>(size) < sizeof(T)) {
-            memset(buf.get() + size, 0, sizeof(T) - size);
+            memset(copy + size, 0, sizeof(T) - size);
         }
 
-        ByteOrder::convert(buf.get(), sizeof(T), ByteOrder::LittleEndian, ByteOrder::Current);
+        ByteOrder::convert(copy, sizeof(T), ByteOrder::LittleEndian, ByteOrder::Current);
 
-        return *reinterpret_cast<T *>(buf.get());
+        T result;
+        memcpy(&result, copy, sizeof(T));
+        return result;
     }
 
     /**
@@ -27,6 +27,7 @@
 #include <boost/range/adaptor/map.hpp>
 #include <boost/unordered_set.hpp>
 
+#include <nc/common/DepthFirstSearch.h>
 #include <nc/common/Foreach.h>
 #include <nc/common/Range.h>
 
@@ -46,85 +47,173 @@ namespace ir {
 
 namespace {
 
-void dfs(
-    const CFG &cfg,
-    const BasicBlock *basicBlock,
-    boost::unordered_set<const BasicBlock *> &visited,
-    std::vector<const BasicBlock *> &trace)
-{
-    visited.insert(basicBlock);
-    trace.push_back(basicBlock);
+/**
+ * Visitor collecting the nodes in the order of discovery,
+ * optionally not entering the nodes already belonging to some function.
+ */
+class TraceCollector: public DepthFirstSearch::Visitor {
+    const std::vector<bool> *processed_;
+    std::vector<std::size_t> &trace_;
 
-    foreach (const BasicBlock *successor, cfg.getSuccessors(basicBlock)) {
-        if (visited.find(successor) == visited.end()) {
-            dfs(cfg, successor, visited, trace);
-        }
+public:
+    TraceCollector(const std::vector<bool> *processed, std::vector<std::size_t> &trace):
+        processed_(processed), trace_(trace)
+    {}
+
+    void discover(std::size_t node) { trace_.push_back(node); }
+
+    bool follow(std::size_t, std::size_t, std::size_t successor, DepthFirstSearch::Color) {
+        return !processed_ || !(*processed_)[successor];
     }
-}
+};
 
 } // anonymous namespace
 
 void FunctionsGenerator::makeFunctions(const Program &program, Functions &functions) const {
-    boost::unordered_set<const BasicBlock *> processed;
+    foreach (const auto &functionBlocks, discoverFunctions(program)) {
+        addFunction(program, makeFunction(functionBlocks.basicBlocks, functionBlocks.entry), functions);
+    }
+}
 
-    CFG cfg(program.basicBlocks());
+void FunctionsGenerator::makeFunctions(std::unique_ptr<Program> program, Functions &functions) const {
+    assert(program != nullptr);
 
-    auto addFunction = [&](const std::vector<const BasicBlock *> basicBlocks, const BasicBlock *entry) {
-        auto function = makeFunction(basicBlocks, entry);
-        if (function->isEmpty()) {
-            return;
+    auto functionsBlocks = discoverFunctions(*program);
+
+    /* Find basic blocks belonging to exactly one function. */
+    boost::unordered_map<const BasicBlock *, std::size_t> useCounts;
+    foreach (const auto &functionBlocks, functionsBlocks) {
+        foreach (const BasicBlock *basicBlock, functionBlocks.basicBlocks) {
+            ++useCounts[basicBlock];
+        }
+    }
+
+    boost::unordered_set<const BasicBlock *> movable;
+    foreach (const auto &pair, useCounts) {
+        if (pair.second == 1) {
+            movable.insert(pair.first);
         }
+    }
+    useCounts.clear();
+
+    foreach (const auto &functionBlocks, functionsBlocks) {
+        std::unique_ptr<Function> function(new Function);
+
+        auto basicBlocks = transferIntoFunction(functionBlocks.basicBlocks, function.get(), program.get(), movable);
 
-        /*
-         * If the function's entry starts with some no-ops, move the function's
-         * entry's address to the first meaningful instruction, unless somebody
-         * calls it using current address.
-         */
-        if (function->entry() && function->entry()->address() &&
-            function->entry()->statements().front() &&
-            function->entry()->statements().front()->instruction() &&
-            *function->entry()->address() != function->entry()->statements().front()->instruction()->addr())
-        {
-            assert(*function->entry()->address() < function->entry()->statements().front()->instruction()->addr());
-            if (!program.isCalledAddress(*function->entry()->address())) {
-                function->entry()->setAddress(function->entry()->statements().front()->instruction()->addr());
+        if (functionBlocks.entry) {
+            BasicBlock *entry = nc::find(basicBlocks, functionBlocks.entry);
+            assert(entry != nullptr && "Entry must have been transferred.");
+
+            function->setEntry(entry);
+        }
+
+        addFunction(*program, std::move(function), functions);
+    }
+
+    /* Releases the basic blocks shared between functions. */
+    program.reset();
+}
+
+std::vector<FunctionsGenerator::FunctionBlocks> FunctionsGenerator::discoverFunctions(const Program &program) const {
+    std::vector<FunctionBlocks> result;
+
+    /* Number the basic blocks to keep the DFS state in flat arrays. */
+    std::vector<const BasicBlock *> basicBlocks(program.basicBlocks().begin(), program.basicBlocks().end());
+
+    boost::unordered_map<const BasicBlock *, std::size_t> indices;
+    for (std::size_t i = 0; i < basicBlocks.size(); ++i) {
+        indices[basicBlocks[i]] = i;
+    }
+
+    std::vector<std::vector<std::size_t>> successors(basicBlocks.size());
+    std::vector<bool> hasPredecessors(basicBlocks.size());
+    {
+        CFG cfg(program.basicBlocks());
+
+        for (std::size_t i = 0; i < basicBlocks.size(); ++i) {
+            foreach (const BasicBlock *successor, cfg.getSuccessors(basicBlocks[i])) {
+                successors[i].push_back(nc::find(indices, successor));
             }
+            hasPredecessors[i] = !cfg.getPredecessors(basicBlocks[i]).empty();
         }
+    }
 
-        functions.addFunction(std::move(function));
+    auto getSuccessors = [&](std::size_t node) -> const std::vector<std::size_t> & { return successors[node]; };
+
+    DepthFirstSearch dfs(basicBlocks.size());
+    std::vector<bool> processed(basicBlocks.size());
+    std::vector<std::size_t> trace;
+
+    /*
+     * Collects the basic blocks reachable from the entry. Called functions can share
+     * basic blocks, other functions get only the blocks not processed yet.
+     */
+    auto addFunctionBlocks = [&](std::size_t entry, bool shareBlocks) {
+        trace.clear();
+
+        TraceCollector collector(shareBlocks ? nullptr : &processed, trace);
+        dfs.visit(entry, getSuccessors, collector);
+
+        if (shareBlocks) {
+            dfs.reset();
+        }
+
+        FunctionBlocks functionBlocks;
+        functionBlocks.entry = basicBlocks[entry];
+        foreach (std::size_t node, trace) {
+            functionBlocks.basicBlocks.push_back(basicBlocks[node]);
+            processed[node] = true;
+        }
+        result.push_back(std::move(functionBlocks));
     };
 
     /* Generate all functions being called. */
-    foreach (const BasicBlock *basicBlock, program.basicBlocks()) {
-        if (basicBlock->address() && program.isCalledAddress(*basicBlock->address())) {
-            boost::unordered_set<const BasicBlock *> visited;
-            std::vector<const BasicBlock *> trace;
-
-            dfs(cfg, basicBlock, visited, trace);
-            addFunction(trace, basicBlock);
-            processed.insert(trace.begin(), trace.end());
+    for (std::size_t i = 0; i < basicBlocks.size(); ++i) {
+        if (basicBlocks[i]->address() && program.isCalledAddress(*basicBlocks[i]->address())) {
+            addFunctionBlocks(i, true);
         }
     }
 
     /* Single out all other possible functions. */
-    foreach (const BasicBlock *basicBlock, program.basicBlocks()) {
-        if (basicBlock->address() && cfg.getPredecessors(basicBlock).empty() && !contains(processed, basicBlock)) {
-            std::vector<const BasicBlock *> trace;
-
-            dfs(cfg, basicBlock, processed, trace);
-            addFunction(trace, basicBlock);
+    for (std::size_t i = 0; i < basicBlocks.size(); ++i) {
+        if (basicBlocks[i]->address() && !hasPredecessors[i] && !processed[i]) {
+            addFunctionBlocks(i, false);
         }
     }
 
     /* Single out remaining weird strongly connected components. */
-    foreach (const BasicBlock *basicBlock, program.basicBlocks()) {
-        if (basicBlock->address() && !contains(processed, basicBlock)) {
-            std::vector<const BasicBlock *> trace;
+    for (std::size_t i = 0; i < basicBlocks.size(); ++i) {
+        if (basicBlocks[i]->address() && !processed[i]) {
+            addFunctionBlocks(i, false);
+        }
+    }
+
+    return result;
+}
+
+void FunctionsGenerator::addFunction(const Program &program, std::unique_ptr<Function> function, Functions &functions) const {
+    if (function->isEmpty()) {
+        return;
+    }
 
-            dfs(cfg, basicBlock, processed, trace);
-            addFunction(trace, basicBlock);
+    /*
+     * If the function's entry starts with some no-ops, move the function's
+     * entry's address to the first meaningful instruction, unless somebody
+     * calls it using current address.
+     */
+    if (function->entry() && function->entry()->address() &&
+        function->entry()->statements().front() &&
+        function->entry()->statements().front()->instruction() &&
+        *function->entry()->address() != function->entry()->statements().front()->instruction()->addr())
+    {
+        assert(*function->entry()->address() < function->entry()->statements().front()->instruction()->addr());
+        if (!program.isCalledAddress(*function->entry()->address())) {
+            function->entry()->setAddress(function->entry()->statements().front()->instruction()->addr());
         }
     }
+
+    functions.addFunction(std::move(function));
 }
 
 std::unique_ptr<Function> FunctionsGenerator::makeFunction(const std::vector<const BasicBlock *> &basicBlocks, const BasicBlock *entry) const {
@@ -149,28 +238,42 @@ std::unique_ptr<Function> FunctionsGenerator::makeFunction(const std::vector<con
 
 FunctionsGenerator::BasicBlockMap
 FunctionsGenerator::cloneIntoFunction(const std::vector<const BasicBlock *> &basicBlocks, Function *function) {
-    BasicBlockMap clones;
+    return transferIntoFunction(basicBlocks, function, nullptr, boost::unordered_set<const BasicBlock *>());
+}
+
+FunctionsGenerator::BasicBlockMap
+FunctionsGenerator::transferIntoFunction(const std::vector<const BasicBlock *> &basicBlocks, Function *function,
+    Program *program, const boost::unordered_set<const BasicBlock *> &movable)
+{
+    BasicBlockMap result;
 
     /*
-     * Clone basic blocks.
+     * Move or clone basic blocks.
      */
     foreach (const BasicBlock *basicBlock, basicBlocks) {
-        auto clone = basicBlock->clone();
-        clones[basicBlock] = clone.get();
-        function->addBasicBlock(std::move(clone));
+        std::unique_ptr<BasicBlock> copy;
+
+        if (program && contains(movable, basicBlock)) {
+            copy = program->basicBlocks().erase(basicBlock);
+        } else {
+            copy = basicBlock->clone();
+        }
+
+        result[basicBlock] = copy.get();
+        function->addBasicBlock(std::move(copy));
     }
 
     /*
      * This function replaces all pointers to basic blocks in a jump target
-     * by the pointers to their clones.
+     * by the pointers to their copies.
      */
     auto updateJumpTarget = [&](JumpTarget &target) {
         if (target.basicBlock()) {
-            target.setBasicBlock(nc::find(clones, target.basicBlock()));
+            target.setBasicBlock(nc::find(result, target.basicBlock()));
         }
         if (target.table()) {
             foreach (JumpTableEntry &entry, *target.table()) {
-                entry.setBasicBlock(nc::find(clones, entry.basicBlock()));
+                entry.setBasicBlock(nc::find(result, entry.basicBlock()));
             }
         }
     };
@@ -178,19 +281,19 @@ FunctionsGenerator::cloneIntoFunction(const std::vector<const BasicBlock *> &bas
     /*
      * Update jump targets.
      */
-    foreach (BasicBlock *basicBlock, clones | boost::adaptors::map_values) {
+    foreach (BasicBlock *basicBlock, result | boost::adaptors::map_values) {
         if (ir::Jump *jump = basicBlock->getJump()) {
             updateJumpTarget(jump->thenTarget());
             updateJumpTarget(jump->elseTarget());
 
-            /* Remove jumps to direct successors that were not cloned. */
+            /* Remove jumps to direct successors that were not copied. */
             if (jump->isUnconditional() && !jump->thenTarget()) {
                 basicBlock->statements().pop_back();
             }
         }
     }
 
-    return clones;
+    return result;
 }
 
 } // namespace ir
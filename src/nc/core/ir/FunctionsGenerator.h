@@ -29,6 +29,7 @@
 #include <vector>
 
 #include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
 
 namespace nc {
 namespace core {
@@ -58,6 +59,19 @@ public:
      */
     virtual void makeFunctions(const Program &program, Functions &functions) const;
 
+    /**
+     * Discovers functions in the control flow graph and creates corresponding
+     * Function objects, taking over the basic blocks of the program.
+     *
+     * Basic blocks reachable from a single function are moved into it.
+     * Only basic blocks shared by several functions are cloned.
+     * The program is destroyed afterwards.
+     *
+     * \param[in] program Valid pointer to the intermediate representation of a program.
+     * \param[out] functions Where to add newly created functions.
+     */
+    virtual void makeFunctions(std::unique_ptr<Program> program, Functions &functions) const;
+
     /**
      * Creates a function out of a set of nodes and, optionally, entry basic block.
      *
@@ -83,6 +97,48 @@ public:
      * \return Mapping of basic blocks to their clones.
      */
     static BasicBlockMap cloneIntoFunction(const std::vector<const BasicBlock *> &basicBlocks, Function *function);
+
+private:
+    /**
+     * Basic blocks of a function being discovered.
+     */
+    struct FunctionBlocks {
+        std::vector<const BasicBlock *> basicBlocks; ///< Basic blocks belonging to the function.
+        const BasicBlock *entry; ///< Entry basic block.
+    };
+
+    /**
+     * Discovers functions in the control flow graph.
+     *
+     * \param[in] program Intermediate representation of a program.
+     *
+     * \return Basic blocks of the discovered functions.
+     */
+    std::vector<FunctionBlocks> discoverFunctions(const Program &program) const;
+
+    /**
+     * Adds a function to the list of functions, unless it is empty.
+     *
+     * \param[in] program Intermediate representation of the program the function came from.
+     * \param[in] function Valid pointer to the function.
+     * \param[out] functions Where to add the function.
+     */
+    void addFunction(const Program &program, std::unique_ptr<Function> function, Functions &functions) const;
+
+    /**
+     * Moves or clones basic blocks into a function and patches the jump targets
+     * to point to the basic blocks of this function.
+     *
+     * \param basicBlocks   Vector of valid pointers to basic blocks of the function.
+     * \param function      Function to add basic blocks to.
+     * \param program       Pointer to the program owning the basic blocks. Can be nullptr.
+     * \param movable       Basic blocks that are moved from the program instead of being cloned.
+     *                      Ignored if program is nullptr.
+     *
+     * \return Mapping of the given basic blocks to the basic blocks of the function.
+     */
+    static BasicBlockMap transferIntoFunction(const std::vector<const BasicBlock *> &basicBlocks, Function *function,
+        Program *program, const boost::unordered_set<const BasicBlock *> &movable);
 };
 
 } // namespace ir
@@ -44,6 +44,27 @@ SignatureAnalyzer::SignatureAnalyzer(Signatures &signatures, const dflow::Datafl
 
 SignatureAnalyzer::~SignatureAnalyzer() {}
 
+void SignatureAnalyzer::fixSignature(const CalleeId &calleeId, std::vector<MemoryLocation> arguments,
+                                     const MemoryLocation &returnValue, bool variadic)
+{
+    assert(calleeId);
+
+    id2arguments_[calleeId] = std::move(arguments);
+    id2returnValue_[calleeId] = returnValue;
+    fixedId2variadic_[calleeId] = variadic;
+}
+
+void SignatureAnalyzer::setFallbackSignature(const CalleeId &calleeId, std::vector<MemoryLocation> arguments,
+                                             const MemoryLocation &returnValue, bool variadic)
+{
+    assert(calleeId);
+
+    auto &signature = id2fallbackSignature_[calleeId];
+    signature.arguments = std::move(arguments);
+    signature.returnValue = returnValue;
+    signature.variadic = variadic;
+}
+
 void SignatureAnalyzer::analyze() {
     computeMappings();
     computeUses();
@@ -84,6 +105,19 @@ void SignatureAnalyzer::computeMappings() {
             }
         }
     }
+
+    foreach (auto &idAndSignature, id2fallbackSignature_) {
+        if (!nc::contains(id2referrers_, idAndSignature.first) &&
+            !nc::contains(fixedId2variadic_, idAndSignature.first)) {
+            fixSignature(idAndSignature.first, std::move(idAndSignature.second.arguments),
+                idAndSignature.second.returnValue, idAndSignature.second.variadic);
+        }
+    }
+
+    /* Fixed signatures are stored even if no analyzed function or call refers to them. */
+    foreach (const CalleeId &calleeId, fixedId2variadic_ | boost::adaptors::map_keys) {
+        id2referrers_[calleeId];
+    }
 }
 
 void SignatureAnalyzer::computeUses() {
@@ -140,6 +174,10 @@ bool isHomogeneous(const Container &container) {
 bool SignatureAnalyzer::computeArguments(const CalleeId &calleeId) {
     assert(calleeId);
 
+    if (nc::contains(fixedId2variadic_, calleeId)) {
+        return false;
+    }
+
     auto convention = hooks_.conventions().getConvention(calleeId);
     if (!convention) {
         return false;
@@ -233,6 +271,10 @@ bool SignatureAnalyzer::computeArguments(const CalleeId &calleeId) {
 bool SignatureAnalyzer::computeReturnValue(const CalleeId &calleeId) {
     assert(calleeId);
 
+    if (nc::contains(fixedId2variadic_, calleeId)) {
+        return false;
+    }
+
     auto convention = hooks_.conventions().getConvention(calleeId);
     if (!convention) {
         return false;
@@ -550,6 +592,10 @@ void SignatureAnalyzer::computeSignatures(const CalleeId &calleeId) {
         functionSignature->setReturnValue(std::make_shared<MemoryLocationAccess>(returnValueLocation));
     }
 
+    if (nc::find(fixedId2variadic_, calleeId)) {
+        functionSignature->setVariadic();
+    }
+
     if (calleeId.entryAddress()) {
         signatures_.setSignature(*calleeId.entryAddress(), functionSignature);
     }
@@ -88,6 +88,18 @@ class SignatureAnalyzer {
     /** Mapping from a callee id to the estimated return value location. */
     boost::unordered_map<CalleeId, MemoryLocation> id2returnValue_;
 
+    /** Mapping from a callee id with a fixed signature to whether the signature is variadic. */
+    boost::unordered_map<CalleeId, bool> fixedId2variadic_;
+
+    struct FallbackSignature {
+        std::vector<MemoryLocation> arguments;
+        MemoryLocation returnValue;
+        bool variadic;
+    };
+
+    /** Mapping from a callee id to the signature it gets if nothing refers to it. */
+    boost::unordered_map<CalleeId, FallbackSignature> id2fallbackSignature_;
+
 public:
     /**
      * Constructor.
@@ -107,6 +119,30 @@ public:
      */
     ~SignatureAnalyzer();
 
+    /**
+     * Fixes the signature of a callee, so that it is not recomputed
+     * from the functions and calls with this id. Must be called before analyze().
+     *
+     * \param calleeId Valid callee id.
+     * \param arguments Locations of the formal arguments, in the order of the convention.
+     * \param returnValue Location of the return value, or an invalid location if there is none.
+     * \param variadic Whether the callee is variadic.
+     */
+    void fixSignature(const CalleeId &calleeId, std::vector<MemoryLocation> arguments,
+                      const MemoryLocation &returnValue, bool variadic);
+
+    /**
+     * Sets the signature of a callee that is fixed if no analyzed function
+     * or call has this id. Must be called before analyze().
+     *
+     * \param calleeId Valid callee id.
+     * \param arguments Locations of the formal arguments, in the order of the convention.
+     * \param returnValue Location of the return value, or an invalid location if there is none.
+     * \param variadic Whether the callee is variadic.
+     */
+    void setFallbackSignature(const CalleeId &calleeId, std::vector<MemoryLocation> arguments,
+                              const MemoryLocation &returnValue, bool variadic);
+
     void analyze();
 
 private:
@@ -52,6 +52,13 @@ public:
         addr2signature_[addr] = std::move(signature);
     }
 
+    /**
+     * \return Mapping from addresses of functions to their signatures.
+     */
+    const boost::unordered_map<ByteAddr, std::shared_ptr<FunctionSignature>> &addr2signature() const {
+        return addr2signature_;
+    }
+
     /**
      * \param function Valid pointer to a function.
      *
@@ -24,8 +24,8 @@
 
 #include "Dfs.h"
 
+#include <nc/common/DepthFirstSearch.h>
 #include <nc/common/Foreach.h>
-#include <nc/common/Range.h>
 #include <nc/common/Unreachable.h>
 
 #include "Edge.h"
@@ -36,47 +36,130 @@ namespace core {
 namespace ir {
 namespace cflow {
 
+namespace {
+
+/**
+ * Visitor recording the DFS orderings and the edge types.
+ */
+class Classifier: public DepthFirstSearch::Visitor {
+    const std::vector<Node *> &nodes_;
+    const std::vector<std::size_t> &edgeOffsets_;
+    std::vector<Dfs::EdgeType> &edgeTypes_;
+    std::vector<Node *> &preordering_;
+    std::vector<Node *> &postordering_;
+
+public:
+    Classifier(const std::vector<Node *> &nodes, const std::vector<std::size_t> &edgeOffsets,
+        std::vector<Dfs::EdgeType> &edgeTypes, std::vector<Node *> &preordering, std::vector<Node *> &postordering):
+        nodes_(nodes), edgeOffsets_(edgeOffsets), edgeTypes_(edgeTypes),
+        preordering_(preordering), postordering_(postordering)
+    {}
+
+    void discover(std::size_t node) { preordering_.push_back(nodes_[node]); }
+
+    bool follow(std::size_t node, std::size_t index, std::size_t, DepthFirstSearch::Color color) {
+        Dfs::EdgeType type;
+
+        switch (color) {
+        case DepthFirstSearch::WHITE:
+            type = Dfs::FORWARD;
+            break;
+        case DepthFirstSearch::GRAY:
+            type = Dfs::BACK;
+            break;
+        case DepthFirstSearch::BLACK:
+            type = Dfs::CROSS;
+            break;
+        default:
+            unreachable();
+        }
+
+        edgeTypes_[edgeOffsets_[node] + index] = type;
+        return true;
+    }
+
+    void finish(std::size_t node) { postordering_.push_back(nodes_[node]); }
+};
+
+} // anonymous namespace
+
 Dfs::Dfs(const cflow::Region *region) {
     assert(region != nullptr);
 
-    preordering_.reserve(region->nodes().size());
-    postordering_.reserve(region->nodes().size());
+    nodes_ = region->nodes();
 
-    visit(region->entry());
+    node2index_.reserve(nodes_.size());
+    for (std::size_t i = 0; i < nodes_.size(); ++i) {
+        node2index_[nodes_[i]] = i;
+    }
 
-    foreach (cflow::Node *node, region->nodes()) {
-        if (find(node2color_, node) == WHITE) {
-            visit(node);
+    successors_.resize(nodes_.size());
+    predecessors_.resize(nodes_.size());
+    edgeOffsets_.reserve(nodes_.size());
+
+    for (std::size_t i = 0; i < nodes_.size(); ++i) {
+        edgeOffsets_.push_back(edges_.size());
+
+        foreach (const cflow::Edge *edge, nodes_[i]->outEdges()) {
+            std::size_t head = getIndex(edge->head());
+            successors_[i].push_back(head);
+            edges_.push_back(edge);
+        }
+        foreach (const cflow::Edge *edge, nodes_[i]->inEdges()) {
+            predecessors_[i].push_back(getIndex(edge->tail()));
+        }
+    }
+
+    edgeTypes_.resize(edges_.size(), UNKNOWN);
+
+    preordering_.reserve(nodes_.size());
+    postordering_.reserve(nodes_.size());
+
+    auto getSuccessors = [this](std::size_t index) -> const std::vector<std::size_t> & { return successors_[index]; };
+
+    DepthFirstSearch dfs(nodes_.size());
+    Classifier classifier(nodes_, edgeOffsets_, edgeTypes_, preordering_, postordering_);
+
+    dfs.visit(getIndex(region->entry()), getSuccessors, classifier);
+
+    for (std::size_t i = 0; i < nodes_.size(); ++i) {
+        if (dfs.color(i) == DepthFirstSearch::WHITE) {
+            dfs.visit(i, getSuccessors, classifier);
         }
     }
 }
 
-void Dfs::visit(cflow::Node *node) {
-    assert(node != nullptr);
-    assert(find(node2color_, node) == WHITE);
+Dfs::EdgeType Dfs::getEdgeType(const Edge *edge) const {
+    assert(edge != nullptr);
 
-    node2color_[node] = GRAY;
-    preordering_.push_back(node);
+    if (!edge->tail()) {
+        return UNKNOWN;
+    }
 
-    foreach (cflow::Edge *edge, node->outEdges()) {
-        switch (find(node2color_, edge->head())) {
-        case WHITE:
-            edge2type_[edge] = FORWARD;
-            visit(edge->head());
-            break;
-        case GRAY:
-            edge2type_[edge] = BACK;
-            break;
-        case BLACK:
-            edge2type_[edge] = CROSS;
-            break;
-        default:
-            unreachable();
+    auto i = node2index_.find(edge->tail());
+    if (i == node2index_.end()) {
+        return UNKNOWN;
+    }
+
+    std::size_t begin = edgeOffsets_[i->second];
+    std::size_t end = i->second + 1 < edgeOffsets_.size() ? edgeOffsets_[i->second + 1] : edges_.size();
+
+    for (std::size_t position = begin; position != end; ++position) {
+        if (edges_[position] == edge) {
+            return edgeTypes_[position];
         }
     }
 
-    node2color_[node] = BLACK;
-    postordering_.push_back(node);
+    return UNKNOWN;
+}
+
+std::size_t Dfs::getIndex(const Node *node) const {
+    assert(node != nullptr);
+
+    auto i = node2index_.find(node);
+    assert(i != node2index_.end() && "Node must belong to the region.");
+
+    return i->second;
 }
 
 } // namespace cflow
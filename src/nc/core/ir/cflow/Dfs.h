@@ -28,9 +28,6 @@
 #include <vector>
 
 #include <boost/unordered_map.hpp>
-#include <boost/unordered_set.hpp>
-
-#include <nc/common/Range.h>
 
 namespace nc {
 namespace core {
@@ -44,6 +41,10 @@ class Region;
 /**
  * This class performs a depth-first search in a given region, sorts its
  * nodes topologically, detects back edges.
+ *
+ * The nodes of the region are numbered, so that the search itself works
+ * on flat arrays and does not recurse. The numbering and the adjacency
+ * lists are also available to other traversals of the same region.
  */
 class Dfs {
 public:
@@ -63,18 +64,33 @@ public:
     };
 
 private:
+    /** Nodes of the region. A node's index in this vector is its number. */
+    std::vector<Node *> nodes_;
+
+    /** Mapping from a node of the region to its number. */
+    boost::unordered_map<const Node *, std::size_t> node2index_;
+
+    /** Numbers of the successors of each node. */
+    std::vector<std::vector<std::size_t>> successors_;
+
+    /** Numbers of the predecessors of each node. */
+    std::vector<std::vector<std::size_t>> predecessors_;
+
+    /** Position of the first outgoing edge of each node in edges_ and edgeTypes_. */
+    std::vector<std::size_t> edgeOffsets_;
+
+    /** Outgoing edges of all the nodes, grouped by the tail. */
+    std::vector<const Edge *> edges_;
+
+    /** Types of the edges in edges_. */
+    std::vector<EdgeType> edgeTypes_;
+
     /** List of region nodes in the order of discovery. */
     std::vector<Node *> preordering_;
 
     /** List of region nodes in the order of leaving. */
     std::vector<Node *> postordering_;
 
-    /** Mapping from a node to its color. */
-    boost::unordered_map<const Node *, NodeColor> node2color_;
-
-    /** Mapping from an edge to its type. */
-    boost::unordered_map<const Edge *, EdgeType> edge2type_;
-
 public:
 
     /**
@@ -109,16 +125,33 @@ public:
      *
      * \return Edge's type.
      */
-    EdgeType getEdgeType(const Edge *edge) const { return nc::find(edge2type_, edge, UNKNOWN); }
+    EdgeType getEdgeType(const Edge *edge) const;
 
-private:
+    /**
+     * \return Nodes of the region, indexed by their numbers.
+     */
+    const std::vector<Node *> &nodes() const { return nodes_; }
+
+    /**
+     * \param node Valid pointer to a node of the region.
+     *
+     * \return Number of the node.
+     */
+    std::size_t getIndex(const Node *node) const;
+
+    /**
+     * \param index Number of a node.
+     *
+     * \return Numbers of the successors of the node, in the order of the outgoing edges.
+     */
+    const std::vector<std::size_t> &getSuccessors(std::size_t index) const { return successors_[index]; }
 
     /**
-     * Visits given node and all its unvisited successors.
+     * \param index Number of a node.
      *
-     * \param node Valid pointer to a not yet visited node.
+     * \return Numbers of the predecessors of the node, in the order of the incoming edges.
      */
-    void visit(Node *node);
+    const std::vector<std::size_t> &getPredecessors(std::size_t index) const { return predecessors_[index]; }
 };
 
 } // namespace cflow
@@ -24,6 +24,9 @@
 
 #include "LoopExplorer.h"
 
+#include <memory>
+
+#include <nc/common/DepthFirstSearch.h>
 #include <nc/common/Foreach.h>
 
 #include "Dfs.h"
@@ -35,61 +38,82 @@ namespace core {
 namespace ir {
 namespace cflow {
 
-LoopExplorer::LoopExplorer(Node *entry, const Dfs &dfs):
-    entry_(entry)
-{
+namespace {
+
+/**
+ * Visitor walking the edges backwards from the back-edge predecessors
+ * of a potential loop entry, without walking past the entry.
+ */
+class BackwardVisitor: public DepthFirstSearch::Visitor {
+    std::size_t entry_;
+
+public:
+    BackwardVisitor(std::size_t entry): entry_(entry) {}
+
+    bool follow(std::size_t node, std::size_t, std::size_t, DepthFirstSearch::Color) {
+        return node != entry_;
+    }
+};
+
+/**
+ * Visitor walking from a loop entry to the nodes found by BackwardVisitor.
+ */
+class ForwardVisitor: public DepthFirstSearch::Visitor {
+    const DepthFirstSearch &backward_;
+    const std::vector<Node *> &nodes_;
+    std::vector<Node *> &loopNodes_;
+
+public:
+    ForwardVisitor(const DepthFirstSearch &backward, const std::vector<Node *> &nodes, std::vector<Node *> &loopNodes):
+        backward_(backward), nodes_(nodes), loopNodes_(loopNodes)
+    {}
+
+    void discover(std::size_t node) { loopNodes_.push_back(nodes_[node]); }
+
+    bool follow(std::size_t, std::size_t, std::size_t successor, DepthFirstSearch::Color) {
+        return backward_.color(successor) != DepthFirstSearch::WHITE;
+    }
+};
+
+} // anonymous namespace
+
+LoopExplorer::LoopExplorer(Node *entry, const Dfs &dfs) {
     assert(entry != nullptr);
 
+    std::unique_ptr<DepthFirstSearch> backward;
+    std::size_t entryIndex = dfs.getIndex(entry);
+
+    auto getPredecessors = [&dfs](std::size_t index) -> const std::vector<std::size_t> & { return dfs.getPredecessors(index); };
+    auto getSuccessors = [&dfs](std::size_t index) -> const std::vector<std::size_t> & { return dfs.getSuccessors(index); };
+
     /*
      * Find all nodes that can be reached from the back-edge
-     * predecessors by reversed edges and paint them gray.
+     * predecessors by reversed edges.
      */
-    foreach (Edge *edge, entry_->inEdges()) {
+    BackwardVisitor backwardVisitor(entryIndex);
+
+    foreach (Edge *edge, entry->inEdges()) {
         if (dfs.getEdgeType(edge) == Dfs::BACK) {
-            if (find(node2color_, edge->tail()) == WHITE) {
-                backwardVisit(edge->tail());
+            if (!backward) {
+                backward.reset(new DepthFirstSearch(dfs.nodes().size()));
+            }
+
+            std::size_t tail = dfs.getIndex(edge->tail());
+            if (backward->color(tail) == DepthFirstSearch::WHITE) {
+                backward->visit(tail, getPredecessors, backwardVisitor);
             }
         }
     }
 
     /*
-     * Find all gray nodes that can be visited from the suspected
-     * loop entry and paint them black. All the black nodes belong
-     * to the loop.
+     * Find all the nodes found above that can be visited from
+     * the suspected loop entry. They belong to the loop.
      */
-    if (find(node2color_, entry_) == GRAY) {
-        forwardVisit(entry_);
-    }
-}
-
-void LoopExplorer::backwardVisit(Node *node) {
-    assert(node != nullptr);
-    assert(find(node2color_, node) == WHITE);
-
-    node2color_[node] = GRAY;
-
-    if (node == entry_) {
-        return;
-    }
+    if (backward && backward->color(entryIndex) != DepthFirstSearch::WHITE) {
+        DepthFirstSearch forward(dfs.nodes().size());
+        ForwardVisitor forwardVisitor(*backward, dfs.nodes(), loopNodes_);
 
-    foreach (Edge *edge, node->inEdges()) {
-        if (find(node2color_, edge->tail()) == WHITE) {
-            backwardVisit(edge->tail());
-        }
-    }
-}
-
-void LoopExplorer::forwardVisit(Node *node) {
-    assert(node != nullptr);
-    assert(find(node2color_, node) == GRAY);
-
-    node2color_[node] = BLACK;
-    loopNodes_.push_back(node);
-
-    foreach (Edge *edge, node->outEdges()) {
-        if (find(node2color_, edge->head()) == GRAY) {
-            forwardVisit(edge->head());
-        }
+        forward.visit(entryIndex, getSuccessors, forwardVisitor);
     }
 }
 
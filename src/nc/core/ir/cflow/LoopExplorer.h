@@ -27,8 +27,6 @@
 
 #include <vector>
 
-#include <boost/unordered_map.hpp>
-
 namespace nc {
 namespace core {
 namespace ir {
@@ -43,19 +41,6 @@ class Node;
  * are expected to belong to the loop with the given node being its entry.
  */
 class LoopExplorer {
-    /** Node color. */
-    enum NodeColor {
-        WHITE,
-        GRAY,
-        BLACK
-    };
-
-    /** Entry node of a potential loop. */
-    Node *entry_;
-
-    /** Mapping from a node to its color. */
-    boost::unordered_map<Node *, NodeColor> node2color_;
-
     /* Nodes on cyclic paths from the entry to the entry. */
     std::vector<Node *> loopNodes_;
 
@@ -77,24 +62,6 @@ public:
      * \return Nodes on cyclic paths from the entry to the entry.
      */
     const std::vector<Node *> &loopNodes() const { return loopNodes_; }
-
-private:
-    /**
-     * Visits given node and, if the node is not entry, recursively
-     * visits all its WHITE predecessors. All the visited nodes are
-     * painted GRAY.
-     *
-     * \param node Valid pointer to a WHITE node.
-     */
-    void backwardVisit(Node *node);
-
-    /**
-     * Visits given node and recursively visits all its GRAY successors.
-     * All the visited nodes are painted BLACK.
-     *
-     * \param node Valid pointer to a GRAY node.
-     */
-    void forwardVisit(Node *node);
 };
 
 } // namespace cflow
@@ -24,8 +24,14 @@
 
 #include "CodeGenerator.h"
 
+#include <algorithm>
+
+#include <QMutexLocker>
+#include <QThread>
+
 #include <nc/common/CancellationToken.h>
 #include <nc/common/Foreach.h>
+#include <nc/common/Parallel.h>
 #include <nc/common/Range.h>
 #include <nc/common/make_unique.h>
 
@@ -33,6 +39,7 @@
 #include <nc/core/image/Image.h>
 #include <nc/core/image/Reader.h>
 #include <nc/core/image/Relocation.h>
+#include <nc/core/ir/BasicBlock.h>
 #include <nc/core/ir/Function.h>
 #include <nc/core/ir/Functions.h>
 #include <nc/core/ir/calling/Hooks.h>
@@ -40,8 +47,11 @@
 #include <nc/core/ir/types/Type.h>
 #include <nc/core/ir/types/Types.h>
 #include <nc/core/ir/vars/Variable.h>
+#include <nc/core/ir/vars/Variables.h>
 #include <nc/core/likec/FunctionDefinition.h>
+#include <nc/core/likec/FunctionIdentifier.h>
 #include <nc/core/likec/IntegerConstant.h>
+#include <nc/core/likec/Simplifier.h>
 #include <nc/core/likec/StructType.h>
 #include <nc/core/likec/StructTypeDeclaration.h>
 #include <nc/core/likec/Tree.h>
@@ -56,16 +66,201 @@ namespace ir {
 namespace cgen {
 
 void CodeGenerator::makeCompilationUnit() {
+    makeEmptyCompilationUnit();
+
+    std::vector<const Function *> functions(functions_.list().begin(), functions_.list().end());
+
+    /*
+     * Always take the same path, even with a single worker: the output
+     * must not depend on the number of cores the decompiler runs on.
+     */
+    makeFunctionDefinitionsInParallel(functions);
+
+    tree().rewriteRoot();
+}
+
+void CodeGenerator::makeFunctionDefinitionsInParallel(const std::vector<const Function *> &functions) {
+    /* Make concurrent reading of types safe. */
+    types().compressPaths();
+
+    std::vector<std::unique_ptr<likec::FunctionDefinition>> definitions(functions.size());
+    std::vector<std::vector<const likec::Declaration *>> uses(functions.size());
+
+    parallel_ = true;
+
+    parallelFor(functions.size(), workerCount_, [&](std::size_t, std::size_t index) {
+        CreationState state;
+        state.uses = &uses[index];
+
+        {
+            QWriteLocker locker(&threadStatesLock_);
+            threadStates_[QThread::currentThread()] = &state;
+        }
+
+        definitions[index] = DefinitionGenerator(*this, functions[index], cancellationToken()).createDefinition();
+
+        {
+            QWriteLocker locker(&threadStatesLock_);
+            threadStates_.erase(QThread::currentThread());
+        }
+
+        cancellationToken().poll();
+    });
+
+    parallel_ = false;
+
+    /*
+     * Definitions were not registered, so that the use of prototypes does not depend on timing.
+     * Instead, a definition replaces the prototypes that would follow it in the compilation unit,
+     * like a registered definition replaces them when the definitions are generated one by one.
+     */
+    boost::unordered_map<const likec::Declaration *, const calling::FunctionSignature *> prototype2signature;
+    foreach (const auto &signatureAndDeclaration, signature2declaration_) {
+        prototype2signature[signatureAndDeclaration.second] = signatureAndDeclaration.first;
+    }
+
+    boost::unordered_map<const calling::FunctionSignature *, likec::FunctionDefinition *> signature2definition;
+    boost::unordered_map<const likec::FunctionDeclaration *, likec::FunctionDefinition *> replacements;
+    std::vector<std::unique_ptr<likec::Declaration>> replacedPrototypes;
+
+    std::function<void(likec::TreeNode *)> rebind = [&](likec::TreeNode *node) {
+        if (auto expression = node->as<likec::Expression>()) {
+            if (auto identifier = expression->as<likec::FunctionIdentifier>()) {
+                if (auto definition = nc::find(replacements, identifier->declaration())) {
+                    identifier->setDeclaration(definition);
+                }
+            }
+        }
+        node->callOnChildren(rebind);
+    };
+
+    std::size_t structCount = 0;
+
+    for (std::size_t i = 0; i < functions.size(); ++i) {
+        auto signature = signatures().getSignature(functions[i]).get();
+
+        /* Recursive calls refer to the definition itself. */
+        if (signature) {
+            signature2definition.insert(std::make_pair(signature, definitions[i].get()));
+        }
+
+        foreach (auto declaration, uses[i]) {
+            if (auto definition = nc::find(signature2definition, nc::find(prototype2signature, declaration))) {
+                auto j = pendingDeclarations_.find(declaration);
+                if (j != pendingDeclarations_.end()) {
+                    replacements[j->second->as<likec::FunctionDeclaration>()] = definition;
+                    replacedPrototypes.push_back(std::move(j->second));
+                    pendingDeclarations_.erase(j);
+                }
+            } else {
+                addPendingDeclaration(declaration, structCount);
+            }
+        }
+
+        if (!replacements.empty()) {
+            rebind(definitions[i].get());
+        }
+
+        if (signature) {
+            auto &declaration = signature2declaration_[signature];
+            if (declaration && !nc::contains(replacements, declaration) && !nc::contains(pendingDeclarations_, declaration)) {
+                definitions[i]->setFirstDeclaration(declaration);
+            } else {
+                declaration = definitions[i].get();
+            }
+        }
+
+        tree().root()->addDeclaration(std::move(definitions[i]));
+    }
+
+    assert(pendingDeclarations_.empty());
+    dependencies_.clear();
+}
+
+void CodeGenerator::makeEmptyCompilationUnit() {
     tree().setPointerSize(image().platform().architecture()->bitness());
     tree().setIntSize(image().platform().intSize());
     tree().setRoot(std::make_unique<likec::CompilationUnit>());
 
-    foreach (const Function *function, functions().list()) {
-        makeFunctionDefinition(function);
-        cancellationToken().poll();
+    streamedDeclarationsCount_ = 0;
+}
+
+void CodeGenerator::makeStreamedFunctionDefinition(const Function *function, const std::function<void(const likec::Declaration *)> &callback,
+                                                   Dependencies *dependencies)
+{
+    if (dependencies) {
+        dependencies->functions.clear();
+        dependencies->variables.clear();
     }
 
-    tree().rewriteRoot();
+    streamedDependencies_ = dependencies;
+    auto definition = makeFunctionDefinition(function);
+    streamedDependencies_ = nullptr;
+
+    if (dependencies) {
+        auto &functions = dependencies->functions;
+        auto &variables = dependencies->variables;
+
+        /* Recursive calls refer to the definition itself. */
+        if (function->entry() && function->entry()->address()) {
+            functions.erase(std::remove(functions.begin(), functions.end(), *function->entry()->address()), functions.end());
+        }
+
+        std::sort(functions.begin(), functions.end());
+        functions.erase(std::unique(functions.begin(), functions.end()), functions.end());
+        std::sort(variables.begin(), variables.end());
+        variables.erase(std::unique(variables.begin(), variables.end()), variables.end());
+    }
+
+    auto &declarations = tree().root()->declarations();
+    assert(declarations.back().get() == definition);
+
+    likec::Simplifier simplifier(tree());
+    for (std::size_t i = streamedDeclarationsCount_; i < declarations.size(); ++i) {
+        declarations[i] = simplifier.simplify(std::move(declarations[i]));
+        callback(declarations[i].get());
+    }
+
+    /* Calls to the function after this point must use a separate declaration. */
+    for (auto i = signature2declaration_.begin(); i != signature2declaration_.end();) {
+        if (i->second == definition) {
+            i = signature2declaration_.erase(i);
+        } else {
+            ++i;
+        }
+    }
+
+    declarations.pop_back();
+    streamedDeclarationsCount_ = declarations.size();
+}
+
+void CodeGenerator::makeStreamedDeclarations(const Dependencies &dependencies, const std::function<void(const likec::Declaration *)> &callback) {
+    foreach (ByteAddr addr, dependencies.functions) {
+        makeFunctionDeclaration(addr);
+    }
+
+    if (!dependencies.variables.empty() && globalVariables_.empty()) {
+        foreach (const vars::Variable *variable, variables().list()) {
+            if (variable->isGlobal()) {
+                globalVariables_[variable->memoryLocation()] = variable;
+            }
+        }
+    }
+    foreach (const MemoryLocation &memoryLocation, dependencies.variables) {
+        if (auto variable = nc::find(globalVariables_, memoryLocation)) {
+            makeGlobalVariableDeclaration(variable);
+        }
+    }
+
+    auto &declarations = tree().root()->declarations();
+
+    likec::Simplifier simplifier(tree());
+    for (std::size_t i = streamedDeclarationsCount_; i < declarations.size(); ++i) {
+        declarations[i] = simplifier.simplify(std::move(declarations[i]));
+        callback(declarations[i].get());
+    }
+
+    streamedDeclarationsCount_ = declarations.size();
 }
 
 const likec::Type *CodeGenerator::makeType(const types::Type *typeTraits) {
@@ -74,7 +269,9 @@ const likec::Type *CodeGenerator::makeType(const types::Type *typeTraits) {
     if (!typeTraits) {
         return tree().makeVoidType();
     } else if (typeTraits->isPointer()) {
-        if (std::find(typeCreationStack_.begin(), typeCreationStack_.end(), typeTraits) != typeCreationStack_.end()) {
+        auto &typeCreationStack = creationState().typeCreationStack;
+
+        if (std::find(typeCreationStack.begin(), typeCreationStack.end(), typeTraits) != typeCreationStack.end()) {
             /* Circular dependency. */
             return tree().makePointerType(typeTraits->size(), tree().makeVoidType());
 #ifdef NC_STRUCT_RECOVERY
@@ -82,9 +279,9 @@ const likec::Type *CodeGenerator::makeType(const types::Type *typeTraits) {
             return tree().makePointerType(typeTraits->size(), structuralType);
 #endif
         } else {
-            typeCreationStack_.push_back(typeTraits);
+            typeCreationStack.push_back(typeTraits);
             const likec::Type *pointee = makeType(typeTraits->pointee());
-            typeCreationStack_.pop_back();
+            typeCreationStack.pop_back();
 
             return tree().makePointerType(typeTraits->size(), pointee);
         }
@@ -107,8 +304,11 @@ const likec::StructType *CodeGenerator::makeStructuralType(const types::Type *ty
         return nullptr;
     }
 
+    QMutexLocker locker(&structsMutex_);
+
     auto i = traits2structType_.find(typeTraits);
     if (i != traits2structType_.end()) {
+        useDeclaration(i->second->typeDeclaration());
         return i->second;
     }
 
@@ -130,11 +330,18 @@ const likec::StructType *CodeGenerator::makeStructuralType(const types::Type *ty
         return nullptr;
     }
 
+    startDeclaration();
+
+    /* Names of structs generated in parallel are assigned when they are added to the compilation unit. */
     auto typeDeclaration = std::make_unique<likec::StructTypeDeclaration>(QString("s%1").arg(traits2structType_.size()));
 
     likec::StructType *type = typeDeclaration->type();
     traits2structType_[typeTraits] = type;
 
+    /* Members do not depend on where the struct is first used. */
+    std::vector<const ir::types::Type *> typeCreationStack;
+    typeCreationStack.swap(creationState().typeCreationStack);
+
     foreach (auto offset, typeTraits->offsets()) {
         ByteSize offsetValue = offset.first;
         const types::Type *offsetType = offset.second->findSet();
@@ -154,7 +361,9 @@ const likec::StructType *CodeGenerator::makeStructuralType(const types::Type *ty
         }
     }
 
-    tree().root()->addDeclaration(std::move(typeDeclaration));
+    creationState().typeCreationStack.swap(typeCreationStack);
+
+    finishDeclaration(std::move(typeDeclaration));
 
     return type;
 }
@@ -176,25 +385,51 @@ likec::VariableDeclaration *CodeGenerator::makeGlobalVariableDeclaration(const v
     assert(variable != nullptr);
     assert(variable->isGlobal());
 
-    if (auto result = nc::find(variableDeclarations_, variable)) {
-        return result;
-    } else {
-        auto type = makeVariableType(variable);
-        auto initialValue = makeInitialValue(variable->memoryLocation(), type);
-        auto nameAndComment = nameGenerator().getGlobalVariableName(variable->memoryLocation());
+    /* Dependencies are recorded only when definitions are generated one by one. */
+    if (streamedDependencies_) {
+        streamedDependencies_->variables.push_back(variable->memoryLocation());
+    }
 
-        auto declaration = std::make_unique<likec::VariableDeclaration>(
-            std::move(nameAndComment.name()),
-            type,
-            std::move(initialValue));
-        declaration->setComment(std::move(nameAndComment.comment()));
+    {
+        QMutexLocker locker(&mutex_);
 
-        result = declaration.get();
-        tree().root()->addDeclaration(std::move(declaration));
-        variableDeclarations_[variable] = result;
+        /* Another thread creating the declaration finishes it without waiting for anything. */
+        while (nc::contains(variablesInCreation_, variable)) {
+            declarationCreated_.wait(&mutex_);
+        }
+
+        if (auto result = nc::find(variableDeclarations_, variable)) {
+            locker.unlock();
+            useDeclaration(result);
+            return result;
+        }
+
+        variablesInCreation_.insert(variable);
+    }
+
+    startDeclaration();
+
+    auto type = makeVariableType(variable);
+    auto initialValue = makeInitialValue(variable->memoryLocation(), type);
+    auto nameAndComment = nameGenerator().getGlobalVariableName(variable->memoryLocation());
+
+    auto declaration = std::make_unique<likec::VariableDeclaration>(
+        std::move(nameAndComment.name()),
+        type,
+        std::move(initialValue));
+    declaration->setComment(std::move(nameAndComment.comment()));
 
-        return result;
+    auto result = declaration.get();
+    finishDeclaration(std::move(declaration));
+
+    {
+        QMutexLocker locker(&mutex_);
+        variableDeclarations_[variable] = result;
+        variablesInCreation_.erase(variable);
     }
+    declarationCreated_.wakeAll();
+
+    return result;
 }
 
 std::unique_ptr<likec::Expression> CodeGenerator::makeInitialValue(const MemoryLocation &memoryLocation, const likec::Type *type) {
@@ -231,12 +466,39 @@ likec::FunctionDeclaration *CodeGenerator::makeFunctionDeclaration(ByteAddr addr
         return nullptr;
     }
 
-    if (auto declaration = nc::find(signature2declaration_, signature)) {
-        return declaration;
+    /* Dependencies are recorded only when definitions are generated one by one. */
+    if (streamedDependencies_) {
+        streamedDependencies_->functions.push_back(addr);
+    }
+
+    {
+        QMutexLocker locker(&mutex_);
+
+        /* Another thread creating the declaration finishes it without waiting for anything. */
+        while (nc::contains(signaturesInCreation_, signature)) {
+            declarationCreated_.wait(&mutex_);
+        }
+
+        if (auto declaration = nc::find(signature2declaration_, signature)) {
+            locker.unlock();
+            useDeclaration(declaration);
+            return declaration;
+        }
+
+        signaturesInCreation_.insert(signature);
     }
 
+    startDeclaration();
+
     DeclarationGenerator generator(*this, calling::EntryAddress(addr), signature);
-    tree().root()->addDeclaration(generator.createDeclaration());
+    finishDeclaration(generator.createDeclaration());
+
+    {
+        QMutexLocker locker(&mutex_);
+        signaturesInCreation_.erase(signature);
+    }
+    declarationCreated_.wakeAll();
+
     return generator.declaration();
 }
 
@@ -250,6 +512,12 @@ void CodeGenerator::setFunctionDeclaration(const calling::FunctionSignature *sig
     assert(signature != nullptr);
     assert(declaration != nullptr);
 
+    QMutexLocker locker(&mutex_);
+
+    if (parallel_ && declaration->is<likec::FunctionDefinition>()) {
+        return;
+    }
+
     auto &currentDeclaration = signature2declaration_[signature];
     if (currentDeclaration == nullptr) {
         currentDeclaration = declaration;
@@ -258,6 +526,78 @@ void CodeGenerator::setFunctionDeclaration(const calling::FunctionSignature *sig
     }
 }
 
+CodeGenerator::CreationState &CodeGenerator::creationState() {
+    if (!parallel_) {
+        return serialState_;
+    }
+
+    QReadLocker locker(&threadStatesLock_);
+    return *threadStates_.at(QThread::currentThread());
+}
+
+void CodeGenerator::startDeclaration() {
+    if (parallel_) {
+        creationState().declarationStack.push_back(std::vector<const likec::Declaration *>());
+    }
+}
+
+void CodeGenerator::finishDeclaration(std::unique_ptr<likec::Declaration> declaration) {
+    assert(declaration != nullptr);
+
+    if (parallel_) {
+        auto &declarationStack = creationState().declarationStack;
+        assert(!declarationStack.empty());
+
+        std::vector<const likec::Declaration *> dependencies;
+        dependencies.swap(declarationStack.back());
+        declarationStack.pop_back();
+
+        const likec::Declaration *result = declaration.get();
+        {
+            QMutexLocker locker(&mutex_);
+            dependencies_[result].swap(dependencies);
+            pendingDeclarations_[result] = std::move(declaration);
+        }
+
+        useDeclaration(result);
+    } else {
+        tree().root()->addDeclaration(std::move(declaration));
+    }
+}
+
+void CodeGenerator::useDeclaration(const likec::Declaration *declaration) {
+    assert(declaration != nullptr);
+
+    if (parallel_) {
+        auto &state = creationState();
+        if (!state.declarationStack.empty()) {
+            state.declarationStack.back().push_back(declaration);
+        } else {
+            state.uses->push_back(declaration);
+        }
+    }
+}
+
+void CodeGenerator::addPendingDeclaration(const likec::Declaration *declaration, std::size_t &structCount) {
+    auto i = pendingDeclarations_.find(declaration);
+    if (i == pendingDeclarations_.end()) {
+        return;
+    }
+
+    auto pendingDeclaration = std::move(i->second);
+    pendingDeclarations_.erase(i);
+
+    foreach (auto dependency, dependencies_[declaration]) {
+        addPendingDeclaration(dependency, structCount);
+    }
+
+    if (pendingDeclaration->is<likec::StructTypeDeclaration>()) {
+        pendingDeclaration->setIdentifier(QString("s%1").arg(structCount++));
+    }
+
+    tree().root()->addDeclaration(std::move(pendingDeclaration));
+}
+
 } // namespace cgen
 } // namespace ir
 } // namespace core
@@ -25,15 +25,26 @@
 
 #include <nc/config.h>
 
+#include <functional>
 #include <vector>
 
 #include <boost/noncopyable.hpp>
 #include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QWaitCondition>
 
 #include <nc/core/ir/MemoryLocation.h>
 
+#include "Dependencies.h"
 #include "NameGenerator.h"
 
+QT_BEGIN_NAMESPACE
+class QThread;
+QT_END_NAMESPACE
+
 namespace nc {
 
 class CancellationToken;
@@ -45,6 +56,7 @@ namespace image {
 }
 
 namespace likec {
+    class Declaration;
     class FunctionDeclaration;
     class FunctionDefinition;
     class Expression;
@@ -106,20 +118,88 @@ class CodeGenerator: boost::noncopyable {
     const liveness::Livenesses &livenesses_;
     const types::Types &types_;
     const CancellationToken &cancellationToken_;
+    std::size_t workerCount_;
     const NameGenerator nameGenerator_;
 
-    /** Types being translated to LikeC. */
-    std::vector<const ir::types::Type *> typeCreationStack_;
+    /**
+     * State of the creation of types and declarations by one thread.
+     */
+    class CreationState {
+    public:
+        /** Types being translated to LikeC. */
+        std::vector<const ir::types::Type *> typeCreationStack;
+
+        /** Top-level declarations used by the pending declarations being created, innermost last. */
+        std::vector<std::vector<const likec::Declaration *>> declarationStack;
+
+        /** Top-level declarations used by the function definition being generated in parallel. */
+        std::vector<const likec::Declaration *> *uses;
+
+        CreationState(): uses(nullptr) {}
+    };
+
+    /** Creation state used when function definitions are not generated in parallel. */
+    CreationState serialState_;
+
+    /** Mapping from a thread generating a function definition in parallel to its creation state. */
+    boost::unordered_map<const QThread *, CreationState *> threadStates_;
 
+    /** Lock guarding threadStates_. */
+    QReadWriteLock threadStatesLock_;
+
+#ifdef NC_STRUCT_RECOVERY
     /** Structural types generated for IR types. */
     boost::unordered_map<const ir::types::Type *, const likec::StructType *> traits2structType_;
 
+    /**
+     * Recursive mutex making the threads create structural types one at a time,
+     * so that no thread sees the members of a struct being created by another one.
+     */
+    QMutex structsMutex_;
+#endif
+
     /** Already declared global variables. */
     boost::unordered_map<const vars::Variable *, likec::VariableDeclaration *> variableDeclarations_;
 
     /** Mapping of functions to their declarations. */
     boost::unordered_map<const calling::FunctionSignature *, likec::FunctionDeclaration *> signature2declaration_;
 
+    /** Number of declarations of the compilation unit already passed to a callback of makeStreamedFunctionDefinition(). */
+    std::size_t streamedDeclarationsCount_;
+
+    /** Dependencies of the definition being created by makeStreamedFunctionDefinition(), if they are recorded. */
+    Dependencies *streamedDependencies_;
+
+    /** Mapping from memory locations to global variables, built on first use by makeStreamedDeclarations(). */
+    boost::unordered_map<MemoryLocation, const vars::Variable *> globalVariables_;
+
+    /** Global variables whose declarations are being created. */
+    boost::unordered_set<const vars::Variable *> variablesInCreation_;
+
+    /** Signatures of the functions whose declarations are being created. */
+    boost::unordered_set<const calling::FunctionSignature *> signaturesInCreation_;
+
+    /**
+     * Top-level declarations created while generating definitions in parallel,
+     * not yet added to the compilation unit.
+     */
+    boost::unordered_map<const likec::Declaration *, std::unique_ptr<likec::Declaration>> pendingDeclarations_;
+
+    /** Mapping from a pending declaration to the top-level declarations used by it. */
+    boost::unordered_map<const likec::Declaration *, std::vector<const likec::Declaration *>> dependencies_;
+
+    /**
+     * Mutex guarding the declarations and the sets of the ones in creation.
+     * It is held only to look up and record declarations, not while creating them.
+     */
+    QMutex mutex_;
+
+    /** Condition signaled when a declaration in creation is created. */
+    QWaitCondition declarationCreated_;
+
+    /** True while function definitions are generated in parallel. */
+    bool parallel_;
+
 public:
 
     /**
@@ -136,15 +216,20 @@ public:
      * \param[in] livenesses Liveness information for all functions.
      * \param[in] types Information about types.
      * \param[in] cancellationToken Cancellation token.
+     * \param[in] workerCount Maximal number of threads generating function definitions.
      */
     CodeGenerator(likec::Tree &tree, const image::Image &image, const Functions &functions, const calling::Hooks &hooks,
         const calling::Signatures &signatures, const dflow::Dataflows &dataflows, const vars::Variables &variables,
         const cflow::Graphs &graphs, const liveness::Livenesses &livenesses, const types::Types &types,
-        const CancellationToken &cancellationToken
+        const CancellationToken &cancellationToken, std::size_t workerCount
     ):
         tree_(tree), image_(image), functions_(functions), hooks_(hooks), signatures_(signatures),
         dataflows_(dataflows), variables_(variables), graphs_(graphs), livenesses_(livenesses),
-        types_(types), cancellationToken_(cancellationToken), nameGenerator_(image)
+        types_(types), cancellationToken_(cancellationToken), workerCount_(workerCount), nameGenerator_(image),
+#ifdef NC_STRUCT_RECOVERY
+        structsMutex_(QMutex::Recursive),
+#endif
+        streamedDeclarationsCount_(0), streamedDependencies_(nullptr), parallel_(false)
     {}
 
     /**
@@ -206,9 +291,49 @@ public:
 
     /**
      * Translates input program into LikeC compilation unit.
+     *
+     * When threads are available, function definitions are generated in parallel.
+     * The top-level declarations are then added to the compilation unit in a deterministic
+     * order: the ones used by each function definition are added before it, in the order
+     * of their first use, each preceded by the declarations it uses itself. Calls to
+     * the functions defined earlier refer to their definitions, not to prototypes,
+     * so the result is the same as when the definitions are generated one by one.
      */
     void makeCompilationUnit();
 
+    /**
+     * Creates an empty LikeC compilation unit.
+     */
+    void makeEmptyCompilationUnit();
+
+    /**
+     * Creates function's definition, adds it to the compilation unit, and simplifies it
+     * together with the declarations added to the compilation unit since the last call.
+     * These declarations are passed to the callback in the order of the compilation unit,
+     * the function's definition being the last one. Then the definition is destroyed.
+     * The other declarations are kept, as subsequent definitions can refer to them.
+     *
+     * \param[in] function Function to create definition for.
+     * \param[in] callback Callback to pass the declarations to.
+     * \param[out] dependencies If not nullptr, receives the functions and global
+     *              variables the definition refers to.
+     */
+    void makeStreamedFunctionDefinition(const Function *function, const std::function<void(const likec::Declaration *)> &callback,
+                                        Dependencies *dependencies = nullptr);
+
+    /**
+     * Creates the declarations of the given functions and global variables,
+     * if they were not yet, together with the declarations they use.
+     * Like makeStreamedFunctionDefinition(), simplifies the declarations added
+     * to the compilation unit since the last call and passes them to the callback.
+     * This way, a definition generated earlier can be printed in place of
+     * the one makeStreamedFunctionDefinition() would create.
+     *
+     * \param[in] dependencies Functions and global variables to declare.
+     * \param[in] callback Callback to pass the declarations to.
+     */
+    void makeStreamedDeclarations(const Dependencies &dependencies, const std::function<void(const likec::Declaration *)> &callback);
+
     /**
      * Creates high-level type object from given type traits.
      *
@@ -279,6 +404,52 @@ public:
      * its own declaration, CodeGenerator already knows about it.
      */
     void setFunctionDeclaration(const calling::FunctionSignature *signature, likec::FunctionDeclaration *declaration);
+
+private:
+    /**
+     * \return Creation state of the current thread.
+     */
+    CreationState &creationState();
+
+    /**
+     * Generates definitions of the given functions in parallel
+     * and adds them to the compilation unit.
+     *
+     * \param functions Functions to create definitions for.
+     */
+    void makeFunctionDefinitionsInParallel(const std::vector<const Function *> &functions);
+
+    /**
+     * Starts the creation of a top-level declaration.
+     * Declarations used until the matching call to finishDeclaration()
+     * are recorded as its dependencies.
+     */
+    void startDeclaration();
+
+    /**
+     * Finishes the creation of a top-level declaration and adds it to the compilation unit.
+     * When definitions are generated in parallel, the declaration is added later.
+     *
+     * \param declaration Valid pointer to the declaration.
+     */
+    void finishDeclaration(std::unique_ptr<likec::Declaration> declaration);
+
+    /**
+     * Records a use of a top-level declaration by the declaration
+     * or definition being generated by the current thread.
+     *
+     * \param declaration Valid pointer to the declaration.
+     */
+    void useDeclaration(const likec::Declaration *declaration);
+
+    /**
+     * Adds a pending declaration to the compilation unit, if not done yet,
+     * after its dependencies.
+     *
+     * \param declaration Valid pointer to a pending declaration.
+     * \param structCount Number of structural types added so far.
+     */
+    void addPendingDeclaration(const likec::Declaration *declaration, std::size_t &structCount);
 };
 
 } // namespace cgen
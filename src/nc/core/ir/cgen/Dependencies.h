@@ -0,0 +1,33 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <vector>
+
+#include <nc/common/Types.h>
+#include <nc/core/ir/MemoryLocation.h>
+
+namespace nc {
+namespace core {
+namespace ir {
+namespace cgen {
+
+/**
+ * Functions and global variables a function definition refers to,
+ * i.e. the top-level declarations it needs apart from types.
+ */
+class Dependencies {
+public:
+    std::vector<ByteAddr> functions; ///< Entry addresses of the called functions, sorted.
+    std::vector<MemoryLocation> variables; ///< Memory locations of the global variables, sorted.
+};
+
+} // namespace cgen
+} // namespace ir
+} // namespace core
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
@@ -26,6 +26,7 @@
 
 #include <nc/common/CancellationToken.h>
 #include <nc/common/Foreach.h>
+#include <nc/common/Range.h>
 
 #include <nc/core/ir/BasicBlock.h>
 #include <nc/core/ir/Function.h>
@@ -66,6 +67,9 @@ void TypeAnalyzer::analyze() {
         changed = false;
 
         foreach (const Function *function, functions_.list()) {
+            if (!nc::contains(livenesses_, function)) {
+                continue;
+            }
             while (analyze(function)) {
                 changed = true;
                 canceled_.poll();
@@ -112,6 +116,10 @@ void TypeAnalyzer::uniteVariableTypes() {
 
 void TypeAnalyzer::uniteArgumentTypes() {
     foreach (auto function, functions_.list()) {
+        if (!nc::contains(dataflows_, function)) {
+            continue;
+        }
+
         const auto &dataflow = *dataflows_.at(function);
 
         if (auto entryHook = hooks_.getEntryHook(function)) {
@@ -96,6 +96,7 @@ public:
 
     /**
      * Computes type traits for all terms in all functions.
+     * Functions without dataflow and liveness information are skipped.
      */
     void analyze();
 
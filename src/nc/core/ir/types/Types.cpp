@@ -24,6 +24,8 @@
 
 #include "Types.h"
 
+#include <nc/common/Foreach.h>
+
 #include <nc/core/ir/Term.h>
 
 #include "Type.h"
@@ -49,9 +51,35 @@ Type *Types::getType(const Term *term) {
 }
 
 const Type *Types::getType(const Term *term) const {
+    {
+        QReadLocker locker(&lock_);
+
+        auto i = types_.find(term);
+        if (i != types_.end()) {
+            return i->second->findSet();
+        }
+    }
+
+    QWriteLocker locker(&lock_);
     return const_cast<Types *>(this)->getType(term);
 }
 
+Type *Types::makeType() {
+    freeTypes_.push_back(std::unique_ptr<Type>(new Type()));
+    return freeTypes_.back().get();
+}
+
+void Types::compressPaths() const {
+    QWriteLocker locker(&lock_);
+
+    foreach (const auto &termAndType, types_) {
+        termAndType.second->findSet();
+    }
+    foreach (const auto &type, freeTypes_) {
+        type->findSet();
+    }
+}
+
 }}}} // namespace nc::core::ir::types
 
 /* vim:set et sts=4 sw=4: */
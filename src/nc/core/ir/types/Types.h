@@ -23,8 +23,13 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include <boost/unordered_map.hpp>
 
+#include <QReadWriteLock>
+
 namespace nc {
 namespace core {
 namespace ir {
@@ -40,6 +45,8 @@ class Type;
  */
 class Types {
     mutable boost::unordered_map<const Term *, std::unique_ptr<Type> > types_; ///< Mapping of terms to their type traits.
+    std::vector<std::unique_ptr<Type> > freeTypes_; ///< Type traits not associated with any term.
+    mutable QReadWriteLock lock_; ///< Lock guarding types_ in const methods.
 
     public:
 
@@ -64,13 +71,34 @@ class Types {
      * \param[in] term Term.
      *
      * \return Valid pointer to type traits for this term.
+     *
+     * This function can be called from several threads concurrently,
+     * provided that compressPaths() was called after the last modification
+     * of the types.
      */
     const Type *getType(const Term *term) const;
 
+    /**
+     * \return Valid pointer to new type traits not associated with any term,
+     *         e.g. for the pointee of restored pointer traits.
+     */
+    Type *makeType();
+
+    /**
+     * Makes all the type traits point directly to the representatives of their sets,
+     * so that finding a representative does not modify anything afterwards.
+     */
+    void compressPaths() const;
+
     /**
      * \return Mapping of terms to their type traits.
      */
     boost::unordered_map<const Term *, std::unique_ptr<Type> > &map() { return types_; };
+
+    /**
+     * \return Mapping of terms to their type traits.
+     */
+    const boost::unordered_map<const Term *, std::unique_ptr<Type> > &map() const { return types_; };
 };
 
 }}}} // namespace nc::core::ir::types
@@ -27,10 +27,13 @@
 #include <cassert>
 #include <queue>
 
+#include <QMutexLocker>
+
 #include <boost/range/algorithm_ext/is_sorted.hpp>
 #include <boost/unordered_set.hpp>
 
 #include <nc/common/Foreach.h>
+#include <nc/common/Parallel.h>
 #include <nc/common/Range.h>
 #include <nc/common/make_unique.h>
 
@@ -56,18 +59,46 @@ namespace nc {
 namespace core {
 namespace irgen {
 
+namespace {
+
+/**
+ * Logger collecting the messages of a worker thread, so that they can be
+ * logged later from the thread committing the worker's results.
+ */
+class CollectingLogger: public Logger {
+    std::vector<std::pair<LogLevel, QString>> &messages_;
+
+public:
+    /**
+     * Constructor.
+     *
+     * \param messages Reference to the vector to append the messages to.
+     */
+    explicit CollectingLogger(std::vector<std::pair<LogLevel, QString>> &messages): messages_(messages) {}
+
+    void log(LogLevel level, const QString &text) override {
+        messages_.push_back(std::make_pair(level, text));
+    }
+};
+
+} // anonymous namespace
+
 IRGenerator::IRGenerator(const image::Image *image, const arch::Instructions *instructions, ir::Program *program,
-    const CancellationToken &canceled, const LogToken &log):
-    image_(image), instructions_(instructions), program_(program), canceled_(canceled), log_(log)
+    const CancellationToken &canceled, const LogToken &log, const ProgressToken &progress,
+    std::size_t workerCount):
+    image_(image), instructions_(instructions), program_(program), canceled_(canceled), log_(log), progress_(progress),
+    workerCount_(workerCount)
 {
     assert(image);
     assert(instructions);
     assert(program);
+    assert(workerCount > 0);
 }
 
 IRGenerator::~IRGenerator() {}
 
 void IRGenerator::generate() {
+    progress_.startStage(tr("Creating statements."));
     image_->platform().architecture()->createInstructionAnalyzer()->createStatements(instructions_, program_, canceled_, log_);
 
 #ifndef NDEBUG
@@ -82,11 +113,10 @@ void IRGenerator::generate() {
     }
 #endif
 
+    progress_.finishStage();
+
     /* Compute jump targets. */
-    foreach (auto basicBlock, program_->basicBlocks()) {
-        computeJumpTargets(basicBlock);
-        canceled_.poll();
-    }
+    computeJumpTargets();
 
 #ifndef NDEBUG
     /*
@@ -102,18 +132,74 @@ void IRGenerator::generate() {
 #endif
 
     /* Add jumps to direct successors where necessary. */
+    progress_.startStage(tr("Adding jumps to direct successors."), program_->basicBlocks().size());
+
     foreach (auto basicBlock, program_->basicBlocks()) {
         addJumpToDirectSuccessor(basicBlock);
+        progress_.advance();
         canceled_.poll();
     }
+
+    progress_.finishStage();
+}
+
+void IRGenerator::computeJumpTargets() {
+    disassemblers_.resize(workerCount_);
+
+    auto &basicBlocks = program_->basicBlocks();
+    auto begin = basicBlocks.begin();
+
+    while (begin != basicBlocks.end()) {
+        /* Analyze the basic blocks added since the previous round. */
+        std::vector<ir::BasicBlock *> blocks(begin, basicBlocks.end());
+        std::vector<BasicBlockTargets> targets(blocks.size());
+
+        /* Each round is a stage of its own: its size is known only when it starts. */
+        progress_.startStage(tr("Computing jump targets."), blocks.size());
+
+        parallelFor(blocks.size(), workerCount_, [&](std::size_t worker, std::size_t index) {
+            computeJumpTargets(blocks[index], targets[index], worker);
+            progress_.advance();
+            canceled_.poll();
+        });
+
+        /*
+         * Committing can split basic blocks, including the analyzed ones.
+         * The resulting tails are appended to the list and analyzed in the next round.
+         */
+        auto last = --basicBlocks.end();
+
+        foreach (const auto &basicBlockTargets, targets) {
+            commitJumpTargets(basicBlockTargets);
+            canceled_.poll();
+        }
+
+        begin = ++last;
+    }
+
+    progress_.finishStage();
 }
 
-void IRGenerator::computeJumpTargets(ir::BasicBlock *basicBlock) {
+void IRGenerator::computeJumpTargets(ir::BasicBlock *basicBlock, BasicBlockTargets &targets, std::size_t worker) {
     assert(basicBlock != nullptr);
 
+    /*
+     * The log token given to the constructor is not necessarily thread-safe.
+     * The analyzer's messages are logged when the targets are committed.
+     */
+    LogToken log;
+    for (int level = LogLevel::LOWEST; level <= LogLevel::HIGHEST; ++level) {
+        if (log_.isEnabled(static_cast<LogLevel::Level>(level))) {
+            auto logger = std::make_shared<CollectingLogger>(targets.messages);
+            logger->setMinLevel(static_cast<LogLevel::Level>(level));
+            log = LogToken(std::move(logger));
+            break;
+        }
+    }
+
     /* Prepare context for quick and dirty dataflow analysis. */
     ir::dflow::Dataflow dataflow;
-    ir::dflow::DataflowAnalyzer analyzer(dataflow, image_->platform().architecture(), canceled_, log_);
+    ir::dflow::DataflowAnalyzer analyzer(dataflow, image_->platform().architecture(), canceled_, log);
     ir::dflow::ReachingDefinitions definitions;
 
     foreach (auto statement, basicBlock->statements()) {
@@ -134,14 +220,10 @@ void IRGenerator::computeJumpTargets(ir::BasicBlock *basicBlock) {
 
                 /* Record information about the function entry. */
                 if (addressValue->abstractValue().isConcrete()) {
-                    ByteAddr address = addressValue->abstractValue().asConcrete().value();
-
-                    program_->addCalledAddress(address);
-                    program_->createBasicBlock(address);
+                    targets.calledAddresses.push_back(addressValue->abstractValue().asConcrete().value());
                 } else {
-                    foreach (ByteAddr address, getJumpTableEntries(call->target(), dataflow)) {
-                        program_->addCalledAddress(address);
-                        program_->createBasicBlock(address);
+                    foreach (ByteAddr address, getJumpTableEntries(call->target(), dataflow, targets, worker)) {
+                        targets.calledAddresses.push_back(address);
                     }
                 }
 
@@ -156,41 +238,72 @@ void IRGenerator::computeJumpTargets(ir::BasicBlock *basicBlock) {
                 auto jump = statement->as<ir::Jump>();
 
                 /* If the target basic block is unknown, try to guess it. */
-                computeJumpTarget(jump->thenTarget(), dataflow);
-                computeJumpTarget(jump->elseTarget(), dataflow);
+                computeJumpTarget(jump->thenTarget(), dataflow, targets, worker);
+                computeJumpTarget(jump->elseTarget(), dataflow, targets, worker);
 
                 break;
             }
         }
 
         if (statement->isTerminator() && statement->basicBlock()->address() && statement->instruction()) {
-            program_->createBasicBlock(statement->instruction()->endAddr());
+            targets.successorAddresses.push_back(statement->instruction()->endAddr());
         }
     }
 }
 
-void IRGenerator::computeJumpTarget(ir::JumpTarget &target, const ir::dflow::Dataflow &dataflow) {
+void IRGenerator::computeJumpTarget(ir::JumpTarget &target, const ir::dflow::Dataflow &dataflow, BasicBlockTargets &targets,
+    std::size_t worker)
+{
     if (target.address() && !target.basicBlock() && !target.table()) {
         const ir::dflow::Value *addressValue = dataflow.getValue(target.address());
 
+        JumpTargetInfo info(&target);
+
         if (addressValue->abstractValue().isConcrete()) {
-            target.setBasicBlock(program_->createBasicBlock(addressValue->abstractValue().asConcrete().value()));
+            info.address = addressValue->abstractValue().asConcrete().value();
         } else {
-            auto entries = getJumpTableEntries(target.address(), dataflow);
+            info.tableEntries = getJumpTableEntries(target.address(), dataflow, targets, worker);
 
-            if (!entries.empty()) {
-                auto table = std::make_unique<ir::JumpTable>();
+            if (info.tableEntries.empty()) {
+                return;
+            }
+        }
 
-                foreach (ByteAddr targetAddress, entries) {
-                    table->push_back(ir::JumpTableEntry(targetAddress, program_->createBasicBlock(targetAddress)));
-                }
-                target.setTable(std::move(table));
+        targets.jumpTargets.push_back(std::move(info));
+    }
+}
+
+void IRGenerator::commitJumpTargets(const BasicBlockTargets &targets) {
+    foreach (const auto &message, targets.messages) {
+        log_.log(message.first, message.second);
+    }
+
+    foreach (ByteAddr address, targets.calledAddresses) {
+        program_->addCalledAddress(address);
+        program_->createBasicBlock(address);
+    }
+
+    foreach (const auto &info, targets.jumpTargets) {
+        if (info.address) {
+            info.target->setBasicBlock(program_->createBasicBlock(*info.address));
+        } else {
+            auto table = std::make_unique<ir::JumpTable>();
+
+            foreach (ByteAddr targetAddress, info.tableEntries) {
+                table->push_back(ir::JumpTableEntry(targetAddress, program_->createBasicBlock(targetAddress)));
             }
+            info.target->setTable(std::move(table));
         }
     }
+
+    foreach (ByteAddr address, targets.successorAddresses) {
+        program_->createBasicBlock(address);
+    }
 }
 
-std::vector<ByteAddr> IRGenerator::getJumpTableEntries(const ir::Term *target, const ir::dflow::Dataflow &dataflow) {
+std::vector<ByteAddr> IRGenerator::getJumpTableEntries(const ir::Term *target, const ir::dflow::Dataflow &dataflow,
+    BasicBlockTargets &targets, std::size_t worker)
+{
     std::vector<ByteAddr> result;
 
     auto arrayAccess = ir::misc::recognizeArrayAccess(target, dataflow);
@@ -202,28 +315,41 @@ std::vector<ByteAddr> IRGenerator::getJumpTableEntries(const ir::Term *target, c
     const std::size_t maxTableEntries = 65536;
     const ByteSize entrySize = target->size() / CHAR_BIT;
 
-    image::Reader reader(image_);
+    /* Number of entries fetched by a single read when the table is dense. */
+    const std::size_t entriesPerRead = arrayAccess.stride() == static_cast<ConstantValue>(entrySize) ? 64 : 1;
 
     auto byteOrder = image_->platform().architecture()->getByteOrder(ir::MemoryDomain::MEMORY);
 
+    std::vector<char> buffer(entriesPerRead * entrySize);
+
     ByteAddr address = arrayAccess.base();
-    while (auto entry = reader.readInt<ByteAddr>(address, entrySize, byteOrder)) {
-        if (!isInstructionAddress(*entry)) {
+    while (true) {
+        auto size = image_->readBytes(address, buffer.data(), buffer.size());
+        if (size < entrySize) {
             break;
         }
-        result.push_back(*entry);
-        address += arrayAccess.stride();
 
-        if (result.size() > maxTableEntries) {
-            log_.warning(tr("Jump table at address %1 seems to have more than %2 entries.").arg(address).arg(maxTableEntries));
-            break;
+        /* A short read ends at the section end; the next read continues from there. */
+        for (ByteSize offset = 0; offset + entrySize <= size; offset += entrySize) {
+            auto entry = image::Reader::decodeInt<ByteAddr>(buffer.data() + offset, entrySize, byteOrder);
+
+            if (!isInstructionAddress(entry, worker)) {
+                return result;
+            }
+            result.push_back(entry);
+            address += arrayAccess.stride();
+
+            if (result.size() > maxTableEntries) {
+                targets.messages.push_back(std::make_pair(LogLevel::WARNING, tr("Jump table at address %1 seems to have more than %2 entries.").arg(address).arg(maxTableEntries)));
+                return result;
+            }
         }
     }
 
     return result;
 }
 
-bool IRGenerator::isInstructionAddress(ByteAddr address) {
+bool IRGenerator::isInstructionAddress(ByteAddr address, std::size_t worker) {
     if (instructions_->get(address)) {
         return true;
     }
@@ -233,11 +359,26 @@ bool IRGenerator::isInstructionAddress(ByteAddr address) {
         return false;
     }
 
-    if (!disassembler_) {
-        disassembler_ = image_->platform().architecture()->createDisassembler();
+    {
+        QMutexLocker locker(&decodedAddressesMutex_);
+
+        auto i = decodedAddresses_.find(address);
+        if (i != decodedAddresses_.end()) {
+            return i->second;
+        }
+    }
+
+    auto &disassembler = disassemblers_[worker];
+    if (!disassembler) {
+        disassembler = image_->platform().architecture()->createDisassembler();
     }
 
-    return disassembler_->disassembleSingleInstruction(address, section) != nullptr;
+    bool result = disassembler->disassembleSingleInstruction(address, section) != nullptr;
+
+    QMutexLocker locker(&decodedAddressesMutex_);
+    decodedAddresses_[address] = result;
+
+    return result;
 }
 
 void IRGenerator::addJumpToDirectSuccessor(ir::BasicBlock *basicBlock) {
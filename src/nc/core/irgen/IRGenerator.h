@@ -26,12 +26,18 @@
 #include <nc/config.h>
 
 #include <QCoreApplication>
+#include <QMutex>
 
 #include <cassert>
+#include <memory>
 #include <vector>
 
+#include <boost/optional.hpp>
+#include <boost/unordered_map.hpp>
+
 #include <nc/common/CancellationToken.h>
 #include <nc/common/LogToken.h>
+#include <nc/common/ProgressToken.h>
 #include <nc/common/Types.h>
 
 namespace nc {
@@ -70,7 +76,32 @@ class IRGenerator {
     ir::Program *program_; ///< Program.
     const CancellationToken &canceled_; ///< Cancellation token.
     const LogToken &log_; ///< Log token.
-    std::unique_ptr<arch::Disassembler> disassembler_; ///< Disassembler.
+    const ProgressToken &progress_; ///< Progress token.
+    std::size_t workerCount_; ///< Maximal number of threads to use.
+    std::vector<std::unique_ptr<arch::Disassembler>> disassemblers_; ///< Disassemblers, one per worker.
+    boost::unordered_map<ByteAddr, bool> decodedAddresses_; ///< Whether an instruction could be decoded at an address.
+    QMutex decodedAddressesMutex_; ///< Mutex guarding decodedAddresses_.
+
+    /**
+     * Targets of a single jump found by the analysis of a basic block.
+     */
+    struct JumpTargetInfo {
+        ir::JumpTarget *target; ///< Jump target to be filled in.
+        boost::optional<ByteAddr> address; ///< Concrete target address, if known.
+        std::vector<ByteAddr> tableEntries; ///< Entries of the jump table, if the address is not known.
+
+        JumpTargetInfo(ir::JumpTarget *target): target(target) {}
+    };
+
+    /**
+     * Call and jump targets discovered in a basic block.
+     */
+    struct BasicBlockTargets {
+        std::vector<ByteAddr> calledAddresses; ///< Addresses of called functions.
+        std::vector<JumpTargetInfo> jumpTargets; ///< Jump targets to be set.
+        std::vector<ByteAddr> successorAddresses; ///< Addresses following terminators.
+        std::vector<std::pair<LogLevel, QString>> messages; ///< Messages to be logged.
+    };
 
 public:
     /**
@@ -81,9 +112,12 @@ public:
      * \param[out] program Valid pointer to the program.
      * \param[in] canceled Cancellation token.
      * \param[in] log Log token.
+     * \param[in] progress Progress token.
+     * \param[in] workerCount Maximal number of threads to use. Must be positive.
      */
     IRGenerator(const image::Image *image, const arch::Instructions *instructions, ir::Program *program,
-        const CancellationToken &canceled, const LogToken &log);
+        const CancellationToken &canceled, const LogToken &log, const ProgressToken &progress,
+        std::size_t workerCount);
 
     /**
      * Destructor.
@@ -98,37 +132,67 @@ public:
 
 private:
     /**
-     * Computes jump targets in the basic block.
+     * Computes jump targets in all basic blocks of the program.
      *
-     * \param basicBlock Valid pointer to a basic block.
+     * Basic blocks are analyzed in parallel, without modifying the program.
+     * The discovered targets are then committed serially, in the order of
+     * the basic blocks. Blocks created by the commit are analyzed in
+     * the next round.
      */
-    void computeJumpTargets(ir::BasicBlock *basicBlock);
+    void computeJumpTargets();
 
     /**
-     * Sets the basic block or jump table fields in the jump target,
+     * Computes call and jump targets in the basic block.
+     * Does not modify the program.
+     *
+     * \param[in]  basicBlock Valid pointer to a basic block.
+     * \param[out] targets    Discovered targets.
+     * \param[in]  worker     Index of the worker doing the analysis.
+     */
+    void computeJumpTargets(ir::BasicBlock *basicBlock, BasicBlockTargets &targets, std::size_t worker);
+
+    /**
+     * Computes the basic block address or jump table entries for the jump target,
      * based on the address expression and some guessing.
      *
-     * \param[in,out] target   Jump target.
+     * \param[in]     target   Jump target.
      * \param[in]     dataflow Dataflow information collected up to the point where jump has been met.
+     * \param[in,out] targets  Targets of the basic block containing the jump.
+     * \param[in]     worker   Index of the worker doing the analysis.
      */
-    void computeJumpTarget(ir::JumpTarget &target, const ir::dflow::Dataflow &dataflow);
+    void computeJumpTarget(ir::JumpTarget &target, const ir::dflow::Dataflow &dataflow, BasicBlockTargets &targets,
+        std::size_t worker);
+
+    /**
+     * Creates basic blocks and sets jump targets found by computeJumpTargets().
+     *
+     * \param targets Targets discovered in a basic block.
+     */
+    void commitJumpTargets(const BasicBlockTargets &targets);
 
     /**
      * Determines jump table address and recovers its entries in a form of a vector of addresses.
      *
-     * \param[in] target Valid pointer to a term representing the jump target.
-     * \param[in] dataflow Dataflow information collected up to the point where jump has been met.
+     * \param[in]     target   Valid pointer to a term representing the jump target.
+     * \param[in]     dataflow Dataflow information collected up to the point where jump has been met.
+     * \param[in,out] targets  Targets of the basic block containing the jump.
+     * \param[in]     worker   Index of the worker doing the analysis.
      *
      * \returns The entries of the jump table.
      */
-    std::vector<ByteAddr> getJumpTableEntries(const ir::Term *target, const ir::dflow::Dataflow &dataflow);
+    std::vector<ByteAddr> getJumpTableEntries(const ir::Term *target, const ir::dflow::Dataflow &dataflow,
+        BasicBlockTargets &targets, std::size_t worker);
 
     /**
+     * Results of decoding addresses not known to the instructions given
+     * to the constructor are cached and shared between the workers.
+     *
      * \param address A virtual address.
+     * \param worker  Index of the worker asking.
      *
      * \return True if the address seems to be an instruction address, false otherwise.
      */
-    bool isInstructionAddress(ByteAddr address);
+    bool isInstructionAddress(ByteAddr address, std::size_t worker);
 
     /**
      * Adds a jump to direct successor to given basic block if the latter
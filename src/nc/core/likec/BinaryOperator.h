@@ -87,12 +87,12 @@ class BinaryOperator: public Expression {
      *
      * \param operatorKind New kind.
      */
-    void setOperatorKind(int operatorKind) { operatorKind_ = operatorKind; }
+    void setOperatorKind(int operatorKind) { operatorKind_ = operatorKind; invalidateCachedType(); }
 
     /**
      * \return Left operand.
      */
-    std::unique_ptr<Expression> &left() { return left_; }
+    std::unique_ptr<Expression> &left() { invalidateCachedType(); return left_; }
 
     /**
      * \return Left operand.
@@ -102,7 +102,7 @@ class BinaryOperator: public Expression {
     /**
      * \return Right operand.
      */
-    std::unique_ptr<Expression> &right() { return right_; }
+    std::unique_ptr<Expression> &right() { invalidateCachedType(); return right_; }
 
     /**
      * \return Right operand.
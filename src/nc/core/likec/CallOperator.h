@@ -53,7 +53,7 @@ public:
     /**
      * \return Callee.
      */
-    std::unique_ptr<Expression> &callee() { return callee_; }
+    std::unique_ptr<Expression> &callee() { invalidateCachedType(); return callee_; }
 
     /**
      * \return Callee.
@@ -63,7 +63,7 @@ public:
     /**
      * Function arguments.
      */
-    std::vector<std::unique_ptr<Expression>> &arguments() { return arguments_; }
+    std::vector<std::unique_ptr<Expression>> &arguments() { invalidateCachedType(); return arguments_; }
 
     /**
      * Function arguments.
@@ -26,6 +26,7 @@
 #include <nc/config.h>
 
 #include <cassert>
+#include <cstddef> /* std::size_t */
 
 #include "TreeNode.h"
 
@@ -38,6 +39,8 @@ namespace ir {
 
 namespace likec {
 
+class Type;
+
 /**
  * Base class for different kinds of expressions.
  */
@@ -45,6 +48,8 @@ class Expression: public TreeNode {
     NC_BASE_CLASS(Expression, expressionKind)
 
     const ir::Term *term_; ///< Term this expression was created from.
+    mutable const Type *cachedType_; ///< Memoized type of the expression, or nullptr.
+    mutable std::size_t cachedTypePass_; ///< Identifier of the type calculation pass that memoized the type.
 
 public:
     enum {
@@ -67,7 +72,7 @@ public:
      * \param[in] expressionKind Kind of expression.
      */
     explicit Expression(int expressionKind):
-        TreeNode(EXPRESSION), expressionKind_(expressionKind), term_(nullptr)
+        TreeNode(EXPRESSION), expressionKind_(expressionKind), term_(nullptr), cachedType_(nullptr), cachedTypePass_(0)
     {}
 
     /**
@@ -84,6 +89,37 @@ public:
 
         term_ = term;
     }
+
+    /**
+     * \param pass Identifier of a type calculation pass.
+     *
+     * \return Type of the expression memoized during the given pass,
+     *         or nullptr if it is not known.
+     */
+    const Type *cachedType(std::size_t pass) const {
+        return cachedTypePass_ == pass ? cachedType_ : nullptr;
+    }
+
+    /**
+     * Memoizes the type of the expression.
+     *
+     * \param type Valid pointer to the type.
+     * \param pass Identifier of the type calculation pass.
+     */
+    void setCachedType(const Type *type, std::size_t pass) const {
+        assert(type != nullptr);
+        cachedType_ = type;
+        cachedTypePass_ = pass;
+    }
+
+protected:
+    /**
+     * Forgets the memoized type. Called by every non-const accessor and
+     * setter of an expression, so that replacing a node of a subtree
+     * invalidates all the nodes on the path to it that are accessed
+     * for the replacement.
+     */
+    void invalidateCachedType() { cachedType_ = nullptr; }
 };
 
 } // namespace likec
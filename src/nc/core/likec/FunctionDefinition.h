@@ -72,6 +72,11 @@ public:
      */
     std::vector<std::unique_ptr<LabelDeclaration>> &labels() { return labels_; };
 
+    /**
+     * \return Labels of the function.
+     */
+    const std::vector<std::unique_ptr<LabelDeclaration>> &labels() const { return labels_; };
+
     /**
      * Adds invisible label declaration to the function.
      *
@@ -65,6 +65,7 @@ public:
     void setDeclaration(FunctionDeclaration *declaration) {
         assert(declaration != nullptr);
         declaration_ = declaration;
+        invalidateCachedType();
     }
 };
 
@@ -41,6 +41,7 @@ IntegerConstant::IntegerConstant(ConstantValue value, const IntegerType *type):
 void IntegerConstant::setValue(const SizedValue &value) {
     assert(value.size() == type_->size());
     value_ = value;
+    invalidateCachedType();
 }
 
 } // namespace likec
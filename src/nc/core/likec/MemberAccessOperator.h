@@ -72,12 +72,12 @@ public:
     /**
      * Sets operator id.
      */
-    void setAccessKind(AccessKind accessKind) { accessKind_ = accessKind; }
+    void setAccessKind(AccessKind accessKind) { accessKind_ = accessKind; invalidateCachedType(); }
 
     /**
      * \return Accessed struct or union.
      */
-    std::unique_ptr<Expression> &compound() { return compound_; }
+    std::unique_ptr<Expression> &compound() { invalidateCachedType(); return compound_; }
 
     /**
      * \return Accessed struct or union.
@@ -0,0 +1,122 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "ParallelTreePrinter.h"
+
+#include <QTextStream>
+
+#include <nc/common/Foreach.h>
+#include <nc/common/Parallel.h>
+
+#include "CompilationUnit.h"
+
+namespace nc {
+namespace core {
+namespace likec {
+
+namespace {
+
+/**
+ * Prints a top-level declaration the way TreePrinter prints it as a part of a compilation unit.
+ *
+ * \param[in] declaration Valid pointer to the declaration.
+ * \param[out] printedNodes If not nullptr, array to record the ranges of the printed nodes to.
+ *
+ * \return The text of the declaration.
+ */
+QString printDeclaration(const Declaration *declaration, std::vector<PrintedNode> *printedNodes) {
+    QString result;
+    QTextStream out(&result);
+
+    out << '\n';
+    if (printedNodes) {
+        TreePrinter(out, *printedNodes).print(declaration);
+    } else {
+        TreePrinter(out, nullptr).print(declaration);
+    }
+    out << '\n';
+    out.flush();
+
+    return result;
+}
+
+} // anonymous namespace
+
+QByteArray ParallelTreePrinter::printUtf8(const CompilationUnit *unit, std::size_t workerCount) {
+    assert(unit != nullptr);
+
+    const auto &declarations = unit->declarations();
+
+    std::vector<QByteArray> buffers(declarations.size());
+
+    parallelFor(declarations.size(), workerCount, [&](std::size_t, std::size_t index) {
+        buffers[index] = printDeclaration(declarations[index], nullptr).toUtf8();
+    });
+
+    int size = 0;
+    foreach (const auto &buffer, buffers) {
+        size += buffer.size();
+    }
+
+    QByteArray result;
+    result.reserve(size);
+    foreach (const auto &buffer, buffers) {
+        result.append(buffer);
+    }
+
+    return result;
+}
+
+QString ParallelTreePrinter::print(const CompilationUnit *unit, std::vector<PrintedNode> &printedNodes, std::size_t workerCount) {
+    assert(unit != nullptr);
+
+    const auto &declarations = unit->declarations();
+
+    std::vector<QString> texts(declarations.size());
+    std::vector<std::vector<PrintedNode>> declarationsNodes(declarations.size());
+
+    parallelFor(declarations.size(), workerCount, [&](std::size_t, std::size_t index) {
+        texts[index] = printDeclaration(declarations[index], &declarationsNodes[index]);
+    });
+
+    std::size_t nodesCount = 1;
+    int size = 0;
+    for (std::size_t i = 0; i < declarations.size(); ++i) {
+        nodesCount += declarationsNodes[i].size();
+        size += texts[i].size();
+    }
+
+    std::size_t unitIndex = printedNodes.size();
+    printedNodes.reserve(unitIndex + nodesCount);
+
+    PrintedNode unitNode;
+    unitNode.node = unit;
+    unitNode.begin = 0;
+    unitNode.end = size;
+    unitNode.parent = PrintedNode::NO_PARENT;
+    printedNodes.push_back(unitNode);
+
+    QString result;
+    result.reserve(size);
+
+    for (std::size_t i = 0; i < declarations.size(); ++i) {
+        std::size_t offset = printedNodes.size();
+
+        foreach (PrintedNode node, declarationsNodes[i]) {
+            node.begin += result.size();
+            node.end += result.size();
+            node.parent = node.parent == PrintedNode::NO_PARENT ? unitIndex : node.parent + offset;
+            printedNodes.push_back(node);
+        }
+
+        result.append(texts[i]);
+    }
+
+    return result;
+}
+
+} // namespace likec
+} // namespace core
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
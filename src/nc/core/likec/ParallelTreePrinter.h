@@ -0,0 +1,56 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <cstddef>
+#include <vector>
+
+#include <QByteArray>
+#include <QString>
+
+#include "TreePrinter.h"
+
+namespace nc {
+namespace core {
+namespace likec {
+
+class CompilationUnit;
+
+/**
+ * Printer of compilation units that prints top-level declarations in parallel,
+ * each into its own buffer, and concatenates the buffers in order.
+ * The text is the same as the one printed by TreePrinter.
+ */
+class ParallelTreePrinter {
+public:
+    /**
+     * Prints a compilation unit.
+     *
+     * \param unit Valid pointer to the compilation unit.
+     * \param workerCount Maximal number of threads to print with.
+     *
+     * \return The text in UTF-8 encoding.
+     */
+    static QByteArray printUtf8(const CompilationUnit *unit, std::size_t workerCount);
+
+    /**
+     * Prints a compilation unit, recording the ranges of all printed nodes.
+     *
+     * \param[in] unit Valid pointer to the compilation unit.
+     * \param[out] printedNodes Array to append the ranges of the printed nodes to,
+     *                          in the order of TreePrinter, the unit's one being first.
+     * \param[in] workerCount Maximal number of threads to print with.
+     *
+     * \return The text.
+     */
+    static QString print(const CompilationUnit *unit, std::vector<PrintedNode> &printedNodes, std::size_t workerCount);
+};
+
+} // namespace likec
+} // namespace core
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
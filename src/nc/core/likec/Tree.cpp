@@ -24,7 +24,9 @@
 
 #include "Tree.h"
 
-#include <nc/common/Foreach.h>
+#include <QMutexLocker>
+
+#include <nc/common/make_unique.h>
 
 #include "Simplifier.h"
 #include "TreePrinter.h"
@@ -49,55 +51,43 @@ const VoidType *Tree::makeVoidType() {
 }
 
 const IntegerType *Tree::makeIntegerType(SmallBitSize size, bool isUnsigned) {
-    foreach (const auto &type, integerTypes_) {
-        if (type->size() == size && type->isUnsigned() == isUnsigned) {
-            return type.get();
-        }
-    }
-
-    IntegerType *type = new IntegerType(size, isUnsigned);
-    integerTypes_.push_back(std::unique_ptr<IntegerType>(type));
+    QMutexLocker locker(&typesMutex_);
 
-    return type;
+    auto &type = types_[TypeKey(TypeKey::INTEGER, size, isUnsigned)];
+    if (!type) {
+        type = std::make_unique<IntegerType>(size, isUnsigned);
+    }
+    return static_cast<const IntegerType *>(type.get());
 }
 
 const FloatType *Tree::makeFloatType(SmallBitSize size) {
-    foreach (const auto &type, floatTypes_) {
-        if (type->size() == size) {
-            return type.get();
-        }
-    }
-
-    FloatType *type = new FloatType(size);
-    floatTypes_.push_back(std::unique_ptr<FloatType>(type));
+    QMutexLocker locker(&typesMutex_);
 
-    return type;
+    auto &type = types_[TypeKey(TypeKey::FLOAT, size)];
+    if (!type) {
+        type = std::make_unique<FloatType>(size);
+    }
+    return static_cast<const FloatType *>(type.get());
 }
 
 const PointerType *Tree::makePointerType(SmallBitSize size, const Type *pointee) {
-    auto range = pointerTypes_.equal_range(pointee);
-    for (auto i = range.first; i != range.second; ++i) {
-        if (i->second->size() == size) {
-            return i->second.get();
-        }
-    }
+    QMutexLocker locker(&typesMutex_);
 
-    PointerType *type = new PointerType(size, pointee);
-    pointerTypes_.insert(std::make_pair(pointee, std::unique_ptr<PointerType>(type)));
-    return type;
+    auto &type = types_[TypeKey(TypeKey::POINTER, size, false, pointee)];
+    if (!type) {
+        type = std::make_unique<PointerType>(size, pointee);
+    }
+    return static_cast<const PointerType *>(type.get());
 }
 
 const ArrayType *Tree::makeArrayType(SmallBitSize size, const Type *elementType, std::size_t length) {
-    auto range = arrayTypes_.equal_range(elementType);
-    for (auto i = range.first; i != range.second; ++i) {
-        if (i->second->length() == length && i->second->size() == size) {
-            return i->second.get();
-        }
-    }
+    QMutexLocker locker(&typesMutex_);
 
-    ArrayType *type = new ArrayType(size, elementType, length);
-    arrayTypes_.insert(std::make_pair(elementType, std::unique_ptr<ArrayType>(type)));
-    return type;
+    auto &type = types_[TypeKey(TypeKey::ARRAY, size, false, elementType, length)];
+    if (!type) {
+        type = std::make_unique<ArrayType>(size, elementType, length);
+    }
+    return static_cast<const ArrayType *>(type.get());
 }
 
 const ErroneousType *Tree::makeErroneousType() {
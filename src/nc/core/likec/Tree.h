@@ -26,11 +26,13 @@
 #include <nc/config.h>
 
 #include <climits>
-#include <map>
 #include <memory>
-#include <vector>
 
+#include <boost/functional/hash.hpp>
 #include <boost/noncopyable.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <QMutex>
 
 #include <nc/common/PrintCallback.h>
 
@@ -51,12 +53,49 @@ class Tree: boost::noncopyable {
     SmallBitSize pointerSize_; ///< Size of void * in bits for target platform.
     SmallBitSize ptrdiffSize_; ///< Size of ptrdiff_t in bits for target platform.
 
+    /**
+     * Key identifying an interned type.
+     * Fields irrelevant for the kind of the type are zero.
+     */
+    struct TypeKey {
+        /** Kind of an interned type. */
+        enum Kind {
+            INTEGER, ///< Integer type.
+            FLOAT,   ///< Float type.
+            POINTER, ///< Pointer type.
+            ARRAY    ///< Array type.
+        };
+
+        Kind kind; ///< Kind of the type.
+        SmallBitSize size; ///< Size of the type.
+        bool isUnsigned; ///< Signedness of an integer type.
+        const Type *elementType; ///< Pointee or element type.
+        std::size_t length; ///< Length of an array type.
+
+        TypeKey(Kind kind, SmallBitSize size, bool isUnsigned = false, const Type *elementType = nullptr, std::size_t length = 0):
+            kind(kind), size(size), isUnsigned(isUnsigned), elementType(elementType), length(length)
+        {}
+
+        bool operator==(const TypeKey &that) const {
+            return kind == that.kind && size == that.size && isUnsigned == that.isUnsigned &&
+                   elementType == that.elementType && length == that.length;
+        }
+
+        friend std::size_t hash_value(const TypeKey &key) {
+            std::size_t result = 0;
+            boost::hash_combine(result, static_cast<int>(key.kind));
+            boost::hash_combine(result, key.size);
+            boost::hash_combine(result, key.isUnsigned);
+            boost::hash_combine(result, key.elementType);
+            boost::hash_combine(result, key.length);
+            return result;
+        }
+    };
+
     const VoidType voidType_; ///< Void type.
-    std::vector<std::unique_ptr<IntegerType> > integerTypes_; ///< Integer types.
-    std::vector<std::unique_ptr<FloatType> > floatTypes_; ///< Float types.
-    std::multimap<const Type *, std::unique_ptr<PointerType> > pointerTypes_; ///< Pointers to other types.
-    std::multimap<const Type *, std::unique_ptr<ArrayType> > arrayTypes_; ///< Arrays of other types.
+    boost::unordered_map<TypeKey, std::unique_ptr<Type>, boost::hash<TypeKey> > types_; ///< Interned integer, float, pointer, and array types.
     const ErroneousType erroneousType_; ///< Erroneous type.
+    QMutex typesMutex_; ///< Mutex guarding the types, so that they can be created from several threads.
 
 public:
     /**
@@ -167,9 +167,17 @@ int getPrecedence(const UnaryOperator *node) {
 } // anonymous namespace
 
 TreePrinter::TreePrinter(QTextStream &out, PrintCallback<const TreeNode *> *callback):
-    out_(out), callback_(callback), indentStep_(4), indent_(0)
+    out_(out), callback_(callback), printedNodes_(nullptr), currentNode_(PrintedNode::NO_PARENT),
+    indentStep_(4), indent_(0)
 {}
 
+TreePrinter::TreePrinter(QTextStream &out, std::vector<PrintedNode> &printedNodes):
+    out_(out), callback_(nullptr), printedNodes_(&printedNodes), currentNode_(PrintedNode::NO_PARENT),
+    indentStep_(4), indent_(0)
+{
+    assert(out.string() != nullptr);
+}
+
 void TreePrinter::print(const TreeNode *node) {
     assert(node);
 
@@ -177,8 +185,25 @@ void TreePrinter::print(const TreeNode *node) {
         callback_->onStartPrinting(node);
     }
 
+    std::size_t parentNode = currentNode_;
+    if (printedNodes_) {
+        PrintedNode printedNode;
+        printedNode.node = node;
+        printedNode.begin = out_.string()->size();
+        printedNode.end = printedNode.begin;
+        printedNode.parent = parentNode;
+
+        currentNode_ = printedNodes_->size();
+        printedNodes_->push_back(printedNode);
+    }
+
     doPrint(node);
 
+    if (printedNodes_) {
+        (*printedNodes_)[currentNode_].end = out_.string()->size();
+        currentNode_ = parentNode;
+    }
+
     if (callback_) {
         callback_->onEndPrinting(node);
     }
@@ -5,6 +5,9 @@
 
 #include <nc/config.h>
 
+#include <cstddef> /* std::size_t */
+#include <vector>
+
 #include <QTextStream>
 
 #include <nc/common/PrintCallback.h>
@@ -50,12 +53,27 @@ class VariableDeclaration;
 class VariableIdentifier;
 class While;
 
+/**
+ * Range of text occupied by a printed node.
+ */
+struct PrintedNode {
+    const TreeNode *node; ///< Printed node.
+    int begin; ///< Position of the first character of the node's text.
+    int end; ///< Position past the last character of the node's text.
+    std::size_t parent; ///< Index of the parent node's range, or NO_PARENT for the root.
+
+    /** Value of parent for the root. */
+    static const std::size_t NO_PARENT = static_cast<std::size_t>(-1);
+};
+
 /**
  * This class can print tree nodes into a stream.
  */
 class TreePrinter {
     QTextStream &out_; ///< Output stream.
     PrintCallback<const TreeNode *> *callback_; ///< Print callback.
+    std::vector<PrintedNode> *printedNodes_; ///< Ranges of printed nodes.
+    std::size_t currentNode_; ///< Index of the range of the node being printed.
     int indentStep_; ///< Size of a single indentation step.
     int indent_; ///< Current indentation.
 
@@ -66,6 +84,17 @@ public:
      */
     TreePrinter(QTextStream &out, PrintCallback<const TreeNode *> *callback);
 
+    /**
+     * Constructs a printer recording the ranges of printed nodes into a flat array.
+     * The ranges are appended in the order in which the nodes start printing,
+     * so that parents come before their children.
+     *
+     * \param out Output stream. Must be operating on a string.
+     * \param printedNodes Array to append the ranges of the printed nodes to.
+     *                     Positions are the offsets in the stream's string.
+     */
+    TreePrinter(QTextStream &out, std::vector<PrintedNode> &printedNodes);
+
     /**
      * Prints the given node to the stream passed to the constructor.
      *
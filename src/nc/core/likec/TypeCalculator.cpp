@@ -1,5 +1,7 @@
 #include "TypeCalculator.h"
 
+#include <atomic>
+
 #include <nc/common/Unreachable.h>
 
 #include "BinaryOperator.h"
@@ -23,7 +25,27 @@ namespace nc {
 namespace core {
 namespace likec {
 
+namespace {
+
+/** Identifier of the last started pass. Zero means no pass. */
+std::atomic<std::size_t> lastPass(0);
+
+} // anonymous namespace
+
+TypeCalculator::TypeCalculator(Tree &tree):
+    tree_(tree), pass_(++lastPass)
+{}
+
 const Type *TypeCalculator::getType(const Expression *node) {
+    if (auto result = node->cachedType(pass_)) {
+        return result;
+    }
+    auto result = computeType(node);
+    node->setCachedType(result, pass_);
+    return result;
+}
+
+const Type *TypeCalculator::computeType(const Expression *node) {
     switch (node->expressionKind()) {
         case Expression::BINARY_OPERATOR:
             return getType(node->as<BinaryOperator>());
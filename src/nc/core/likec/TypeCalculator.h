@@ -5,7 +5,7 @@
 
 #include <nc/config.h>
 
-#include <boost/unordered_map.hpp>
+#include <cstddef> /* std::size_t */
 
 namespace nc {
 namespace core {
@@ -26,12 +26,29 @@ class UnaryOperator;
 class UndeclaredIdentifier;
 class VariableIdentifier;
 
+/**
+ * Calculator of the types of expressions.
+ *
+ * Each calculator is a separate pass: the types it memoizes in the nodes
+ * are not used by other calculators, so a tree modified between passes,
+ * by whatever means, never yields stale types. Within a pass, the tree
+ * must be modified only via the non-const accessors of the nodes on the
+ * path to the modified node, as Simplifier does.
+ */
 class TypeCalculator {
     Tree &tree_;
+    std::size_t pass_; ///< Unique identifier of this pass.
 
 public:
-    explicit TypeCalculator(Tree &tree): tree_(tree) {}
+    explicit TypeCalculator(Tree &tree);
 
+    /**
+     * \param node Valid pointer to an expression.
+     *
+     * \return Type of the expression. The result is memoized in the node
+     *         for this pass until the node is modified via its non-const
+     *         accessors.
+     */
     const Type *getType(const Expression *node);
     const Type *getType(const BinaryOperator *node);
     const Type *getType(const CallOperator *node);
@@ -46,6 +63,9 @@ public:
     const Type *getType(const UndeclaredIdentifier *node);
     const Type *getBinaryOperatorType(int operatorKind, const Expression *left, const Expression *right);
     Tree &tree() { return tree_; }
+
+private:
+    const Type *computeType(const Expression *node);
 };
 
 } // namespace likec
@@ -76,7 +76,7 @@ public:
     /**
      * \return Operand.
      */
-    std::unique_ptr<Expression> &operand() { return operand_; }
+    std::unique_ptr<Expression> &operand() { invalidateCachedType(); return operand_; }
 
     /**
      * \return Operand.
@@ -69,12 +69,12 @@ public:
      *
      * \param operatorKind New kind.
      */
-    void setOperatorKind(int operatorKind) { operatorKind_ = operatorKind; }
+    void setOperatorKind(int operatorKind) { operatorKind_ = operatorKind; invalidateCachedType(); }
 
     /**
      * \return Operand.
      */
-    std::unique_ptr<Expression> &operand() { return operand_; }
+    std::unique_ptr<Expression> &operand() { invalidateCachedType(); return operand_; }
 
     /**
      * \return Operand.
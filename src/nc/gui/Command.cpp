@@ -28,6 +28,9 @@
 #include <QThreadPool>
 #endif
 
+#include <nc/common/Foreach.h>
+#include <nc/common/SignalProgressListener.h>
+
 #include "Activity.h"
 
 namespace nc {
@@ -38,7 +41,11 @@ Command::Command():
     threadPool_(QThreadPool::globalInstance()),
 #endif
     activityCount_(0),
-    isBackground_(false)
+    progressCompleted_(0),
+    progressTotal_(0),
+    progressEta_(-1),
+    isBackground_(false),
+    priority_(NORMAL_PRIORITY)
 {}
 
 Command::~Command() {
@@ -50,11 +57,36 @@ void Command::execute() {
 
     cancellationToken_ = CancellationToken();
 
+    auto progressListener = std::make_shared<SignalProgressListener>();
+    connect(progressListener.get(), SIGNAL(progressChanged(const QString &, qint64, qint64, qint64)),
+            this, SLOT(setProgress(const QString &, qint64, qint64, qint64)));
+    progressToken_ = ProgressToken(progressListener);
+
     ++activityCount_;
     work();
     activityFinished();
 }
 
+void Command::addDependency(Command *command) {
+    assert(command);
+    assert(command != this);
+
+    dependencies_.push_back(command);
+}
+
+bool Command::ready() const {
+    foreach (const auto &dependency, dependencies_) {
+        if (dependency) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Command::supersedes(const Command &) const {
+    return false;
+}
+
 void Command::delegate(std::unique_ptr<Activity> activity) {
     assert(activity);
 
@@ -78,6 +110,15 @@ void Command::activityFinished() {
     }
 }
 
+void Command::setProgress(const QString &stage, qint64 completed, qint64 total, qint64 eta) {
+    progressStage_ = stage;
+    progressCompleted_ = completed;
+    progressTotal_ = total;
+    progressEta_ = eta;
+
+    Q_EMIT progressChanged();
+}
+
 }} // namespace nc::gui
 
 /* vim:set et sts=4 sw=4: */
@@ -26,11 +26,15 @@
 #include <nc/config.h>
 
 #include <QObject>
+#include <QPointer>
+#include <QString>
 
 #include <cassert>
 #include <memory>
+#include <vector>
 
 #include <nc/common/CancellationToken.h>
+#include <nc/common/ProgressToken.h>
 
 #ifdef NC_USE_THREADS
 QT_BEGIN_NAMESPACE
@@ -60,11 +64,41 @@ class Command: public QObject {
     /** Cancellation token for this command. */
     CancellationToken cancellationToken_;
 
+    /** Progress token for this command. */
+    ProgressToken progressToken_;
+
+    /** Name of the stage the command is executing. */
+    QString progressStage_;
+
+    /** Number of completed units of work of the stage. */
+    qint64 progressCompleted_;
+
+    /** Total number of units of work of the stage, zero if unknown. */
+    qint64 progressTotal_;
+
+    /** Estimated number of milliseconds until the end of the stage, or -1 if unknown. */
+    qint64 progressEta_;
+
     /** The command does not prevent the user from doing something else. */
     bool isBackground_;
 
+    /** Priority of the command. */
+    int priority_;
+
+    /** Commands that must finish before this one starts. */
+    std::vector<QPointer<Command>> dependencies_;
+
     public:
 
+    /**
+     * Usual priorities of commands.
+     */
+    enum Priority {
+        LOW_PRIORITY = -1,   ///< Work the user is not waiting for.
+        NORMAL_PRIORITY = 0, ///< Default priority.
+        HIGH_PRIORITY = 1    ///< Work the user is waiting for right now.
+    };
+
     /**
      * Constructor.
      */
@@ -113,12 +147,66 @@ class Command: public QObject {
      */
     bool canceled() const { return cancellationToken_.cancellationRequested(); }
 
+    /**
+     * \return Name of the stage the command is executing, empty if none was reported yet.
+     */
+    const QString &progressStage() const { return progressStage_; }
+
+    /**
+     * \return Number of completed units of work of the current stage.
+     */
+    qint64 progressCompleted() const { return progressCompleted_; }
+
+    /**
+     * \return Total number of units of work of the current stage, zero if unknown.
+     */
+    qint64 progressTotal() const { return progressTotal_; }
+
+    /**
+     * \return Estimated number of milliseconds until the end of the current stage, or -1 if unknown.
+     */
+    qint64 progressEta() const { return progressEta_; }
+
     /**
      * \return True if the command does not prevent the user from doing something else,
      *         false (default) otherwise.
      */
     bool isBackground() const { return isBackground_; }
 
+    /**
+     * \return Priority of the command. Among the commands ready for execution,
+     *         the ones with higher priority are started first.
+     */
+    int priority() const { return priority_; }
+
+    /**
+     * Sets the priority of the command.
+     *
+     * \param priority New priority.
+     */
+    void setPriority(int priority) { priority_ = priority; }
+
+    /**
+     * Makes the command wait for the given one to finish before starting.
+     * A dependency that is canceled and deleted is considered finished.
+     *
+     * \param command Valid pointer to a command that has already been pushed to a command queue.
+     */
+    void addDependency(Command *command);
+
+    /**
+     * \return True if all the commands this one depends on have finished.
+     */
+    bool ready() const;
+
+    /**
+     * \param command Another command.
+     *
+     * \return True if scheduling this command makes the given one stale,
+     *         so that it must be canceled, false (default) otherwise.
+     */
+    virtual bool supersedes(const Command &command) const;
+
     Q_SIGNALS:
 
     /**
@@ -126,6 +214,11 @@ class Command: public QObject {
      */
     void finished();
 
+    /**
+     * Signal emitted when the command reports its progress.
+     */
+    void progressChanged();
+
     protected:
 
     /**
@@ -147,6 +240,12 @@ class Command: public QObject {
      */
     const CancellationToken &cancellationToken() const { return cancellationToken_; }
 
+    /**
+     * \return Progress token for this command. Commands running concurrently
+     *         have different tokens, so that they do not reset each other's stages.
+     */
+    const ProgressToken &progressToken() const { return progressToken_; }
+
     /**
      * Sets whether the command prevents the user from doing something else.
      *
@@ -160,6 +259,16 @@ class Command: public QObject {
      * This slot is called when an activity is finished.
      */
     void activityFinished();
+
+    /**
+     * This slot is called when the command reports its progress.
+     *
+     * \param stage Name of the stage.
+     * \param completed Number of completed units of work.
+     * \param total Total number of units of work, zero if unknown.
+     * \param eta Estimated number of milliseconds until the end of the stage, or -1 if unknown.
+     */
+    void setProgress(const QString &stage, qint64 completed, qint64 total, qint64 eta);
 };
 
 }} // namespace nc::gui
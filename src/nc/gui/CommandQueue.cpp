@@ -24,8 +24,11 @@
 
 #include "CommandQueue.h"
 
+#include <algorithm>
 #include <cassert>
 
+#include <nc/common/Foreach.h>
+
 #include "Command.h"
 
 namespace nc {
@@ -42,52 +45,95 @@ CommandQueue::~CommandQueue() {
 void CommandQueue::push(std::unique_ptr<Command> command) {
     assert(command);
 
+    /* Drop the work the new command makes stale. */
+    for (auto i = queue_.begin(); i != queue_.end();) {
+        if (command->supersedes(**i)) {
+            i = queue_.erase(i);
+        } else {
+            ++i;
+        }
+    }
+    for (auto i = running_.begin(); i != running_.end();) {
+        if (command->supersedes(**i)) {
+            (*i)->cancel();
+            i = running_.erase(i);
+        } else {
+            ++i;
+        }
+    }
+
     queue_.push_back(std::move(command));
     executeNext();
 }
 
+bool CommandQueue::hasForegroundCommands() const {
+    foreach (const auto &command, running_) {
+        if (!command->isBackground()) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void CommandQueue::cancel() {
-    if (front()) {
-        front()->cancel();
+    foreach (const auto &command, running_) {
+        command->cancel();
     }
 }
 
 void CommandQueue::clear() {
     if (!empty()) {
         cancel();
-        front_.reset();
+        running_.clear();
         queue_.clear();
         Q_EMIT idle();
     }
 }
 
 void CommandQueue::executeNext() {
-    if (front()) {
-        /* Some command is already being executed. */
-        return;
-    } else if (queue_.empty()) {
-        /* No commands left. */
-        Q_EMIT idle();
-    } else {
-        /* Pop the front command. */
-        front_ = std::move(queue_.front());
-        queue_.pop_front();
+    while (true) {
+        /* Find the oldest ready command with the highest priority. */
+        auto next = queue_.end();
+        for (auto i = queue_.begin(); i != queue_.end(); ++i) {
+            if ((*i)->ready() && (next == queue_.end() || (*i)->priority() > (*next)->priority())) {
+                next = i;
+            }
+        }
+
+        if (next == queue_.end()) {
+            break;
+        }
+
+        /* Make sure the command is not deleted while we are executing it. */
+        std::shared_ptr<Command> command(std::move(*next));
+        queue_.erase(next);
+        running_.push_back(command);
 
         /* Notify everybody. */
         Q_EMIT nextCommand();
 
-        /* Make sure the command is not deleted while we are executing it. */
-        auto command = front_;
-
         /* Execute it. */
-        connect(command.get(), SIGNAL(finished()), this, SLOT(commandFinished()), Qt::QueuedConnection);
+        connect(command.get(), SIGNAL(finished()), this, SLOT(removeFinished()), Qt::QueuedConnection);
+        connect(command.get(), SIGNAL(progressChanged()), this, SIGNAL(progressChanged()));
         command->execute();
     }
+
+    if (empty()) {
+        /* No commands left. */
+        Q_EMIT idle();
+    }
 }
 
-void CommandQueue::commandFinished() {
-    assert(front_ != nullptr);
-    front_.reset();
+void CommandQueue::removeFinished() {
+    /* The sender is only compared, as it might have been superseded and deleted already. */
+    QObject *command = sender();
+
+    running_.erase(std::remove_if(running_.begin(), running_.end(),
+        [command](const std::shared_ptr<Command> &running) { return static_cast<QObject *>(running.get()) == command; }), running_.end());
+
+    if (!empty()) {
+        Q_EMIT commandFinished();
+    }
     executeNext();
 }
 
@@ -29,6 +29,7 @@
 
 #include <memory>
 #include <deque>
+#include <vector>
 
 namespace nc {
 namespace gui {
@@ -36,16 +37,23 @@ namespace gui {
 class Command;
 
 /**
- * Command for executing a sequence of commands.
+ * Scheduler of commands.
+ *
+ * A command is started as soon as all the commands it depends on have
+ * finished, so independent commands run concurrently. Among the commands
+ * ready to start, the ones with higher priority go first, and the ones
+ * pushed earlier go first among the commands with equal priority.
+ * A pushed command cancels and removes the pending and running commands
+ * it supersedes.
  */
 class CommandQueue: public QObject {
     Q_OBJECT
 
-    /** Command queue. */
+    /** Commands waiting to be started, in the order of pushing. */
     std::deque<std::unique_ptr<Command>> queue_;
 
-    /** First element of the queue. */
-    std::shared_ptr<Command> front_;
+    /** Commands being executed. */
+    std::vector<std::shared_ptr<Command>> running_;
 
     public:
 
@@ -59,7 +67,7 @@ class CommandQueue: public QObject {
     /**
      * Destructor.
      *
-     * Cancels currently executing command.
+     * Cancels currently executing commands.
      */
     ~CommandQueue();
 
@@ -71,24 +79,30 @@ class CommandQueue: public QObject {
     void push(std::unique_ptr<Command> command);
 
     /**
-     * \return Pointer to the first element of the queue. Can be nullptr if the queue is empty.
+     * \return Commands being executed.
+     */
+    const std::vector<std::shared_ptr<Command>> &running() const { return running_; }
+
+    /**
+     * \return True if no commands are being executed or waiting, false otherwise.
      */
-    Command *front() const { return front_.get(); }
+    bool empty() const { return running_.empty() && queue_.empty(); }
 
     /**
-     * \return True if the queue is empty, false otherwise.
+     * \return True if some of the commands being executed prevent the user
+     *         from doing something else, false otherwise.
      */
-    bool empty() const { return front() == nullptr; }
+    bool hasForegroundCommands() const;
 
     public Q_SLOTS:
 
     /**
-     * Cancels currently executed command.
+     * Cancels currently executed commands.
      */
     void cancel();
 
     /**
-     * Cancels currently executed command and clears the queue.
+     * Cancels currently executed commands and clears the queue.
      */
     void clear();
 
@@ -99,24 +113,34 @@ class CommandQueue: public QObject {
      */
     void nextCommand();
 
+    /**
+     * This signal is emitted when a command has finished, but the queue is not empty.
+     */
+    void commandFinished();
+
     /**
      * This signal is emitted when the queue queue becomes empty.
      */
     void idle();
 
+    /**
+     * This signal is emitted when a command being executed reports its progress.
+     */
+    void progressChanged();
+
     private:
 
     /**
-     * Executes the next instruction in the queue.
+     * Starts all the commands that are ready.
      */
     void executeNext();
 
     private Q_SLOTS:
 
     /**
-     * Slot called when an activity is finished.
+     * Slot called when a command is finished.
      */
-    void commandFinished();
+    void removeFinished();
 };
 
 }} // namespace nc::gui
@@ -28,7 +28,6 @@
 #include <boost/array.hpp>
 
 #include <QSyntaxHighlighter>
-#include <QSet>
 #include <QWidget>
 
 QT_BEGIN_NAMESPACE
@@ -119,7 +118,11 @@ private:
 };
 
 /**
- * Syntax highlighter for C++.
+ * Syntax highlighter for C++ listings.
+ *
+ * The formats of the blocks are looked up in the format run table of
+ * the CxxDocument being highlighted, which is computed from the tree
+ * the listing was printed from. Other documents are not highlighted.
  */
 class CppSyntaxHighlighter: public QSyntaxHighlighter {
     Q_OBJECT
@@ -141,32 +144,6 @@ protected:
     virtual void highlightBlock(const QString &text) override;
 
 private:
-    bool processState(const QString &text, int *startPos, int *endPos);
-
-    void processRegexp(QRegExp &regexp, CxxFormatting::Element element, const QString &text, int startPos = 0);
-
-    void processRegexps(const QString &text, int startPos = 0);
-
-    bool processPreprocessor(const QString &text);
-
-    void processEscapeChar(const QString &text, int start = 0, int len = 0);
-
-    int findStringEnd(const QString &text, int startPos = 0, QChar strChar = '"');
-
-    int findMultilineCommentEnd(const QString &text, int startPos = 0);
-
-    /** Keywords. */ 
-    QSet<QString> mKeywords;
-
-    /* Regular expressions. */
-    QRegExp mIncludeRegexp;
-    QRegExp mMacroRegexp;
-    QRegExp mMultilineMacroRegexp;
-    QRegExp mSpecialRegexp;
-    QRegExp mNumberRegexp;
-    QRegExp mOperatorRegexp;
-    QRegExp mTextRegexp;
-
     const CxxFormatting *formatting_;
 };
 
@@ -24,11 +24,21 @@
 
 #include "CxxDocument.h"
 
+#include <QMutex>
+#include <QMutexLocker>
 #include <QPlainTextDocumentLayout>
-#include <QTextStream>
+#include <QRunnable>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <nc/common/CheckedCast.h>
 
 #include <nc/core/Context.h>
 
+#include <nc/core/arch/Instruction.h>
+
 #include <nc/core/ir/Statement.h>
 #include <nc/core/ir/Term.h>
 
@@ -39,6 +49,7 @@
 #include <nc/core/likec/LabelDeclaration.h>
 #include <nc/core/likec/LabelIdentifier.h>
 #include <nc/core/likec/LabelStatement.h>
+#include <nc/core/likec/ParallelTreePrinter.h>
 #include <nc/core/likec/Statement.h>
 #include <nc/core/likec/Tree.h>
 #include <nc/core/likec/VariableDeclaration.h>
@@ -50,29 +61,29 @@ namespace nc { namespace gui {
 
 namespace {
 
-QString printTree(const core::likec::Tree &tree, RangeTree &rangeTree) {
-    class Callback: public PrintCallback<const core::likec::TreeNode *> {
-        RangeTreeBuilder builder_;
-        const QString &out_;
+/** Maximal number of characters added to the document at once while loading. */
+const int CHUNK_SIZE = 1 << 16;
 
-    public:
-        Callback(RangeTree &tree, const QString &out) : builder_(tree), out_(out) {}
+void buildRangeTree(const std::vector<core::likec::PrintedNode> &printedNodes, RangeTree &rangeTree) {
+    RangeTreeBuilder builder(rangeTree);
+    std::vector<std::size_t> stack;
 
-        void onStartPrinting(const core::likec::TreeNode *node) override {
-            builder_.onStart((void *)(node), out_.size());
-        }
-        void onEndPrinting(const core::likec::TreeNode *node) override {
-            builder_.onEnd((void *)(node), out_.size());
-        }
-    };
+    for (std::size_t i = 0; i < printedNodes.size(); ++i) {
+        const auto &printedNode = printedNodes[i];
 
-    QString result;
-    QTextStream stream(&result);
-    Callback callback(rangeTree, result);
+        while (!stack.empty() && stack.back() != printedNode.parent) {
+            builder.onEnd((void *)printedNodes[stack.back()].node, printedNodes[stack.back()].end);
+            stack.pop_back();
+        }
 
-    tree.print(stream, &callback);
+        builder.onStart((void *)printedNode.node, printedNode.begin);
+        stack.push_back(i);
+    }
 
-    return result;
+    while (!stack.empty()) {
+        builder.onEnd((void *)printedNodes[stack.back()].node, printedNodes[stack.back()].end);
+        stack.pop_back();
+    }
 }
 
 inline const core::likec::TreeNode *getNode(const RangeNode *rangeNode) {
@@ -81,27 +92,100 @@ inline const core::likec::TreeNode *getNode(const RangeNode *rangeNode) {
 
 } // anonymous namespace
 
-CxxDocument::CxxDocument(QObject *parent, std::shared_ptr<const core::Context> context):
-    QTextDocument(parent), context_(std::move(context))
-{
-    setDocumentLayout(new QPlainTextDocumentLayout(this));
+/**
+ * Prints the tree and computes the mappings in a background thread.
+ * The results are handed to the document via queued calls of its slots.
+ */
+class CxxDocument::Builder {
+public:
+    QMutex mutex; ///< Mutex guarding the document pointer.
+    CxxDocument *document; ///< The document being built. nullptr if it was destroyed.
+    std::shared_ptr<const core::Context> context; ///< Context with the tree.
+
+    /* The results. The members of the document with the same names are swapped with them. */
+    QString text;
+    FormatRunTable formatRuns;
+    RangeTree rangeTree;
+    NodeIndex nodeIndex;
+    boost::unordered_map<const core::likec::Declaration *, std::vector<const core::likec::TreeNode *>> declaration2uses;
+    boost::unordered_map<const core::likec::LabelDeclaration *, const core::likec::LabelStatement *> label2statement;
+    boost::unordered_map<const core::likec::FunctionDeclaration *, const core::likec::FunctionDefinition *> functionDeclaration2definition;
+    bool mappingsComputed; ///< True if the mappings are computed. Guarded by the mutex.
+
+    Builder(CxxDocument *document, std::shared_ptr<const core::Context> context):
+        document(document), context(std::move(context)), mappingsComputed(false)
+    {}
+
+    /**
+     * Starts building in the global thread pool.
+     *
+     * \param builder Valid pointer to the builder.
+     */
+    static void start(const std::shared_ptr<Builder> &builder) {
+        class Runnable: public QRunnable {
+            std::shared_ptr<Builder> builder_;
+
+        public:
+            Runnable(std::shared_ptr<Builder> builder): builder_(std::move(builder)) {}
+
+            void run() override { builder_->run(); }
+        };
+
+        QThreadPool::globalInstance()->start(new Runnable(builder));
+    }
 
-    if (context_ && context_->tree()) {
-        setPlainText(printTree(*context_->tree(), rangeTree_));
-        if (rangeTree_.root()) {
-            computeReverseMappings(rangeTree_.root());
+private:
+    void run() {
+        std::vector<core::likec::PrintedNode> printedNodes;
+        QString printedText = core::likec::ParallelTreePrinter::print(context->tree()->root(), printedNodes, context->workerCount());
+
+        buildRangeTree(printedNodes, rangeTree);
+        printedNodes = std::vector<core::likec::PrintedNode>();
+
+        /* The formats are needed as soon as the text is shown. */
+        FormatRunTable printedFormatRuns;
+        printedFormatRuns.compute(rangeTree, printedText);
+
+        if (!notify("onTextPrinted", [&]() {
+            text = std::move(printedText);
+            formatRuns.swap(printedFormatRuns);
+        })) {
+            return;
+        }
+
+        if (rangeTree.root()) {
+            computeReverseMappings(rangeTree.root());
         }
+        nodeIndex.finish();
+
+        notify("onMappingsComputed", [&]() { mappingsComputed = true; });
     }
 
-    connect(this, SIGNAL(contentsChange(int, int, int)), this, SLOT(onContentsChange(int, int, int)));
-}
+    /**
+     * If the document still exists, publishes the results and queues a call of the document's slot.
+     *
+     * \return False if the document was destroyed.
+     */
+    template<class Publish>
+    bool notify(const char *slot, Publish publish) {
+        QMutexLocker locker(&mutex);
+        if (!document) {
+            return false;
+        }
+        publish();
+        QMetaObject::invokeMethod(document, slot, Qt::QueuedConnection);
+        return true;
+    }
 
-void CxxDocument::computeReverseMappings(const RangeNode *rangeNode) {
+    void computeReverseMappings(const RangeNode *rangeNode);
+};
+
+void CxxDocument::Builder::computeReverseMappings(const RangeNode *rangeNode) {
     assert(rangeNode != nullptr);
 
     auto node = getNode(rangeNode);
 
-    node2rangeNode_[node] = rangeNode;
+    nodeIndex.addNode(node, rangeNode);
 
     const core::ir::Statement *statement;
     const core::ir::Term *term;
@@ -110,22 +194,22 @@ void CxxDocument::computeReverseMappings(const RangeNode *rangeNode) {
     getOrigin(node, statement, term, instruction);
 
     if (instruction) {
-        instruction2rangeNodes_[instruction].push_back(rangeNode);
+        nodeIndex.addAddress(instruction->addr(), rangeNode);
     }
 
     if (auto declaration = getDeclarationOfIdentifier(node)) {
-        declaration2uses_[declaration].push_back(node);
+        declaration2uses[declaration].push_back(node);
     }
 
     if (auto declaration = node->as<core::likec::Declaration>()) {
         if (auto definition = declaration->as<core::likec::FunctionDefinition>()) {
-            functionDeclaration2definition_[definition->getFirstDeclaration()] = definition;
+            functionDeclaration2definition[definition->getFirstDeclaration()] = definition;
         }
     }
 
     if (auto *statement = node->as<core::likec::Statement>()) {
         if (auto *labelStatement = statement->as<core::likec::LabelStatement>()) {
-            label2statement_[labelStatement->identifier()->declaration()] = labelStatement;
+            label2statement[labelStatement->identifier()->declaration()] = labelStatement;
         }
     }
 
@@ -134,6 +218,97 @@ void CxxDocument::computeReverseMappings(const RangeNode *rangeNode) {
     }
 }
 
+CxxDocument::CxxDocument(QObject *parent, std::shared_ptr<const core::Context> context):
+    QTextDocument(parent), context_(std::move(context)), pendingPosition_(-1)
+{
+    setDocumentLayout(new QPlainTextDocumentLayout(this));
+
+    if (context_ && context_->tree()) {
+        setUndoRedoEnabled(false);
+        builder_ = std::make_shared<Builder>(this, context_);
+        Builder::start(builder_);
+    }
+
+    connect(this, SIGNAL(contentsChange(int, int, int)), this, SLOT(onContentsChange(int, int, int)));
+}
+
+CxxDocument::~CxxDocument() {
+    if (builder_) {
+        QMutexLocker locker(&builder_->mutex);
+        builder_->document = nullptr;
+    }
+}
+
+void CxxDocument::onTextPrinted() {
+    assert(builder_);
+
+    {
+        QMutexLocker locker(&builder_->mutex);
+        pendingText_ = std::move(builder_->text);
+        formatRuns_.swap(builder_->formatRuns);
+    }
+    pendingPosition_ = 0;
+
+    appendPendingText();
+}
+
+void CxxDocument::appendPendingText() {
+    int end = pendingPosition_ + CHUNK_SIZE;
+    if (end < pendingText_.size()) {
+        /* Prefer adding whole lines. */
+        int newline = pendingText_.lastIndexOf('\n', end);
+        if (newline >= pendingPosition_) {
+            end = newline + 1;
+        }
+    } else {
+        end = pendingText_.size();
+    }
+
+    QTextCursor cursor(this);
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText(pendingText_.mid(pendingPosition_, end - pendingPosition_));
+    pendingPosition_ = end;
+
+    if (pendingPosition_ < pendingText_.size()) {
+        /* Let the GUI thread process events before adding the next chunk. */
+        QTimer::singleShot(0, this, SLOT(appendPendingText()));
+    } else {
+        pendingText_ = QString();
+        finishLoading();
+    }
+}
+
+void CxxDocument::onMappingsComputed() {
+    finishLoading();
+}
+
+void CxxDocument::finishLoading() {
+    assert(builder_);
+
+    bool textComplete = pendingPosition_ >= 0 && pendingText_.isEmpty();
+    if (!textComplete) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&builder_->mutex);
+        if (!builder_->mappingsComputed) {
+            return;
+        }
+    }
+
+    rangeTree_.swap(builder_->rangeTree);
+    nodeIndex_.swap(builder_->nodeIndex);
+    declaration2uses_.swap(builder_->declaration2uses);
+    label2statement_.swap(builder_->label2statement);
+    functionDeclaration2definition_.swap(builder_->functionDeclaration2definition);
+
+    builder_.reset();
+    setUndoRedoEnabled(true);
+
+    Q_EMIT loaded();
+}
+
 const core::likec::TreeNode *CxxDocument::getLeafAt(int position) const {
     if (auto rangeNode = rangeTree_.getLeafAt(position)) {
         return getNode(rangeNode);
@@ -156,7 +331,7 @@ std::vector<const core::likec::TreeNode *> CxxDocument::getNodesIn(const Range<i
 
 Range<int> CxxDocument::getRange(const core::likec::TreeNode *node) const {
     assert(node != nullptr);
-    if (auto rangeNode = nc::find(node2rangeNode_, node)) {
+    if (auto rangeNode = nodeIndex_.getRangeNode(node)) {
         return rangeTree_.getRange(rangeNode);
     }
     return Range<int>();
@@ -165,22 +340,55 @@ Range<int> CxxDocument::getRange(const core::likec::TreeNode *node) const {
 void CxxDocument::getRanges(const core::arch::Instruction *instruction, std::vector<Range<int>> &result) const {
     assert(instruction != nullptr);
 
-    const auto &rangeNodes = nc::find(instruction2rangeNodes_, instruction);
+    getRanges(Range<ByteAddr>(instruction->addr(), instruction->addr() + 1), result);
+}
 
-    foreach (auto rangeNode, rangeNodes) {
-        if (auto range = rangeTree_.getRange(rangeNode)) {
+void CxxDocument::getRanges(const Range<ByteAddr> &addresses, std::vector<Range<int>> &result) const {
+    foreach (const auto &entry, nodeIndex_.getEntries(addresses)) {
+        if (auto range = rangeTree_.getRange(entry.rangeNode)) {
             result.push_back(range);
         }
     }
 }
 
 void CxxDocument::onContentsChange(int position, int charsRemoved, int charsAdded) {
+    /*
+     * The range tree is computed for the complete text. Until then, the
+     * only changes are the appended chunks of it: views keep the document
+     * read-only while it is loading.
+     */
+    if (builder_) {
+        return;
+    }
+
     if (charsRemoved > 0) {
         rangeTree_.handleRemoval(position, charsRemoved);
     }
     if (charsAdded > 0) {
         rangeTree_.handleInsertion(position, charsAdded);
     }
+
+    /*
+     * The formats of the changed blocks are updated before the highlighter,
+     * connected to this signal after us, rehighlights them.
+     */
+    if (!formatRuns_.empty()) {
+        auto first = findBlock(position);
+        auto last = findBlock(position + charsAdded);
+
+        std::vector<int> positions;
+        for (auto block = first; block != last; block = block.next()) {
+            positions.push_back(block.position());
+        }
+        positions.push_back(last.position());
+        positions.push_back(last.next().isValid() ? last.next().position() : last.position() + last.length() - 1);
+
+        std::size_t newBlockCount = positions.size() - 1;
+        std::size_t oldBlockCount = newBlockCount + formatRuns_.blockCount() - checked_cast<std::size_t>(blockCount());
+
+        formatRuns_.update(rangeTree_, first.blockNumber(), oldBlockCount, positions,
+                           [this](const Range<int> &range) { return getText(range); });
+    }
 }
 
 void CxxDocument::rename(const core::likec::Declaration *declaration, const QString &newName) {
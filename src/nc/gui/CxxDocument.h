@@ -35,6 +35,8 @@
 #include <nc/common/Range.h>
 #include <nc/common/Types.h>
 
+#include "FormatRunTable.h"
+#include "NodeIndex.h"
 #include "RangeTree.h"
 
 namespace nc {
@@ -65,14 +67,25 @@ namespace gui {
 
 /**
  * Text document containing C++ listing.
+ *
+ * The listing is printed and the mappings between the text, tree nodes, and
+ * instructions are computed in a background thread. The printed text is added
+ * to the document in chunks, so that it is shown before it is complete
+ * without blocking the GUI thread. The mappings are available after the
+ * loaded() signal is emitted.
  */
 class CxxDocument: public QTextDocument {
     Q_OBJECT
 
+    class Builder;
+
     std::shared_ptr<const core::Context> context_;
+    std::shared_ptr<Builder> builder_; ///< Builder of the text and the mappings. nullptr when loading is finished.
+    QString pendingText_; ///< Printed text being added to the document.
+    int pendingPosition_; ///< Index of the first character of pendingText_ not added to the document yet, -1 if the text is not printed yet.
     RangeTree rangeTree_;
-    boost::unordered_map<const core::likec::TreeNode *, const RangeNode *> node2rangeNode_;
-    boost::unordered_map<const core::arch::Instruction *, std::vector<const RangeNode *>> instruction2rangeNodes_;
+    FormatRunTable formatRuns_; ///< Formats of the text blocks.
+    NodeIndex nodeIndex_; ///< Range nodes by tree nodes and instruction addresses.
     boost::unordered_map<const core::likec::Declaration *, std::vector<const core::likec::TreeNode *>> declaration2uses_;
     boost::unordered_map<const core::likec::LabelDeclaration *, const core::likec::LabelStatement *> label2statement_;
     boost::unordered_map<const core::likec::FunctionDeclaration *, const core::likec::FunctionDefinition *> functionDeclaration2definition_;
@@ -86,6 +99,18 @@ public:
      */
     explicit CxxDocument(QObject *parent = nullptr, std::shared_ptr<const core::Context> context = nullptr);
 
+    ~CxxDocument();
+
+    /**
+     * \return True if the text or the mappings are not complete yet.
+     */
+    bool isLoading() const { return builder_ != nullptr; }
+
+    /**
+     * \return Formats of the text blocks. Available as soon as the text starts being added.
+     */
+    const FormatRunTable &formatRuns() const { return formatRuns_; }
+
     /**
      * \return Pointer to the deepest tree node at the given position. Can be nullptr.
      */
@@ -109,6 +134,13 @@ public:
      */
     void getRanges(const core::arch::Instruction *instruction, std::vector<Range<int>> &result) const;
 
+    /**
+     * \param addresses Range of instruction addresses.
+     * \param[out] result List of ranges occupied by the nodes generated from
+     *                    the instructions starting in the given range.
+     */
+    void getRanges(const Range<ByteAddr> &addresses, std::vector<Range<int>> &result) const;
+
     /**
      * \param declaration Valid pointer to a declaration tree node.
      *
@@ -167,11 +199,20 @@ public:
      */
     static const core::likec::Declaration *getDeclarationOfIdentifier(const core::likec::TreeNode *node);
 
+Q_SIGNALS:
+    /**
+     * Signal emitted when the text is complete and the mappings are computed.
+     */
+    void loaded();
+
 private Q_SLOTS:
     void onContentsChange(int position, int charsRemoved, int charsAdded);
+    void onTextPrinted();
+    void onMappingsComputed();
+    void appendPendingText();
 
 private:
-    void computeReverseMappings(const RangeNode *rangeNode);
+    void finishLoading();
     void replaceText(const Range<int> &range, const QString &text);
 };
 
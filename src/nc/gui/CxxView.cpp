@@ -24,12 +24,15 @@
 
 #include "CxxView.h"
 
+#include <algorithm>
+
 #include <QAction>
 #include <QInputDialog>
 #include <QMenu>
 #include <QPlainTextEdit>
 
 #include <nc/common/StringToInt.h>
+#include <nc/core/arch/Instruction.h>
 #include <nc/core/likec/Expression.h>
 #include <nc/core/likec/FunctionDefinition.h>
 #include <nc/core/likec/LabelDeclaration.h>
@@ -93,10 +96,26 @@ void CxxView::setDocument(CxxDocument *document) {
     /* No signals until we are in a consistent state. */
     textEdit()->blockSignals(true);
 
+    /* A document replaced while loading must not make the new one editable. */
+    if (document_) {
+        disconnect(document_, SIGNAL(loaded()), this, SLOT(onDocumentLoaded()));
+    }
+
     TextView::setDocument(document);
     highlighter_->setDocument(document);
     document_ = document;
 
+    /*
+     * The range tree is built for the complete printed text,
+     * so the text cannot be edited until then.
+     */
+    textEdit()->setReadOnly(document && document->isLoading());
+
+    if (document) {
+        /* Nodes can be selected only when the mappings are computed. */
+        connect(document, SIGNAL(loaded()), this, SLOT(onDocumentLoaded()));
+    }
+
     textEdit()->blockSignals(false);
 
     updateSelection();
@@ -106,6 +125,15 @@ void CxxView::rehighlight() {
     highlighter_->rehighlight();
 }
 
+void CxxView::onDocumentLoaded() {
+    if (sender() != document_ || !document_ || document_->isLoading()) {
+        return;
+    }
+
+    textEdit()->setReadOnly(false);
+    updateSelection();
+}
+
 void CxxView::updateSelection() {
     std::vector<const core::likec::TreeNode *> nodes;
     std::vector<const core::ir::Statement *> statements;
@@ -276,10 +304,26 @@ void CxxView::highlightInstructions(const std::vector<const core::arch::Instruct
         return;
     }
 
+    /*
+     * A selection in the instructions view is mostly a run of adjacent
+     * instructions, which is looked up in the document as a single range.
+     */
+    std::vector<Range<ByteAddr>> addresses;
+    addresses.reserve(instructions.size());
+    foreach (const core::arch::Instruction *instruction, instructions) {
+        addresses.push_back(Range<ByteAddr>(instruction->addr(), instruction->endAddr()));
+    }
+    std::sort(addresses.begin(), addresses.end());
+
     std::vector<Range<int>> ranges;
 
-    foreach (const core::arch::Instruction *instruction, instructions) {
-        document()->getRanges(instruction, ranges);
+    for (std::size_t i = 0; i < addresses.size();) {
+        ByteAddr begin = addresses[i].start();
+        ByteAddr end = addresses[i].end();
+        for (++i; i < addresses.size() && addresses[i].start() <= end; ++i) {
+            end = std::max(end, addresses[i].end());
+        }
+        document()->getRanges(Range<ByteAddr>(begin, end), ranges);
     }
 
     highlight(std::move(ranges), ensureVisible);
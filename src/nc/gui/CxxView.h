@@ -193,6 +193,11 @@ private Q_SLOTS:
      */
     void updateSelection();
 
+    /**
+     * Makes the text editable once the document is loaded and updates the selections.
+     */
+    void onDocumentLoaded();
+
     /**
      * Highlights all references of the identifier under cursor.
      */
@@ -30,6 +30,8 @@
 
 #include <nc/core/Context.h>
 
+#include "DecompileAll.h"
+#include "DecompileFunction.h"
 #include "Decompilation.h"
 #include "Project.h"
 
@@ -46,12 +48,19 @@ Decompile::Decompile(Project *project, const std::shared_ptr<const core::arch::I
     setBackground(true);
 }
 
+bool Decompile::supersedes(const Command &command) const {
+    return qobject_cast<const Decompile *>(&command) ||
+           qobject_cast<const DecompileAll *>(&command) ||
+           qobject_cast<const DecompileFunction *>(&command);
+}
+
 void Decompile::work() {
     auto context = std::make_shared<core::Context>();
     context->setImage(project_->image());
     context->setInstructions(instructions_);
     context->setCancellationToken(cancellationToken());
     context->setLogToken(project_->logToken());
+    context->setProgressToken(progressToken());
 
     project_->setContext(context);
 
@@ -61,6 +61,11 @@ class Decompile: public Command {
      */
     Decompile(Project *project, const std::shared_ptr<const core::arch::Instructions> &instructions);
 
+    /**
+     * A decompilation supersedes all other decompilations, as it replaces the current context.
+     */
+    bool supersedes(const Command &command) const override;
+
     protected:
 
     void work() override;
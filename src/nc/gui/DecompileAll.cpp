@@ -30,6 +30,8 @@
 
 #include <nc/core/Context.h>
 
+#include "Decompile.h"
+#include "DecompileFunction.h"
 #include "Decompilation.h"
 #include "Project.h"
 
@@ -45,12 +47,19 @@ DecompileAll::DecompileAll(Project *project):
     setBackground(true);
 }
 
+bool DecompileAll::supersedes(const Command &command) const {
+    return qobject_cast<const Decompile *>(&command) ||
+           qobject_cast<const DecompileAll *>(&command) ||
+           qobject_cast<const DecompileFunction *>(&command);
+}
+
 void DecompileAll::work() {
     auto context = std::make_shared<core::Context>();
     context->setImage(project_->image());
     context->setInstructions(project_->instructions());
     context->setCancellationToken(cancellationToken());
     context->setLogToken(project_->logToken());
+    context->setProgressToken(progressToken());
 
     project_->setContext(context);
 
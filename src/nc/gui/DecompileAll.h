@@ -55,6 +55,11 @@ class DecompileAll: public Command {
      */
     explicit DecompileAll(Project *project);
 
+    /**
+     * A decompilation supersedes all other decompilations, as it replaces the current context.
+     */
+    bool supersedes(const Command &command) const override;
+
     protected:
 
     void work() override;
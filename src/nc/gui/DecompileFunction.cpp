@@ -0,0 +1,54 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "DecompileFunction.h"
+
+#include <cassert>
+
+#include <nc/common/make_unique.h>
+
+#include <nc/core/Context.h>
+
+#include "Decompile.h"
+#include "DecompileAll.h"
+#include "FunctionDecompilation.h"
+#include "Project.h"
+
+namespace nc {
+namespace gui {
+
+DecompileFunction::DecompileFunction(Project *project, ByteAddr address, bool isEntry):
+    project_(project),
+    address_(address),
+    isEntry_(isEntry)
+{
+    assert(project);
+
+    setBackground(true);
+}
+
+bool DecompileFunction::supersedes(const Command &command) const {
+    if (priority() < HIGH_PRIORITY) {
+        return false;
+    }
+    if (auto decompileFunction = qobject_cast<const DecompileFunction *>(&command)) {
+        /* A function already being decompiled will be needed soon anyway. */
+        return decompileFunction->priority() >= HIGH_PRIORITY && !decompileFunction->executing();
+    }
+    return qobject_cast<const Decompile *>(&command) || qobject_cast<const DecompileAll *>(&command);
+}
+
+void DecompileFunction::work() {
+    auto context = std::make_shared<core::Context>();
+    context->setImage(project_->image());
+    context->setInstructions(project_->instructions());
+    context->setCancellationToken(cancellationToken());
+    context->setLogToken(project_->logToken());
+    context->setProgressToken(progressToken());
+
+    delegate(std::make_unique<FunctionDecompilation>(context, address_, isEntry_, project_->functionCache()));
+}
+
+}} // namespace nc::gui
+
+/* vim:set et sts=4 sw=4: */
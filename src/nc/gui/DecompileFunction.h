@@ -0,0 +1,64 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <nc/common/Types.h>
+
+#include "Command.h"
+
+namespace nc {
+namespace gui {
+
+class Project;
+
+/**
+ * Command for decompiling a single function and remembering
+ * the results in the project's function cache.
+ */
+class DecompileFunction: public Command {
+    Q_OBJECT
+
+    /** Project. */
+    Project *project_;
+
+    /** Address of an instruction of the function. */
+    ByteAddr address_;
+
+    /** Whether the address is the entry address of the function. */
+    bool isEntry_;
+
+    public:
+
+    /**
+     * Constructor.
+     *
+     * \param project Valid pointer to a project.
+     * \param address Address of an instruction of the function to decompile.
+     * \param isEntry Whether the address is the entry address of the function.
+     */
+    DecompileFunction(Project *project, ByteAddr address, bool isEntry = false);
+
+    /**
+     * \return Address of an instruction of the function to decompile.
+     */
+    ByteAddr address() const { return address_; }
+
+    /**
+     * A decompilation of a function with high priority, i.e. the one the user
+     * is waiting for, supersedes the decompilations of the program, of selected
+     * instructions, and of other functions the user was waiting for, unless
+     * they have already started.
+     */
+    bool supersedes(const Command &command) const override;
+
+    protected:
+
+    void work() override;
+};
+
+}} // namespace nc::gui
+
+/* vim:set et sts=4 sw=4: */
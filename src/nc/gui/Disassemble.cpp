@@ -29,6 +29,7 @@
 #include <nc/common/make_unique.h>
 
 #include <nc/core/Context.h>
+#include <nc/core/arch/Instructions.h>
 
 #include "Disassembly.h"
 #include "Project.h"
@@ -41,20 +42,42 @@ Disassemble::Disassemble(Project *project, const core::image::ByteSource *source
 {
     assert(project);
     assert(source);
+
+    connect(this, SIGNAL(finished()), this, SLOT(addInstructions()));
+}
+
+Disassemble::~Disassemble() {}
+
+bool Disassemble::supersedes(const Command &command) const {
+    auto disassemble = qobject_cast<const Disassemble *>(&command);
+    return disassemble &&
+        disassemble->source_ == source_ &&
+        begin_ <= disassemble->begin_ &&
+        disassemble->end_ <= end_;
 }
 
 void Disassemble::work() {
     project_->logToken().info(tr("Disassembling addresses %2 to %3...").arg(begin_, 0, 16).arg(end_, 0, 16));
 
-    auto context = std::make_shared<core::Context>();
-    context->setImage(project_->image());
-    context->setInstructions(project_->instructions());
-    context->setCancellationToken(cancellationToken());
-    context->setLogToken(project_->logToken());
+    /*
+     * Disassemblies of different ranges run concurrently, so each collects
+     * only the new instructions, which are merged into the project's ones
+     * when it has finished.
+     */
+    context_ = std::make_shared<core::Context>();
+    context_->setImage(project_->image());
+    context_->setCancellationToken(cancellationToken());
+    context_->setLogToken(project_->logToken());
+    context_->setProgressToken(progressToken());
 
-    project_->setContext(context);
+    delegate(std::make_unique<Disassembly>(context_, source_, begin_, end_));
+}
 
-    delegate(std::make_unique<Disassembly>(context, source_, begin_, end_));
+void Disassemble::addInstructions() {
+    if (context_ && !canceled()) {
+        project_->addInstructions(context_->instructions());
+    }
+    context_.reset();
 }
 
 }} // namespace nc::gui
@@ -23,6 +23,8 @@
 
 #include <nc/config.h>
 
+#include <memory>
+
 #include <nc/common/Types.h>
 
 #include "Command.h"
@@ -30,6 +32,8 @@
 namespace nc {
 
 namespace core {
+    class Context;
+
     namespace image {
         class ByteSource;
     }
@@ -57,6 +61,9 @@ class Disassemble: public Command {
     /** Last address in the range to be disassembled. */
     ByteAddr end_;
 
+    /** Context receiving the disassembled instructions. */
+    std::shared_ptr<core::Context> context_;
+
     public:
 
     /**
@@ -69,7 +76,26 @@ class Disassemble: public Command {
      */
     Disassemble(Project *project, const core::image::ByteSource *source, ByteAddr begin, ByteAddr end);
 
+    /**
+     * Destructor.
+     */
+    ~Disassemble();
+
+    /**
+     * A disassembly supersedes the disassemblies of the same or smaller ranges of the same byte source.
+     */
+    bool supersedes(const Command &command) const override;
+
+    protected:
+
     void work() override;
+
+    private Q_SLOTS:
+
+    /**
+     * Adds the disassembled instructions to the project.
+     */
+    void addInstructions();
 };
 
 }} // namespace nc::gui
@@ -0,0 +1,397 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "FormatRunTable.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <QSet>
+
+#include <nc/common/Foreach.h>
+
+#include <nc/core/likec/Expression.h>
+#include <nc/core/likec/TreeNode.h>
+
+#include "RangeTree.h"
+
+namespace nc { namespace gui {
+
+namespace {
+
+/**
+ * Array of all C++ keywords.
+ */
+const char *cppKeywords[] = {
+    "asm",
+    "auto",
+    "bool",
+    "break",
+    "case",
+    "catch",
+    "char",
+    "class",
+    "const",
+    "const_cast",
+    "continue",
+    "default",
+    "delete",
+    "do",
+    "double",
+    "dynamic_cast",
+    "else",
+    "enum",
+    "explicit",
+    "export",
+    "extern",
+    "false",
+    "float",
+    "for",
+    "friend",
+    "goto",
+    "if",
+    "inline",
+    "int",
+    "long",
+    "mutable",
+    "namespace",
+    "new",
+    "operator",
+    "private",
+    "protected",
+    "public",
+    "register",
+    "reinterpret_cast",
+    "return",
+    "short",
+    "signed",
+    "sizeof",
+    "static",
+    "static_cast",
+    "struct",
+    "switch",
+    "template",
+    "this",
+    "throw",
+    "true",
+    "try",
+    "typedef",
+    "typeid",
+    "typename",
+    "union",
+    "unsigned",
+    "using",
+    "virtual",
+    "void",
+    "volatile",
+    "wchar_t",
+    "while",
+    "int8_t",
+    "uint8_t",
+    "int16_t",
+    "uint16_t",
+    "int32_t",
+    "uint32_t",
+    "int64_t",
+    "uint64_t",
+    "__asm__"
+};
+
+bool isKeyword(const QString &word) {
+    static const QSet<QString> keywords = []() {
+        QSet<QString> result;
+        foreach (const char *keyword, cppKeywords) {
+            result.insert(QLatin1String(keyword));
+        }
+        return result;
+    }();
+
+    return keywords.contains(word);
+}
+
+bool isOperator(QChar c) {
+    return c.unicode() != 0 && c.unicode() < 128 && std::strchr("()[]{}:;,.!?/*-+<>%^&|=~", c.toLatin1());
+}
+
+/**
+ * Collects the runs of a text range, given by the absolute positions of their starts.
+ */
+class RunCollector {
+    Range<int> range_;
+    const FormatRunTable::TextGetter &getText_;
+    std::vector<FormatRun> &runs_;
+
+public:
+    /**
+     * \param range Text range to collect the runs of.
+     * \param getText Function returning the text in a given range.
+     * \param runs Array to append the runs to.
+     */
+    RunCollector(const Range<int> &range, const FormatRunTable::TextGetter &getText, std::vector<FormatRun> &runs):
+        range_(range), getText_(getText), runs_(runs)
+    {}
+
+    /**
+     * Collects the runs of the text printed for a node and its descendants.
+     *
+     * \param node Range node.
+     * \param start Absolute position of the node's text.
+     */
+    void collect(const RangeNode &node, int start) {
+        if (auto element = getElement(node)) {
+            if (node.size() == 0) {
+                /* Keep the run, so that the number of runs does not change while an identifier is being replaced. */
+                if (range_.start() <= start && start < range_.end()) {
+                    runs_.push_back(FormatRun(start, 0, *element));
+                }
+            } else {
+                addRun(start, start + node.size(), *element);
+            }
+            return;
+        }
+
+        auto i = std::lower_bound(node.children().begin(), node.children().end(), range_.start() - start,
+                                  [](const RangeNode &child, int offset) { return child.endOffset() < offset; });
+        auto iend = node.children().end();
+
+        int position = i == node.children().begin() ? start : start + (i - 1)->endOffset();
+
+        for (; i != iend && start + i->offset() < range_.end(); ++i) {
+            tokenize(position, start + i->offset());
+            collect(*i, start + i->offset());
+            position = start + i->endOffset();
+        }
+
+        tokenize(position, i == iend ? start + node.size() : start + i->offset());
+    }
+
+private:
+    /**
+     * \param node Range node.
+     *
+     * \return Pointer to the element of the whole text of the node, if it is
+     *         known from the node's kind, nullptr otherwise.
+     */
+    static const CxxFormatting::Element *getElement(const RangeNode &node) {
+        static const CxxFormatting::Element text = CxxFormatting::TEXT;
+        static const CxxFormatting::Element number = CxxFormatting::NUMBER;
+
+        auto expression = static_cast<const core::likec::TreeNode *>(node.data())->as<core::likec::Expression>();
+        if (!expression) {
+            return nullptr;
+        }
+
+        switch (expression->expressionKind()) {
+            case core::likec::Expression::FUNCTION_IDENTIFIER:
+            case core::likec::Expression::LABEL_IDENTIFIER:
+            case core::likec::Expression::VARIABLE_IDENTIFIER:
+            case core::likec::Expression::UNDECLARED_IDENTIFIER:
+                return &text;
+            case core::likec::Expression::INTEGER_CONSTANT:
+                return &number;
+            default:
+                return nullptr;
+        }
+    }
+
+    /**
+     * Adds a run clipped to the collected range, unless it becomes empty.
+     */
+    void addRun(int start, int end, CxxFormatting::Element element) {
+        start = std::max(start, range_.start());
+        end = std::min(end, range_.end());
+        if (start < end) {
+            runs_.push_back(FormatRun(start, end - start, element));
+        }
+    }
+
+    /**
+     * Splits the text printed by a node itself into tokens and adds their runs.
+     *
+     * \param start Absolute position of the text.
+     * \param end Absolute position past the end of the text.
+     */
+    void tokenize(int start, int end) {
+        if (start >= end || end <= range_.start() || range_.end() <= start) {
+            return;
+        }
+
+        QString text = getText_(make_range(start, end));
+        int size = text.size();
+
+        for (int i = 0; i < size;) {
+            QChar c = text[i];
+            int j = i + 1;
+
+            if (c == '/' && j < size && text[j] == '*') {
+                j = text.indexOf(QLatin1String("*/"), j + 1);
+                j = j == -1 ? size : j + 2;
+                addRun(start + i, start + j, CxxFormatting::MULTI_LINE_COMMENT);
+            } else if (c == '/' && j < size && text[j] == '/') {
+                j = text.indexOf('\n', j + 1);
+                j = j == -1 ? size : j;
+                addRun(start + i, start + j, CxxFormatting::SINGLE_LINE_COMMENT);
+            } else if (c == '"' || c == '\'') {
+                while (j < size && text[j] != c) {
+                    j += text[j] == '\\' ? 2 : 1;
+                }
+                j = std::min(j + 1, size);
+                addRun(start + i, start + j, CxxFormatting::STRING);
+                addEscapeChars(text, i, j, start);
+            } else if (c.isLetter() || c == '_') {
+                while (j < size && (text[j].isLetterOrNumber() || text[j] == '_')) {
+                    ++j;
+                }
+                addRun(start + i, start + j, isKeyword(text.mid(i, j - i)) ? CxxFormatting::KEYWORD : CxxFormatting::TEXT);
+            } else if (c.isDigit()) {
+                while (j < size && (text[j].isLetterOrNumber() || text[j] == '.')) {
+                    ++j;
+                }
+                addRun(start + i, start + j, CxxFormatting::NUMBER);
+            } else if (isOperator(c)) {
+                while (j < size && isOperator(text[j]) && !(text[j] == '/' && j + 1 < size && (text[j + 1] == '*' || text[j + 1] == '/'))) {
+                    ++j;
+                }
+                addRun(start + i, start + j, CxxFormatting::OPERATOR);
+            }
+
+            i = j;
+        }
+    }
+
+    /**
+     * Adds the runs of the escape sequences in a string literal.
+     *
+     * \param text Text containing the literal.
+     * \param begin Index of the opening quote.
+     * \param end Index past the closing quote.
+     * \param start Absolute position of the text.
+     */
+    void addEscapeChars(const QString &text, int begin, int end, int start) {
+        for (int i = begin + 1; i < end - 1; ++i) {
+            if (text[i] != '\\') {
+                continue;
+            }
+
+            int j = i + 1;
+            if (j < end - 1 && text[j].toLower() == 'x') {
+                do {
+                    ++j;
+                } while (j < end - 1 && (text[j].isDigit() || (text[j].toLower() >= 'a' && text[j].toLower() <= 'f')));
+            } else if (j < end - 1 && text[j] >= '0' && text[j] <= '7') {
+                do {
+                    ++j;
+                } while (j < end - 1 && j < i + 4 && text[j] >= '0' && text[j] <= '7');
+            } else {
+                j = std::min(j + 1, end - 1);
+            }
+
+            addRun(start + i, start + j, CxxFormatting::ESCAPE_CHAR);
+            i = j - 1;
+        }
+    }
+};
+
+} // anonymous namespace
+
+void FormatRunTable::compute(const RangeTree &tree, const QString &text) {
+    std::vector<int> positions;
+    positions.push_back(0);
+    for (int i = text.indexOf('\n'); i != -1; i = text.indexOf('\n', i + 1)) {
+        positions.push_back(i + 1);
+    }
+    positions.push_back(text.size());
+
+    computeRuns(tree, positions, [&text](const Range<int> &range) { return text.mid(range.start(), range.length()); },
+                runs_, blockStarts_);
+}
+
+void FormatRunTable::update(const RangeTree &tree, std::size_t firstBlock, std::size_t oldBlockCount,
+                            const std::vector<int> &positions, const TextGetter &getText)
+{
+    assert(!empty());
+    assert(firstBlock + oldBlockCount <= blockCount());
+    assert(positions.size() >= 2);
+
+    std::vector<FormatRun> runs;
+    std::vector<std::size_t> blockStarts;
+    computeRuns(tree, positions, getText, runs, blockStarts);
+
+    std::size_t newBlockCount = positions.size() - 1;
+    std::size_t oldBegin = blockStarts_[firstBlock];
+    std::size_t oldEnd = blockStarts_[firstBlock + oldBlockCount];
+
+    if (newBlockCount == oldBlockCount && runs.size() == oldEnd - oldBegin) {
+        std::copy(runs.begin(), runs.end(), runs_.begin() + oldBegin);
+        for (std::size_t i = 0; i < newBlockCount; ++i) {
+            blockStarts_[firstBlock + i] = oldBegin + blockStarts[i];
+        }
+        return;
+    }
+
+    runs_.erase(runs_.begin() + oldBegin, runs_.begin() + oldEnd);
+    runs_.insert(runs_.begin() + oldBegin, runs.begin(), runs.end());
+
+    std::ptrdiff_t shift = static_cast<std::ptrdiff_t>(runs.size()) - static_cast<std::ptrdiff_t>(oldEnd - oldBegin);
+    for (auto i = blockStarts_.begin() + firstBlock + oldBlockCount; i != blockStarts_.end(); ++i) {
+        *i += shift;
+    }
+
+    blockStarts_.erase(blockStarts_.begin() + firstBlock, blockStarts_.begin() + firstBlock + oldBlockCount);
+    for (auto &blockStart : blockStarts) {
+        blockStart += oldBegin;
+    }
+    blockStarts_.insert(blockStarts_.begin() + firstBlock, blockStarts.begin(), blockStarts.end() - 1);
+}
+
+void FormatRunTable::computeRuns(const RangeTree &tree, const std::vector<int> &positions, const TextGetter &getText,
+                                 std::vector<FormatRun> &runs, std::vector<std::size_t> &blockStarts)
+{
+    assert(positions.size() >= 2);
+
+    std::vector<FormatRun> absoluteRuns;
+    if (tree.root()) {
+        RunCollector(make_range(positions.front(), positions.back()), getText, absoluteRuns).collect(*tree.root(), 0);
+    }
+
+    /* Split the runs between the blocks. A run can span several blocks only if it is a comment. */
+    std::vector<std::pair<std::size_t, FormatRun>> pieces;
+    pieces.reserve(absoluteRuns.size());
+
+    foreach (const auto &run, absoluteRuns) {
+        std::size_t block = std::upper_bound(positions.begin(), positions.end() - 1, run.start) - positions.begin();
+        block = block > 0 ? block - 1 : 0;
+
+        int start = run.start;
+        int end = run.start + run.length;
+        do {
+            int pieceEnd = std::min(end, positions[block + 1]);
+            pieces.push_back(std::make_pair(block, FormatRun(start - positions[block], pieceEnd - start, run.element)));
+            start = pieceEnd;
+            ++block;
+        } while (start < end && block + 1 < positions.size());
+    }
+
+    std::stable_sort(pieces.begin(), pieces.end(),
+                     [](const std::pair<std::size_t, FormatRun> &a, const std::pair<std::size_t, FormatRun> &b) {
+                         return a.first < b.first;
+                     });
+
+    runs.clear();
+    runs.reserve(pieces.size());
+    blockStarts.assign(1, 0);
+
+    foreach (const auto &piece, pieces) {
+        while (blockStarts.size() <= piece.first) {
+            blockStarts.push_back(runs.size());
+        }
+        runs.push_back(piece.second);
+    }
+    while (blockStarts.size() < positions.size()) {
+        blockStarts.push_back(runs.size());
+    }
+}
+
+}} // namespace nc::gui
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,130 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <cassert>
+#include <cstddef> /* std::size_t */
+#include <functional>
+#include <vector>
+
+#include <boost/range/iterator_range.hpp>
+
+#include <QString>
+
+#include <nc/common/RangeClass.h>
+
+#include "CppSyntaxHighlighter.h"
+
+namespace nc { namespace gui {
+
+class RangeTree;
+
+/**
+ * Run of characters of a text block having the same format.
+ */
+struct FormatRun {
+    int start;  ///< Position of the first character in the block.
+    int length; ///< Number of characters. Zero for an identifier whose text was removed.
+    CxxFormatting::Element element; ///< Text element giving the format.
+
+    FormatRun(int start, int length, CxxFormatting::Element element):
+        start(start), length(length), element(element)
+    {}
+};
+
+/**
+ * Formats of the text blocks of a C++ listing.
+ *
+ * The formats are computed from the range tree built while printing:
+ * identifiers and integer constants are classified by the kind of their
+ * tree nodes, and only the text printed by the nodes themselves (keywords,
+ * types, operators, strings, and comments) is split into tokens.
+ * The runs of all the blocks are stored in one array, block after block.
+ */
+class FormatRunTable {
+    std::vector<FormatRun> runs_; ///< Runs of all the blocks.
+    std::vector<std::size_t> blockStarts_; ///< Index of the first run of each block, followed by the number of runs. Empty if not computed.
+
+public:
+    /** Type of the function returning the text in the given range. */
+    typedef std::function<QString(const Range<int> &)> TextGetter;
+
+    /** Type for the range of runs of a block. */
+    typedef boost::iterator_range<std::vector<FormatRun>::const_iterator> RunsRange;
+
+    /**
+     * \return True if the table is not computed.
+     */
+    bool empty() const { return blockStarts_.empty(); }
+
+    /**
+     * \return Number of blocks in the table.
+     */
+    std::size_t blockCount() const { return empty() ? 0 : blockStarts_.size() - 1; }
+
+    /**
+     * \param block Block number less than blockCount().
+     *
+     * \return Runs of the block, ordered by their start positions.
+     *         A later run overrides the format of an earlier one.
+     */
+    RunsRange getRuns(std::size_t block) const {
+        assert(block < blockCount());
+        return boost::make_iterator_range(runs_.begin() + blockStarts_[block], runs_.begin() + blockStarts_[block + 1]);
+    }
+
+    /**
+     * Computes the runs of all the blocks of the text.
+     *
+     * \param tree Range tree of the text.
+     * \param text The text.
+     */
+    void compute(const RangeTree &tree, const QString &text);
+
+    /**
+     * Recomputes the runs of the blocks touched by an edit.
+     *
+     * If the number of blocks and runs does not change, as when an identifier
+     * is renamed, the runs are overwritten in place. Otherwise, the runs of
+     * the following blocks are moved.
+     *
+     * \param tree Range tree of the edited text.
+     * \param firstBlock Number of the first block touched by the edit.
+     * \param oldBlockCount Number of blocks replaced by the edit.
+     * \param positions Start positions of the blocks replacing the old ones,
+     *                  followed by the end position of the last of them.
+     * \param getText Function returning the text of the document in a given range.
+     */
+    void update(const RangeTree &tree, std::size_t firstBlock, std::size_t oldBlockCount,
+                const std::vector<int> &positions, const TextGetter &getText);
+
+    /**
+     * Exchanges the contents of this table with another one.
+     *
+     * \param that Another table.
+     */
+    void swap(FormatRunTable &that) {
+        runs_.swap(that.runs_);
+        blockStarts_.swap(that.blockStarts_);
+    }
+
+private:
+    /**
+     * Computes the runs of the blocks with the given positions.
+     *
+     * \param[in] tree Range tree of the text.
+     * \param[in] positions Start positions of the blocks, followed by the end position of the last one.
+     * \param[in] getText Function returning the text in a given range.
+     * \param[out] runs Runs of the blocks, block after block.
+     * \param[out] blockStarts Index of the first run of each block, followed by the number of runs.
+     */
+    static void computeRuns(const RangeTree &tree, const std::vector<int> &positions, const TextGetter &getText,
+                            std::vector<FormatRun> &runs, std::vector<std::size_t> &blockStarts);
+};
+
+}} // namespace nc::gui
+
+/* vim:set et sts=4 sw=4: */
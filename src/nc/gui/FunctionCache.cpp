@@ -0,0 +1,103 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "FunctionCache.h"
+
+#include <cassert>
+
+#include <QMutexLocker>
+
+#include <nc/common/Foreach.h>
+#include <nc/common/Range.h>
+
+#include <nc/core/Context.h>
+#include <nc/core/FunctionSelector.h>
+#include <nc/core/arch/Instructions.h>
+#include <nc/core/ir/BasicBlock.h>
+#include <nc/core/ir/Function.h>
+
+namespace nc {
+namespace gui {
+
+FunctionCache::FunctionCache() {}
+
+FunctionCache::~FunctionCache() {}
+
+std::shared_ptr<const core::FunctionSelector> FunctionCache::getSelector(const core::Context &context) {
+    {
+        QMutexLocker locker(&mutex_);
+        if (selector_ && instructions_ == context.instructions()) {
+            return selector_;
+        }
+    }
+
+    auto selector = std::make_shared<const core::FunctionSelector>(context);
+
+    QMutexLocker locker(&mutex_);
+    selector_ = selector;
+    instructions_ = context.instructions();
+    return selector;
+}
+
+std::shared_ptr<const core::FunctionSelector> FunctionCache::selector() const {
+    QMutexLocker locker(&mutex_);
+    return selector_;
+}
+
+boost::optional<ByteAddr> FunctionCache::getEntry(ByteAddr address) const {
+    if (getContext(address)) {
+        return address;
+    }
+
+    auto selector = this->selector();
+    if (selector) {
+        if (auto function = selector->getFunctionContaining(address)) {
+            if (function->entry() && function->entry()->address()) {
+                return *function->entry()->address();
+            }
+        }
+    }
+    return boost::none;
+}
+
+std::shared_ptr<const core::Context> FunctionCache::getContext(ByteAddr entry) const {
+    QMutexLocker locker(&mutex_);
+    return nc::find(contexts_, entry);
+}
+
+void FunctionCache::setContext(ByteAddr entry, const std::shared_ptr<const core::Context> &context) {
+    assert(context);
+
+    QMutexLocker locker(&mutex_);
+    contexts_[entry] = context;
+}
+
+void FunctionCache::update(const std::shared_ptr<const core::arch::Instructions> &instructions) {
+    assert(instructions);
+
+    QMutexLocker locker(&mutex_);
+
+    if (instructions_ != instructions) {
+        selector_.reset();
+        instructions_.reset();
+    }
+
+    for (auto i = contexts_.begin(); i != contexts_.end();) {
+        bool valid = true;
+        foreach (const auto &instruction, i->second->instructions()->all()) {
+            if (instructions->get(instruction->addr()) != instruction) {
+                valid = false;
+                break;
+            }
+        }
+        if (valid) {
+            ++i;
+        } else {
+            i = contexts_.erase(i);
+        }
+    }
+}
+
+}} // namespace nc::gui
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,98 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <memory>
+
+#include <boost/optional.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <QMutex>
+
+#include <nc/common/Types.h>
+
+namespace nc {
+
+namespace core {
+    class Context;
+    class FunctionSelector;
+
+    namespace arch {
+        class Instructions;
+    }
+}
+
+namespace gui {
+
+/**
+ * Results of decompiling functions one by one, shared between
+ * the GUI thread and the background decompilations.
+ *
+ * Each function is decompiled in its own context, together with
+ * its direct callees. The results are kept until the instructions
+ * of the decompiled functions change.
+ */
+class FunctionCache {
+    mutable QMutex mutex_; ///< Mutex guarding the members.
+    std::shared_ptr<const core::FunctionSelector> selector_; ///< Functions of the instructions. Can be nullptr.
+    std::shared_ptr<const core::arch::Instructions> instructions_; ///< Instructions the functions were formed from.
+    boost::unordered_map<ByteAddr, std::shared_ptr<const core::Context>> contexts_; ///< Contexts by entry address of the function.
+
+public:
+    FunctionCache();
+    ~FunctionCache();
+
+    /**
+     * Returns the functions of the context's instructions, computing them if necessary.
+     * Can take long, must not be called from the GUI thread.
+     *
+     * \param context Context with the image and the instructions.
+     *
+     * \return Valid pointer to the functions.
+     */
+    std::shared_ptr<const core::FunctionSelector> getSelector(const core::Context &context);
+
+    /**
+     * \return Functions computed by the last call to getSelector(). Can be nullptr.
+     */
+    std::shared_ptr<const core::FunctionSelector> selector() const;
+
+    /**
+     * \param address Address of an instruction.
+     *
+     * \return Entry address of a function containing the instruction, if there is a decompiled
+     *         function with this entry address, or the functions are computed and there is one.
+     */
+    boost::optional<ByteAddr> getEntry(ByteAddr address) const;
+
+    /**
+     * \param entry Entry address of a function.
+     *
+     * \return Context with the decompiled function. Can be nullptr.
+     */
+    std::shared_ptr<const core::Context> getContext(ByteAddr entry) const;
+
+    /**
+     * Remembers the context with the decompiled function.
+     *
+     * \param entry Entry address of the function.
+     * \param context Valid pointer to the context.
+     */
+    void setContext(ByteAddr entry, const std::shared_ptr<const core::Context> &context);
+
+    /**
+     * Forgets the functions if they were formed from other instructions,
+     * and the results of decompiling the functions whose instructions are
+     * not all in the given set.
+     *
+     * \param instructions Current set of instructions.
+     */
+    void update(const std::shared_ptr<const core::arch::Instructions> &instructions);
+};
+
+}} // namespace nc::gui
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,77 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "FunctionDecompilation.h"
+
+#include <cassert>
+#include <vector>
+
+#include <nc/core/Context.h>
+#include <nc/core/Driver.h>
+#include <nc/core/FunctionSelector.h>
+#include <nc/core/arch/Instructions.h>
+#include <nc/core/ir/BasicBlock.h>
+#include <nc/core/ir/Function.h>
+
+#include "FunctionCache.h"
+
+namespace nc {
+namespace gui {
+
+FunctionDecompilation::FunctionDecompilation(const std::shared_ptr<core::Context> &context, ByteAddr address, bool isEntry,
+                                             const std::shared_ptr<FunctionCache> &cache):
+    context_(context),
+    address_(address),
+    isEntry_(isEntry),
+    cache_(cache)
+{
+    assert(context);
+    assert(cache);
+}
+
+FunctionDecompilation::~FunctionDecompilation() {}
+
+void FunctionDecompilation::work() {
+    try {
+        ByteAddr entry;
+
+        auto selector = cache_->selector();
+        if (isEntry_ && !(selector && selector->getFunction(address_))) {
+            /* Form only the function and its callees, the user is waiting for them. */
+            entry = address_;
+            if (cache_->getContext(entry)) {
+                return;
+            }
+
+            if (core::Driver::selectFunctions(*context_, std::vector<ByteAddr>(1, entry)).empty()) {
+                context_->logToken().warning(tr("There is no function at address 0x%1.").arg(address_, 0, 16));
+                return;
+            }
+        } else {
+            selector = cache_->getSelector(*context_);
+
+            auto function = selector->getFunctionContaining(address_);
+            if (!function || !function->entry() || !function->entry()->address()) {
+                context_->logToken().warning(tr("There is no function at address 0x%1.").arg(address_, 0, 16));
+                return;
+            }
+
+            entry = *function->entry()->address();
+            if (cache_->getContext(entry)) {
+                return;
+            }
+
+            context_->setInstructions(selector->select(std::vector<ByteAddr>(1, entry)));
+        }
+
+        core::Driver::decompile(*context_);
+
+        cache_->setContext(entry, context_);
+    } catch (const CancellationException &) {
+        /* Nothing to do. */
+    }
+}
+
+}} // namespace nc::gui
+
+/* vim:set et sts=4 sw=4: */
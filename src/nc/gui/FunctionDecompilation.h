@@ -0,0 +1,70 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <memory>
+
+#include <nc/common/Types.h>
+
+#include "Activity.h"
+
+namespace nc {
+
+namespace core {
+    class Context;
+}
+
+namespace gui {
+
+class FunctionCache;
+
+/**
+ * Activity decompiling a single function together with its direct callees.
+ */
+class FunctionDecompilation: public Activity {
+    Q_OBJECT
+
+    /** Context with the image and all the instructions. */
+    std::shared_ptr<core::Context> context_;
+
+    /** Address of an instruction of the function. */
+    ByteAddr address_;
+
+    /** Whether the address is the entry address of the function. */
+    bool isEntry_;
+
+    /** Cache of the results. */
+    std::shared_ptr<FunctionCache> cache_;
+
+    public:
+
+    /**
+     * Constructor.
+     *
+     * \param context Valid pointer to the context with the image and all the instructions.
+     *                Only the instructions of the function and its callees are left in it.
+     * \param address Address of an instruction of the function.
+     * \param isEntry Whether the address is the entry address of the function. If it is,
+     *                and the functions of all the instructions are not computed yet,
+     *                the function is found without computing them.
+     * \param cache Valid pointer to the cache where the context is stored after decompilation.
+     */
+    FunctionDecompilation(const std::shared_ptr<core::Context> &context, ByteAddr address, bool isEntry,
+                          const std::shared_ptr<FunctionCache> &cache);
+
+    /**
+     * Destructor.
+     */
+    ~FunctionDecompilation();
+
+    protected:
+
+    void work() override;
+};
+
+}} // namespace nc::gui
+
+/* vim:set et sts=4 sw=4: */
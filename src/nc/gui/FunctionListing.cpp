@@ -0,0 +1,37 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "FunctionListing.h"
+
+#include <cassert>
+
+#include <nc/common/CancellationToken.h>
+
+#include <nc/core/Context.h>
+
+#include "FunctionCache.h"
+
+namespace nc {
+namespace gui {
+
+FunctionListing::FunctionListing(const std::shared_ptr<const core::Context> &context, const std::shared_ptr<FunctionCache> &cache):
+    context_(context),
+    cache_(cache)
+{
+    assert(context);
+    assert(cache);
+}
+
+FunctionListing::~FunctionListing() {}
+
+void FunctionListing::work() {
+    try {
+        cache_->getSelector(*context_);
+    } catch (const CancellationException &) {
+        /* Nothing to do. */
+    }
+}
+
+}} // namespace nc::gui
+
+/* vim:set et sts=4 sw=4: */
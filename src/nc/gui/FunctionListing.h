@@ -0,0 +1,56 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <memory>
+
+#include "Activity.h"
+
+namespace nc {
+
+namespace core {
+    class Context;
+}
+
+namespace gui {
+
+class FunctionCache;
+
+/**
+ * Activity forming the functions of all the instructions of a context.
+ */
+class FunctionListing: public Activity {
+    Q_OBJECT
+
+    /** Context with the image and the instructions. */
+    std::shared_ptr<const core::Context> context_;
+
+    /** Cache where the functions are stored. */
+    std::shared_ptr<FunctionCache> cache_;
+
+    public:
+
+    /**
+     * Constructor.
+     *
+     * \param context Valid pointer to the context with the image and the instructions.
+     * \param cache Valid pointer to the cache where the functions are stored.
+     */
+    FunctionListing(const std::shared_ptr<const core::Context> &context, const std::shared_ptr<FunctionCache> &cache);
+
+    /**
+     * Destructor.
+     */
+    ~FunctionListing();
+
+    protected:
+
+    void work() override;
+};
+
+}} // namespace nc::gui
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,100 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "FunctionsModel.h"
+
+#include <nc/common/CheckedCast.h>
+#include <nc/common/Unreachable.h>
+
+#include <nc/core/FunctionSelector.h>
+#include <nc/core/image/Image.h>
+#include <nc/core/ir/cgen/NameGenerator.h>
+
+namespace nc { namespace gui {
+
+enum FunctionsModelColumns {
+    COL_ADDRESS,
+    COL_NAME,
+    COL_COUNT
+};
+
+FunctionsModel::FunctionsModel(QObject *parent, std::shared_ptr<const core::image::Image> image,
+                               std::shared_ptr<const core::FunctionSelector> functions):
+    QAbstractItemModel(parent), image_(std::move(image)), functions_(std::move(functions))
+{}
+
+boost::optional<ByteAddr> FunctionsModel::getEntry(const QModelIndex &index) const {
+    if (!functions_ || !index.isValid() || index.row() >= rowCount()) {
+        return boost::none;
+    }
+    return functions_->entries()[index.row()];
+}
+
+int FunctionsModel::rowCount(const QModelIndex &parent) const {
+    if (!functions_) {
+        return 0;
+    }
+    if (parent == QModelIndex()) {
+        return checked_cast<int>(functions_->entries().size());
+    } else {
+        return 0;
+    }
+}
+
+int FunctionsModel::columnCount(const QModelIndex & /*parent*/) const {
+    return COL_COUNT;
+}
+
+QModelIndex FunctionsModel::index(int row, int column, const QModelIndex &parent) const {
+    if (row < rowCount(parent)) {
+        return createIndex(row, column);
+    } else {
+        return QModelIndex();
+    }
+}
+
+QModelIndex FunctionsModel::parent(const QModelIndex & /*index*/) const {
+    return QModelIndex();
+}
+
+QVariant FunctionsModel::data(const QModelIndex &index, int role) const {
+    if (role == Qt::DisplayRole || role == SortRole) {
+        auto entry = getEntry(index);
+        assert(entry);
+
+        switch (index.column()) {
+            case COL_ADDRESS:
+                if (role == Qt::DisplayRole) {
+                    return QString("%1").arg(*entry, 0, 16);
+                } else {
+                    return static_cast<qlonglong>(*entry);
+                }
+            case COL_NAME:
+                if (image_) {
+                    return core::ir::cgen::NameGenerator(*image_).getFunctionName(*entry).name();
+                } else {
+                    return QString();
+                }
+            default:
+                unreachable();
+        }
+    }
+    return QVariant();
+}
+
+QVariant FunctionsModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation == Qt::Horizontal) {
+        if (role == Qt::DisplayRole) {
+            switch (section) {
+                case COL_ADDRESS: return tr("Address");
+                case COL_NAME: return tr("Name");
+                default: unreachable();
+            }
+        }
+    }
+    return QAbstractItemModel::headerData(section, orientation, role);
+}
+
+}} // namespace nc::gui
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,69 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <memory> /* std::shared_ptr */
+
+#include <boost/optional.hpp>
+
+#include <QAbstractItemModel>
+
+#include <nc/common/Types.h>
+
+namespace nc {
+
+namespace core {
+    class FunctionSelector;
+
+    namespace image {
+        class Image;
+    }
+}
+
+namespace gui {
+
+/**
+ * Model of the list of functions formed from the instructions.
+ */
+class FunctionsModel: public QAbstractItemModel {
+    Q_OBJECT
+
+    std::shared_ptr<const core::image::Image> image_;
+    std::shared_ptr<const core::FunctionSelector> functions_;
+
+public:
+    enum {
+        SortRole = Qt::UserRole
+    };
+
+    /**
+     * Constructor.
+     *
+     * \param parent    Pointer to the parent object. Can be nullptr.
+     * \param image     Pointer to the image. Can be nullptr.
+     * \param functions Pointer to the functions. Can be nullptr.
+     */
+    explicit FunctionsModel(QObject *parent = nullptr, std::shared_ptr<const core::image::Image> image = nullptr,
+                            std::shared_ptr<const core::FunctionSelector> functions = nullptr);
+
+    /**
+     * \param index Model index.
+     *
+     * \return Entry address of the function associated with the index, if any.
+     */
+    boost::optional<ByteAddr> getEntry(const QModelIndex &index) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QModelIndex parent(const QModelIndex &index) const override;
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+};
+
+}} // namespace nc::gui
+
+/* vim:set et sts=4 sw=4: */
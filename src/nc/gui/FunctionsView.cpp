@@ -0,0 +1,49 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "FunctionsView.h"
+
+#include <QSortFilterProxyModel>
+#include <QTreeView>
+
+#include "FunctionsModel.h"
+
+namespace nc {
+namespace gui {
+
+FunctionsView::FunctionsView(QWidget *parent):
+    TreeView(tr("Functions"), parent),
+    model_(nullptr)
+{
+    treeView()->setItemsExpandable(false);
+    treeView()->setRootIsDecorated(false);
+    treeView()->setSelectionBehavior(QAbstractItemView::SelectRows);
+    treeView()->setSelectionMode(QAbstractItemView::SingleSelection);
+    treeView()->setUniformRowHeights(true);
+    treeView()->setSortingEnabled(true);
+
+    proxyModel_ = new QSortFilterProxyModel(this);
+    proxyModel_->setSortRole(FunctionsModel::SortRole);
+    treeView()->setModel(proxyModel_);
+
+    connect(treeView(), SIGNAL(activated(const QModelIndex &)), this, SIGNAL(functionActivated()));
+}
+
+void FunctionsView::setModel(FunctionsModel *model) {
+    if (model != model_) {
+        model_ = model;
+        proxyModel_->setSourceModel(model);
+    }
+}
+
+boost::optional<ByteAddr> FunctionsView::selectedFunction() const {
+    if (!model_) {
+        return boost::none;
+    }
+    return model_->getEntry(proxyModel_->mapToSource(treeView()->currentIndex()));
+}
+
+} // namespace gui
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
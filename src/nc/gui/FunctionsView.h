@@ -0,0 +1,71 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <boost/optional.hpp>
+
+#include <nc/common/Types.h>
+
+#include "TreeView.h"
+
+QT_BEGIN_NAMESPACE
+class QModelIndex;
+class QSortFilterProxyModel;
+QT_END_NAMESPACE
+
+namespace nc {
+namespace gui {
+
+class FunctionsModel;
+
+/**
+ * Dock widget listing the functions, for choosing the one shown in the C++ view.
+ */
+class FunctionsView: public TreeView {
+    Q_OBJECT
+
+    /** The model being the source of the data. */
+    FunctionsModel *model_;
+
+    /** The model being given to QTreeView. */
+    QSortFilterProxyModel *proxyModel_;
+
+public:
+    /**
+     * Constructor.
+     *
+     * \param parent Pointer to the parent widget. Can be nullptr.
+     */
+    explicit FunctionsView(QWidget *parent = 0);
+
+    /**
+     * \return Pointer to the model being viewed. Can be nullptr.
+     */
+    FunctionsModel *model() const { return model_; }
+
+    /**
+     * Sets the model being viewed.
+     *
+     * \param model Pointer to the new model. Can be nullptr.
+     */
+    void setModel(FunctionsModel *model);
+
+    /**
+     * \return Entry address of the currently selected function, if any.
+     */
+    boost::optional<ByteAddr> selectedFunction() const;
+
+Q_SIGNALS:
+    /**
+     * Signal emitted when the user activates a function, e.g. by double-clicking it.
+     */
+    void functionActivated();
+};
+
+} // namespace gui
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
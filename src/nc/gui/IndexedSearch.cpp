@@ -0,0 +1,243 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "IndexedSearch.h"
+
+#include <cassert>
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThreadPool>
+
+namespace nc { namespace gui {
+
+/**
+ * State of a background job, shared between the job and the owner.
+ * The results are handed to the owner via a queued call of its slot.
+ */
+class IndexedSearch::Job {
+public:
+    QMutex mutex; ///< Mutex guarding the owner pointer.
+    IndexedSearch *owner; ///< The object waiting for the results. nullptr if it is not waiting anymore.
+    CancellationToken cancellationToken; ///< Cancellation token of the job.
+    int version; ///< Version of the contents.
+    std::shared_ptr<const SearchIndex> index; ///< Built or searched index.
+    std::vector<SearchIndex::Match> matches; ///< Found occurrences.
+    bool finished; ///< True if the job has finished. Guarded by the mutex.
+
+    Job(IndexedSearch *owner, int version): owner(owner), version(version), finished(false) {}
+
+    /**
+     * \return True if the job has finished.
+     */
+    bool isFinished() {
+        QMutexLocker locker(&mutex);
+        return finished;
+    }
+
+    /**
+     * Runs the function in the global thread pool and calls the owner's slot afterwards, unless canceled.
+     *
+     * \param job Valid pointer to the job.
+     * \param function Function doing the work.
+     * \param slot Name of the owner's slot.
+     */
+    static void start(const std::shared_ptr<Job> &job, std::function<void(Job &)> function, const char *slot) {
+        class Runnable: public QRunnable {
+            std::shared_ptr<Job> job_;
+            std::function<void(Job &)> function_;
+            const char *slot_;
+
+        public:
+            Runnable(std::shared_ptr<Job> job, std::function<void(Job &)> function, const char *slot):
+                job_(std::move(job)), function_(std::move(function)), slot_(slot)
+            {}
+
+            void run() override {
+                try {
+                    function_(*job_);
+                } catch (const CancellationException &) {
+                    return;
+                }
+
+                QMutexLocker locker(&job_->mutex);
+                job_->finished = true;
+                if (job_->owner) {
+                    QMetaObject::invokeMethod(job_->owner, slot_, Qt::QueuedConnection);
+                }
+            }
+        };
+
+        QThreadPool::globalInstance()->start(new Runnable(job, std::move(function), slot));
+    }
+
+    /**
+     * Cancels the job and makes it forget the owner.
+     */
+    void cancel() {
+        QMutexLocker locker(&mutex);
+        owner = nullptr;
+        cancellationToken.cancel();
+    }
+};
+
+IndexedSearch::IndexedSearch(QObject *parent):
+    QObject(parent), version_(-1), searchPending_(false), flags_(0)
+{}
+
+IndexedSearch::~IndexedSearch() {
+    clear();
+}
+
+const SearchIndex *IndexedSearch::index(int version) const {
+    return version_ == version ? index_.get() : nullptr;
+}
+
+bool IndexedSearch::isIndexed(int version) const {
+    return (index_ && version_ == version) || (building_ && building_->version == version);
+}
+
+void IndexedSearch::build(int version, LinesSource source) {
+    if (isIndexed(version)) {
+        return;
+    }
+
+    if (building_) {
+        building_->cancel();
+    }
+
+    building_ = std::make_shared<Job>(this, version);
+
+    Job::start(building_, [source](Job &job) {
+        auto index = std::make_shared<SearchIndex>(source(), job.cancellationToken);
+
+        QMutexLocker locker(&job.mutex);
+        job.index = std::move(index);
+    }, "onIndexBuilt");
+}
+
+void IndexedSearch::clear() {
+    if (building_) {
+        building_->cancel();
+        building_.reset();
+    }
+    cancelSearch();
+
+    index_.reset();
+    version_ = -1;
+    searchedIndex_.reset();
+    matches_.clear();
+}
+
+void IndexedSearch::onIndexBuilt() {
+    /* The call might have been queued by a job canceled since then. */
+    if (!building_ || !building_->isFinished()) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&building_->mutex);
+        index_ = std::move(building_->index);
+    }
+    version_ = building_->version;
+    building_.reset();
+
+    Q_EMIT indexBuilt();
+
+    if (searchPending_) {
+        startSearch();
+    }
+}
+
+const std::vector<SearchIndex::Match> *IndexedSearch::matches(const QString &expression, Searcher::FindFlags flags, int version) {
+    flags &= ~Searcher::FindBackward;
+
+    if (!index_ || version_ != version) {
+        return nullptr;
+    }
+
+    if (searchedIndex_ == index_ && expression_ == expression && flags_ == flags) {
+        return &matches_;
+    }
+
+    if (flags & Searcher::FindRegexp) {
+        /* May take arbitrarily long, must be done by search(). */
+        return nullptr;
+    }
+
+    cancelSearch();
+
+    expression_ = expression;
+    flags_ = flags;
+    searchedIndex_ = index_;
+    matches_ = index_->find(expression, flags);
+
+    return &matches_;
+}
+
+void IndexedSearch::search(const QString &expression, Searcher::FindFlags flags) {
+    assert(index_ || building_);
+
+    flags &= ~Searcher::FindBackward;
+
+    cancelSearch();
+
+    expression_ = expression;
+    flags_ = flags;
+    searchedIndex_.reset();
+    matches_.clear();
+
+    if (building_) {
+        searchPending_ = true;
+    } else {
+        startSearch();
+    }
+}
+
+void IndexedSearch::startSearch() {
+    assert(index_);
+
+    searchPending_ = false;
+    searching_ = std::make_shared<Job>(this, version_);
+    searching_->index = index_;
+
+    QString expression = expression_;
+    Searcher::FindFlags flags = flags_;
+
+    Job::start(searching_, [expression, flags](Job &job) {
+        auto matches = job.index->find(expression, flags, job.cancellationToken);
+
+        QMutexLocker locker(&job.mutex);
+        job.matches = std::move(matches);
+    }, "onFound");
+}
+
+void IndexedSearch::cancelSearch() {
+    searchPending_ = false;
+
+    if (searching_) {
+        searching_->cancel();
+        searching_.reset();
+    }
+}
+
+void IndexedSearch::onFound() {
+    /* The call might have been queued by a job canceled since then. */
+    if (!searching_ || !searching_->isFinished()) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&searching_->mutex);
+        searchedIndex_ = searching_->index;
+        matches_ = std::move(searching_->matches);
+    }
+    searching_.reset();
+
+    Q_EMIT found(matches_);
+}
+
+}} // namespace nc::gui
+
+/* vim:set et sts=4 sw=4: */
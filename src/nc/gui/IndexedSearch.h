@@ -0,0 +1,174 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <QObject>
+#include <QString>
+
+#include "SearchIndex.h"
+
+namespace nc { namespace gui {
+
+/**
+ * Builds a search index and runs searches over it in background threads.
+ *
+ * The searched contents are identified by a version number chosen by
+ * the user of the class, which must change whenever the contents change.
+ */
+class IndexedSearch: public QObject {
+    Q_OBJECT
+
+    class Job;
+
+    /** Built index. Can be nullptr. */
+    std::shared_ptr<const SearchIndex> index_;
+
+    /** Version of the contents the index was built from. */
+    int version_;
+
+    /** Job building the index. Can be nullptr. */
+    std::shared_ptr<Job> building_;
+
+    /** Job searching in the index. Can be nullptr. */
+    std::shared_ptr<Job> searching_;
+
+    /** Whether the search job must be started as soon as the index is built. */
+    bool searchPending_;
+
+    /** Expression of the last search. */
+    QString expression_;
+
+    /** Flags of the last search. */
+    Searcher::FindFlags flags_;
+
+    /** Index the last search was done in. Can be nullptr. */
+    std::shared_ptr<const SearchIndex> searchedIndex_;
+
+    /** Results of the last search. */
+    std::vector<SearchIndex::Match> matches_;
+
+    public:
+
+    /**
+     * Function returning the lines of the contents. Called in a background thread.
+     */
+    typedef std::function<std::vector<QString>()> LinesSource;
+
+    /**
+     * Constructor.
+     *
+     * \param parent Pointer to the parent object. Can be nullptr.
+     */
+    explicit IndexedSearch(QObject *parent = nullptr);
+
+    /**
+     * Destructor. Cancels the background jobs.
+     */
+    ~IndexedSearch();
+
+    /**
+     * \param version Version of the contents.
+     *
+     * \return The index if it is built for the given version, nullptr otherwise.
+     */
+    const SearchIndex *index(int version) const;
+
+    /**
+     * \param version Version of the contents.
+     *
+     * \return True if the index for the given version is built or being built.
+     */
+    bool isIndexed(int version) const;
+
+    /**
+     * \return Pointer to the index the results of the last search are from. Can be nullptr.
+     */
+    const SearchIndex *searchedIndex() const { return searchedIndex_.get(); }
+
+    /**
+     * Starts building the index for the given version of the contents,
+     * unless it is built or being built already.
+     *
+     * \param version Version of the contents.
+     * \param source Function returning the lines of this version of the contents.
+     */
+    void build(int version, LinesSource source);
+
+    /**
+     * Forgets the index and cancels all the jobs.
+     */
+    void clear();
+
+    /**
+     * Returns the occurrences of the expression in the given version of the contents.
+     * Plain text queries are answered at once using the index. Regular expressions
+     * are answered only if they have been searched for by search() before.
+     *
+     * \param expression Search expression.
+     * \param flags Search flags. Searcher::FindBackward is ignored.
+     * \param version Version of the contents.
+     *
+     * \return Pointer to the occurrences sorted by line and column,
+     *         or nullptr if they are not known yet.
+     */
+    const std::vector<SearchIndex::Match> *matches(const QString &expression, Searcher::FindFlags flags, int version);
+
+    /**
+     * Starts finding all the occurrences of the expression in a background thread,
+     * canceling the previous search. The index must be built or being built.
+     * found() is emitted when the search is finished.
+     *
+     * \param expression Search expression.
+     * \param flags Search flags. Searcher::FindBackward is ignored.
+     */
+    void search(const QString &expression, Searcher::FindFlags flags);
+
+    /**
+     * Cancels the search being run in the background.
+     */
+    void cancelSearch();
+
+    Q_SIGNALS:
+
+    /**
+     * Signal emitted when the index is built.
+     */
+    void indexBuilt();
+
+    /**
+     * Signal emitted when a search started by search() is finished.
+     *
+     * \param matches Occurrences of the expression, sorted by line and column.
+     */
+    void found(const std::vector<SearchIndex::Match> &matches);
+
+    private Q_SLOTS:
+
+    /**
+     * Takes the built index from the building job.
+     */
+    void onIndexBuilt();
+
+    /**
+     * Takes the occurrences from the searching job.
+     */
+    void onFound();
+
+    private:
+
+    /**
+     * Starts the search job in the global thread pool.
+     */
+    void startSearch();
+};
+
+}} // namespace nc::gui
+
+/* vim:set et sts=4 sw=4: */
@@ -25,6 +25,7 @@
 #include "InspectorModel.h"
 
 #include <nc/common/CheckedCast.h>
+#include <nc/common/Range.h>
 
 #include <nc/core/Context.h>
 #include <nc/core/arch/Instruction.h>
@@ -163,8 +164,14 @@ void expand(InspectorItem *item, const core::ir::Term *term, const core::Context
     }
     item->addChild(tr("size = %1").arg(term->size()));
 
-    if (term->statement() && term->statement()->basicBlock() && term->statement()->basicBlock()->function()) {
-        auto &dataflow = *context->dataflows()->at(term->statement()->basicBlock()->function());
+    /* Functions restored from a session or taken from the cache have no dataflow. */
+    const core::ir::dflow::Dataflow *functionDataflow = nullptr;
+    if (term->statement() && term->statement()->basicBlock() && term->statement()->basicBlock()->function() && context->dataflows()) {
+        functionDataflow = nc::find(*context->dataflows(), term->statement()->basicBlock()->function()).get();
+    }
+
+    if (functionDataflow) {
+        auto &dataflow = *functionDataflow;
 
         if (const core::ir::dflow::Value *value = dataflow.getValue(term)) {
             InspectorItem *valueItem = item->addChild(tr("value properties"));
@@ -209,7 +216,7 @@ void expand(InspectorItem *item, const core::ir::Term *term, const core::Context
             }
         }
     } else {
-        item->addChild("function = nullptr");
+        item->addChild("dataflow = nullptr");
     }
 
     switch (term->kind()) {
@@ -654,6 +661,49 @@ const core::likec::TreeNode *InspectorModel::getParent(const core::likec::TreeNo
     return nc::find(node2parent_, node);
 }
 
+namespace {
+
+template<class T>
+InspectorItem *findDescendant(InspectorItem *item, int maxDepth, T match) {
+    if (match(item)) {
+        return item;
+    }
+    if (maxDepth > 0) {
+        --maxDepth;
+        foreach (const auto &child, item->children()) {
+            if (InspectorItem *result = findDescendant(child.get(), maxDepth, match)) {
+                return result;
+            }
+        }
+    }
+    return nullptr;
+}
+
+} // anonymous namespace
+
+InspectorItem *InspectorModel::getItem(const core::likec::TreeNode *node) {
+    assert(node != nullptr);
+
+    auto i = node2item_.find(node);
+    if (i != node2item_.end()) {
+        return i->second;
+    }
+
+    InspectorItem *parentItem = root();
+    if (auto parent = getParent(node)) {
+        parentItem = getItem(parent);
+    }
+
+    InspectorItem *result = nullptr;
+    if (parentItem) {
+        expand(parentItem);
+        result = findDescendant(parentItem, 2, [node](InspectorItem *x) { return x->node() == node; });
+    }
+
+    node2item_[node] = result;
+    return result;
+}
+
 }} // namespace nc::gui
 
 /* vim:set et sts=4 sw=4: */
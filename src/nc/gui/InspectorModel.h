@@ -60,6 +60,9 @@ class InspectorModel: public QAbstractItemModel {
     /** Mapping from LikeC nodes to their parents. */
     boost::unordered_map<const core::likec::TreeNode *, const core::likec::TreeNode *> node2parent_;
 
+    /** Mapping from LikeC nodes to the items showing them, filled on demand. */
+    boost::unordered_map<const core::likec::TreeNode *, InspectorItem *> node2item_;
+
 public:
     /**
      * Constructor.
@@ -106,6 +109,17 @@ public:
      */
     const core::likec::TreeNode *getParent(const core::likec::TreeNode *node);
 
+    /**
+     * Finds the item showing the given node, expanding its ancestors
+     * as necessary. The result is remembered, so that looking up the node
+     * or its descendants later does not search the ancestors again.
+     *
+     * \param[in] node Valid pointer to a LikeC tree node.
+     *
+     * \return Pointer to the item showing the node. Can be nullptr.
+     */
+    InspectorItem *getItem(const core::likec::TreeNode *node);
+
     /**
      * Computes children of given tree item.
      *
@@ -24,6 +24,7 @@
 
 #include "InspectorView.h"
 
+#include <QItemSelectionModel>
 #include <QKeyEvent>
 #include <QTreeView>
 
@@ -102,26 +103,6 @@ void InspectorView::updateSelection() {
     }
 }
 
-namespace {
-
-template<class T>
-InspectorItem *findDescendant(InspectorItem *item, int maxDepth, T match) {
-    if (match(item)) {
-        return item;
-    }
-    if (maxDepth > 0) {
-        --maxDepth;
-        foreach (const auto &child, item->children()) {
-            if (InspectorItem *result = findDescendant(child.get(), maxDepth, match)) {
-                return result;
-            }
-        }
-    }
-    return nullptr;
-}
-
-} // anonymous namespace
-
 void InspectorView::highlightNodes(const std::vector<const core::likec::TreeNode *> &nodes) {
     if (!model()) {
         return;
@@ -130,37 +111,23 @@ void InspectorView::highlightNodes(const std::vector<const core::likec::TreeNode
     disconnect(treeView_->selectionModel(), SIGNAL(selectionChanged(const QItemSelection &, const QItemSelection &)),
                this, SLOT(updateSelection()));
 
-    treeView_->selectionModel()->clearSelection();
-
     QModelIndex index;
+    QItemSelection selection;
 
     foreach (const core::likec::TreeNode *node, nodes) {
-        std::vector<const core::likec::TreeNode *> path;
-
-        while (node != nullptr) {
-            path.push_back(node);
-            node = model()->getParent(node);
-        }
-
-        InspectorItem *item = model()->root();
-        reverse_foreach(const core::likec::TreeNode *node, path) {
-            model()->expand(item);
-            item = findDescendant(item, 2, [node](InspectorItem *x) { return x->node() == node; } );
-            if (!item) {
-                break;
-            }
-        }
-
-        if (item) {
+        if (InspectorItem *item = model()->getItem(node)) {
             index = model()->getIndex(item);
 
             for (QModelIndex parent = index; parent.isValid(); parent = model()->parent(parent)) {
                 treeView_->expand(parent);
             }
-            treeView_->selectionModel()->select(index, QItemSelectionModel::Select);
+            selection.select(index, index);
         }
     }
 
+    /* Selecting all the items at once emits a single change of the selection. */
+    treeView_->selectionModel()->select(selection, QItemSelectionModel::ClearAndSelect);
+
     treeView_->scrollTo(index);
 
     connect(treeView_->selectionModel(), SIGNAL(selectionChanged(const QItemSelection &, const QItemSelection &)),
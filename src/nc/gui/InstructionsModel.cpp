@@ -25,6 +25,7 @@
 #include "InstructionsModel.h"
 
 #include <algorithm>
+#include <iterator>
 
 #include <QColor>
 
@@ -45,28 +46,119 @@ enum InstructionsModelColumns {
     IMC_COUNT
 };
 
+namespace {
+
+/** Number of rows numbered at once. */
+const std::size_t ROWS_PER_STEP = 4096;
+
+/** Maximal number of rows' texts kept formatted. */
+const std::size_t MAX_CACHED_TEXTS = 8192;
+
+} // anonymous namespace
+
 InstructionsModel::InstructionsModel(QObject *parent, std::shared_ptr<const core::arch::Instructions> instructions):
     QAbstractItemModel(parent),
     instructions_(std::move(instructions))
 {
-    std::vector<const core::arch::Instruction *> vector;
-
     if (instructions_) {
-        instructionsVector_.reserve(instructions_->size());
+        nextRow_ = instructions_->all().begin();
+        end_ = instructions_->all().end();
+    }
+}
 
-        foreach (const auto &instruction, instructions_->all()) {
-            instructionsVector_.push_back(instruction.get());
-        }
+void InstructionsModel::numberRows(std::size_t count) const {
+    if (!instructions_ || rows_.size() >= count) {
+        return;
+    }
+
+    /* Number a bit more than necessary, so that scrolling down does not go here for each row. */
+    count = std::min(std::max(count, rows_.size() + ROWS_PER_STEP), instructions_->size());
+    rows_.reserve(count);
+
+    while (rows_.size() < count && nextRow_ != end_) {
+        rows_.push_back(nextRow_->get());
+        ++nextRow_;
     }
 }
 
-void InstructionsModel::setHighlightedInstructions(std::vector<const core::arch::Instruction *> instructions) {
-    beginResetModel();
+int InstructionsModel::getRow(const core::arch::Instruction *instruction) const {
+    assert(instruction);
+
+    if (!instructions_) {
+        return -1;
+    }
+
+    while (nextRow_ != end_ && (rows_.empty() || rows_.back()->addr() < instruction->addr())) {
+        numberRows(rows_.size() + 1);
+    }
+
+    auto i = std::lower_bound(rows_.begin(), rows_.end(), instruction,
+        [](const core::arch::Instruction *a, const core::arch::Instruction *b) { return a->addr() < b->addr(); });
+
+    if (i != rows_.end() && *i == instruction) {
+        return checked_cast<int>(i - rows_.begin());
+    } else {
+        return -1;
+    }
+}
 
+const QString &InstructionsModel::getText(const core::arch::Instruction *instruction) const {
+    assert(instruction);
+
+    auto i = instruction2text_.find(instruction);
+    if (i != instruction2text_.end()) {
+        /* Move to the front of the list. */
+        texts_.splice(texts_.begin(), texts_, i->second);
+        return i->second->second;
+    }
+
+    if (texts_.size() >= MAX_CACHED_TEXTS) {
+        instruction2text_.erase(texts_.back().first);
+        texts_.pop_back();
+    }
+
+    texts_.push_front(std::make_pair(instruction, tr("%1:\t%2").arg(instruction->addr(), 0, 16).arg(instruction->toString())));
+    instruction2text_[instruction] = texts_.begin();
+
+    return texts_.front().second;
+}
+
+void InstructionsModel::setHighlightedInstructions(std::vector<const core::arch::Instruction *> instructions) {
     std::sort(instructions.begin(), instructions.end());
+    instructions.erase(std::unique(instructions.begin(), instructions.end()), instructions.end());
+
+    /* Instructions that got or lost highlighting. */
+    std::vector<const core::arch::Instruction *> changed;
+    std::set_symmetric_difference(
+        highlightedInstructions_.begin(), highlightedInstructions_.end(),
+        instructions.begin(), instructions.end(),
+        std::back_inserter(changed));
+
     highlightedInstructions_ = std::move(instructions);
 
-    endResetModel();
+    std::vector<int> rows;
+    rows.reserve(changed.size());
+
+    foreach (auto instruction, changed) {
+        int row = getRow(instruction);
+        if (row >= 0) {
+            rows.push_back(row);
+        }
+    }
+
+    std::sort(rows.begin(), rows.end());
+
+    /* Update each run of consecutive rows at once. */
+    for (std::size_t begin = 0; begin < rows.size();) {
+        std::size_t end = begin + 1;
+        while (end < rows.size() && rows[end] == rows[end - 1] + 1) {
+            ++end;
+        }
+
+        Q_EMIT dataChanged(index(rows[begin], 0), index(rows[end - 1], IMC_COUNT - 1));
+
+        begin = end;
+    }
 }
 
 const core::arch::Instruction *InstructionsModel::getInstruction(const QModelIndex &index) const {
@@ -76,19 +168,17 @@ const core::arch::Instruction *InstructionsModel::getInstruction(const QModelInd
 QModelIndex InstructionsModel::getIndex(const core::arch::Instruction *instruction) const {
     assert(instruction);
 
-    auto i = std::lower_bound(instructionsVector_.begin(), instructionsVector_.end(), instruction,
-        [](const core::arch::Instruction *a, const core::arch::Instruction *b) { return a->addr() < b->addr(); });
-
-    if (i != instructionsVector_.end() && *i == instruction) {
-        return index(i - instructionsVector_.begin(), 0, QModelIndex());
+    int row = getRow(instruction);
+    if (row >= 0) {
+        return index(row, 0, QModelIndex());
     } else {
         return QModelIndex();
     }
 }
 
 int InstructionsModel::rowCount(const QModelIndex &parent) const {
-    if (parent == QModelIndex()) {
-        return checked_cast<int>(instructionsVector_.size());
+    if (parent == QModelIndex() && instructions_) {
+        return checked_cast<int>(instructions_->size());
     } else {
         return 0;
     }
@@ -99,8 +189,9 @@ int InstructionsModel::columnCount(const QModelIndex & /*parent*/) const {
 }
 
 QModelIndex InstructionsModel::index(int row, int column, const QModelIndex &parent) const {
-    if (row < rowCount(parent)) {
-        return createIndex(row, column, const_cast<core::arch::Instruction *>(instructionsVector_[row]));
+    if (row >= 0 && row < rowCount(parent)) {
+        numberRows(row + 1);
+        return createIndex(row, column, const_cast<core::arch::Instruction *>(rows_[row]));
     } else {
         return QModelIndex();
     }
@@ -116,7 +207,7 @@ QVariant InstructionsModel::data(const QModelIndex &index, int role) const {
         assert(instruction);
 
         switch (index.column()) {
-            case IMC_INSTRUCTION: return tr("%1:\t%2").arg(instruction->addr(), 0, 16).arg(instruction->toString());
+            case IMC_INSTRUCTION: return getText(instruction);
             default: unreachable();
         }
     } else if (role == Qt::BackgroundRole) {
@@ -25,17 +25,21 @@
 
 #include <nc/config.h>
 
+#include <list>
 #include <memory> /* std::shared_ptr */
 #include <vector>
 
+#include <boost/unordered_map.hpp>
+
 #include <QAbstractItemModel>
 
+#include <nc/core/arch/Instructions.h>
+
 namespace nc {
 
 namespace core {
     namespace arch {
         class Instruction;
-        class Instructions;
     }
 }
 
@@ -43,6 +47,11 @@ namespace gui {
 
 /**
  * Item model for InstructionsView.
+ *
+ * The model scales to millions of instructions: rows are numbered lazily
+ * as the view asks for them, only a bounded number of recently shown rows
+ * keep their formatted text, and changing the highlighting only updates
+ * the rows whose highlighting has actually changed.
  */
 class InstructionsModel: public QAbstractItemModel {
     Q_OBJECT
@@ -84,14 +93,53 @@ public:
     QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
 
 private:
+    /** Type of iterator over the instructions. */
+    typedef boost::range_iterator<core::arch::Instructions::InstructionsRange>::type InstructionIterator;
+
+    /** Type of the list of cached rows' texts, the most recently used first. */
+    typedef std::list<std::pair<const core::arch::Instruction *, QString>> TextList;
+
     /** Associated set of instructions. */
     std::shared_ptr<const core::arch::Instructions> instructions_;
 
-    /** Set of instructions as a vector (needed for direct access by index). */
-    std::vector<const core::arch::Instruction *> instructionsVector_;
+    /** Instructions of the rows numbered so far (needed for direct access by index). */
+    mutable std::vector<const core::arch::Instruction *> rows_;
+
+    /** Instruction to become the next row. */
+    mutable InstructionIterator nextRow_;
+
+    /** End of the instructions. */
+    InstructionIterator end_;
+
+    /** Formatted texts of the recently shown rows. */
+    mutable TextList texts_;
+
+    /** Positions of the instructions' texts in texts_. */
+    mutable boost::unordered_map<const core::arch::Instruction *, TextList::iterator> instruction2text_;
 
     /** Sorted vector of instructions that must be highlighted. */
     std::vector<const core::arch::Instruction *> highlightedInstructions_;
+
+    /**
+     * Numbers the rows until there are at least the given number of them, or all instructions are numbered.
+     *
+     * \param count Required number of rows.
+     */
+    void numberRows(std::size_t count) const;
+
+    /**
+     * \param[in] instruction Valid pointer to an instruction.
+     *
+     * \return Row of the instruction, or -1 if the instruction is not in the model.
+     */
+    int getRow(const core::arch::Instruction *instruction) const;
+
+    /**
+     * \param[in] instruction Valid pointer to an instruction.
+     *
+     * \return Text of the row with the instruction.
+     */
+    const QString &getText(const core::arch::Instruction *instruction) const;
 };
 
 }} // namespace nc::gui
@@ -0,0 +1,39 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "ListFunctions.h"
+
+#include <cassert>
+
+#include <nc/common/make_unique.h>
+
+#include <nc/core/Context.h>
+
+#include "FunctionListing.h"
+#include "Project.h"
+
+namespace nc {
+namespace gui {
+
+ListFunctions::ListFunctions(Project *project):
+    project_(project)
+{
+    assert(project);
+
+    setBackground(true);
+}
+
+void ListFunctions::work() {
+    auto context = std::make_shared<core::Context>();
+    context->setImage(project_->image());
+    context->setInstructions(project_->instructions());
+    context->setCancellationToken(cancellationToken());
+    context->setLogToken(project_->logToken());
+    context->setProgressToken(progressToken());
+
+    delegate(std::make_unique<FunctionListing>(context, project_->functionCache()));
+}
+
+}} // namespace nc::gui
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,41 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include "Command.h"
+
+namespace nc {
+namespace gui {
+
+class Project;
+
+/**
+ * Command for forming the functions of all the instructions
+ * and remembering them in the project's function cache.
+ */
+class ListFunctions: public Command {
+    Q_OBJECT
+
+    /** Project. */
+    Project *project_;
+
+    public:
+
+    /**
+     * Constructor.
+     *
+     * \param project Valid pointer to a project.
+     */
+    explicit ListFunctions(Project *project);
+
+    protected:
+
+    void work() override;
+};
+
+}} // namespace nc::gui
+
+/* vim:set et sts=4 sw=4: */
@@ -25,23 +25,55 @@
 #include "LogView.h"
 
 #include <QPlainTextEdit>
+#include <QTimer>
 
 #include "LogManager.h"
 
 namespace nc { namespace gui {
 
+namespace {
+
+/** Maximal number of lines in the log. */
+const int MAX_LINES = 10000;
+
+/** Interval between appending the pending messages, in milliseconds. */
+const int APPEND_INTERVAL = 100;
+
+} // anonymous namespace
+
 LogView::LogView(QWidget *parent):
     TextView(tr("Log"), parent)
 {
     /* Limit log length. */
-    textEdit()->document()->setMaximumBlockCount(10000);
+    textEdit()->document()->setMaximumBlockCount(MAX_LINES);
+
+    timer_ = new QTimer(this);
+    timer_->setSingleShot(true);
+    timer_->setInterval(APPEND_INTERVAL);
+    connect(timer_, SIGNAL(timeout()), this, SLOT(appendPendingLines()));
 
     /* Log Qt messages here. */
     connect(LogManager::instance(), SIGNAL(message(const QString &)), this, SLOT(log(const QString &)), Qt::QueuedConnection);
 }
 
 void LogView::log(const QString &text) {
-    textEdit()->appendPlainText(text);
+    pendingLines_.append(text);
+
+    /* Older lines would be removed right away anyway. */
+    if (pendingLines_.size() > MAX_LINES) {
+        pendingLines_.removeFirst();
+    }
+
+    if (!timer_->isActive()) {
+        timer_->start();
+    }
+}
+
+void LogView::appendPendingLines() {
+    if (!pendingLines_.isEmpty()) {
+        textEdit()->appendPlainText(pendingLines_.join(QLatin1String("\n")));
+        pendingLines_.clear();
+    }
 }
 
 }} // namespace nc::gui
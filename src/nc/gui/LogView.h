@@ -25,8 +25,14 @@
 
 #include <nc/config.h>
 
+#include <QStringList>
+
 #include "TextView.h"
 
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
 namespace nc { namespace gui {
 
 /**
@@ -35,6 +41,12 @@ namespace nc { namespace gui {
 class LogView: public TextView {
     Q_OBJECT
 
+    /** Messages not shown yet. */
+    QStringList pendingLines_;
+
+    /** Timer for showing the pending messages. */
+    QTimer *timer_;
+
     public:
 
     /**
@@ -49,9 +61,19 @@ class LogView: public TextView {
     /**
      * Shows given log message.
      *
+     * The messages are appended to the text in batches, so that
+     * a stream of messages does not relayout the text for each one.
+     *
      * \param text Message text.
      */
     void log(const QString &text);
+
+    private Q_SLOTS:
+
+    /**
+     * Appends the pending messages to the text.
+     */
+    void appendPendingLines();
 };
 
 }} // namespace nc::gui
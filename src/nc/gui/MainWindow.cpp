@@ -24,6 +24,8 @@
 
 #include "MainWindow.h"
 
+#include <algorithm> /* std::min() */
+
 #include <QAction>
 #include <QApplication>
 #include <QFileDialog>
@@ -58,6 +60,9 @@
 #include "CxxDocument.h"
 #include "CxxView.h"
 #include "DisassemblyDialog.h"
+#include "FunctionCache.h"
+#include "FunctionsModel.h"
+#include "FunctionsView.h"
 #include "InspectorModel.h"
 #include "InspectorView.h"
 #include "InstructionsModel.h"
@@ -82,6 +87,8 @@ MainWindow::MainWindow(Branding branding, QWidget *parent):
     createMenus();
 
     auto logger = std::make_shared<SignalLogger>();
+    /* Debug messages, like the per-function ones, are not worth formatting and sending to the GUI thread. */
+    logger->setMinLevel(LogLevel::INFO);
     connect(logger.get(), SIGNAL(onMessage(const QString &)), logView_, SLOT(log(const QString &)));
     connect(logger.get(), SIGNAL(onMessage(const QString &)), progressDialog_, SLOT(setLabelText(const QString &)));
     connect(logger.get(), SIGNAL(onMessage(const QString &)), this, SLOT(setStatusText(const QString &)));
@@ -141,6 +148,13 @@ void MainWindow::createWidgets() {
 
     connect(symbolsView_, SIGNAL(contextMenuCreated(QMenu *)), this, SLOT(populateSymbolsContextMenu(QMenu *)));
 
+    functionsView_ = new FunctionsView(this);
+    functionsView_->setObjectName("FunctionsView");
+    addDockWidget(Qt::LeftDockWidgetArea, functionsView_);
+    functionsView_->hide();
+
+    connect(functionsView_, SIGNAL(functionActivated()), this, SLOT(showSelectedFunction()));
+
     inspectorView_ = new InspectorView(this);
     inspectorView_->setObjectName("InspectorView");
     addDockWidget(Qt::RightDockWidgetArea, inspectorView_);
@@ -176,6 +190,13 @@ void MainWindow::createActions() {
     openAction_->setShortcuts(QKeySequence::Open);
     connect(openAction_, SIGNAL(triggered()), this, SLOT(open()));
 
+    openSessionAction_ = new QAction(tr("Open Sessio&n..."), this);
+    connect(openSessionAction_, SIGNAL(triggered()), this, SLOT(openSession()));
+
+    saveSessionAction_ = new QAction(tr("&Save Session..."), this);
+    saveSessionAction_->setShortcuts(QKeySequence::Save);
+    connect(saveSessionAction_, SIGNAL(triggered()), this, SLOT(saveSession()));
+
     exportCfgAction_ = new QAction(tr("&Export CFG..."), this);
     connect(exportCfgAction_, SIGNAL(triggered()), this, SLOT(exportCfg()));
 
@@ -201,6 +222,10 @@ void MainWindow::createActions() {
     decompileAutomaticallyAction_->setCheckable(true);
     connect(decompileAutomaticallyAction_, SIGNAL(toggled(bool)), this, SLOT(setDecompileAutomatically(bool)));
 
+    decompileByFunctionAction_ = new QAction(tr("Decompile by &Function"), this);
+    decompileByFunctionAction_->setCheckable(true);
+    connect(decompileByFunctionAction_, SIGNAL(toggled(bool)), this, SLOT(setDecompileByFunction(bool)));
+
     instructionsViewAction_ = instructionsView_->toggleViewAction();
     instructionsViewAction_->setText(tr("&Instructions"));
     instructionsViewAction_->setShortcut(Qt::ALT + Qt::Key_I);
@@ -213,6 +238,10 @@ void MainWindow::createActions() {
     symbolsViewAction_->setText(tr("S&ymbols"));
     symbolsViewAction_->setShortcut(Qt::ALT + Qt::Key_Y);
 
+    functionsViewAction_ = functionsView_->toggleViewAction();
+    functionsViewAction_->setText(tr("F&unctions"));
+    functionsViewAction_->setShortcut(Qt::ALT + Qt::Key_U);
+
     inspectorViewAction_ = inspectorView_->toggleViewAction();
     inspectorViewAction_->setText(tr("Inspec&tor"));
     inspectorViewAction_->setShortcut(Qt::ALT + Qt::Key_T);
@@ -243,6 +272,8 @@ void MainWindow::createActions() {
 void MainWindow::createMenus() {
     QMenu *fileMenu = menuBar()->addMenu(tr("&File"));
     fileMenu->addAction(openAction_);
+    fileMenu->addAction(openSessionAction_);
+    fileMenu->addAction(saveSessionAction_);
     fileMenu->addSeparator();
     fileMenu->addAction(exportCfgAction_);
     fileMenu->addSeparator();
@@ -255,6 +286,7 @@ void MainWindow::createMenus() {
     analyseMenu->addSeparator();
     analyseMenu->addAction(decompileAction_);
     analyseMenu->addAction(decompileAutomaticallyAction_);
+    analyseMenu->addAction(decompileByFunctionAction_);
     analyseMenu->addSeparator();
     analyseMenu->addAction(cancelAllAction_);
 
@@ -262,6 +294,7 @@ void MainWindow::createMenus() {
     viewMenu->addAction(instructionsViewAction_);
     viewMenu->addAction(sectionsViewAction_);
     viewMenu->addAction(symbolsViewAction_);
+    viewMenu->addAction(functionsViewAction_);
     viewMenu->addAction(inspectorViewAction_);
     viewMenu->addAction(logViewAction_);
 
@@ -282,6 +315,7 @@ void MainWindow::loadSettings() {
     }
     restoreState(settings_->value("windowState", saveState()).toByteArray());
     setDecompileAutomatically(settings_->value("decompileAutomatically", true).toBool());
+    setDecompileByFunction(settings_->value("decompileByFunction", false).toBool());
 
     foreach (QObject *child, children()) {
         if (auto textView = qobject_cast<TextView *>(child)) {
@@ -303,6 +337,7 @@ void MainWindow::saveSettings() {
     }
     settings_->setValue("windowState", saveState());
     settings_->setValue("decompileAutomatically", decompileAutomatically());
+    settings_->setValue("decompileByFunction", decompileByFunction());
 
     foreach (QObject *child, children()) {
         if (auto textView = qobject_cast<TextView *>(child)) {
@@ -318,10 +353,11 @@ void MainWindow::saveSettings() {
 }
 
 void MainWindow::updateGuiState() {
+    saveSessionAction_->setEnabled(project() != nullptr);
     exportCfgAction_->setEnabled(project() != nullptr);
     disassembleAction_->setEnabled(project() != nullptr);
     decompileAction_->setEnabled(project() != nullptr);
-    cancelAllAction_->setEnabled(project() != nullptr && project()->commandQueue()->front() != nullptr);
+    cancelAllAction_->setEnabled(project() != nullptr && !project()->commandQueue()->empty());
 
     if (project() && !project()->name().isEmpty()) {
         setWindowTitle(tr("%1 - %2").arg(project()->name()).arg(branding_.applicationName()));
@@ -329,17 +365,67 @@ void MainWindow::updateGuiState() {
         setWindowTitle(branding_.applicationName());
     }
 
-    if (project() && project()->commandQueue()->front() && !project()->commandQueue()->front()->isBackground()) {
+    if (project() && project()->commandQueue()->hasForegroundCommands()) {
         progressDialog_->show();
     } else {
         progressDialog_->hide();
     }
 
-    if (project() && project()->commandQueue()->front()) {
+    if (project() && !project()->commandQueue()->empty()) {
         statusProgressBar_->show();
     } else {
         statusProgressBar_->hide();
     }
+
+    updateProgress();
+}
+
+void MainWindow::updateProgress() {
+    /* QProgressBar takes int values, so the progress is scaled to a fixed range. */
+    const int scale = 1000;
+
+    /*
+     * The commands count units of work differently, so each command contributes
+     * the completed fraction of its stage. The ones with unknown totals are
+     * left out, and if all are such, the bars show a busy indicator.
+     */
+    double fractions = 0;
+    int measured = 0;
+    QStringList stages;
+
+    if (project()) {
+        foreach (const auto &command, project()->commandQueue()->running()) {
+            if (command->progressStage().isEmpty()) {
+                continue;
+            }
+
+            if (command->progressTotal() > 0) {
+                fractions += static_cast<double>(std::min(command->progressCompleted(), command->progressTotal())) /
+                             command->progressTotal();
+                ++measured;
+            }
+
+            if (command->progressEta() > 0) {
+                stages.push_back(tr("%1 About %2 s left.").arg(command->progressStage()).arg((command->progressEta() + 999) / 1000));
+            } else {
+                stages.push_back(command->progressStage());
+            }
+        }
+    }
+
+    if (measured > 0) {
+        int value = static_cast<int>(fractions * scale / measured);
+
+        statusProgressBar_->setRange(0, scale);
+        statusProgressBar_->setValue(value);
+        progressDialog_->setRange(0, scale);
+        progressDialog_->setValue(value);
+    } else {
+        statusProgressBar_->setRange(0, 0);
+        progressDialog_->setRange(0, 0);
+    }
+
+    statusProgressBar_->setToolTip(stages.join(QLatin1String("\n")));
 }
 
 void MainWindow::setWindowTitle(const QString &title) {
@@ -396,10 +482,12 @@ void MainWindow::open(std::unique_ptr<Project> project) {
     assert(project);
 
     project_ = std::move(project);
+    project_->setDecompileByFunction(decompileByFunction());
 
     imageChanged();
     instructionsChanged();
     treeChanged();
+    functionsChanged();
 
     /* Log messages to the log window. */
     project_->setLogToken(logToken_);
@@ -409,10 +497,13 @@ void MainWindow::open(std::unique_ptr<Project> project) {
     connect(project_.get(), SIGNAL(imageChanged()), this, SLOT(imageChanged()));
     connect(project_.get(), SIGNAL(instructionsChanged()), this, SLOT(instructionsChanged()));
     connect(project_.get(), SIGNAL(treeChanged()), this, SLOT(treeChanged()));
+    connect(project_.get(), SIGNAL(functionsChanged()), this, SLOT(functionsChanged()));
 
     /* Connect the project to the progress dialog. */
     connect(project_->commandQueue(), SIGNAL(nextCommand()), this, SLOT(updateGuiState()));
+    connect(project_->commandQueue(), SIGNAL(commandFinished()), this, SLOT(updateGuiState()));
     connect(project_->commandQueue(), SIGNAL(idle()), this, SLOT(updateGuiState()));
+    connect(project_->commandQueue(), SIGNAL(progressChanged()), this, SLOT(updateProgress()));
     connect(progressDialog_, SIGNAL(canceled()), project_.get(), SLOT(cancelAll()));
 
     /* Delegate "Cancel All" to the project. */
@@ -484,6 +575,67 @@ void MainWindow::populateSymbolsContextMenu(QMenu *menu) {
     }
 }
 
+void MainWindow::openSession() {
+    QString filename = QFileDialog::getOpenFileName(this, tr("Which session should I restore?"), QString(), tr("Sessions (*.ncs);;All Files(*)"));
+    if (filename.isEmpty()) {
+        return;
+    }
+
+    auto context = std::make_shared<core::Context>();
+    context->setLogToken(logToken_);
+
+    std::shared_ptr<const core::arch::Instructions> instructions;
+
+    try {
+        instructions = core::Driver::loadSession(*context, filename, true);
+    } catch (const nc::Exception &e) {
+        QMessageBox::critical(this, tr("Error"), e.unicodeWhat());
+        return;
+    } catch (const std::exception &e) {
+        QMessageBox::critical(this, tr("Error"), e.what());
+        return;
+    }
+
+    auto project = std::make_unique<gui::Project>();
+    project->setName(QFileInfo(filename).completeBaseName());
+    project->setContext(context);
+    project->setImage(context->image());
+    project->setInstructions(instructions);
+
+    open(std::move(project));
+
+    if (!context->tree() && decompileAutomatically()) {
+        project_->decompile();
+    }
+}
+
+void MainWindow::saveSession() {
+    if (!project()) {
+        return;
+    }
+
+    QString filename = QFileDialog::getSaveFileName(this, tr("Where should I save the session?"), project()->name() + ".ncs", tr("Sessions (*.ncs);;All Files(*)"));
+    if (filename.isEmpty()) {
+        return;
+    }
+
+    /* The decompilation results are saved along, if there are any. */
+    std::shared_ptr<const core::Context> context = project()->context();
+
+    if (!context->tree()) {
+        auto emptyContext = std::make_shared<core::Context>();
+        emptyContext->setLogToken(logToken_);
+        emptyContext->setImage(project()->image());
+        context = emptyContext;
+    }
+
+    try {
+        core::Driver::saveSession(*context, *project()->instructions(), filename);
+    } catch (const nc::Exception &e) {
+        QMessageBox::critical(this, tr("Error"), e.unicodeWhat());
+    }
+}
+
 void MainWindow::exportCfg() {
     if (!project()) {
         return;
@@ -553,9 +705,6 @@ void MainWindow::disassembleSelectedSectionRange() {
     if (!project()) {
         return;
     }
-    if (decompileAutomatically()) {
-        project()->cancelAll();
-    }
     project()->disassemble(disassemblyDialog_->selectedSection(), *disassemblyDialog_->startAddress(), *disassemblyDialog_->endAddress());
     if (decompileAutomatically()) {
         project()->decompile();
@@ -571,9 +720,6 @@ void MainWindow::deleteSelectedInstructions() {
     if (!project()) {
         return;
     }
-    if (decompileAutomatically()) {
-        project()->cancelAll();
-    }
     project()->deleteInstructions(instructionsView_->selectedInstructions());
     if (decompileAutomatically()) {
         project()->decompile();
@@ -584,7 +730,6 @@ void MainWindow::decompile() {
     if (!project()) {
         return;
     }
-    project()->cancelAll();
     project()->decompile();
 }
 
@@ -592,10 +737,16 @@ void MainWindow::decompileSelectedInstructions() {
     if (!project()) {
         return;
     }
-    project()->cancelAll();
     project()->decompile(instructionsView_->selectedInstructions());
 }
 
+void MainWindow::functionsChanged() {
+    if (functionsView_->model()) {
+        functionsView_->model()->deleteLater();
+    }
+    functionsView_->setModel(new FunctionsModel(this, project()->image(), project()->functionCache()->selector()));
+}
+
 bool MainWindow::decompileAutomatically() const {
     return decompileAutomaticallyAction_->isChecked();
 }
@@ -604,7 +755,31 @@ void MainWindow::setDecompileAutomatically(bool value) {
     decompileAutomaticallyAction_->setChecked(value);
 }
 
+bool MainWindow::decompileByFunction() const {
+    return decompileByFunctionAction_->isChecked();
+}
+
+void MainWindow::setDecompileByFunction(bool value) {
+    decompileByFunctionAction_->setChecked(value);
+
+    if (value) {
+        functionsView_->show();
+    }
+
+    if (project()) {
+        project()->setDecompileByFunction(value);
+    }
+}
+
 void MainWindow::highlightInstructionsInCxx() {
+    if (project() && project()->decompileByFunction()) {
+        /* Switch to the function containing the selected instruction, decompiling it if necessary. */
+        const auto &instructions = instructionsView_->selectedInstructions();
+        if (!instructions.empty() && !project()->context()->instructions()->get(instructions.front()->addr())) {
+            project()->showFunction(instructions.front()->addr());
+        }
+    }
+
     if (cxxView_->isVisible()) {
         /* Block signals, in order to avoid backfire. */
         cxxView_->blockSignals(true);
@@ -667,6 +842,14 @@ void MainWindow::jumpToSymbolAddress() {
     }
 }
 
+void MainWindow::showSelectedFunction() {
+    if (project()) {
+        if (auto entry = functionsView_->selectedFunction()) {
+            project()->showFunction(*entry, true);
+        }
+    }
+}
+
 bool MainWindow::jumpToAddress(ByteAddr address) {
     if (!project()) {
         return false;
@@ -51,6 +51,7 @@ namespace gui {
 
 class CxxView;
 class DisassemblyDialog;
+class FunctionsView;
 class InspectorView;
 class InstructionsView;
 class LogView;
@@ -70,6 +71,7 @@ class MainWindow: public QMainWindow {
     CxxView *cxxView_; ///< C++ view.
     SectionsView *sectionsView_; ///< Sections view.
     SymbolsView *symbolsView_; ///< Symbols view.
+    FunctionsView *functionsView_; ///< Functions view.
     InspectorView *inspectorView_; ///< Inspector view.
     LogView *logView_; ///< Log window.
     DisassemblyDialog *disassemblyDialog_; ///< Disassembly dialog.
@@ -78,6 +80,8 @@ class MainWindow: public QMainWindow {
     QProgressBar *statusProgressBar_; ///< Progress bar in the status bar.
 
     QAction *openAction_; ///< Action for opening a file.
+    QAction *openSessionAction_; ///< Action for restoring a saved session.
+    QAction *saveSessionAction_; ///< Action for saving the session.
     QAction *exportCfgAction_; ///< Action for exporting CFG in DOT format.
     QAction *loadStyleSheetAction_; ///< Action for loading a Qt style sheet.
     QAction *quitAction_; ///< Action for closing the main window.
@@ -85,9 +89,11 @@ class MainWindow: public QMainWindow {
     QAction *decompileAction_; ///< Action for starting decompilation.
     QAction *cancelAllAction_; ///< Action for cancelling all scheduled commands.
     QAction *decompileAutomaticallyAction_; ///< Action for toggling automatic decompilation.
+    QAction *decompileByFunctionAction_; ///< Action for toggling decompilation by function.
     QAction *instructionsViewAction_; ///< Action for showing/hiding the instructions window.
     QAction *sectionsViewAction_; ///< Action for showing/hiding the sections window.
     QAction *symbolsViewAction_; ///< Action for showing/hiding the symbols window.
+    QAction *functionsViewAction_; ///< Action for showing/hiding the functions window.
     QAction *inspectorViewAction_; ///< Action for showing/hiding the tree inspector.
     QAction *logViewAction_; ///< Action for showing/hiding the log window.
     QAction *aboutAction_; ///< Action for showing 'About Application' dialog.
@@ -148,6 +154,12 @@ public:
      */
     bool decompileAutomatically() const;
 
+    /**
+     * \return True if functions must be decompiled one by one, starting
+     *         from the one being viewed, false otherwise.
+     */
+    bool decompileByFunction() const;
+
 public Q_SLOTS:
     /**
      * Sets whether decompilation must be performed when a user changes the project.
@@ -156,6 +168,13 @@ public Q_SLOTS:
      */
     void setDecompileAutomatically(bool value);
 
+    /**
+     * Sets whether functions must be decompiled one by one.
+     *
+     * \param value True to decompile by function, false to decompile the whole program at once.
+     */
+    void setDecompileByFunction(bool value);
+
     /**
      * Opens a dialog for selecting files for decompilation, parses selected files, and starts decompiling them.
      */
@@ -257,6 +276,12 @@ private Q_SLOTS:
      */
     void updateGuiState();
 
+    /**
+     * Shows the combined progress of the commands being executed in the progress bars,
+     * and the stage of each of them in the tooltip.
+     */
+    void updateProgress();
+
     /**
      * This slot handles the event of setting a new image.
      */
@@ -272,6 +297,11 @@ private Q_SLOTS:
      */
     void treeChanged();
 
+    /**
+     * This slot handles the event of computing the functions of the instructions.
+     */
+    void functionsChanged();
+
     /**
      * Populates context menu of instructions view with actions.
      *
@@ -300,6 +330,16 @@ private Q_SLOTS:
      */
     void populateSymbolsContextMenu(QMenu *menu);
 
+    /**
+     * Opens a dialog for selecting a session file and restores the session from it.
+     */
+    void openSession();
+
+    /**
+     * Opens a dialog for selecting a file and saves the current session to it.
+     */
+    void saveSession();
+
     /**
      * Export CFG in DOT format.
      */
@@ -375,6 +415,11 @@ private Q_SLOTS:
      */
     void jumpToSymbolAddress();
 
+    /**
+     * Shows the function selected in the functions view, decompiling it if necessary.
+     */
+    void showSelectedFunction();
+
     /**
      * Shows 'About Application' dialog.
      */
@@ -0,0 +1,42 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "NodeIndex.h"
+
+#include <algorithm>
+
+namespace nc { namespace gui {
+
+void NodeIndex::finish() {
+    std::sort(nodes_.begin(), nodes_.end(), [](const NodeEntry &a, const NodeEntry &b) {
+        return a.node < b.node;
+    });
+
+    /* The range nodes are added in text order, which is the order they are highlighted in. */
+    std::stable_sort(addresses_.begin(), addresses_.end(), [](const AddressEntry &a, const AddressEntry &b) {
+        return a.address < b.address;
+    });
+}
+
+const RangeNode *NodeIndex::getRangeNode(const core::likec::TreeNode *node) const {
+    auto i = std::lower_bound(nodes_.begin(), nodes_.end(), node, [](const NodeEntry &entry, const core::likec::TreeNode *node) {
+        return entry.node < node;
+    });
+    if (i != nodes_.end() && i->node == node) {
+        return i->rangeNode;
+    }
+    return nullptr;
+}
+
+NodeIndex::AddressEntries NodeIndex::getEntries(const Range<ByteAddr> &addresses) const {
+    auto less = [](const AddressEntry &entry, ByteAddr address) { return entry.address < address; };
+
+    auto begin = std::lower_bound(addresses_.begin(), addresses_.end(), addresses.start(), less);
+    auto end = std::lower_bound(begin, addresses_.end(), addresses.end(), less);
+
+    return boost::make_iterator_range(begin, end);
+}
+
+}} // namespace nc::gui
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,125 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <vector>
+
+#include <boost/range/iterator_range.hpp>
+
+#include <nc/common/RangeClass.h>
+#include <nc/common/Types.h>
+
+namespace nc {
+
+namespace core {
+    namespace likec {
+        class TreeNode;
+    }
+}
+
+namespace gui {
+
+class RangeNode;
+
+/**
+ * Index of the range nodes of a C++ listing by their tree nodes and by
+ * the addresses of the instructions the tree nodes originate from.
+ *
+ * Both mappings are flat arrays sorted by the key, built once after
+ * printing and searched by binary search. The range nodes, unlike
+ * the text ranges, stay valid when the text is edited.
+ */
+class NodeIndex {
+public:
+    /**
+     * Entry of the mapping from tree nodes to range nodes.
+     */
+    struct NodeEntry {
+        const core::likec::TreeNode *node; ///< Tree node.
+        const RangeNode *rangeNode; ///< Range node of the tree node.
+
+        NodeEntry(const core::likec::TreeNode *node, const RangeNode *rangeNode):
+            node(node), rangeNode(rangeNode)
+        {}
+    };
+
+    /**
+     * Entry of the mapping from instruction addresses to range nodes.
+     */
+    struct AddressEntry {
+        ByteAddr address; ///< Address of the instruction.
+        const RangeNode *rangeNode; ///< Range node of a tree node generated from the instruction.
+
+        AddressEntry(ByteAddr address, const RangeNode *rangeNode):
+            address(address), rangeNode(rangeNode)
+        {}
+    };
+
+    /** Type for the range of entries of some addresses. */
+    typedef boost::iterator_range<std::vector<AddressEntry>::const_iterator> AddressEntries;
+
+private:
+    std::vector<NodeEntry> nodes_; ///< Entries sorted by the tree node.
+    std::vector<AddressEntry> addresses_; ///< Entries sorted by the address, then in text order.
+
+public:
+    /**
+     * Adds the range node of a tree node. The index must be sorted by
+     * calling finish() before it is searched.
+     *
+     * \param node Valid pointer to the tree node.
+     * \param rangeNode Valid pointer to the range node of the tree node.
+     */
+    void addNode(const core::likec::TreeNode *node, const RangeNode *rangeNode) {
+        nodes_.push_back(NodeEntry(node, rangeNode));
+    }
+
+    /**
+     * Adds the range node of a tree node generated from an instruction.
+     * The index must be sorted by calling finish() before it is searched.
+     *
+     * \param address Address of the instruction.
+     * \param rangeNode Valid pointer to the range node.
+     */
+    void addAddress(ByteAddr address, const RangeNode *rangeNode) {
+        addresses_.push_back(AddressEntry(address, rangeNode));
+    }
+
+    /**
+     * Sorts the entries added so far. The addresses having several range
+     * nodes keep them in the order they were added in.
+     */
+    void finish();
+
+    /**
+     * \param node Valid pointer to a tree node.
+     *
+     * \return Pointer to the range node of the tree node. Can be nullptr.
+     */
+    const RangeNode *getRangeNode(const core::likec::TreeNode *node) const;
+
+    /**
+     * \param addresses Range of instruction addresses.
+     *
+     * \return Entries of the range nodes generated from the instructions
+     *         starting in the given range, ordered by address.
+     */
+    AddressEntries getEntries(const Range<ByteAddr> &addresses) const;
+
+    /**
+     * Exchanges the contents of this index with another one.
+     *
+     * \param that Another index.
+     */
+    void swap(NodeIndex &that) {
+        nodes_.swap(that.nodes_);
+        addresses_.swap(that.addresses_);
+    }
+};
+
+}} // namespace nc::gui
+
+/* vim:set et sts=4 sw=4: */
@@ -24,21 +24,27 @@
 
 #include "Project.h"
 
+#include <algorithm>
 #include <cassert>
 
 #include <nc/common/make_unique.h>
 #include <nc/common/Foreach.h>
 
 #include <nc/core/Context.h>
+#include <nc/core/FunctionSelector.h>
 #include <nc/core/arch/Instructions.h>
 #include <nc/core/image/Image.h>
 #include <nc/core/image/Section.h>
 
+#include "Command.h"
 #include "CommandQueue.h"
 #include "Decompile.h"
 #include "DecompileAll.h"
+#include "DecompileFunction.h"
 #include "DeleteInstructions.h"
 #include "Disassemble.h"
+#include "FunctionCache.h"
+#include "ListFunctions.h"
 
 namespace nc {
 namespace gui {
@@ -48,7 +54,10 @@ Project::Project(QObject *parent):
     image_(std::make_shared<core::image::Image>()),
     instructions_(std::make_shared<core::arch::Instructions>()),
     context_(std::make_shared<core::Context>()),
-    commandQueue_(new CommandQueue(this))
+    commandQueue_(new CommandQueue(this)),
+    decompileByFunction_(false),
+    functionCache_(std::make_shared<FunctionCache>()),
+    queueAllFunctions_(false)
 {
 }
 
@@ -75,10 +84,26 @@ void Project::setInstructions(const std::shared_ptr<const core::arch::Instructio
 
     if (instructions_ != instructions) {
         instructions_ = instructions;
+        functionCache_->update(instructions);
         Q_EMIT instructionsChanged();
     }
 }
 
+void Project::addInstructions(const std::shared_ptr<const core::arch::Instructions> &instructions) {
+    assert(instructions);
+
+    if (instructions->empty()) {
+        return;
+    }
+
+    auto newInstructions = std::make_shared<core::arch::Instructions>(*instructions_);
+    foreach (const auto &instruction, instructions->all()) {
+        newInstructions->add(instruction);
+    }
+
+    setInstructions(newInstructions);
+}
+
 void Project::updateInstructions() {
     assert(context());
     setInstructions(context()->instructions());
@@ -88,6 +113,9 @@ void Project::setContext(const std::shared_ptr<const core::Context> &context) {
     assert(context);
 
     if (context_ != context) {
+        /* Commands run concurrently, so a replaced context may still be changing. */
+        disconnect(context_.get(), nullptr, this, nullptr);
+
         context_ = context;
 
         connect(context_.get(), SIGNAL(instructionsChanged()), this, SLOT(updateInstructions()));
@@ -95,8 +123,29 @@ void Project::setContext(const std::shared_ptr<const core::Context> &context) {
     }
 }
 
+void Project::waitForInstructions(Command *command, bool disassemblies) {
+    assert(command);
+
+    auto finished = [](const QPointer<Command> &command) { return command.isNull(); };
+    deletions_.erase(std::remove_if(deletions_.begin(), deletions_.end(), finished), deletions_.end());
+    disassemblies_.erase(std::remove_if(disassemblies_.begin(), disassemblies_.end(), finished), disassemblies_.end());
+
+    foreach (const auto &deletion, deletions_) {
+        command->addDependency(deletion);
+    }
+    if (disassemblies) {
+        foreach (const auto &disassembly, disassemblies_) {
+            command->addDependency(disassembly);
+        }
+    }
+}
+
 void Project::deleteInstructions(const std::vector<const core::arch::Instruction *> &instructions) {
-    commandQueue()->push(std::make_unique<DeleteInstructions>(this, instructions));
+    auto command = std::make_unique<DeleteInstructions>(this, instructions);
+    waitForInstructions(command.get());
+
+    deletions_.push_back(command.get());
+    commandQueue()->push(std::move(command));
 }
 
 void Project::disassemble() {
@@ -110,11 +159,145 @@ void Project::disassemble() {
 void Project::disassemble(const core::image::ByteSource *source, ByteAddr begin, ByteAddr end) {
     assert(source);
 
-    commandQueue()->push(std::make_unique<Disassemble>(this, source, begin, end));
+    /* Disassemblies only add instructions, so they can run concurrently. */
+    auto command = std::make_unique<Disassemble>(this, source, begin, end);
+    waitForInstructions(command.get(), false);
+
+    disassemblies_.push_back(command.get());
+    commandQueue()->push(std::move(command));
 }
 
 void Project::decompile() {
-    commandQueue()->push(std::make_unique<DecompileAll>(this));
+    pendingFunctions_.clear();
+    queueAllFunctions_ = false;
+    shownAddress_ = boost::none;
+
+    if (!decompileByFunction()) {
+        auto command = std::make_unique<DecompileAll>(this);
+        waitForInstructions(command.get());
+        commandQueue()->push(std::move(command));
+        return;
+    }
+
+    if (image()->entrypoint()) {
+        showFunction(*image()->entrypoint(), true);
+    } else if (!instructions()->all().empty()) {
+        showFunction((*instructions()->all().begin())->addr(), true);
+    } else {
+        return;
+    }
+
+    /* The function list is computed after the function shown first. */
+    queueAllFunctions_ = true;
+
+    if (functionCache_->selector()) {
+        updateFunctions();
+        decompileNextFunction();
+    } else {
+        auto command = std::make_unique<ListFunctions>(this);
+        command->setPriority(Command::LOW_PRIORITY);
+        connect(command.get(), SIGNAL(finished()), this, SLOT(functionsListed()));
+        waitForInstructions(command.get());
+
+        commandQueue()->push(std::move(command));
+    }
+}
+
+void Project::showFunction(ByteAddr address, bool isEntry) {
+    shownAddress_ = address;
+
+    if (!showDecompiledFunction()) {
+        auto command = std::make_unique<DecompileFunction>(this, address, isEntry);
+        command->setPriority(Command::HIGH_PRIORITY);
+        connect(command.get(), SIGNAL(finished()), this, SLOT(functionDecompiled()));
+        waitForInstructions(command.get());
+
+        commandQueue()->push(std::move(command));
+    }
+}
+
+bool Project::showDecompiledFunction() {
+    if (!shownAddress_) {
+        return false;
+    }
+
+    auto entry = functionCache_->getEntry(*shownAddress_);
+    if (!entry) {
+        return false;
+    }
+
+    auto context = functionCache_->getContext(*entry);
+    if (!context) {
+        return false;
+    }
+
+    shownAddress_ = boost::none;
+
+    if (context_ != context) {
+        setContext(context);
+        Q_EMIT treeChanged();
+    }
+    return true;
+}
+
+void Project::decompileNextFunction() {
+    if (backgroundFunction_) {
+        return;
+    }
+
+    if (pendingFunctions_.empty() && queueAllFunctions_) {
+        if (auto selector = functionCache_->selector()) {
+            queueAllFunctions_ = false;
+
+            foreach (ByteAddr entry, selector->entries()) {
+                if (!functionCache_->getContext(entry)) {
+                    pendingFunctions_.push_back(entry);
+                }
+            }
+        }
+    }
+
+    while (!pendingFunctions_.empty()) {
+        ByteAddr address = pendingFunctions_.front();
+        pendingFunctions_.pop_front();
+
+        auto entry = functionCache_->getEntry(address);
+        if (entry && functionCache_->getContext(*entry)) {
+            continue;
+        }
+
+        auto command = std::make_unique<DecompileFunction>(this, address);
+        command->setPriority(Command::LOW_PRIORITY);
+        connect(command.get(), SIGNAL(finished()), this, SLOT(functionDecompiled()));
+        waitForInstructions(command.get());
+
+        backgroundFunction_ = command.get();
+        commandQueue()->push(std::move(command));
+        return;
+    }
+}
+
+void Project::functionDecompiled() {
+    if (sender() == backgroundFunction_.data()) {
+        backgroundFunction_ = nullptr;
+    }
+
+    showDecompiledFunction();
+    updateFunctions();
+    decompileNextFunction();
+}
+
+void Project::functionsListed() {
+    updateFunctions();
+    decompileNextFunction();
+}
+
+void Project::updateFunctions() {
+    auto selector = functionCache_->selector();
+    if (selector && selector != listedFunctions_) {
+        listedFunctions_ = selector;
+        Q_EMIT functionsChanged();
+    }
 }
 
 void Project::decompile(const std::vector<const core::arch::Instruction *> &instructions) {
@@ -133,10 +316,18 @@ void Project::decompile(const std::vector<const core::arch::Instruction *> &inst
 void Project::decompile(const std::shared_ptr<const core::arch::Instructions> &instructions) {
     assert(instructions);
 
+    pendingFunctions_.clear();
+    queueAllFunctions_ = false;
+    shownAddress_ = boost::none;
+
     commandQueue()->push(std::make_unique<Decompile>(this, instructions));
 }
 
 void Project::cancelAll() {
+    pendingFunctions_.clear();
+    queueAllFunctions_ = false;
+    shownAddress_ = boost::none;
+
     commandQueue()->clear();
 }
 
@@ -26,11 +26,15 @@
 #include <nc/config.h>
 
 #include <QObject>
+#include <QPointer>
 
 #include <cassert>
+#include <deque>
 #include <memory>
 #include <vector>
 
+#include <boost/optional.hpp>
+
 #include <nc/common/Types.h>
 #include <nc/common/LogToken.h>
 
@@ -38,6 +42,7 @@ namespace nc {
 
 namespace core {
     class Context;
+    class FunctionSelector;
 
     namespace arch {
         class Instruction;
@@ -52,8 +57,10 @@ namespace core {
 
 namespace gui {
 
+class Command;
 class CommandQueue;
 class Decompile;
+class FunctionCache;
 
 /**
  * Class providing high-level model of the decompilation project.
@@ -79,6 +86,33 @@ class Project: public QObject {
     /** Queue of user commands. */
     CommandQueue *commandQueue_;
 
+    /** Whether decompilation is done function by function. */
+    bool decompileByFunction_;
+
+    /** Results of decompiling functions one by one. */
+    std::shared_ptr<FunctionCache> functionCache_;
+
+    /** Addresses of the functions to be decompiled in the background, in the order of decreasing priority. */
+    std::deque<ByteAddr> pendingFunctions_;
+
+    /** Command decompiling a function in the background. Null if there is none. */
+    QPointer<Command> backgroundFunction_;
+
+    /** Whether the functions not decompiled yet must be queued when the function list is known. */
+    bool queueAllFunctions_;
+
+    /** Functions last announced by functionsChanged(). */
+    std::shared_ptr<const core::FunctionSelector> listedFunctions_;
+
+    /** Address of an instruction of the function to be shown. */
+    boost::optional<ByteAddr> shownAddress_;
+
+    /** Scheduled commands adding disassembled instructions. */
+    std::vector<QPointer<Command>> disassemblies_;
+
+    /** Scheduled commands deleting instructions. */
+    std::vector<QPointer<Command>> deletions_;
+
     public:
 
     /**
@@ -129,6 +163,14 @@ class Project: public QObject {
      */
     void setInstructions(const std::shared_ptr<const core::arch::Instructions> &instructions);
 
+    /**
+     * Adds instructions to the set of instructions of the executable file.
+     * Instructions at the addresses already having an instruction are ignored.
+     *
+     * \param instructions Valid pointer to the instructions to add.
+     */
+    void addInstructions(const std::shared_ptr<const core::arch::Instructions> &instructions);
+
     /**
      * \return Pointer to the current context instance. Can be nullptr.
      */
@@ -158,6 +200,34 @@ class Project: public QObject {
      */
     CommandQueue *commandQueue() const { return commandQueue_; }
 
+    /**
+     * \return True if decompile() decompiles the functions one by one,
+     *         showing each of them as soon as it is ready.
+     */
+    bool decompileByFunction() const { return decompileByFunction_; }
+
+    /**
+     * Sets whether decompile() decompiles the functions one by one.
+     *
+     * \param value Whether to decompile by function.
+     */
+    void setDecompileByFunction(bool value) { decompileByFunction_ = value; }
+
+    /**
+     * \return Valid pointer to the results of decompiling functions one by one.
+     */
+    const std::shared_ptr<FunctionCache> &functionCache() const { return functionCache_; }
+
+    /**
+     * Makes the context with the decompiled function containing the given
+     * instruction current. If the function has not been decompiled yet,
+     * schedules its decompilation before all other functions.
+     *
+     * \param address Address of an instruction.
+     * \param isEntry Whether the address is the entry address of the function.
+     */
+    void showFunction(ByteAddr address, bool isEntry = false);
+
     /**
      * Schedules deletion of given instructions.
      *
@@ -197,6 +267,11 @@ class Project: public QObject {
 
     /**
      * Schedules decompilation of all the instructions of the project.
+     * In the decompile-by-function mode, the function at the entry point
+     * is decompiled and shown first. It is formed from the instructions
+     * reachable from the entry point only. Then the functions of all the
+     * instructions are computed and announced by functionsChanged(), and
+     * the rest of them are decompiled in the background.
      */
     void decompile();
 
@@ -227,12 +302,59 @@ class Project: public QObject {
      */
     void treeChanged();
 
+    /**
+     * Signal emitted when the functions of the instructions have been
+     * computed and can be taken from functionCache().
+     */
+    void functionsChanged();
+
     private Q_SLOTS:
 
     /**
      * Takes and sets the set of instructions from context.
      */
     void updateInstructions();
+
+    /**
+     * Shows the function being waited for, if it has been decompiled,
+     * and schedules decompilation of the next pending function.
+     */
+    void functionDecompiled();
+
+    /**
+     * Announces the functions of the instructions and schedules
+     * decompilation of the next pending function.
+     */
+    void functionsListed();
+
+    private:
+
+    /**
+     * Makes the context of the function being waited for current, if it has been decompiled.
+     *
+     * \return True if the function has been decompiled, false otherwise.
+     */
+    bool showDecompiledFunction();
+
+    /**
+     * Emits functionsChanged() if the function cache has functions not announced yet.
+     */
+    void updateFunctions();
+
+    /**
+     * Schedules decompilation of the next pending function,
+     * unless a function is being decompiled in the background already.
+     */
+    void decompileNextFunction();
+
+    /**
+     * Makes the command wait for the scheduled changes of the instructions.
+     *
+     * \param command Valid pointer to a command.
+     * \param disassemblies Whether to wait for the disassembly commands,
+     *                      in addition to the deletion commands.
+     */
+    void waitForInstructions(Command *command, bool disassemblies = true);
 };
 
 }} // namespace nc::gui
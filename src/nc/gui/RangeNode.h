@@ -20,24 +20,39 @@ namespace core { namespace likec {
 
 namespace gui {
 
+/**
+ * Node of a RangeTree.
+ *
+ * The offset of a node is relative to the start of its parent.
+ * Shifts of the children made by edits are not applied to each
+ * child separately, but accumulated in a Fenwick tree over the
+ * children, so that shifting all the children after a given one
+ * and computing the offset of a child take logarithmic time.
+ */
 class RangeNode {
     void *data_;
-    int offset_;
+    int offset_; ///< Offset in the parent, not including the shifts accumulated in the parent.
     int size_;
     std::vector<RangeNode> children_;
+    std::vector<int> shifts_; ///< Fenwick tree of the shifts of the children. Empty if there were none.
     RangeNode *parent_;
+    std::size_t index_; ///< Index of the node in the list of its parent's children.
 
 public:
     RangeNode(void *data, int offset):
-        data_(data), offset_(offset), size_(-1), parent_(nullptr)
+        data_(data), offset_(offset), size_(-1), parent_(nullptr), index_(0)
     {
         assert(offset >= 0);
     }
 
     void *data() const { return data_; }
 
-    int offset() const { return offset_; }
-    void setOffset(int offset) { assert(offset >= 0); offset_ = offset; }
+    int offset() const { return offset_ + (parent_ ? parent_->getChildShift(index_) : 0); }
+
+    void setOffset(int offset) {
+        assert(offset >= 0);
+        offset_ = offset - (parent_ ? parent_->getChildShift(index_) : 0);
+    }
 
     int size() const { assert(size_ >= 0); return size_; }
     void setSize(int size) { assert(size >= 0); size_ = size; }
@@ -50,19 +65,61 @@ public:
     const std::vector<RangeNode> &children() const { return children_; }
 
     RangeNode *addChild(RangeNode node) {
+        assert(shifts_.empty());
         assert(children_.empty() || children_.back().endOffset() <= node.offset());
         children_.push_back(std::move(node));
         return &children_.back();
     }
 
+    /**
+     * Adds the given value to the offsets of the child with the given index
+     * and of all the children after it. Parent pointers must be up to date.
+     *
+     * \param index Index of the first shifted child.
+     * \param shift Value to add.
+     */
+    void shiftChildren(std::size_t index, int shift) {
+        assert(index <= children_.size());
+
+        if (shifts_.empty()) {
+            shifts_.resize(children_.size());
+        }
+        for (auto i = index; i < shifts_.size(); i |= i + 1) {
+            shifts_[i] += shift;
+        }
+    }
+
     const RangeNode *parent() const { return parent_; }
 
+    /**
+     * Sets the parent pointers and the indices of all the descendants.
+     * Must be called once the tree is built and before it is edited,
+     * because the children move in memory while being added.
+     */
     void updateParentPointers() {
+        std::size_t index = 0;
         foreach (auto &child, children_) {
             child.parent_ = this;
+            child.index_ = index++;
             child.updateParentPointers();
         }
     }
+
+private:
+    /**
+     * \param index Index of a child.
+     *
+     * \return Sum of the shifts applied to the child with the given index.
+     */
+    int getChildShift(std::size_t index) const {
+        int result = 0;
+        if (!shifts_.empty()) {
+            for (auto i = index + 1; i > 0; i &= i - 1) {
+                result += shifts_[i - 1];
+            }
+        }
+        return result;
+    }
 };
 
 }} // namespace nc::gui
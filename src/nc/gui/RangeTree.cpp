@@ -76,10 +76,7 @@ Range<int> RangeTree::getRange(const RangeNode *node) const {
     assert(node != nullptr);
     assert(root_ != nullptr);
 
-    if (node->parent() == nullptr && node != root_.get()) {
-        root_->updateParentPointers();
-        assert(node->parent() != nullptr);
-    }
+    assert(node->parent() != nullptr || node == root_.get());
 
     int offset = 0;
     for (auto current = node; current != root_.get(); current = current->parent()) {
@@ -108,17 +105,16 @@ void doHandleRemoval(RangeNode &node, int offset, int nchars, std::vector<const
     modified.push_back(&node);
 
     auto i = getFirstChildNotToTheLeftOf(node, offset);
+    auto iend = node.children().end();
 
-    for (auto iend = node.children().end(); i != iend; ++i) {
-        if (i->offset() < offset + nchars) {
-            doHandleRemoval(*i, offset - i->offset(), nchars, modified);
-            if (offset < i->offset()) {
-                i->setOffset(offset);
-            }
-        } else {
-            i->setOffset(i->offset() - nchars);
+    for (; i != iend && i->offset() < offset + nchars; ++i) {
+        doHandleRemoval(*i, offset - i->offset(), nchars, modified);
+        if (offset < i->offset()) {
+            i->setOffset(offset);
         }
     }
+
+    node.shiftChildren(i - node.children().begin(), -nchars);
 }
 
 } // anonymous namespace
@@ -147,9 +143,7 @@ void doHandleInsertion(RangeNode &node, int offset, int nchars, std::vector<cons
             ++i;
         }
 
-        for (auto iend = node.children().end(); i != iend; ++i) {
-            i->setOffset(i->offset() + nchars);
-        }
+        node.shiftChildren(i - node.children().begin(), nchars);
     }
 }
 
@@ -29,6 +29,13 @@ public:
     const RangeNode *root() const { return root_.get(); }
     void setRoot(std::unique_ptr<RangeNode> root);
 
+    /**
+     * Exchanges the contents of this tree with another one.
+     *
+     * \param that Another tree.
+     */
+    void swap(RangeTree &that) { root_.swap(that.root_); }
+
     const RangeNode *getLeafAt(int position) const;
     std::vector<const RangeNode *> getNodesIn(const Range<int> &range) const;
 
@@ -52,8 +52,13 @@ public:
     void onEnd(void *data, int position) {
         assert(stack_.top().node()->data() == data);
 
-        stack_.top().node()->setSize(position - stack_.top().position());
+        auto node = stack_.top().node();
+        node->setSize(position - stack_.top().position());
         stack_.pop();
+
+        if (stack_.empty()) {
+            node->updateParentPointers();
+        }
     }
 };
 
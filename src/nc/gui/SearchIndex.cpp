@@ -0,0 +1,160 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "SearchIndex.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+#include <QRegExp>
+
+#include <nc/common/CheckedCast.h>
+#include <nc/common/Foreach.h>
+
+namespace nc { namespace gui {
+
+namespace {
+
+/** Number of lines processed between checks for cancellation. */
+const int LINES_PER_POLL = 1024;
+
+inline quint64 trigram(const QString &string, int position) {
+    return (static_cast<quint64>(string[position].unicode()) << 32) |
+           (static_cast<quint64>(string[position + 1].unicode()) << 16) |
+            static_cast<quint64>(string[position + 2].unicode());
+}
+
+inline bool isWordCharacter(QChar c) {
+    return c.isLetterOrNumber() || c == QLatin1Char('_');
+}
+
+bool isWholeWord(const QString &line, int column, int length) {
+    return (column == 0 || !isWordCharacter(line[column - 1])) &&
+           (column + length == line.size() || !isWordCharacter(line[column + length]));
+}
+
+} // anonymous namespace
+
+SearchIndex::SearchIndex(std::vector<QString> lines, const CancellationToken &cancellationToken):
+    lines_(std::move(lines))
+{
+    foldedLines_.reserve(lines_.size());
+
+    for (std::size_t i = 0; i < lines_.size(); ++i) {
+        if (i % LINES_PER_POLL == 0) {
+            cancellationToken.poll();
+        }
+
+        foldedLines_.push_back(lines_[i].toCaseFolded());
+        const QString &line = foldedLines_.back();
+
+        for (int position = 0; position + 3 <= line.size(); ++position) {
+            auto &lineNumbers = trigram2lines_[trigram(line, position)];
+            if (lineNumbers.empty() || lineNumbers.back() != static_cast<int>(i)) {
+                lineNumbers.push_back(checked_cast<int>(i));
+            }
+        }
+    }
+}
+
+void SearchIndex::getCandidateLines(const QString &foldedExpression, std::vector<int> &lines) const {
+    assert(foldedExpression.size() >= 3);
+
+    /* Lists of lines for all the trigrams, the shortest first. */
+    std::vector<const std::vector<int> *> lists;
+    for (int position = 0; position + 3 <= foldedExpression.size(); ++position) {
+        auto i = trigram2lines_.find(trigram(foldedExpression, position));
+        if (i == trigram2lines_.end()) {
+            lines.clear();
+            return;
+        }
+        lists.push_back(&i->second);
+    }
+
+    std::sort(lists.begin(), lists.end());
+    lists.erase(std::unique(lists.begin(), lists.end()), lists.end());
+    std::sort(lists.begin(), lists.end(),
+        [](const std::vector<int> *a, const std::vector<int> *b) { return a->size() < b->size(); });
+
+    lines = *lists.front();
+
+    std::vector<int> intersection;
+    for (std::size_t i = 1; i < lists.size() && !lines.empty(); ++i) {
+        intersection.clear();
+        std::set_intersection(lines.begin(), lines.end(), lists[i]->begin(), lists[i]->end(), std::back_inserter(intersection));
+        lines.swap(intersection);
+    }
+}
+
+std::vector<SearchIndex::Match> SearchIndex::find(const QString &expression, Searcher::FindFlags flags,
+    const CancellationToken &cancellationToken) const
+{
+    std::vector<Match> result;
+
+    if (expression.isEmpty()) {
+        return result;
+    }
+
+    Qt::CaseSensitivity caseSensitivity = flags & Searcher::FindCaseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
+
+    if (flags & Searcher::FindRegexp) {
+        QRegExp regexp(expression, caseSensitivity);
+        if (!regexp.isValid()) {
+            return result;
+        }
+
+        for (std::size_t i = 0; i < lines_.size(); ++i) {
+            if (i % LINES_PER_POLL == 0) {
+                cancellationToken.poll();
+            }
+
+            int column = 0;
+            while ((column = regexp.indexIn(lines_[i], column)) != -1) {
+                int length = regexp.matchedLength();
+                result.push_back(Match(checked_cast<int>(i), column, length));
+                column += std::max(length, 1);
+            }
+        }
+        return result;
+    }
+
+    /* Case folding maps one character to one, so the columns in the folded lines are the same. */
+    bool caseSensitive = caseSensitivity == Qt::CaseSensitive;
+    QString pattern = caseSensitive ? expression : expression.toCaseFolded();
+
+    auto findInLine = [&](int lineNumber) {
+        const QString &line = caseSensitive ? lines_[lineNumber] : foldedLines_[lineNumber];
+
+        int column = 0;
+        while ((column = line.indexOf(pattern, column, Qt::CaseSensitive)) != -1) {
+            if (!(flags & Searcher::FindWholeWords) || isWholeWord(line, column, pattern.size())) {
+                result.push_back(Match(lineNumber, column, pattern.size()));
+            }
+            ++column;
+        }
+    };
+
+    if (expression.size() >= 3) {
+        std::vector<int> candidates;
+        getCandidateLines(expression.toCaseFolded(), candidates);
+
+        foreach (int lineNumber, candidates) {
+            findInLine(lineNumber);
+        }
+    } else {
+        /* Too short for the trigrams. */
+        for (std::size_t i = 0; i < lines_.size(); ++i) {
+            if (i % LINES_PER_POLL == 0) {
+                cancellationToken.poll();
+            }
+            findInLine(checked_cast<int>(i));
+        }
+    }
+
+    return result;
+}
+
+}} // namespace nc::gui
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,90 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
+#include <QString>
+
+#include <nc/common/CancellationToken.h>
+
+#include "Searcher.h"
+
+namespace nc { namespace gui {
+
+/**
+ * Trigram index over a list of lines of text.
+ *
+ * A plain text query is answered by intersecting the lists of lines
+ * containing each trigram of the query and checking only the lines
+ * left. Regular expressions are matched against every line, but with
+ * cancellation, so that they can be run in a background thread.
+ *
+ * The index is immutable once built, so it can be shared between threads.
+ */
+class SearchIndex {
+    public:
+
+    /**
+     * Occurrence of a search expression.
+     */
+    struct Match {
+        int line;   ///< Line number.
+        int column; ///< Position of the first character in the line.
+        int length; ///< Length of the occurrence.
+
+        Match(int line, int column, int length): line(line), column(column), length(length) {}
+    };
+
+    /**
+     * Constructor. Builds the index.
+     *
+     * \param lines Lines of text.
+     * \param cancellationToken Cancellation token.
+     */
+    explicit SearchIndex(std::vector<QString> lines, const CancellationToken &cancellationToken = CancellationToken());
+
+    /**
+     * \return The indexed lines.
+     */
+    const std::vector<QString> &lines() const { return lines_; }
+
+    /**
+     * Finds all occurrences of the expression.
+     *
+     * \param expression Search expression.
+     * \param flags Searcher::FindCaseSensitive, Searcher::FindWholeWords and Searcher::FindRegexp
+     *              are taken into account. Whole words mode does not apply to regular expressions.
+     * \param cancellationToken Cancellation token.
+     *
+     * \return Occurrences of the expression, sorted by line and column.
+     */
+    std::vector<Match> find(const QString &expression, Searcher::FindFlags flags,
+        const CancellationToken &cancellationToken = CancellationToken()) const;
+
+    private:
+
+    /** Indexed lines. */
+    std::vector<QString> lines_;
+
+    /** Case folded indexed lines. */
+    std::vector<QString> foldedLines_;
+
+    /** Sorted numbers of lines containing each trigram of case folded characters. */
+    boost::unordered_map<quint64, std::vector<int>> trigram2lines_;
+
+    /**
+     * \param[in] foldedExpression Case folded expression with at least three characters.
+     * \param[out] lines Sorted numbers of lines that may contain the expression.
+     */
+    void getCandidateLines(const QString &foldedExpression, std::vector<int> &lines) const;
+};
+
+}} // namespace nc::gui
+
+/* vim:set et sts=4 sw=4: */
@@ -31,25 +31,33 @@
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QLineEdit>
+#include <QListView>
 #include <QMenu>
 #include <QPalette>
 #include <QPushButton>
 #include <QStringListModel>
 #include <QTimer>
+#include <QVBoxLayout>
 
 #include "Searcher.h"
 
 namespace nc { namespace gui {
 
 SearchWidget::SearchWidget(std::unique_ptr<Searcher> searcher, QWidget *parent):
-    QWidget(parent), searcher_(std::move(searcher))
+    QWidget(parent), searcher_(std::move(searcher)), showMatches_(false), incrementalSearchPending_(false)
 {
     assert(searcher_ != nullptr);
 
     auto supportedFlags = searcher_->supportedFlags();
+    auto defaultFlags = searcher_->defaultFlags();
 
-    QHBoxLayout *layout = new QHBoxLayout(this);
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    mainLayout->setContentsMargins(0, 0, 0, 0);
+    mainLayout->setSpacing(0);
+
+    QHBoxLayout *layout = new QHBoxLayout();
     layout->setContentsMargins(4, 0, 4, 4);
+    mainLayout->addLayout(layout);
 
     QLabel *findLabel = new QLabel(tr("Find:"), this);
     layout->addWidget(findLabel);
@@ -80,6 +88,12 @@ SearchWidget::SearchWidget(std::unique_ptr<Searcher> searcher, QWidget *parent):
         connect(previousButton, SIGNAL(clicked()), this, SLOT(rememberCompletion()));
     }
 
+    QPushButton *allButton = new QPushButton(tr("Find &All"), this);
+    layout->addWidget(allButton);
+
+    connect(allButton, SIGNAL(clicked()), this, SLOT(findAll()));
+    connect(allButton, SIGNAL(clicked()), this, SLOT(rememberCompletion()));
+
     incrementalSearchAction_ = new QAction(tr("&Incremental Search"), this);
     incrementalSearchAction_->setCheckable(true);
     incrementalSearchAction_->setChecked(true);
@@ -103,7 +117,7 @@ SearchWidget::SearchWidget(std::unique_ptr<Searcher> searcher, QWidget *parent):
         optionsMenu->addAction(wholeWordsAction_);
     }
     if (supportedFlags & Searcher::FindRegexp) {
-        regexpAction_->setChecked(true);
+        regexpAction_->setChecked(defaultFlags & Searcher::FindRegexp);
         optionsMenu->addAction(regexpAction_);
     }
 
@@ -120,6 +134,20 @@ SearchWidget::SearchWidget(std::unique_ptr<Searcher> searcher, QWidget *parent):
     incrementalSearchTimer_->setSingleShot(true);
 
     connect(incrementalSearchTimer_, SIGNAL(timeout()), this, SLOT(performIncrementalSearch()));
+
+    matchesModel_ = new QStringListModel(this);
+
+    matchesView_ = new QListView(this);
+    matchesView_->setModel(matchesModel_);
+    matchesView_->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    matchesView_->setUniformItemSizes(true);
+    matchesView_->hide();
+    mainLayout->addWidget(matchesView_);
+
+    connect(matchesView_, SIGNAL(activated(const QModelIndex &)), this, SLOT(showMatch(const QModelIndex &)));
+    connect(matchesView_, SIGNAL(clicked(const QModelIndex &)), this, SLOT(showMatch(const QModelIndex &)));
+
+    connect(searcher_.get(), SIGNAL(allFound(const QStringList &)), this, SLOT(showAllFound(const QStringList &)));
 }
 
 SearchWidget::~SearchWidget() {}
@@ -144,6 +172,11 @@ void SearchWidget::deactivate() {
 
     incrementalSearchTimer_->stop();
 
+    searcher()->cancelFindAll();
+    incrementalSearchPending_ = false;
+    showMatches_ = false;
+    matchesView_->hide();
+
     hide();
 }
 
@@ -187,6 +220,17 @@ void SearchWidget::scheduleIncrementalSearch() {
 }
 
 void SearchWidget::performIncrementalSearch() {
+    if (regexpAction_->isChecked() && !lineEdit_->text().isEmpty()) {
+        /* Regular expressions are matched in the background; the result is shown when ready. */
+        incrementalSearchPending_ = true;
+        searcher()->findAll(lineEdit_->text(), searchFlags());
+    } else {
+        incrementalSearchPending_ = false;
+        findIncrementally();
+    }
+}
+
+void SearchWidget::findIncrementally() {
     searcher()->stopTrackingViewport();
     searcher()->restoreViewport();
 
@@ -222,6 +266,38 @@ void SearchWidget::rememberCompletion() {
     }
 }
 
+void SearchWidget::findAll() {
+    showMatches_ = true;
+    incrementalSearchPending_ = false;
+    searcher()->findAll(lineEdit_->text(), searchFlags());
+}
+
+void SearchWidget::showAllFound(const QStringList &matches) {
+    matchesModel_->setStringList(matches);
+
+    if (showMatches_) {
+        matchesView_->show();
+    }
+
+    if (incrementalSearchPending_) {
+        incrementalSearchPending_ = false;
+        findIncrementally();
+    } else if (matches.isEmpty()) {
+        indicateFailure();
+    } else {
+        indicateSuccess();
+    }
+}
+
+void SearchWidget::showMatch(const QModelIndex &index) {
+    if (index.isValid()) {
+        searcher()->stopTrackingViewport();
+        searcher()->showMatch(index.row());
+        searcher()->rememberViewport();
+        searcher()->startTrackingViewport();
+    }
+}
+
 }} // namespace nc::gui
 
 /* vim:set et sts=4 sw=4: */
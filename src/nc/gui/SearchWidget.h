@@ -33,6 +33,8 @@
 QT_BEGIN_NAMESPACE
 class QAction;
 class QLineEdit;
+class QListView;
+class QModelIndex;
 class QStringListModel;
 QT_END_NAMESPACE
 
@@ -88,6 +90,12 @@ class SearchWidget: public QWidget {
      */
     void findPrevious();
 
+    /**
+     * Starts finding all occurrences of the entered search string
+     * and shows them in a list when found.
+     */
+    void findAll();
+
     private Q_SLOTS:
 
     /**
@@ -105,6 +113,20 @@ class SearchWidget: public QWidget {
      */
     void rememberCompletion();
 
+    /**
+     * Fills the list of the found occurrences.
+     *
+     * \param matches Descriptions of the occurrences.
+     */
+    void showAllFound(const QStringList &matches);
+
+    /**
+     * Highlights the occurrence chosen in the list.
+     *
+     * \param index Index of the occurrence in the list.
+     */
+    void showMatch(const QModelIndex &index);
+
     private:
 
     /** Associated searcher. */
@@ -137,6 +159,23 @@ class SearchWidget: public QWidget {
     /** Timer for implementing delayed incremental search. */
     QTimer *incrementalSearchTimer_;
 
+    /** List of the occurrences found by the last search for all of them. */
+    QListView *matchesView_;
+
+    /** Model of the list of the occurrences. */
+    QStringListModel *matchesModel_;
+
+    /** Whether the list of the occurrences must be shown when they are found. */
+    bool showMatches_;
+
+    /** Whether an incremental search waits for all the occurrences to be found. */
+    bool incrementalSearchPending_;
+
+    /**
+     * Finds the first occurrence of the search string and indicates the result.
+     */
+    void findIncrementally();
+
     /**
      * \return Searcher encoding of search flags selected by the user.
      */
@@ -25,7 +25,9 @@
 
 #include <nc/config.h>
 
+#include <QObject>
 #include <QString>
+#include <QStringList>
 
 namespace nc { namespace gui {
 
@@ -34,7 +36,9 @@ namespace nc { namespace gui {
  * text search in various kinds of widgets. Instances of
  * its subclasses are given to SearchWidget constructors.
  */
-class Searcher {
+class Searcher: public QObject {
+    Q_OBJECT
+
     public:
 
     /**
@@ -52,6 +56,13 @@ class Searcher {
      */
     typedef int FindFlags;
 
+    /**
+     * Constructor.
+     *
+     * \param parent Pointer to the parent object. Can be nullptr.
+     */
+    explicit Searcher(QObject *parent = nullptr): QObject(parent) {}
+
     /**
      * Virtual destructor.
      */
@@ -82,6 +93,11 @@ class Searcher {
      */
     virtual FindFlags supportedFlags() const = 0;
 
+    /**
+     * \return Bitmask of flags that must be enabled by default.
+     */
+    virtual FindFlags defaultFlags() const { return 0; }
+
     /**
      * Finds and highlights the next occurrence of given string.
      * Even if the string is not found, this function is not guaranteed
@@ -93,6 +109,37 @@ class Searcher {
      * \return True if the string was found, false otherwise.
      */
     virtual bool find(const QString &expression, FindFlags flags) = 0;
+
+    /**
+     * Starts finding all occurrences of the given string in the background.
+     * allFound() is emitted when the search is finished. After that, find()
+     * with the same arguments does not take long even for regular expressions.
+     *
+     * \param expression    Search expression.
+     * \param flags         Search flags.
+     */
+    virtual void findAll(const QString &expression, FindFlags flags) = 0;
+
+    /**
+     * Cancels the search started by findAll().
+     */
+    virtual void cancelFindAll() = 0;
+
+    /**
+     * Highlights an occurrence found by the last findAll().
+     *
+     * \param index Index of the occurrence in the list given to allFound().
+     */
+    virtual void showMatch(int index) = 0;
+
+    Q_SIGNALS:
+
+    /**
+     * Signal emitted when the search started by findAll() is finished.
+     *
+     * \param matches Descriptions of the found occurrences.
+     */
+    void allFound(const QStringList &matches);
 };
 
 }} // namespace nc::gui
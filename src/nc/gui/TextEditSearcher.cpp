@@ -24,17 +24,36 @@
 
 #include "TextEditSearcher.h"
 
+#include <algorithm>
 #include <cassert>
 
 #include <QPlainTextEdit>
+#include <QRegExp>
 #include <QScrollBar>
+#include <QTextBlock>
+#include <QTextDocument>
+
+#include <nc/common/Foreach.h>
+
+#include "IndexedSearch.h"
 
 namespace nc { namespace gui {
 
+namespace {
+
+/** Maximal number of occurrences reported by findAll(). */
+const std::size_t MAX_REPORTED_MATCHES = 10000;
+
+} // anonymous namespace
+
 TextEditSearcher::TextEditSearcher(QPlainTextEdit *textEdit):
     textEdit_(textEdit), hvalue_(-1), vvalue_(-1)
 {
     assert(textEdit != nullptr);
+
+    search_ = new IndexedSearch(this);
+    connect(search_, SIGNAL(found(const std::vector<SearchIndex::Match> &)),
+            this, SLOT(onFound(const std::vector<SearchIndex::Match> &)));
 }
 
 void TextEditSearcher::startTrackingViewport() {
@@ -62,7 +81,32 @@ void TextEditSearcher::restoreViewport() {
 }
 
 Searcher::FindFlags TextEditSearcher::supportedFlags() const {
-    return FindBackward | FindCaseSensitive | FindWholeWords;
+    return FindBackward | FindCaseSensitive | FindWholeWords | FindRegexp;
+}
+
+int TextEditSearcher::version() {
+    auto document = textEdit_->document();
+    if (document != indexedDocument_) {
+        indexedDocument_ = document;
+        search_->clear();
+    }
+    return document->revision();
+}
+
+void TextEditSearcher::buildIndex(int version) {
+    if (search_->isIndexed(version)) {
+        return;
+    }
+
+    QString text = textEdit_->document()->toPlainText();
+
+    search_->build(version, [text]() {
+        std::vector<QString> lines;
+        foreach (const QString &line, text.split(QLatin1Char('\n'))) {
+            lines.push_back(line);
+        }
+        return lines;
+    });
 }
 
 bool TextEditSearcher::find(const QString &expression, FindFlags flags) {
@@ -70,6 +114,62 @@ bool TextEditSearcher::find(const QString &expression, FindFlags flags) {
         return true;
     }
 
+    int version = this->version();
+    buildIndex(version);
+
+    if (auto matches = search_->matches(expression, flags, version)) {
+        return selectNext(*matches, flags & FindBackward);
+    } else {
+        return findSequentially(expression, flags);
+    }
+}
+
+bool TextEditSearcher::selectNext(const std::vector<SearchIndex::Match> &matches, bool backward) {
+    if (matches.empty()) {
+        return false;
+    }
+
+    auto document = textEdit_->document();
+    auto position = [document](const SearchIndex::Match &match) {
+        return document->findBlockByNumber(match.line).position() + match.column;
+    };
+
+    QTextCursor cursor = textEdit_->textCursor();
+
+    if (!backward) {
+        int start = cursor.selectionEnd();
+        auto i = std::lower_bound(matches.begin(), matches.end(), start,
+            [&](const SearchIndex::Match &match, int start) { return position(match) < start; });
+
+        select(i != matches.end() ? *i : matches.front());
+    } else {
+        int end = cursor.selectionStart();
+        auto i = std::lower_bound(matches.begin(), matches.end(), end,
+            [&](const SearchIndex::Match &match, int end) { return position(match) < end; });
+
+        select(i != matches.begin() ? *(i - 1) : matches.back());
+    }
+
+    return true;
+}
+
+void TextEditSearcher::select(const SearchIndex::Match &match) {
+    auto block = textEdit_->document()->findBlockByNumber(match.line);
+    if (!block.isValid()) {
+        return;
+    }
+
+    int position = block.position() + std::min(match.column, block.length() - 1);
+    int end = block.position() + std::min(match.column + match.length, block.length() - 1);
+
+    QTextCursor cursor = textEdit_->textCursor();
+    cursor.setPosition(position);
+    cursor.setPosition(end, QTextCursor::KeepAnchor);
+    textEdit_->setTextCursor(cursor);
+    textEdit_->ensureCursorVisible();
+}
+
+bool TextEditSearcher::findSequentially(const QString &expression, FindFlags flags) {
     auto options = QTextDocument::FindFlags();
 
     if (flags & FindBackward) {
@@ -82,14 +182,62 @@ bool TextEditSearcher::find(const QString &expression, FindFlags flags) {
         options |= QTextDocument::FindWholeWords;
     }
 
-    if (textEdit_->find(expression, options)) {
-        return true;
-    } else {
+    auto find = [&](const QTextCursor &from) -> QTextCursor {
+        if (flags & FindRegexp) {
+            return textEdit_->document()->find(
+                QRegExp(expression, flags & FindCaseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive),
+                from, options);
+        } else {
+            return textEdit_->document()->find(expression, from, options);
+        }
+    };
+
+    QTextCursor result = find(textEdit_->textCursor());
+
+    if (result.isNull()) {
         QTextCursor cursor = textEdit_->textCursor();
         cursor.movePosition((flags & FindBackward) ? QTextCursor::End : QTextCursor::Start);
-        textEdit_->setTextCursor(cursor);
 
-        return textEdit_->find(expression, options);
+        result = find(cursor);
+    }
+
+    if (result.isNull()) {
+        return false;
+    }
+
+    textEdit_->setTextCursor(result);
+    textEdit_->ensureCursorVisible();
+    return true;
+}
+
+void TextEditSearcher::findAll(const QString &expression, FindFlags flags) {
+    int version = this->version();
+    buildIndex(version);
+
+    search_->search(expression, flags);
+}
+
+void TextEditSearcher::cancelFindAll() {
+    search_->cancelSearch();
+}
+
+void TextEditSearcher::onFound(const std::vector<SearchIndex::Match> &matches) {
+    auto index = search_->searchedIndex();
+    assert(index);
+
+    matches_.assign(matches.begin(), matches.begin() + std::min(matches.size(), MAX_REPORTED_MATCHES));
+
+    QStringList descriptions;
+    foreach (const auto &match, matches_) {
+        descriptions.append(tr("%1: %2").arg(match.line + 1).arg(index->lines()[match.line].trimmed()));
+    }
+
+    Q_EMIT allFound(descriptions);
+}
+
+void TextEditSearcher::showMatch(int index) {
+    if (0 <= index && index < static_cast<int>(matches_.size())) {
+        select(matches_[index]);
     }
 }
 
@@ -25,21 +25,30 @@
 
 #include <nc/config.h>
 
-#include <QObject>
+#include <vector>
+
+#include <QPointer>
 #include <QTextCursor>
 
+#include "SearchIndex.h"
 #include "Searcher.h"
 
 QT_BEGIN_NAMESPACE
 class QPlainTextEdit;
+class QTextDocument;
 QT_END_NAMESPACE
 
 namespace nc { namespace gui {
 
+class IndexedSearch;
+
 /**
  * Search controller for QPlainTextEdit.
+ *
+ * The lines of the document are indexed in the background. Until the
+ * index is ready, the document is searched sequentially.
  */
-class TextEditSearcher: public QObject, public Searcher {
+class TextEditSearcher: public Searcher {
     Q_OBJECT
 
     /** Controlled widget. */
@@ -54,6 +63,15 @@ class TextEditSearcher: public QObject, public Searcher {
     /** Remembered vertical scrollbar position. */
     int vvalue_;
 
+    /** Index of the document's lines. */
+    IndexedSearch *search_;
+
+    /** Document the index is built for. */
+    QPointer<QTextDocument> indexedDocument_;
+
+    /** Occurrences found by the last findAll(). */
+    std::vector<SearchIndex::Match> matches_;
+
     public:
 
     /**
@@ -75,6 +93,59 @@ class TextEditSearcher: public QObject, public Searcher {
 
     virtual FindFlags supportedFlags() const override;
     virtual bool find(const QString &expression, FindFlags flags) override;
+    virtual void findAll(const QString &expression, FindFlags flags) override;
+    virtual void cancelFindAll() override;
+    virtual void showMatch(int index) override;
+
+    private Q_SLOTS:
+
+    /**
+     * Remembers the occurrences found by the index and reports them.
+     *
+     * \param matches Occurrences of the search expression.
+     */
+    void onFound(const std::vector<SearchIndex::Match> &matches);
+
+    private:
+
+    /**
+     * \return Version of the document's contents, for the index.
+     */
+    int version();
+
+    /**
+     * Starts building the index of the given version of the document, unless it is built already.
+     *
+     * \param version Version of the document's contents.
+     */
+    void buildIndex(int version);
+
+    /**
+     * Selects the occurrence next to the cursor.
+     *
+     * \param matches Occurrences in the document.
+     * \param backward Whether to select the previous occurrence instead of the next one.
+     *
+     * \return True if there was an occurrence, false otherwise.
+     */
+    bool selectNext(const std::vector<SearchIndex::Match> &matches, bool backward);
+
+    /**
+     * Selects the given occurrence.
+     *
+     * \param match Occurrence.
+     */
+    void select(const SearchIndex::Match &match);
+
+    /**
+     * Finds the next occurrence by scanning the document.
+     *
+     * \param expression Search expression.
+     * \param flags Search flags.
+     *
+     * \return True if the expression was found, false otherwise.
+     */
+    bool findSequentially(const QString &expression, FindFlags flags);
 };
 
 }} // namespace nc::gui
@@ -24,19 +24,39 @@
 
 #include "TreeViewSearcher.h"
 
+#include <algorithm>
 #include <cassert>
+#include <limits>
 
 #include <QScrollBar>
+#include <QTimer>
 #include <QTreeView>
 
 #include <nc/common/Foreach.h>
 
+#include "IndexedSearch.h"
+
 namespace nc { namespace gui {
 
+namespace {
+
+/** Number of rows whose texts are collected between the events. */
+const int ROWS_PER_STEP = 10000;
+
+/** Maximal number of occurrences reported by findAll(). */
+const std::size_t MAX_REPORTED_MATCHES = 10000;
+
+} // anonymous namespace
+
 TreeViewSearcher::TreeViewSearcher(QTreeView *treeView):
-    treeView_(treeView), hvalue_(-1), vvalue_(-1)
+    treeView_(treeView), hvalue_(-1), vvalue_(-1), version_(0), collectingVersion_(-1),
+    findAllPending_(false), pendingFlags_(0)
 {
     assert(treeView != nullptr);
+
+    search_ = new IndexedSearch(this);
+    connect(search_, SIGNAL(found(const std::vector<SearchIndex::Match> &)),
+            this, SLOT(onFound(const std::vector<SearchIndex::Match> &)));
 }
 
 void TreeViewSearcher::startTrackingViewport() {
@@ -92,6 +112,87 @@ Searcher::FindFlags TreeViewSearcher::supportedFlags() const {
     return FindBackward | FindCaseSensitive | FindRegexp;
 }
 
+Searcher::FindFlags TreeViewSearcher::defaultFlags() const {
+    return FindRegexp;
+}
+
+int TreeViewSearcher::version() {
+    auto model = treeView_->model();
+    if (model != indexedModel_) {
+        if (indexedModel_) {
+            disconnect(indexedModel_, nullptr, this, nullptr);
+        }
+
+        indexedModel_ = model;
+
+        if (model) {
+            connect(model, SIGNAL(modelReset()), this, SLOT(invalidateIndex()));
+            connect(model, SIGNAL(layoutChanged()), this, SLOT(invalidateIndex()));
+            connect(model, SIGNAL(rowsInserted(const QModelIndex &, int, int)), this, SLOT(invalidateIndex()));
+            connect(model, SIGNAL(rowsRemoved(const QModelIndex &, int, int)), this, SLOT(invalidateIndex()));
+            connect(model, SIGNAL(columnsInserted(const QModelIndex &, int, int)), this, SLOT(invalidateIndex()));
+            connect(model, SIGNAL(columnsRemoved(const QModelIndex &, int, int)), this, SLOT(invalidateIndex()));
+        }
+
+        invalidateIndex();
+    }
+    return version_;
+}
+
+void TreeViewSearcher::invalidateIndex() {
+    ++version_;
+    collectingVersion_ = -1;
+    texts_.clear();
+    search_->clear();
+}
+
+void TreeViewSearcher::buildIndex(int version) {
+    if (search_->isIndexed(version) || collectingVersion_ == version) {
+        return;
+    }
+
+    collectingVersion_ = version;
+    texts_.clear();
+
+    QTimer::singleShot(0, this, SLOT(collectTexts()));
+}
+
+void TreeViewSearcher::collectTexts() {
+    auto model = treeView_->model();
+    if (collectingVersion_ != version_ || model != indexedModel_ || !model) {
+        return;
+    }
+
+    int rowCount = model->rowCount();
+    int columnCount = model->columnCount();
+    int row = columnCount > 0 ? static_cast<int>(texts_.size()) / columnCount : rowCount;
+    int end = std::min(rowCount, row + ROWS_PER_STEP);
+
+    texts_.reserve(static_cast<std::size_t>(rowCount) * columnCount);
+    for (; row < end; ++row) {
+        for (int column = 0; column < columnCount; ++column) {
+            texts_.push_back(model->index(row, column).data().toString());
+        }
+    }
+
+    if (row < rowCount) {
+        /* Let the GUI thread process events before collecting the next portion. */
+        QTimer::singleShot(0, this, SLOT(collectTexts()));
+        return;
+    }
+
+    auto lines = std::make_shared<std::vector<QString>>(std::move(texts_));
+    texts_.clear();
+    collectingVersion_ = -1;
+
+    search_->build(version_, [lines]() { return std::move(*lines); });
+
+    if (findAllPending_) {
+        findAllPending_ = false;
+        search_->search(pendingExpression_, pendingFlags_);
+    }
+}
+
 namespace {
 
 bool match(const QModelIndex &index, const QString &expression, Searcher::FindFlags flags) {
@@ -205,6 +306,15 @@ bool TreeViewSearcher::find(const QString &expression, FindFlags flags) {
         return false;
     }
 
+    int version = this->version();
+    buildIndex(version);
+
+    if (!treeView_->currentIndex().parent().isValid()) {
+        if (auto matches = search_->matches(expression, flags, version)) {
+            return selectNext(*matches, flags & FindBackward);
+        }
+    }
+
     QModelIndex result = findFirst(treeView_->currentIndex(), expression, flags);
 
     if (result.isValid()) {
@@ -216,6 +326,93 @@ bool TreeViewSearcher::find(const QString &expression, FindFlags flags) {
     }
 }
 
+bool TreeViewSearcher::selectNext(const std::vector<SearchIndex::Match> &matches, bool backward) {
+    if (matches.empty()) {
+        return false;
+    }
+
+    auto current = treeView_->currentIndex();
+    int columnCount = treeView_->model()->columnCount();
+
+    auto byLine = [](const SearchIndex::Match &match, int line) { return match.line < line; };
+
+    if (!backward) {
+        int line = current.isValid() ? current.row() * columnCount + current.column() + 1 : 0;
+        auto i = std::lower_bound(matches.begin(), matches.end(), line, byLine);
+
+        select(i != matches.end() ? *i : matches.front());
+    } else {
+        int line = current.isValid() ? current.row() * columnCount + current.column() : std::numeric_limits<int>::max();
+        auto i = std::lower_bound(matches.begin(), matches.end(), line, byLine);
+
+        select(i != matches.begin() ? *(i - 1) : matches.back());
+    }
+
+    return true;
+}
+
+void TreeViewSearcher::select(const SearchIndex::Match &match) {
+    int columnCount = treeView_->model()->columnCount();
+    if (columnCount <= 0) {
+        return;
+    }
+
+    auto index = treeView_->model()->index(match.line / columnCount, match.line % columnCount);
+    if (index.isValid()) {
+        treeView_->setCurrentIndex(index);
+        treeView_->scrollTo(index);
+    }
+}
+
+void TreeViewSearcher::findAll(const QString &expression, FindFlags flags) {
+    if (treeView_->model() == nullptr) {
+        Q_EMIT allFound(QStringList());
+        return;
+    }
+
+    int version = this->version();
+    buildIndex(version);
+
+    if (collectingVersion_ == version) {
+        findAllPending_ = true;
+        pendingExpression_ = expression;
+        pendingFlags_ = flags;
+    } else {
+        search_->search(expression, flags);
+    }
+}
+
+void TreeViewSearcher::cancelFindAll() {
+    findAllPending_ = false;
+    search_->cancelSearch();
+}
+
+void TreeViewSearcher::onFound(const std::vector<SearchIndex::Match> &matches) {
+    auto index = search_->searchedIndex();
+    assert(index);
+
+    matches_.clear();
+
+    QStringList descriptions;
+    foreach (const auto &match, matches) {
+        if (matches_.size() >= MAX_REPORTED_MATCHES) {
+            break;
+        }
+        if (matches_.empty() || matches_.back().line != match.line) {
+            matches_.push_back(match);
+            descriptions.append(index->lines()[match.line].trimmed());
+        }
+    }
+
+    Q_EMIT allFound(descriptions);
+}
+
+void TreeViewSearcher::showMatch(int index) {
+    if (treeView_->model() && 0 <= index && index < static_cast<int>(matches_.size())) {
+        select(matches_[index]);
+    }
+}
+
 }} // namespace nc::gui
 
 /* vim:set et sts=4 sw=4: */
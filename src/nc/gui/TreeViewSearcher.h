@@ -25,21 +25,31 @@
 
 #include <nc/config.h>
 
+#include <vector>
+
 #include <QModelIndex>
-#include <QObject>
+#include <QPointer>
 
+#include "SearchIndex.h"
 #include "Searcher.h"
 
 QT_BEGIN_NAMESPACE
+class QAbstractItemModel;
 class QTreeView;
 QT_END_NAMESPACE
 
 namespace nc { namespace gui {
 
+class IndexedSearch;
+
 /**
  * Search controller for QTreeView.
+ *
+ * The texts of the top-level items are collected in small portions
+ * between the events and indexed in the background. Until the index
+ * is ready, and for the nested items, the model is searched sequentially.
  */
-class TreeViewSearcher: public QObject, public Searcher {
+class TreeViewSearcher: public Searcher {
     Q_OBJECT
 
     /** Controlled widget. */
@@ -57,6 +67,33 @@ class TreeViewSearcher: public QObject, public Searcher {
     /** Remembered vertical scrollbar position. */
     int vvalue_;
 
+    /** Index of the top-level items' texts, one line per cell. */
+    IndexedSearch *search_;
+
+    /** Model the index is built for. */
+    QPointer<QAbstractItemModel> indexedModel_;
+
+    /** Version of the model's contents. */
+    int version_;
+
+    /** Version of the model's contents whose texts are being collected, or -1. */
+    int collectingVersion_;
+
+    /** Collected texts of the cells. */
+    std::vector<QString> texts_;
+
+    /** Whether findAll() must be started when the texts are collected. */
+    bool findAllPending_;
+
+    /** Expression for the pending findAll(). */
+    QString pendingExpression_;
+
+    /** Flags for the pending findAll(). */
+    FindFlags pendingFlags_;
+
+    /** Occurrences found by the last findAll(), one per cell. */
+    std::vector<SearchIndex::Match> matches_;
+
     public:
 
     /**
@@ -77,7 +114,62 @@ class TreeViewSearcher: public QObject, public Searcher {
     virtual void stopTrackingViewport() override;
 
     virtual FindFlags supportedFlags() const override;
+    virtual FindFlags defaultFlags() const override;
     virtual bool find(const QString &string, int flags) override;
+    virtual void findAll(const QString &expression, FindFlags flags) override;
+    virtual void cancelFindAll() override;
+    virtual void showMatch(int index) override;
+
+    private Q_SLOTS:
+
+    /**
+     * Makes the index outdated.
+     */
+    void invalidateIndex();
+
+    /**
+     * Collects the texts of the next portion of the rows.
+     */
+    void collectTexts();
+
+    /**
+     * Remembers the occurrences found by the index and reports them.
+     *
+     * \param matches Occurrences of the search expression.
+     */
+    void onFound(const std::vector<SearchIndex::Match> &matches);
+
+    private:
+
+    /**
+     * \return Version of the model's contents, for the index.
+     */
+    int version();
+
+    /**
+     * Starts collecting the texts for the index of the given version
+     * of the model, unless it is built or being built already.
+     *
+     * \param version Version of the model's contents.
+     */
+    void buildIndex(int version);
+
+    /**
+     * Makes current the cell with an occurrence next to the current one.
+     *
+     * \param matches Occurrences in the cells.
+     * \param backward Whether to select the previous occurrence instead of the next one.
+     *
+     * \return True if there was an occurrence, false otherwise.
+     */
+    bool selectNext(const std::vector<SearchIndex::Match> &matches, bool backward);
+
+    /**
+     * Makes current the cell with the given occurrence.
+     *
+     * \param match Occurrence.
+     */
+    void select(const SearchIndex::Match &match);
 };
 
 }} // namespace nc::gui
@@ -27,17 +27,25 @@
 #include <nc/common/Branding.h>
 #include <nc/common/Exception.h>
 #include <nc/common/Foreach.h>
+#include <nc/common/Parallel.h>
+#include <nc/common/ProgressToken.h>
+#include <nc/common/Range.h>
 #include <nc/common/StreamLogger.h>
+#include <nc/common/StreamProgressListener.h>
+#include <nc/common/make_unique.h>
 #include <nc/common/Unreachable.h>
 
 #include <nc/core/Context.h>
+#include <nc/core/DecompilationCache.h>
 #include <nc/core/Driver.h>
+#include <nc/core/FunctionSelector.h>
 #include <nc/core/arch/Architecture.h>
 #include <nc/core/arch/ArchitectureRepository.h>
 #include <nc/core/arch/Instruction.h>
 #include <nc/core/arch/Instructions.h>
 #include <nc/core/image/Image.h>
 #include <nc/core/image/Section.h>
+#include <nc/core/image/Symbol.h>
 #include <nc/core/input/Parser.h>
 #include <nc/core/input/ParserRepository.h>
 #include <nc/core/ir/BasicBlock.h>
@@ -47,12 +55,31 @@
 #include <nc/core/ir/Statements.h>
 #include <nc/core/ir/Terms.h>
 #include <nc/core/ir/cflow/Graphs.h>
+#include <nc/core/ir/cgen/NameGenerator.h>
+#include <nc/core/likec/FunctionDefinition.h>
+#include <nc/core/likec/ParallelTreePrinter.h>
 #include <nc/core/likec/Tree.h>
+#include <nc/core/likec/TreePrinter.h>
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
 
 #include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
 #include <QStringList>
 #include <QTextStream>
+#include <QThreadPool>
+#include <QWaitCondition>
 
 const char *self = "nocode";
 
@@ -128,6 +155,803 @@ void printRegionGraphs(nc::core::Context &context, QTextStream &out) {
     out << "}" << endl;
 }
 
+void printTree(nc::core::Context &context, QTextStream &out) {
+    out.flush();
+    out.device()->write(nc::core::likec::ParallelTreePrinter::printUtf8(context.tree()->root(), context.workerCount()));
+}
+
+void printDeclaration(const nc::core::likec::Declaration *declaration, QTextStream &out) {
+    out << endl;
+    nc::core::likec::TreePrinter(out, nullptr).print(declaration);
+    out << endl;
+}
+
+QString printDeclaration(const nc::core::likec::Declaration *declaration) {
+    QString result;
+    QTextStream out(&result);
+    nc::core::likec::TreePrinter(out, nullptr).print(declaration);
+    out.flush();
+    return result;
+}
+
+/**
+ * Names of the files and directories to print the information to.
+ * Empty names mean that the corresponding information must not be printed.
+ */
+struct OutputFiles {
+    QString sections;
+    QString symbols;
+    QString instructions;
+    QString cfg;
+    QString ir;
+    QString regions;
+    QString cxx;
+    QString irDir;
+    QString regionsDir;
+    QString cxxDir;
+    QString session;
+};
+
+/**
+ * Functions to decompile. When empty, all functions are decompiled.
+ */
+struct Selection {
+    std::vector<nc::ByteAddr> entries; ///< Entry addresses of the functions.
+    std::vector<std::pair<nc::ByteAddr, nc::ByteAddr>> ranges; ///< Ranges [begin, end) of entry addresses.
+
+    bool empty() const { return entries.empty() && ranges.empty(); }
+
+    bool contains(nc::ByteAddr entry) const {
+        if (std::find(entries.begin(), entries.end(), entry) != entries.end()) {
+            return true;
+        }
+        foreach (const auto &range, ranges) {
+            if (range.first <= entry && entry < range.second) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+/**
+ * Disassembles only the code of the selected functions and of the functions they call directly:
+ * the given ranges, and then everything reachable from the selected entries.
+ *
+ * \return Entry addresses of the selected functions.
+ */
+std::vector<nc::ByteAddr> disassembleSelection(nc::core::Context &context, const Selection &selection) {
+    std::vector<nc::ByteAddr> entries = selection.entries;
+
+    if (!selection.ranges.empty()) {
+        foreach (const auto &range, selection.ranges) {
+            foreach (auto section, context.image()->sections()) {
+                if (section->isCode()) {
+                    auto begin = std::max(range.first, section->addr());
+                    auto end = std::min(range.second, section->endAddr());
+                    if (begin < end) {
+                        nc::core::Driver::disassemble(context, section, begin, end);
+                    }
+                }
+            }
+        }
+
+        nc::core::FunctionSelector selector(context);
+        foreach (nc::ByteAddr entry, selector.entries()) {
+            if (selection.contains(entry)) {
+                entries.push_back(entry);
+            }
+        }
+    }
+
+    return nc::core::Driver::disassembleFunctions(context, entries);
+}
+
+/** Name of the header with the declarations shared by the files in the C++ directory. */
+const char *const sharedHeaderName = "declarations.h";
+
+/**
+ * Writes files in a pool of threads, so that the generation of the next
+ * function does not wait for the disk.
+ */
+class FileWriter {
+    QThreadPool pool_;
+    QMutex mutex_;
+    QString error_;
+
+    class Task: public QRunnable {
+        FileWriter &writer_;
+        QString filename_;
+        QByteArray contents_;
+
+    public:
+        Task(FileWriter &writer, const QString &filename, const QByteArray &contents):
+            writer_(writer), filename_(filename), contents_(contents)
+        {}
+
+        void run() override { writer_.writeNow(filename_, contents_); }
+    };
+
+public:
+    ~FileWriter() { pool_.waitForDone(); }
+
+    /**
+     * Schedules writing of a file.
+     *
+     * \param filename Name of the file.
+     * \param contents New contents of the file.
+     */
+    void write(const QString &filename, const QByteArray &contents) {
+#ifdef NC_USE_THREADS
+        pool_.start(new Task(*this, filename, contents));
+#else
+        writeNow(filename, contents);
+#endif
+    }
+
+    /**
+     * Waits until all the scheduled files are written.
+     *
+     * \throws nc::Exception If some file could not be written.
+     */
+    void finish() {
+        pool_.waitForDone();
+        if (!error_.isEmpty()) {
+            throw nc::Exception(error_);
+        }
+    }
+
+private:
+    void writeNow(const QString &filename, const QByteArray &contents) {
+        QFile file(filename);
+        if (!file.open(QIODevice::WriteOnly) || file.write(contents) != contents.size()) {
+            QMutexLocker locker(&mutex_);
+            if (error_.isEmpty()) {
+                error_ = QString("could not write file: %1").arg(filename);
+            }
+        }
+    }
+};
+
+nc::ByteAddr parseAddress(const QString &string) {
+    bool ok;
+    nc::ByteAddr result = string.toULongLong(&ok, 16);
+    if (!ok) {
+        throw nc::Exception(QString("invalid address: %1").arg(string));
+    }
+    return result;
+}
+
+void makeDirectory(const QString &directory) {
+    if (!directory.isEmpty() && !QDir().mkpath(directory)) {
+        throw nc::Exception(QString("could not create directory: %1").arg(directory));
+    }
+}
+
+/**
+ * \return Name of the files with the information about the function,
+ *         without the extension: the entry address and the function's name.
+ *         Long names are truncated and followed by a hash of the full
+ *         name, so that the file names fit in NAME_MAX and stay unique.
+ */
+QString getFunctionFileName(const nc::core::ir::cgen::NameGenerator &nameGenerator, const nc::core::ir::Function *function) {
+    /* Leaves room for the address and the longest extension within 255 bytes. */
+    const int maxNameLength = 160;
+
+    auto name = nameGenerator.getFunctionName(function).name();
+    if (name.size() > maxNameLength) {
+        auto hash = QCryptographicHash::hash(name.toUtf8(), QCryptographicHash::Md5).toHex().left(8);
+        name = name.left(maxNameLength) + QLatin1Char('_') + QString::fromLatin1(hash.constData());
+    }
+    if (function->entry() && function->entry()->address()) {
+        return QString("%1_%2").arg(*function->entry()->address(), 0, 16).arg(name);
+    } else {
+        return name;
+    }
+}
+
+/**
+ * Prints the information about a single function to the files in the
+ * directories given in outputs.
+ *
+ * \param definition Definition of the function, or nullptr if C++ code is not printed.
+ */
+void printFunctionFiles(nc::core::Context &context, const nc::core::ir::cgen::NameGenerator &nameGenerator,
+                        const nc::core::ir::Function *function, const QString &definition,
+                        const OutputFiles &outputs, FileWriter &writer)
+{
+    QString name = getFunctionFileName(nameGenerator, function);
+
+    auto print = [&](const QString &directory, const char *extension, const std::function<void(QTextStream &)> &printer) {
+        QString text;
+        QTextStream out(&text);
+        printer(out);
+        out.flush();
+        writer.write(QDir(directory).filePath(name + QLatin1String(extension)), text.toUtf8());
+    };
+
+    if (!outputs.cxxDir.isEmpty() && !definition.isEmpty()) {
+        print(outputs.cxxDir, ".cxx", [&](QTextStream &out) {
+            out << "#include \"" << sharedHeaderName << "\"" << endl;
+            out << endl << definition << endl;
+        });
+    }
+    if (!outputs.irDir.isEmpty()) {
+        print(outputs.irDir, ".ir.dot", [&](QTextStream &out) {
+            out << "digraph Function {" << endl;
+            out << "compound = true" << endl;
+            out << *function;
+            out << "}" << endl;
+        });
+    }
+
+    /* Functions taken from the cache are not analyzed and have no graphs. */
+    const auto &graph = nc::find(*context.graphs(), function);
+    if (!outputs.regionsDir.isEmpty() && graph) {
+        print(outputs.regionsDir, ".regions.dot", [&](QTextStream &out) {
+            out << "digraph Function { compound=true; " << endl;
+            graph->print(out);
+            out << "}" << endl;
+        });
+    }
+}
+
+void decompile(const QStringList &files, const QString &session, const OutputFiles &outputs, const Selection &selection,
+               bool stream, const QString &cacheDir, std::size_t workerCount, const nc::LogToken &logToken,
+               const nc::ProgressToken &progressToken = nc::ProgressToken())
+{
+    nc::core::Context context;
+    context.setWorkerCount(workerCount);
+
+    /* The program is only needed for printing the control flow graph. */
+    context.setKeepProgram(!outputs.cfg.isEmpty());
+
+    context.setLogToken(logToken);
+    context.setProgressToken(progressToken);
+
+    bool perFunction = !outputs.irDir.isEmpty() || !outputs.regionsDir.isEmpty() || !outputs.cxxDir.isEmpty();
+
+    /* Per-function C++ files, selected functions, and cached functions can only be produced by streaming generation. */
+    bool streamed = stream || !outputs.cxxDir.isEmpty() || !selection.empty() || !cacheDir.isEmpty();
+
+    /* Whether all the functions are decompiled at once, so that the decompilation results can be saved. */
+    bool decompiledAtOnce = (!outputs.cfg.isEmpty() || !outputs.ir.isEmpty() || !outputs.regions.isEmpty() || !outputs.cxx.isEmpty() || perFunction) &&
+                            !(streamed && (!outputs.cxx.isEmpty() || !outputs.cxxDir.isEmpty()));
+
+    /* The restored results have no analyses but types and variables, so only the C++ code is printed from them. */
+    bool restoreResults = files.empty() && !streamed && !perFunction && outputs.instructions.isEmpty() &&
+                          outputs.cfg.isEmpty() && outputs.ir.isEmpty() && outputs.regions.isEmpty();
+
+    std::shared_ptr<const nc::core::arch::Instructions> allInstructions;
+
+    if (!session.isEmpty()) {
+        allInstructions = nc::core::Driver::loadSession(context, session, restoreResults);
+    }
+
+    foreach (const QString &filename, files) {
+        try {
+            nc::core::Driver::parse(context, filename);
+        } catch (const nc::Exception &e) {
+            throw nc::Exception(filename + ":" + e.unicodeWhat());
+        } catch (const std::exception &e) {
+            throw nc::Exception(filename + ":" + e.what());
+        }
+    }
+
+    openFileForWritingAndCall(outputs.sections, [&](QTextStream &out) { printSections(context, out); });
+    openFileForWritingAndCall(outputs.symbols, [&](QTextStream &out) { printSymbols(context, out); });
+
+    auto isPrinted = [&](const nc::core::ir::Function *function) {
+        return selection.empty() ||
+               (function->entry() && function->entry()->address() && selection.contains(*function->entry()->address()));
+    };
+
+    if (!outputs.instructions.isEmpty() || !outputs.cfg.isEmpty() || !outputs.ir.isEmpty() || !outputs.regions.isEmpty() || !outputs.cxx.isEmpty() || perFunction ||
+        !outputs.session.isEmpty())
+    {
+        /* A saved session must have all the instructions. */
+        bool disassembleSelected = session.isEmpty() && outputs.session.isEmpty() && !selection.empty();
+
+        if (session.isEmpty() && !disassembleSelected) {
+            nc::core::Driver::disassemble(context);
+            allInstructions = context.instructions();
+        }
+
+        /* Otherwise, the session is saved with the decompilation results. */
+        if (!outputs.session.isEmpty() && !decompiledAtOnce) {
+            nc::core::Driver::saveSession(context, *allInstructions, outputs.session);
+        }
+
+        if (!selection.empty()) {
+            auto selected = disassembleSelected ?
+                disassembleSelection(context, selection) :
+                nc::core::Driver::selectFunctions(context, [&](nc::ByteAddr entry) { return selection.contains(entry); });
+            if (selected.empty()) {
+                throw nc::Exception("no functions found at the given addresses");
+            }
+        }
+
+        openFileForWritingAndCall(outputs.instructions, [&](QTextStream &out) { context.instructions()->print(out); });
+
+        if (!outputs.cfg.isEmpty() || !outputs.ir.isEmpty() || !outputs.regions.isEmpty() || !outputs.cxx.isEmpty() || perFunction) {
+            makeDirectory(outputs.irDir);
+            makeDirectory(outputs.regionsDir);
+            makeDirectory(outputs.cxxDir);
+
+            nc::core::ir::cgen::NameGenerator nameGenerator(*context.image());
+            FileWriter writer;
+
+            if (streamed && (!outputs.cxx.isEmpty() || !outputs.cxxDir.isEmpty())) {
+                QFile headerFile;
+                QTextStream header;
+                if (!outputs.cxxDir.isEmpty()) {
+                    headerFile.setFileName(QDir(outputs.cxxDir).filePath(sharedHeaderName));
+                    if (!headerFile.open(QIODevice::WriteOnly)) {
+                        throw nc::Exception("could not open file for writing");
+                    }
+                    header.setDevice(&headerFile);
+                    header << "#pragma once" << endl;
+                }
+
+                if (!cacheDir.isEmpty()) {
+                    context.setCache(std::make_shared<nc::core::DecompilationCache>(cacheDir));
+                }
+
+                auto decompileStreamed = [&](QTextStream *out) {
+                    nc::core::Driver::decompile(context, [&](const nc::core::ir::Function *function,
+                                                             const nc::core::likec::Declaration *declaration) {
+                        if (declaration && !declaration->is<nc::core::likec::FunctionDefinition>()) {
+                            if (header.device()) {
+                                printDeclaration(declaration, header);
+                            }
+                            if (out) {
+                                printDeclaration(declaration, *out);
+                            }
+                        } else if (isPrinted(function)) {
+                            QString definition;
+                            if (declaration) {
+                                definition = printDeclaration(declaration);
+                            } else if (auto cached = context.cache()->find(context, function)) {
+                                definition = cached->text;
+                            } else {
+                                throw nc::Exception("cached function definition has disappeared");
+                            }
+                            if (perFunction) {
+                                printFunctionFiles(context, nameGenerator, function, definition, outputs, writer);
+                            }
+                            if (out) {
+                                *out << endl << definition << endl;
+                            }
+                        }
+                    });
+                };
+
+                if (!outputs.cxx.isEmpty()) {
+                    openFileForWritingAndCall(outputs.cxx, [&](QTextStream &out) { decompileStreamed(&out); });
+                } else {
+                    decompileStreamed(nullptr);
+                }
+            } else {
+                if (!context.tree()) {
+                    nc::core::Driver::decompile(context);
+                }
+
+                if (!outputs.session.isEmpty()) {
+                    nc::core::Driver::saveSession(context, *allInstructions, outputs.session);
+                }
+
+                if (perFunction) {
+                    foreach (const nc::core::ir::Function *function, context.functions()->list()) {
+                        if (isPrinted(function)) {
+                            printFunctionFiles(context, nameGenerator, function, QString(), outputs, writer);
+                        }
+                    }
+                }
+            }
+
+            writer.finish();
+
+            openFileForWritingAndCall(outputs.cfg,     [&](QTextStream &out) { context.program()->print(out); });
+            openFileForWritingAndCall(outputs.ir,      [&](QTextStream &out) { context.functions()->print(out); });
+            openFileForWritingAndCall(outputs.regions, [&](QTextStream &out) { printRegionGraphs(context, out); });
+
+            if (!streamed) {
+                openFileForWritingAndCall(outputs.cxx, [&](QTextStream &out) { printTree(context, out); });
+            }
+        }
+    }
+}
+
+/**
+ * Estimated peak memory used for decompiling a file, per byte of the file.
+ * The intermediate representation, the analyses, and the syntax tree take
+ * tens of bytes per byte of code.
+ */
+const qint64 MEMORY_PER_FILE_BYTE = 64;
+
+/**
+ * Memory budget shared by the files decompiled at once. A file waits until
+ * its estimated memory fits into the budget, unless no other file is being
+ * decompiled, so that a file larger than the budget is still decompiled.
+ */
+class MemoryBudget {
+    qint64 limit_;
+    qint64 used_;
+    QMutex mutex_;
+    QWaitCondition released_;
+
+public:
+    /**
+     * \param limit Budget in bytes, or 0 for an unlimited one.
+     */
+    explicit MemoryBudget(qint64 limit): limit_(limit), used_(0) {}
+
+    /**
+     * Waits until the given amount of memory fits into the budget and reserves it.
+     *
+     * \param size Amount of memory in bytes.
+     */
+    void acquire(qint64 size) {
+        if (limit_ == 0) {
+            return;
+        }
+        QMutexLocker locker(&mutex_);
+        while (used_ > 0 && used_ + size > limit_) {
+            released_.wait(&mutex_);
+        }
+        used_ += size;
+    }
+
+    /**
+     * Returns reserved memory to the budget.
+     *
+     * \param size Amount of memory in bytes.
+     */
+    void release(qint64 size) {
+        if (limit_ == 0) {
+            return;
+        }
+        QMutexLocker locker(&mutex_);
+        used_ -= size;
+        released_.wakeAll();
+    }
+};
+
+/**
+ * Decompiles each of the given files in its own context, at most jobs files at once.
+ * The information requested in outputs is printed to the files in the output
+ * directory named after the input files.
+ *
+ * \param maxMemory If nonzero, the files are decompiled at once only while
+ *                  their estimated memory use fits into this many bytes.
+ *
+ * \return Number of files that failed to decompile.
+ */
+std::size_t decompileBatch(const QStringList &files, const OutputFiles &outputs, const Selection &selection, bool stream,
+                           const QString &cacheDir, bool verbose, std::size_t jobs, qint64 maxMemory, const QString &outputDir)
+{
+    QDir dir(outputDir);
+    if (!dir.mkpath(".")) {
+        throw nc::Exception(QString("could not create directory: %1").arg(outputDir));
+    }
+
+    /* Give the outputs of the inputs having the same file name different names. */
+    std::vector<QString> prefixes;
+    QStringList usedNames;
+    foreach (const QString &filename, files) {
+        QString name = QFileInfo(filename).fileName();
+        if (usedNames.contains(name)) {
+            name += QString(".%1").arg(prefixes.size());
+        }
+        usedNames.append(name);
+        prefixes.push_back(dir.filePath(name));
+    }
+
+    std::vector<QString> errors(files.size());
+
+    /*
+     * Each file is decompiled using a share of the cores, so that the threads
+     * of the jobs do not add up to jobs times the number of cores.
+     */
+    std::size_t concurrentFiles = std::max<std::size_t>(1, std::min<std::size_t>(jobs, files.size()));
+    std::size_t workerCount = std::max<std::size_t>(1, nc::parallelWorkerCount() / concurrentFiles);
+
+    MemoryBudget budget(maxMemory);
+
+    nc::parallelFor(files.size(), jobs, [&](std::size_t, std::size_t index) {
+        const QString &prefix = prefixes[index];
+
+        qint64 memory = QFileInfo(files[index]).size() * MEMORY_PER_FILE_BYTE;
+        budget.acquire(memory);
+
+        auto choose = [&](const QString &option, const char *suffix) {
+            return option.isEmpty() ? QString() : prefix + QLatin1String(suffix);
+        };
+
+        OutputFiles fileOutputs;
+        fileOutputs.sections     = choose(outputs.sections,     ".sections.txt");
+        fileOutputs.symbols      = choose(outputs.symbols,      ".symbols.txt");
+        fileOutputs.instructions = choose(outputs.instructions, ".instructions.txt");
+        fileOutputs.cfg          = choose(outputs.cfg,          ".cfg.dot");
+        fileOutputs.ir           = choose(outputs.ir,           ".ir.dot");
+        fileOutputs.regions      = choose(outputs.regions,      ".regions.dot");
+        fileOutputs.cxx          = choose(outputs.cxx,          ".cxx");
+        fileOutputs.irDir        = choose(outputs.irDir,        ".ir");
+        fileOutputs.regionsDir   = choose(outputs.regionsDir,   ".regions");
+        fileOutputs.cxxDir       = choose(outputs.cxxDir,       ".cxx.d");
+
+        try {
+            if (verbose) {
+                QFile logFile(prefix + QLatin1String(".log"));
+                if (!logFile.open(QIODevice::WriteOnly)) {
+                    throw nc::Exception("could not open file for writing");
+                }
+                QTextStream log(&logFile);
+                decompile(QStringList(files[index]), QString(), fileOutputs, selection, stream, cacheDir, workerCount,
+                          nc::LogToken(std::make_shared<nc::StreamLogger>(log)));
+            } else {
+                decompile(QStringList(files[index]), QString(), fileOutputs, selection, stream, cacheDir, workerCount,
+                          nc::LogToken());
+            }
+        } catch (const nc::Exception &e) {
+            errors[index] = e.unicodeWhat();
+        } catch (const std::exception &e) {
+            errors[index] = QString::fromLocal8Bit(e.what());
+        }
+
+        budget.release(memory);
+    });
+
+    std::size_t failed = 0;
+    for (int i = 0; i < files.size(); ++i) {
+        if (errors[i].isEmpty()) {
+            qout << files[i] << ": ok" << endl;
+        } else {
+            qout << files[i] << ": error: " << errors[i] << endl;
+            ++failed;
+        }
+    }
+    qout << files.size() << " files, " << files.size() - failed << " decompiled, " << failed << " failed" << endl;
+
+    return failed;
+}
+
+/**
+ * Server keeping the parsed image and the disassembled instructions in memory
+ * and answering requests given as JSON objects, one per line.
+ *
+ * Functions are decompiled on demand, each together with its direct callees,
+ * and the results are kept until invalidated.
+ */
+class Server {
+    typedef boost::property_tree::ptree Json;
+
+    /** Results of decompiling a function. */
+    struct Result {
+        QString cxx; ///< Printed definition of the function and the declarations it needs.
+        QString ir; ///< Intermediate representation of the function in DOT language.
+        std::shared_ptr<const nc::core::arch::Instructions> instructions; ///< Decompiled instructions.
+    };
+
+    std::shared_ptr<nc::core::image::Image> image_; ///< Image.
+    std::shared_ptr<const nc::core::arch::Instructions> instructions_; ///< All the instructions.
+    nc::LogToken logToken_; ///< Log token.
+    std::unique_ptr<nc::core::FunctionSelector> selector_; ///< Functions of the instructions, created on first use.
+    std::map<nc::ByteAddr, Result> results_; ///< Results by entry address of the function.
+
+public:
+    /**
+     * Constructor.
+     *
+     * \param context Context with the parsed image and disassembled instructions.
+     */
+    explicit Server(const nc::core::Context &context):
+        image_(context.image()), instructions_(context.instructions()), logToken_(context.logToken())
+    {}
+
+    /**
+     * Answers the requests until the end of input or the "quit" command.
+     *
+     * \param in Stream with the requests.
+     * \param out Stream for the answers.
+     */
+    void run(QTextStream &in, QTextStream &out) {
+        bool quit = false;
+        while (!quit && !in.atEnd()) {
+            QString line = in.readLine().trimmed();
+            if (line.isEmpty()) {
+                continue;
+            }
+
+            Json request;
+            Json response;
+            try {
+                std::istringstream input(toUtf8String(line));
+                boost::property_tree::read_json(input, request);
+
+                if (auto id = request.get_child_optional("id")) {
+                    response.put_child("id", *id);
+                }
+                quit = handle(request, response);
+            } catch (const nc::Exception &e) {
+                response.put("error", toUtf8String(e.unicodeWhat()));
+            } catch (const std::exception &e) {
+                response.put("error", e.what());
+            }
+
+            std::ostringstream output;
+            boost::property_tree::write_json(output, response, false);
+            out << QString::fromUtf8(output.str().c_str()) << flush;
+        }
+    }
+
+private:
+    /**
+     * Handles a request.
+     *
+     * \param request Request.
+     * \param response Response to fill.
+     *
+     * \return True if the server must stop.
+     */
+    bool handle(const Json &request, Json &response) {
+        QString command = getString(request, "command");
+
+        if (command == "list") {
+            nc::core::ir::cgen::NameGenerator nameGenerator(*image_);
+            Json functions;
+            foreach (nc::ByteAddr entry, selector().entries()) {
+                Json function;
+                function.put("address", toUtf8String(QString::number(entry, 16)));
+                function.put("name", toUtf8String(nameGenerator.getFunctionName(entry).name()));
+                functions.push_back(std::make_pair(std::string(), function));
+            }
+            response.put_child("result", functions);
+        } else if (command == "decompile") {
+            response.put("result", toUtf8String(getResult(getAddress(request, "address")).cxx));
+        } else if (command == "ir") {
+            response.put("result", toUtf8String(getResult(getAddress(request, "address")).ir));
+        } else if (command == "rename") {
+            auto address = getAddress(request, "address");
+            image_->addSymbol(std::make_unique<nc::core::image::Symbol>(
+                nc::core::image::SymbolType::FUNCTION, getString(request, "name"), address));
+            /* Callers print the name too, and have the callee's instructions. */
+            response.put("result", invalidate(address, address + 1));
+        } else if (command == "invalidate") {
+            response.put("result", invalidate(getAddress(request, "begin"), getAddress(request, "end")));
+        } else if (command == "quit") {
+            response.put("result", "bye");
+            return true;
+        } else {
+            throw nc::Exception(QString("unknown command: %1").arg(command));
+        }
+        return false;
+    }
+
+    static std::string toUtf8String(const QString &string) {
+        return string.toUtf8().constData();
+    }
+
+    static QString getString(const Json &request, const char *key) {
+        return QString::fromUtf8(request.get<std::string>(key).c_str());
+    }
+
+    static nc::ByteAddr getAddress(const Json &request, const char *key) {
+        return parseAddress(getString(request, key));
+    }
+
+    const nc::core::FunctionSelector &selector() {
+        if (!selector_) {
+            nc::core::Context context;
+            context.setImage(image_);
+            context.setInstructions(instructions_);
+            context.setLogToken(logToken_);
+            selector_ = std::make_unique<nc::core::FunctionSelector>(context);
+        }
+        return *selector_;
+    }
+
+    /**
+     * \param entry Entry address of a function.
+     *
+     * \return Results of decompiling the function, computed if necessary.
+     */
+    const Result &getResult(nc::ByteAddr entry) {
+        auto i = results_.find(entry);
+        if (i != results_.end()) {
+            return i->second;
+        }
+
+        if (!selector().getFunction(entry)) {
+            throw nc::Exception(QString("no function at address %1").arg(entry, 0, 16));
+        }
+
+        nc::core::Context context;
+        context.setImage(image_);
+        context.setInstructions(selector().select(std::vector<nc::ByteAddr>(1, entry)));
+        context.setLogToken(logToken_);
+
+        auto isSelected = [&](const nc::core::ir::Function *function) {
+            return function->entry() && function->entry()->address() && *function->entry()->address() == entry;
+        };
+
+        Result result;
+        QString declarations;
+        QString definition;
+        nc::core::Driver::decompile(context, [&](const nc::core::ir::Function *function,
+                                                 const nc::core::likec::Declaration *declaration) {
+            if (!declaration->is<nc::core::likec::FunctionDefinition>()) {
+                declarations += printDeclaration(declaration) + '\n';
+            } else if (isSelected(function)) {
+                definition = printDeclaration(declaration);
+            }
+        });
+        result.cxx = declarations + '\n' + definition;
+
+        foreach (const nc::core::ir::Function *function, context.functions()->list()) {
+            if (isSelected(function)) {
+                QTextStream out(&result.ir);
+                out << "digraph Function {" << endl;
+                out << "compound = true" << endl;
+                out << *function;
+                out << "}" << endl;
+            }
+        }
+
+        result.instructions = context.instructions();
+
+        return results_[entry] = std::move(result);
+    }
+
+    /**
+     * Forgets the results of decompiling the functions having instructions in the given range.
+     *
+     * \param begin First address of the range.
+     * \param end First address past the range.
+     *
+     * \return Number of forgotten results.
+     */
+    std::size_t invalidate(nc::ByteAddr begin, nc::ByteAddr end) {
+        std::size_t count = 0;
+        for (auto i = results_.begin(); i != results_.end();) {
+            bool overlaps = false;
+            foreach (const auto &instruction, i->second.instructions->all()) {
+                if (instruction->addr() < end && begin < instruction->endAddr()) {
+                    overlaps = true;
+                    break;
+                }
+            }
+            if (overlaps) {
+                results_.erase(i++);
+                ++count;
+            } else {
+                ++i;
+            }
+        }
+        return count;
+    }
+};
+
+/**
+ * Parses the files, or restores the session, and runs the server on stdin and stdout.
+ */
+void serve(const QStringList &files, const QString &session, const nc::LogToken &logToken) {
+    nc::core::Context context;
+    context.setLogToken(logToken);
+
+    if (!session.isEmpty()) {
+        nc::core::Driver::loadSession(context, session, false);
+    }
+    foreach (const QString &filename, files) {
+        nc::core::Driver::parse(context, filename);
+    }
+    if (session.isEmpty()) {
+        nc::core::Driver::disassemble(context);
+    }
+
+    Server(context).run(qin, qout);
+}
+
 void help() {
     auto branding = nc::branding();
     branding.setApplicationName("Nocode");
@@ -144,6 +968,55 @@ void help() {
          << "  --print-ir[=FILE]           Print intermediate representation in DOT language to the file." << endl
          << "  --print-regions[=FILE]      Print results of structural analysis in DOT language to the file." << endl
          << "  --print-cxx[=FILE]          Print reconstructed program into given file." << endl
+         << "  --print-ir-dir=DIR          Print intermediate representation of each function" << endl
+         << "                              into a separate file in the directory." << endl
+         << "  --print-regions-dir=DIR     Print results of structural analysis of each function" << endl
+         << "                              into a separate file in the directory." << endl
+         << "  --print-cxx-dir=DIR         Print each reconstructed function into a separate file" << endl
+         << "                              in the directory, and the declarations they share into" << endl
+         << "                              " << sharedHeaderName << ". Implies --stream for --print-cxx." << endl
+         << "                              Files are named after functions' addresses and names." << endl
+         << "  --function=ADDR[,ADDR...]   Decompile only the functions with given hexadecimal entry" << endl
+         << "                              addresses. Only these functions and their direct callees" << endl
+         << "                              are disassembled and analyzed, and only their definitions" << endl
+         << "                              are printed. Implies --stream for --print-cxx." << endl
+         << "  --range=BEGIN-END           Same, for the functions with entry addresses in the" << endl
+         << "                              given hexadecimal range, excluding END." << endl
+         << "  --cache-dir=DIR             Keep the decompiled functions in the directory and reuse" << endl
+         << "                              them, without analyzing, for the functions whose code did" << endl
+         << "                              not change. Cached functions have no region graphs." << endl
+         << "                              Implies --stream for --print-cxx." << endl
+         << "  --save-session=FILE         Save the parsed image, the disassembled instructions," << endl
+         << "                              and the decompilation results (signatures, variables," << endl
+         << "                              types, C++ code), unless they are streamed, to the file." << endl
+         << "  --load-session=FILE         Restore the image and the instructions from the file" << endl
+         << "                              saved by --save-session instead of parsing and" << endl
+         << "                              disassembling. Input files are optional then." << endl
+         << "                              The decompilation results saved by the same version" << endl
+         << "                              are restored instead of decompiling again, when only" << endl
+         << "                              --print-cxx needs them." << endl
+         << "  --stream                    Generate and print C++ code one function at a time," << endl
+         << "                              freeing the analyses of each function once it is printed." << endl
+         << "                              Cannot be combined with --print-regions." << endl
+         << "  --serve                     Keep the parsed files in memory and answer requests," << endl
+         << "                              one JSON object per line, read from stdin. Answers" << endl
+         << "                              are printed to stdout, one JSON object per line." << endl
+         << "                              Requests have a \"command\" and an optional \"id\"," << endl
+         << "                              copied to the answer. Addresses are hexadecimal strings." << endl
+         << "                              Commands: list; decompile, ir (address); rename" << endl
+         << "                              (address, name); invalidate (begin, end); quit." << endl
+         << "                              The --print-* options are ignored." << endl
+         << "  --batch                     Decompile each input file independently. The printed" << endl
+         << "                              information goes to FILE.cxx, FILE.ir.dot, etc. in the" << endl
+         << "                              output directory; file names given to --print-* options" << endl
+         << "                              are ignored. A summary is printed to stdout." << endl
+         << "  --jobs=N                    Decompile at most N files at once in batch mode." << endl
+         << "                              Defaults to the number of processors." << endl
+         << "  --max-memory=MB             Decompile files at once in batch mode only while their" << endl
+         << "                              estimated memory use, " << MEMORY_PER_FILE_BYTE << " times the file size," << endl
+         << "                              fits into MB megabytes. Unlimited by default." << endl
+         << "  --output-dir=DIR            Directory for the files printed in batch mode." << endl
+         << "                              Defaults to the current directory." << endl
          << endl
          << branding.applicationName() << " is a command-line native code to C/C++ decompiler." << endl
          << "It parses given files, decompiles them, and prints the requested" << endl
@@ -178,12 +1051,23 @@ int main(int argc, char *argv[]) {
         QString irFile;
         QString regionsFile;
         QString cxxFile;
+        QString irDir;
+        QString regionsDir;
+        QString cxxDir;
 
         bool autoDefault = true;
         bool verbose = false;
+        bool stream = false;
+        bool batch = false;
+        bool serve = false;
+        std::size_t jobs = 0;
+        qint64 maxMemory = 0;
+        QString outputDir;
+        QString cacheDir;
+        QString loadSession;
+        QString saveSession;
 
-        std::vector<nc::ByteAddr> functionAddresses;
-        std::vector<nc::ByteAddr> callAddresses;
+        Selection selection;
 
         QStringList files;
 
@@ -196,6 +1080,46 @@ int main(int argc, char *argv[]) {
                 return 1;
             } else if (arg == "--verbose" || arg == "-v") {
                 verbose = true;
+            } else if (arg == "--stream") {
+                stream = true;
+            } else if (arg == "--batch") {
+                batch = true;
+            } else if (arg == "--serve") {
+                serve = true;
+            } else if (arg.startsWith("--jobs=")) {
+                bool ok;
+                jobs = arg.section('=', 1).toUInt(&ok);
+                if (!ok || jobs == 0) {
+                    throw nc::Exception(QString("invalid number of jobs: %1").arg(arg.section('=', 1)));
+                }
+            } else if (arg.startsWith("--max-memory=")) {
+                bool ok;
+                maxMemory = arg.section('=', 1).toLongLong(&ok);
+                if (!ok || maxMemory <= 0) {
+                    throw nc::Exception(QString("invalid memory limit: %1").arg(arg.section('=', 1)));
+                }
+                maxMemory *= 1024 * 1024;
+            } else if (arg.startsWith("--output-dir=")) {
+                outputDir = arg.section('=', 1);
+            } else if (arg.startsWith("--cache-dir=")) {
+                cacheDir = arg.section('=', 1);
+            } else if (arg.startsWith("--load-session=")) {
+                loadSession = arg.section('=', 1);
+            } else if (arg.startsWith("--save-session=")) {
+                saveSession = arg.section('=', 1);
+                autoDefault = false;
+            } else if (arg.startsWith("--function=")) {
+                foreach (const QString &address, arg.section('=', 1).split(',')) {
+                    selection.entries.push_back(parseAddress(address));
+                }
+            } else if (arg.startsWith("--range=")) {
+                QString range = arg.section('=', 1);
+                auto begin = parseAddress(range.section('-', 0, 0));
+                auto end = parseAddress(range.section('-', 1));
+                if (begin >= end) {
+                    throw nc::Exception(QString("empty address range: %1").arg(range));
+                }
+                selection.ranges.push_back(std::make_pair(begin, end));
 
             #define FILE_OPTION(option, variable)       \
             } else if (arg == option) {                 \
@@ -215,6 +1139,17 @@ int main(int argc, char *argv[]) {
 
             #undef FILE_OPTION
 
+            #define DIR_OPTION(option, variable)        \
+            } else if (arg.startsWith(option "=")) {    \
+                variable = arg.section('=', 1);         \
+                autoDefault = false;
+
+            DIR_OPTION("--print-ir-dir", irDir)
+            DIR_OPTION("--print-regions-dir", regionsDir)
+            DIR_OPTION("--print-cxx-dir", cxxDir)
+
+            #undef DIR_OPTION
+
             } else if (arg == "--") {
                 while (++i < args.size()) {
                     files.append(args[i]);
@@ -230,41 +1165,65 @@ int main(int argc, char *argv[]) {
             cxxFile = "-";
         }
 
-        if (files.empty()) {
+        if (files.empty() && loadSession.isEmpty()) {
             throw nc::Exception("no input files");
         }
 
-        nc::core::Context context;
-
-        if (verbose) {
-            context.setLogToken(nc::LogToken(std::make_shared<nc::StreamLogger>(qerr)));
+        if (serve && batch) {
+            throw nc::Exception("--serve cannot be used with --batch");
         }
 
-        foreach (const QString &filename, files) {
-            try {
-                nc::core::Driver::parse(context, filename);
-            } catch (const nc::Exception &e) {
-                throw nc::Exception(filename + ":" + e.unicodeWhat());
-            } catch (const std::exception &e) {
-                throw nc::Exception(filename + ":" + e.what());
-            }
+        if (batch && (!loadSession.isEmpty() || !saveSession.isEmpty())) {
+            throw nc::Exception("--load-session and --save-session cannot be used with --batch");
         }
 
-        openFileForWritingAndCall(sectionsFile, [&](QTextStream &out) { printSections(context, out); });
-        openFileForWritingAndCall(symbolsFile, [&](QTextStream &out) { printSymbols(context, out); });
+        if ((stream || !cxxDir.isEmpty() || !selection.empty() || !cacheDir.isEmpty()) && !regionsFile.isEmpty()) {
+            throw nc::Exception("--stream, --print-cxx-dir, --function, --range, and --cache-dir cannot be combined with --print-regions");
+        }
 
-        if (!instructionsFile.isEmpty() || !cfgFile.isEmpty() || !irFile.isEmpty() || !regionsFile.isEmpty() || !cxxFile.isEmpty()) {
-            nc::core::Driver::disassemble(context);
-            openFileForWritingAndCall(instructionsFile, [&](QTextStream &out) { context.instructions()->print(out); });
+        if (!batch && (jobs != 0 || maxMemory != 0 || !outputDir.isEmpty())) {
+            throw nc::Exception("--jobs, --max-memory, and --output-dir can only be used with --batch");
+        }
 
-            if (!cfgFile.isEmpty() || !irFile.isEmpty() || !regionsFile.isEmpty() || !cxxFile.isEmpty()) {
-                nc::core::Driver::decompile(context);
+        OutputFiles outputs;
+        outputs.sections     = sectionsFile;
+        outputs.symbols      = symbolsFile;
+        outputs.instructions = instructionsFile;
+        outputs.cfg          = cfgFile;
+        outputs.ir           = irFile;
+        outputs.regions      = regionsFile;
+        outputs.cxx          = cxxFile;
+        outputs.irDir        = irDir;
+        outputs.regionsDir   = regionsDir;
+        outputs.cxxDir       = cxxDir;
+        outputs.session      = saveSession;
 
-                openFileForWritingAndCall(cfgFile,     [&](QTextStream &out) { context.program()->print(out); });
-                openFileForWritingAndCall(irFile,      [&](QTextStream &out) { context.functions()->print(out); });
-                openFileForWritingAndCall(regionsFile, [&](QTextStream &out) { printRegionGraphs(context, out); });
-                openFileForWritingAndCall(cxxFile,     [&](QTextStream &out) { context.tree()->print(out); });
+        if (serve) {
+            nc::LogToken logToken;
+            if (verbose) {
+                logToken = nc::LogToken(std::make_shared<nc::StreamLogger>(qerr));
+            }
+            ::serve(files, loadSession, logToken);
+        } else if (batch) {
+            if (jobs == 0) {
+                jobs = nc::parallelWorkerCount();
+            }
+            if (outputDir.isEmpty()) {
+                outputDir = ".";
+            }
+            if (decompileBatch(files, outputs, selection, stream, cacheDir, verbose, jobs, maxMemory, outputDir) != 0) {
+                return 1;
+            }
+        } else {
+            nc::LogToken logToken;
+            nc::ProgressToken progressToken;
+            if (verbose) {
+                logToken = nc::LogToken(std::make_shared<nc::StreamLogger>(qerr));
+                /* Once a second is often enough for a terminal. */
+                progressToken = nc::ProgressToken(std::make_shared<nc::StreamProgressListener>(qerr), 1000);
             }
+            decompile(files, loadSession, outputs, selection, stream, cacheDir, nc::parallelWorkerCount(),
+                      logToken, progressToken);
         }
     } catch (const nc::Exception &e) {
         qerr << self << ": " << e.unicodeWhat() << endl;